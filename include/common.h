@@ -162,9 +162,11 @@ typedef enum DataType {
 } DataType;
 
 typedef enum TensorLayout {
-    M_LAYOUT_NCHW = 0,
-    M_LAYOUT_NHWC = 1,
-    M_LAYOUT_MAX  = 2,
+    M_LAYOUT_NCHW     = 0, ///< planar channels
+    M_LAYOUT_NHWC     = 1, ///< interleaved channels
+    M_LAYOUT_NC8HW8   = 2, ///< blocks of 8 channels, interleaved in a block
+    M_LAYOUT_NC16HW16 = 3, ///< blocks of 16 channels, interleaved in a block
+    M_LAYOUT_MAX      = 4,
 } TensorLayout;
 #ifdef __cplusplus
 }
@@ -193,5 +195,5 @@ const static std::string DataTypeStr[M_DATA_TYPE_MAX] = {
     "INT64",   "UINT8",   "UINT16",  "UINT32", "UINT64",
     "FLOAT16", "FLOAT32", "FLOAT64", "FIX16",  "FIX32"};
 const static std::string TensorLayoutStr[M_LAYOUT_MAX] = {
-    "NCHW",    "NHWC"};
+    "NCHW",    "NHWC",    "NC8HW8",  "NC16HW16"};
 #endif // SIMPLE_BASE_COMMON_H_
\ No newline at end of file
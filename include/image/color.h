@@ -0,0 +1,78 @@
+#ifndef SIMPLE_BASE_COLOR_H_
+#define SIMPLE_BASE_COLOR_H_
+
+#include "common.h"
+#include "image/image.h"
+
+namespace base {
+
+/** A enum of yuv matrix and range used by color conversion */
+typedef enum ColorSpace {
+    M_COLOR_BT601_LIMITED = 0, /**< BT.601, Y in [16, 235], UV in [16, 240] */
+    M_COLOR_BT601_FULL    = 1, /**< BT.601 full range, as jpeg */
+    M_COLOR_BT709_LIMITED = 2, /**< BT.709, Y in [16, 235], UV in [16, 240] */
+    M_COLOR_BT709_FULL    = 3, /**< BT.709 full range */
+    M_COLOR_MAX           = 4  /**< color space is invalid */
+} ColorSpace;
+
+/// @brief convert color of image into out
+/// @param input image on cpu, yuv of NV12, NV21, NV12_DETACH, NV21_DETACH, YUV420P, YU12, YV12,
+/// YUYV or UYVY, or rgb of 8 bits packed, 4 channels and planar formats, 16 bits and 32 bits
+/// packed and planar formats. planes of yuv may be in buffers of their own
+/// @param format rgb format of out, 8 bits of yuv input, the type size of input for rgb input
+/// @param out converted image of the same width, height and number as input
+/// @param space yuv matrix and range of yuv input
+/// @return M_OK on success
+/// @note
+/// buffer of out is reused when it already has the result size and format, otherwise out
+/// gets a new buffer. width of yuv images must be even, height of 4:2:0 images too.
+/// yuv runs a fixed-point AVX2 kernel of 32 pixels per step with 16 bits lanes, coefficients
+/// are rounded to 1/8192 and the result differs from float conversion by at most 1.
+/// rgb to rgb moves channels, 8 bits formats 32 pixels per step with vld3/vld4 and vst3/vst4,
+/// missing alpha is 255. rgb out can share buffer with input when the byte size is the same,
+/// a change between packed and planar runs from a copy of input then.
+/// rows run on the compute pipe
+MStatus convert_color(const Image& input,
+                      const PixelFormat format,
+                      Image& out,
+                      const ColorSpace space = M_COLOR_BT601_LIMITED);
+
+/// @brief convert 8 bits image into fp32 or fp16 image as pixel * scale[c] + offset[c]
+/// @param input image on cpu of BGR888, RGB888, BGRA8888, RGBA8888, BGR888_PLANAR,
+/// RGB888_PLANAR or GRAY8
+/// @param format 32 bits or 16 bits rgb format of out, packed or planar, GRAY32 or GRAY16 of
+/// GRAY8 input. 16 bits formats are fp16
+/// @param scale scale of channel c of out, gray takes scale[0]
+/// @param offset offset of channel c of out, -mean * scale of mean and std normalization
+/// @param out normalized image of the same width, height and number as input, must not be input
+/// @return M_OK on success
+/// @note
+/// buffer of out is reused when it already has the result size and format, otherwise out
+/// gets a new buffer. 32 pixels per step, loaded by vld3/vld4, widened to fp32 and scaled by
+/// FMA, stored to planes or by vst3_f32x8_avx to packed rows, fp16 by F16C conversion.
+/// rows run on the compute pipe
+MStatus normalize(const Image& input,
+                  const PixelFormat format,
+                  const float scale[3],
+                  const float offset[3],
+                  Image& out);
+
+/// @brief convert row i of image n into packed 8 bits rgb row
+/// @param input image on cpu of yuv or 8 bits rgb format supported by convert_color
+/// @param n index of image in batch
+/// @param i index of row
+/// @param format M_PIX_FMT_BGR888 or M_PIX_FMT_RGB888
+/// @param dst buffer of width * 3 bytes
+/// @param space yuv matrix and range of yuv input
+/// @return M_OK on success
+/// @note
+/// same result as the row of convert_color, for fused operators needing only some rows
+MStatus convert_color_row(const Image& input,
+                          const uint32_t n,
+                          const uint32_t i,
+                          const PixelFormat format,
+                          uint8_t* dst,
+                          const ColorSpace space = M_COLOR_BT601_LIMITED);
+
+} // namespace base
+#endif // SIMPLE_BASE_COLOR_H_
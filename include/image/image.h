@@ -11,12 +11,48 @@
 #include <vector>
 
 namespace base {
+
+/// @brief One plane of image
+/// @note
+/// packed formats have one plane, planar formats a plane per channel, yuv 4:2:0 formats
+/// a Y plane and chroma planes of half size, where the UV plane of NV12/NV21 has 2 channels
+typedef struct ImagePlane {
+    uint8_t* data;      ///< first pixel of plane
+    uint32_t width;     ///< pixels of a row
+    uint32_t height;    ///< rows of plane
+    uint32_t pitch;     ///< bytes between rows
+    uint32_t channel;   ///< interleaved channels of a pixel
+    uint32_t type_size; ///< bytes of one channel
+} ImagePlane;
+
+#define IMAGE_MAX_PLANES 3
+
+/// @brief data type of a channel of type_size bytes, 16 bits images are fp16
+inline DataType ImageDataType(const uint32_t type_size) {
+    return type_size == 1U   ? M_DATA_TYPE_UINT8
+           : type_size == 2U ? M_DATA_TYPE_FLOAT16
+           : type_size == 4U ? M_DATA_TYPE_FLOAT32
+                             : M_DATA_TYPE_MAX;
+}
+
+class Tensor;
+
 class EXPORT_API Image final {
 public:
     Image();
 
     ~Image() {}
 
+    /// @brief Copy image, the copy shares buffer of other
+    Image(const Image& other) = default;
+
+    /// @brief Move image, other is left empty without buffer
+    Image(Image&& other) noexcept = default;
+
+    Image& operator=(const Image& other) = default;
+
+    Image& operator=(Image&& other) noexcept = default;
+
     /// @brief Construct image without  memory allocate and data copy
     /// @param[in] width  : The width of image.
     /// @param[in] height : The height of image.
@@ -37,6 +73,72 @@ public:
           const void* data,
           const MemoryType mem_type = MemoryType::M_MEM_ON_CPU);
 
+    /// @brief Construct image on buffer with row pitch, without memory allocate and data copy
+    /// @param[in] width  : The width of image.
+    /// @param[in] height : The height of image.
+    /// @param[in] number : The number of image.
+    /// @param[in] pixel_format : The format of image.
+    /// @param[in] time_stamp : The time_stamp of image.
+    /// @param[in] data : The address point of image
+    /// @param[in] pitch : bytes between rows of every plane, as GetPlanes. missing or 0 pitch
+    /// takes the dense pitch of plane, Y pitch / 2 for U and V of YUV420P, YU12 and YV12
+    /// @param[in] aligned_height : rows of every plane in buffer, >= height, 4:2:0 chroma
+    /// planes have aligned_height / 2 rows. 0 takes height
+    /// @param[in] mem_type : The memory type of image.
+    /// @note
+    /// wraps decoder output as is, planes follow each other in buffer and images of a batch
+    /// are GetScalar() bytes apart. image is empty if a pitch is less than row bytes of plane.
+    /// NV12_DETACH and NV21_DETACH on one buffer are Y followed by UV as NV12 and NV21
+    Image(const uint32_t width,
+          const uint32_t height,
+          const uint32_t number,
+          const PixelFormat pixel_format,
+          const TimeStamp& time_stamp,
+          const void* data,
+          const std::vector<uint32_t>& pitch,
+          const uint32_t aligned_height,
+          const MemoryType mem_type = MemoryType::M_MEM_ON_CPU);
+
+    /// @brief Construct multi-plane image on a buffer of every plane, without memory allocate
+    /// and data copy
+    /// @param[in] width  : The width of image.
+    /// @param[in] height : The height of image.
+    /// @param[in] number : The number of image.
+    /// @param[in] pixel_format : NV12_DETACH, NV21_DETACH, NV12, NV21, YUV420P, YU12, YV12
+    /// or planar rgb formats
+    /// @param[in] time_stamp : The time_stamp of image.
+    /// @param[in] planes : The address point of every plane in order of GetPlanes, eg. Y and
+    /// UV of NV12
+    /// @param[in] pitch : bytes between rows of every plane, as the constructor on buffer
+    /// @param[in] aligned_height : rows of every plane in buffer, 0 takes height
+    /// @param[in] mem_type : The memory type of image.
+    /// @note
+    /// wraps planes of decoders as is, no concatenation copy. every plane has its data
+    /// manager, images of a batch are pitch * rows bytes apart in every plane buffer.
+    /// image is empty if count of planes mismatches format
+    Image(const uint32_t width,
+          const uint32_t height,
+          const uint32_t number,
+          const PixelFormat pixel_format,
+          const TimeStamp& time_stamp,
+          const std::vector<const void*>& planes,
+          const std::vector<uint32_t>& pitch,
+          const uint32_t aligned_height,
+          const MemoryType mem_type = MemoryType::M_MEM_ON_CPU);
+
+    /// @brief Construct image with row pitch and memory allocate
+    /// @note
+    /// pitch and aligned_height as the constructor on buffer, eg. 64 bytes aligned rows.
+    /// Y and UV of NV12_DETACH and NV21_DETACH are allocated apart
+    Image(const uint32_t width,
+          const uint32_t height,
+          const uint32_t number,
+          const PixelFormat pixel_format,
+          const TimeStamp& time_stamp,
+          const std::vector<uint32_t>& pitch,
+          const uint32_t aligned_height,
+          const MemoryType mem_type = MemoryType::M_MEM_ON_CPU);
+
     /// @brief Construct image with memory allocate
     /// @param[in] width  : The width of image.
     /// @param[in] height : The height of image.
@@ -105,14 +207,29 @@ public:
 
     /// @brief Split image with index, No data copy
     /// @param[in] idx : The index of number.
-    /// @param[out] image_out : output Image.
+    /// @param[out] image_out : view of image idx, number is 1
     /// @note
-    /// Only support number == 1 or batch size = 1
-    /// image_out will not take control of memory.
-    /// the memory will be controled by raw image.
-    /// User need to make sure split_image is free before raw_image
+    /// image_out shares buffers of raw image by SubDataManager, which holds the buffers,
+    /// so the view stays valid after raw image released. pitch and planes are those of
+    /// raw image, writes to the view change raw image
     MStatus ImageSplit(const uint32_t idx, Image& image_out) const;
 
+    /// @brief Crop region of every image in batch, No data copy
+    /// @param[in] x : left of region
+    /// @param[in] y : top of region
+    /// @param[in] width : width of region
+    /// @param[in] height : height of region
+    /// @param[out] image_out : view of region with pitch of raw image
+    /// @note
+    /// image_out shares buffers as ImageSplit, rows of the view are not dense, kernels read
+    /// and write it in place by GetPlanes. x of subsampled chroma and y of 4:2:0 formats must
+    /// be even
+    MStatus Crop(const uint32_t x,
+                 const uint32_t y,
+                 const uint32_t width,
+                 const uint32_t height,
+                 Image& image_out) const;
+
 
     /// @brief Split image with channel, No data copy
     /// @param[in] idx : The index of number.
@@ -130,7 +247,8 @@ public:
     /// @param[in] number : The width of image.
     /// @param[in] pixel_format : The format of image.
     /// @note
-    /// etc .use for YUV reshape to Y
+    /// etc .use for YUV reshape to Y. layout of rows is dense after reshape, images with
+    /// row padding can't reshape
     MStatus ImageReshape(const uint32_t width,
                          const uint32_t height,
                          const uint32_t number,
@@ -154,6 +272,13 @@ public:
         return static_cast<T*>(data);
     }
 
+    /// @brief Get planes of image
+    /// @param[in] n : The idx of image number
+    /// @param[out] planes : planes of image, IMAGE_MAX_PLANES at most
+    /// @return count of planes, 0 if image is empty. YUYV and UYVY are one plane of
+    /// width / 2 macro pixels of 4 channels
+    uint32_t GetPlanes(const uint32_t n, ImagePlane* planes) const;
+
     /// @brief Get width of image
     inline uint32_t GetWidth() const { return width_; }
 
@@ -164,8 +289,30 @@ public:
     inline uint32_t GetChannel() const { return channel_; }
 
     /// @brief Get stride of image or image width * channel
+    /// @note bytes between rows of the first plane, pitch of decoder buffer
     inline uint32_t GetStride() const { return stride_; }
 
+    /// @brief Get bytes between rows of plane, see GetPlanes
+    inline uint32_t GetPitch(const uint32_t plane = 0) const {
+        return plane < IMAGE_MAX_PLANES ? pitch_[plane] : 0U;
+    }
+
+    /// @brief Get rows of every plane in buffer, height of image without row padding
+    inline uint32_t GetAlignedHeight() const { return aligned_height_; }
+
+    /// @brief Whether rows of all planes are contiguous without padding
+    inline bool IsDense() const { return dense_; }
+
+    /// @brief Whether planes are in buffers of their own, see GetPlaneDataManager
+    /// @note
+    /// GetData, GetScalar and GetSize are of the first plane then
+    inline bool IsDetached() const { return plane_data_[1] != nullptr; }
+
+    /// @brief Get data manager of plane, data manager of image for planes in its buffer
+    inline const std::shared_ptr<DataManager>& GetPlaneDataManager(const uint32_t plane) const {
+        return plane < IMAGE_MAX_PLANES && plane_data_[plane] ? plane_data_[plane] : data_manager_;
+    }
+
     /// @brief Get numbers of image
     inline uint32_t GetNumber() const { return number_; }
 
@@ -176,7 +323,7 @@ public:
 
     /// @brief Get typesize of image
     /// @note
-    /// etc. sizeof(float) * width * hight * channal
+    /// etc. sizeof(float) * width * hight * channal, bytes of all planes with row padding
     inline uint32_t GetScalar() const { return nscalar_; }
 
     /// @brief Get size of image
@@ -202,13 +349,62 @@ public:
     inline const TimeStamp GetTimestamp() const { return time_stamp_; }
 
     /// @brief Deep Clone of Image
+    /// @note
+    /// all planes of yuv formats are copied. large images are copied on compute pipe,
+    /// frames larger than STREAM_COPY_THRESHOLD with non-temporal stores
     Image Clone() const { return Clone(data_manager_->GetMemType()); }
     Image Clone(MemoryType type) const;
 
+    /// @brief Deep copy image into target
+    /// @param[out] target : output Image.
+    /// @note
+    /// buffer of target is reused when target is dense on a buffer of its own and has the
+    /// same byte size, otherwise target gets a new dense buffer of the format, so views
+    /// never write their parent, detached planes are copied into one buffer but for
+    /// NV12_DETACH and NV21_DETACH. target takes size, format and time stamp of this image
+    MStatus CloneInto(Image& target) const;
+
+    /// @brief View tensor as image, No data copy
+    /// @param[in] tensor : tensor on cpu of {N, C, H, W} NCHW for planar formats or
+    /// {N, H, W, C} NHWC for packed formats, data type of ImageDataType of format
+    /// @param[in] format : rgb or gray format of C channels
+    /// @param[out] image_out : image sharing the data manager of tensor
+    /// @return M_OK on success, M_NOT_SUPPORT if tensor can't be seen as format
+    /// @note
+    /// pitch of every plane is the stride of tensor, so padded tensors give padded images
+    static MStatus FromTensor(const Tensor& tensor, const PixelFormat format, Image& image_out);
+
 private:
     MStatus InitImageParamters();
     MStatus CreatDataManager(const MemoryType mem_type);
 
+    /// @brief Set pitch and offset of planes and size of image
+    /// @note
+    /// missing or 0 pitch takes dense pitch of plane, 0 aligned_height takes height.
+    /// detached planes after the first are at offset 0 of their own buffers
+    MStatus InitPlanes(const std::vector<uint32_t>& pitch,
+                       const uint32_t aligned_height,
+                       const bool detached = false);
+
+    /// @brief Allocate buffers of image, Y and UV of NV12_DETACH and NV21_DETACH apart
+    MStatus MallocData();
+
+    /// @brief Set data managers of planes after the first, on planes or allocated if empty
+    MStatus InitPlaneData(const MemoryType mem_type, const std::vector<const void*>& planes);
+
+    /// @brief view of region of images [first, first + number) on buffers of this image
+    MStatus MakeView(const uint32_t first,
+                     const uint32_t number,
+                     const uint32_t x,
+                     const uint32_t y,
+                     const uint32_t width,
+                     const uint32_t height,
+                     Image& image_out) const;
+
+    /// @brief copy pixels into target of the same size and format
+    /// @note whole buffer at once when layouts match, otherwise row by row of every plane
+    void CopyData(Image& target) const;
+
 private:
     uint32_t number_{0};
     uint32_t width_{0};
@@ -217,11 +413,17 @@ private:
     uint32_t stride_{0};
     uint32_t nscalar_{0};
     uint32_t type_size_{0};
+    uint32_t aligned_height_{0};
+    uint32_t pitch_[IMAGE_MAX_PLANES]{};  ///< bytes between rows of plane
+    uint32_t offset_[IMAGE_MAX_PLANES]{}; ///< bytes from image to plane
+    uint32_t plane_size_[IMAGE_MAX_PLANES]{}; ///< bytes of plane of one image
+    bool dense_{true};
 
     TimeStamp time_stamp_;
     PixelFormat pixel_format_;
     std::string pixel_format_str_{};
     std::shared_ptr<DataManager> data_manager_{nullptr};
+    std::shared_ptr<DataManager> plane_data_[IMAGE_MAX_PLANES]; ///< buffers of detached planes
 
     bool init_done_{false};
 };
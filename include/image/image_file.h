@@ -0,0 +1,75 @@
+#ifndef SIMPLE_BASE_IMAGE_FILE_H_
+#define SIMPLE_BASE_IMAGE_FILE_H_
+
+#include "common.h"
+#include "image/image.h"
+
+#include <string>
+#include <vector>
+
+namespace base {
+
+/// @brief read binary PGM (P5) or PPM (P6) of 8 bits file as image, No data copy
+/// @param path path of file
+/// @param out GRAY8 image of P5 or RGB888 image of P6, number is 1
+/// @return M_OK on success, M_NOT_SUPPORT for ascii or 16 bits files
+/// @note
+/// the file is mapped and out points at pixels after the header, the mapping is held by out
+/// and private, writes to out don't change the file
+MStatus read_pnm(const std::string& path, Image& out);
+
+/// @brief read raw frames as written by write_raw or dumped by decoders, No data copy
+/// @param path path of file
+/// @param width width of image
+/// @param height height of image
+/// @param number frames in file, each GetScalar() bytes after the previous one
+/// @param format format of frames
+/// @param out image on the mapped file
+/// @param pitch bytes between rows of every plane, as the Image constructor on buffer
+/// @param aligned_height rows of every plane in file, 0 takes height
+/// @return M_OK on success, M_INVALID_ARG if size, format, pitch or aligned_height don't make
+/// an image, M_INVALID_FILE_FORMAT if file is smaller than the frames
+/// @note
+/// the file is mapped as read_pnm, frames start at page boundary, so SIMD loads of rows
+/// are aligned as the pitch
+MStatus read_raw(const std::string& path,
+                 const uint32_t width,
+                 const uint32_t height,
+                 const uint32_t number,
+                 const PixelFormat format,
+                 Image& out,
+                 const std::vector<uint32_t>& pitch = std::vector<uint32_t>(),
+                 const uint32_t aligned_height      = 0);
+
+/// @brief write image n of batch as binary PGM or PPM file
+/// @param path path of file
+/// @param image image on cpu of GRAY8, RGB888 or BGR888, BGR888 is written as RGB
+/// @param n index of image in batch
+/// @return M_OK on success
+/// @note
+/// rows are gathered into 1 MB chunks and written by write(2), dense RGB888 and GRAY8
+/// images go to disk in one call without copy
+MStatus write_pnm(const std::string& path, const Image& image, const uint32_t n = 0);
+
+/// @brief write all planes of all images of batch as dense raw frames
+/// @param path path of file
+/// @param image image on cpu of any format
+/// @return M_OK on success
+/// @note
+/// row padding of image is dropped, read_raw of the size and format gives image back.
+/// written as write_pnm
+MStatus write_raw(const std::string& path, const Image& image);
+
+/// @brief write images into files in parallel, eg. dump of a replay
+/// @param paths path of every image
+/// @param images images to write
+/// @param pnm write_pnm of image 0 of every image, otherwise write_raw
+/// @return M_OK if all files are written, otherwise status of the first failed file
+/// @note
+/// files are written on the compute pipe, one file per task
+MStatus write_images(const std::vector<std::string>& paths,
+                     const std::vector<Image>& images,
+                     const bool pnm = true);
+
+} // namespace base
+#endif // SIMPLE_BASE_IMAGE_FILE_H_
@@ -0,0 +1,36 @@
+#ifndef SIMPLE_BASE_IMAGE_OPERATOR_H_
+#define SIMPLE_BASE_IMAGE_OPERATOR_H_
+
+#include "common.h"
+#include "image/image.h"
+#include "register.h"
+
+#include <memory>
+#include <string>
+
+namespace base {
+
+/// @brief Image operator created by key from RegisterBase<ImageOperator>
+/// @note
+/// operators write out in the size and format out already has, eg. resize to the width and
+/// height of out. built-in operators are registered in image_operator.cc, create them by
+/// ImageOperator::Create so that they are linked from the static library. user operators
+/// can be registered as:
+/// REGISTER_COMMON_ENGINE(base, my_operator, ImageOperator, MyOperator)
+class EXPORT_API ImageOperator {
+public:
+    virtual ~ImageOperator() = default;
+
+    /// @brief Run operator
+    /// @param[in] input : input image
+    /// @param[in,out] out : output image, must not be input
+    /// @return M_OK on success
+    virtual MStatus Run(const Image& input, Image& out) = 0;
+
+    /// @brief Create operator registered with key, eg: resize
+    /// @return operator, nullptr if key is not registered
+    static std::shared_ptr<ImageOperator> Create(const std::string& key);
+};
+
+} // namespace base
+#endif // SIMPLE_BASE_IMAGE_OPERATOR_H_
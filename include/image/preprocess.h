@@ -0,0 +1,88 @@
+#ifndef SIMPLE_BASE_PREPROCESS_H_
+#define SIMPLE_BASE_PREPROCESS_H_
+
+#include "common.h"
+#include "image/color.h"
+#include "image/image.h"
+#include "image/resize.h"
+#include "tensor/tensor.h"
+
+namespace base {
+
+/// @brief Paramter of preprocess
+typedef struct PreprocessParam {
+    PreprocessParam()
+        : format(M_PIX_FMT_RGB888),
+          width(0),
+          height(0),
+          layout(M_LAYOUT_NCHW),
+          elem_type(M_DATA_TYPE_FLOAT32),
+          interpolation(M_INTER_LINEAR),
+          space(M_COLOR_BT601_LIMITED),
+          mean{0.f, 0.f, 0.f},
+          norm{1.f, 1.f, 1.f},
+          letterbox(false),
+          pad(0.f) {}
+    PixelFormat format;              ///< channel order of out, RGB888, BGR888 or GRAY8
+    uint32_t width;                  ///< W of out, 0 keeps width of input
+    uint32_t height;                 ///< H of out, 0 keeps height of input
+    TensorLayout layout;             ///< NCHW or NHWC
+    DataType elem_type;              ///< FLOAT32 or FLOAT16
+    InterpolationType interpolation; ///< M_INTER_NEAREST or M_INTER_LINEAR
+    ColorSpace space;                ///< yuv matrix and range of yuv input
+    float mean[3];                   ///< mean of channel c of out
+    float norm[3];                   ///< 1 / std of channel c of out
+    bool letterbox;                  ///< keep aspect ratio, center in out with padding around
+    float pad;                       ///< pixel value of padding, normalized as pixels
+} PreprocessParam;
+
+/// @brief Region of image n of batch, in pixels, right and bottom excluded
+typedef struct CropBox {
+    float x0;       ///< left
+    float y0;       ///< top
+    float x1;       ///< right
+    float y1;       ///< bottom
+    uint32_t index; ///< index of image in batch
+} CropBox;
+
+/// @brief color convert, resize and normalize image into model input tensor in one pass
+/// @param input image on cpu of NV12, NV21, NV12_DETACH, NV21_DETACH, YUV420P, YU12, YV12,
+/// YUYV, UYVY, BGR888, RGB888, BGRA8888, RGBA8888, BGR888_PLANAR, RGB888_PLANAR or GRAY8
+/// @param param format, size, layout and type of out, and normalization
+/// @param out tensor of {N, C, H, W} for NCHW or {N, H, W, C} for NHWC, buffer reused as
+/// Tensor::Reset with padding of out
+/// @return M_OK on success
+/// @note
+/// out = (pixel - mean[c]) * norm[c], pixel is the resized value of convert_color output.
+/// letterbox resizes the image into the largest centered region of its aspect ratio, other
+/// pixels are pad.
+/// GRAY8 out takes gray input or Y of 4:2:0 yuv input, yuv sizes must be even as
+/// convert_color. only source rows used by out are converted, one row at a time into a
+/// scratch buffer, rows already in the format of out are read in place.
+/// rows are filtered along W into a ring of 2 rows per thread in channel order of out, so
+/// NCHW output needs no deinterleave, and blended along H, normalized by FMA and stored as
+/// fp32 or fp16 in the same step. output rows run on the compute pipe
+MStatus preprocess(const Image& input, const PreprocessParam& param, Tensor& out);
+
+/// @brief crop boxes of image and preprocess them into one batch tensor, as ROIAlign with
+/// one sample per bin
+/// @param input image on cpu of the formats of preprocess
+/// @param boxes regions to crop, may exceed image but must overlap it
+/// @param param format, size, layout and type of out, and normalization as preprocess,
+/// width and height must not be 0
+/// @param out tensor of {boxes, C, H, W} for NCHW or {boxes, H, W, C} for NHWC, buffer reused
+/// as Tensor::Reset with padding of out
+/// @return M_OK on success
+/// @note
+/// out pixel i samples the box at x0 + (i + 0.5) * (x1 - x0) / W - 0.5 bilinear, samples out
+/// of image take the edge. every box reads a Crop view of its region, so only its pixels are
+/// converted. taps of all boxes are built once before resizing, normalization is shared.
+/// workers take bands of 8 output rows of any box in turn, so boxes of different sizes
+/// balance over the compute pipe
+MStatus crop_resize(const Image& input,
+                    const std::vector<CropBox>& boxes,
+                    const PreprocessParam& param,
+                    Tensor& out);
+
+} // namespace base
+#endif // SIMPLE_BASE_PREPROCESS_H_
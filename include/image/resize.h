@@ -0,0 +1,62 @@
+#ifndef SIMPLE_BASE_RESIZE_H_
+#define SIMPLE_BASE_RESIZE_H_
+
+#include "common.h"
+#include "image/image.h"
+#include "image/image_operator.h"
+
+namespace base {
+
+/** A enum of interpolation of resize */
+typedef enum InterpolationType {
+    M_INTER_NEAREST = 0, /**< nearest pixel */
+    M_INTER_LINEAR  = 1, /**< bilinear */
+    M_INTER_AREA    = 2, /**< mean of covered pixels when shrinking, bilinear when enlarging */
+    M_INTER_MAX     = 3  /**< interpolation is invalid */
+} InterpolationType;
+
+/// @brief resize image into out
+/// @param input image on cpu of GRAY8, BGR888, RGB888, BGRA8888, RGBA8888, GRAY32,
+/// BGR323232, RGB323232, FLOAT32C4, 8 bits or fp32 planar formats, NV12, NV21, NV12_DETACH,
+/// NV21_DETACH, YUV420P, YU12 or YV12
+/// @param width width of out
+/// @param height height of out
+/// @param out resized image of the format and number of input, must not be input
+/// @param type interpolation
+/// @return M_OK on success
+/// @note
+/// buffer of out is reused when it already has the result size and format, otherwise out
+/// gets a new buffer. every plane is resized alone, yuv sizes must be even.
+/// pixel centers are aligned as (x + 0.5) * scale - 0.5 and edges are replicated.
+/// coordinates and weights of both axes are tables built once per plane. bilinear runs a
+/// horizontal pass into a ring buffer of 2 rows per thread, so a source row is filtered once
+/// for all output rows using it, and a vertical pass blending 2 rows. u8 weights are 11 bits
+/// fixed-point, the horizontal pass gathers 8 elements with AVX2 and the vertical pass makes
+/// 16 bytes per step. area sums its taps in fp32 with a ring of the taps of one output row,
+/// the horizontal pass gathers the taps of 8 elements as bilinear, u8 rows are widened to fp32
+/// first and u8 results round half to even. output rows run on the compute pipe
+MStatus resize(const Image& input,
+               const uint32_t width,
+               const uint32_t height,
+               Image& out,
+               const InterpolationType type = M_INTER_LINEAR);
+
+/// @brief Resize operator to the width and height of out
+/// @note
+/// registered as resize, resize_nearest and resize_area, eg:
+/// base::Image out(input, 320, 240);
+/// ImageOperator::Create("resize")->Run(input, out);
+template <InterpolationType kType>
+class Resize final : public ImageOperator {
+public:
+    MStatus Run(const Image& input, Image& out) override {
+        return resize(input, out.GetWidth(), out.GetHeight(), out, kType);
+    }
+};
+
+typedef Resize<M_INTER_NEAREST> ResizeNearest;
+typedef Resize<M_INTER_LINEAR> ResizeLinear;
+typedef Resize<M_INTER_AREA> ResizeArea;
+
+} // namespace base
+#endif // SIMPLE_BASE_RESIZE_H_
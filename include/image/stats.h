@@ -0,0 +1,52 @@
+#ifndef SIMPLE_BASE_STATS_H_
+#define SIMPLE_BASE_STATS_H_
+
+#include "common.h"
+#include "image/image.h"
+
+#include <vector>
+
+namespace base {
+
+#define IMAGE_STATS_MAX_CHANNEL 4
+#define IMAGE_HIST_BINS 256
+
+/// @brief Statistics of every channel of image
+typedef struct ImageStats {
+    ImageStats() : channel(0), count(0), mean{}, stddev{}, min{}, max{} {}
+    uint32_t channel;                        ///< channels of image, in memory order of format
+    uint64_t count;                          ///< pixels of a channel over all images of batch
+    double mean[IMAGE_STATS_MAX_CHANNEL];    ///< mean of channel c
+    double stddev[IMAGE_STATS_MAX_CHANNEL];  ///< population standard deviation of channel c
+    double min[IMAGE_STATS_MAX_CHANNEL];     ///< min of channel c
+    double max[IMAGE_STATS_MAX_CHANNEL];     ///< max of channel c
+} ImageStats;
+
+/// @brief mean, standard deviation, min and max of every channel of image
+/// @param input image on cpu of GRAY8, BGR888, RGB888, BGRA8888, RGBA8888, GRAY16, GRAY32,
+/// 16 bits and 32 bits packed and planar formats or FLOAT32C4, 16 bits formats are fp16
+/// @param stats statistics over all images of batch, channel c of BGR888 is B, G and R
+/// @return M_OK on success
+/// @note
+/// rows are read in blocks of 48 bytes, channel of a lane is fixed for 1, 3 and 4 channels,
+/// so packed pixels need no deinterleave. 8 bits sums are exact, 256 blocks are summed in
+/// 16 bits lanes and squares by madd of even and odd lanes before flushed into doubles.
+/// fp16 and fp32 sum differences to the first block of the 256 blocks in fp32. every flush
+/// gives count, mean and squared deviations, merged by Chan's formula, so large means don't
+/// cancel the variance. bands of rows run on the compute pipe and are merged at the end
+MStatus image_stats(const Image& input, ImageStats& stats);
+
+/// @brief 256 bins histogram of every channel of 8 bits image
+/// @param input image on cpu of GRAY8, BGR888, RGB888, BGRA8888, RGBA8888, BGR888_PLANAR or
+/// RGB888_PLANAR
+/// @param hist bins of channel c at [c * IMAGE_HIST_BINS, (c + 1) * IMAGE_HIST_BINS), over all
+/// images of batch, resized to channels * IMAGE_HIST_BINS
+/// @return M_OK on success
+/// @note
+/// consecutive pixels count into 4 sub-histograms, so increments of equal values don't wait
+/// for the store of the previous one. sub-histograms of bands of rows on the compute pipe
+/// are summed at the end
+MStatus image_histogram(const Image& input, std::vector<uint32_t>& hist);
+
+} // namespace base
+#endif // SIMPLE_BASE_STATS_H_
@@ -0,0 +1,69 @@
+#ifndef SIMPLE_BASE_WARP_H_
+#define SIMPLE_BASE_WARP_H_
+
+#include "common.h"
+#include "image/image.h"
+#include "image/resize.h"
+
+namespace base {
+
+/** A enum of pixels out of image read by warp */
+typedef enum BorderType {
+    M_BORDER_CONSTANT  = 0, /**< value of border */
+    M_BORDER_REPLICATE = 1, /**< nearest edge pixel */
+    M_BORDER_MAX       = 2  /**< border is invalid */
+} BorderType;
+
+/// @brief affine transform of image into out
+/// @param input image on cpu of GRAY8, BGR888, RGB888, BGRA8888, RGBA8888, GRAY32,
+/// BGR323232, RGB323232, FLOAT32C4, 8 bits or fp32 planar formats
+/// @param matrix 2 x 3 matrix of row major mapping input to out, as cv::warpAffine
+/// @param width width of out
+/// @param height height of out
+/// @param out warped image of the format and number of input, must not be input
+/// @param type M_INTER_NEAREST or M_INTER_LINEAR
+/// @param border pixels out of input
+/// @param value every channel of border pixels of M_BORDER_CONSTANT
+/// @return M_OK on success, M_INVALID_ARG if matrix can't be inverted
+/// @note
+/// buffer of out is reused when it already has the result size and format, otherwise out
+/// gets a new buffer. out(x, y) = input(M^-1 (x, y)), pixel centers are integers.
+/// source coordinates step along a row in fixed-point of 1 / 1024 pixel by integer adds,
+/// 8 pixels per AVX2 step, and are rounded to 1 / 32 pixel. out runs in tiles of 64 x 16
+/// pixels on the compute pipe, so source rows of a tile stay in cache for any rotation.
+/// u8 bilinear loads the 2 x 2 taps of a tile row into a block without gather, and blends
+/// 16 channels per step with 10 bits weights by madd. planes of planar formats share the
+/// coordinates of a tile
+MStatus warp_affine(const Image& input,
+                    const float matrix[6],
+                    const uint32_t width,
+                    const uint32_t height,
+                    Image& out,
+                    const InterpolationType type = M_INTER_LINEAR,
+                    const BorderType border      = M_BORDER_CONSTANT,
+                    const float value            = 0.f);
+
+/// @brief perspective transform of image into out
+/// @param input image of the formats of warp_affine
+/// @param matrix 3 x 3 matrix of row major mapping input to out, as cv::warpPerspective
+/// @param width width of out
+/// @param height height of out
+/// @param out warped image of the format and number of input, must not be input
+/// @param type M_INTER_NEAREST or M_INTER_LINEAR
+/// @param border pixels out of input
+/// @param value every channel of border pixels of M_BORDER_CONSTANT
+/// @return M_OK on success, M_INVALID_ARG if matrix can't be inverted
+/// @note
+/// as warp_affine, source coordinates are divided in fp32, 8 pixels per AVX2 step. pixels
+/// of a zero divisor take the border
+MStatus warp_perspective(const Image& input,
+                         const float matrix[9],
+                         const uint32_t width,
+                         const uint32_t height,
+                         Image& out,
+                         const InterpolationType type = M_INTER_LINEAR,
+                         const BorderType border      = M_BORDER_CONSTANT,
+                         const float value            = 0.f);
+
+} // namespace base
+#endif // SIMPLE_BASE_WARP_H_
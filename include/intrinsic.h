@@ -4,6 +4,7 @@
 #include "common.h"
 
 #include <stdio.h>
+#include <string.h>
 #ifdef USE_AVX
 #include <immintrin.h>
 #endif
@@ -12,7 +13,58 @@ SIMPLE_INLINE int divide_255(int value) {
     return (value + 1 + (value >> 8)) >> 8;
 }
 
+/// fp32 to fp16 bits, rounded to nearest even as _mm256_cvtps_ph
+SIMPLE_INLINE uint16_t fp32_to_fp16(float value) {
+    uint32_t x;
+    memcpy(&x, &value, sizeof(x));
+    const uint16_t sign = static_cast<uint16_t>((x >> 16) & 0x8000);
+    const uint32_t abs  = x & 0x7FFFFFFF;
+    if (abs > 0x7F800000) {
+        return sign | 0x7E00;
+    }
+    if (abs >= 0x477FF000) {
+        return sign | 0x7C00;
+    }
+    if (abs < 0x33000000) {
+        return sign;
+    }
+    uint32_t shift = 13, mantissa = abs - 0x38000000;
+    if (abs < 0x38800000) {
+        // subnormal of fp16
+        shift    = 126 - (abs >> 23);
+        mantissa = (abs & 0x7FFFFF) | 0x800000;
+    }
+    const uint32_t rest = mantissa & ((1U << shift) - 1), half = 1U << (shift - 1);
+    uint32_t result     = mantissa >> shift;
+    result += (rest > half || (rest == half && (result & 1))) ? 1 : 0;
+    return static_cast<uint16_t>(sign | result);
+}
+
+/// fp16 bits to fp32
+SIMPLE_INLINE float fp16_to_fp32(uint16_t value) {
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F, mantissa = value & 0x3FF, x = sign;
+    if (exponent == 0x1F) {
+        x = sign | 0x7F800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        x = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa != 0) {
+        // subnormal of fp16 is normal of fp32
+        exponent = 113;
+        while ((mantissa & 0x400) == 0) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        x = sign | (exponent << 23) | ((mantissa & 0x3FF) << 13);
+    }
+    float result;
+    memcpy(&result, &x, sizeof(result));
+    return result;
+}
+
 #ifdef USE_AVX
+// gcc >= 10 and clang already provide the unaligned 128-bit pair helpers
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ < 10)
 SIMPLE_INLINE __m256i _mm256_loadu2_m128i(__m128i const* __addr_hi, __m128i const* __addr_lo) {
     __m256i __v256 = _mm256_castsi128_si256(_mm_loadu_si128(__addr_lo));
     return _mm256_insertf128_si256(__v256, _mm_loadu_si128(__addr_hi), 1);
@@ -25,7 +77,10 @@ SIMPLE_INLINE void _mm256_storeu2_m128i(__m128i* __addr_hi, __m128i* __addr_lo,
     __v128 = _mm256_extractf128_si256(__a, 1);
     _mm_storeu_si128(__addr_hi, __v128);
 }
+#endif
 
+// gcc >= 11 and clang already provide the partial store helpers
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ < 11)
 SIMPLE_INLINE void _mm_storeu_si32(void* mem_addr, __m128i a) {
     _mm_store_ss((float*)mem_addr, _mm_castsi128_ps(a));
 }
@@ -33,6 +88,7 @@ SIMPLE_INLINE void _mm_storeu_si32(void* mem_addr, __m128i a) {
 SIMPLE_INLINE void _mm_storeu_si64(void* mem_addr, __m128i a) {
     _mm_store_sd((double*)mem_addr, _mm_castsi128_pd(a));
 }
+#endif
 
 SIMPLE_INLINE void
 _mm256_storeu_si256_planner(__m256i A, __m256i B, __m256i C, uint32_t stride, float* dst) {
@@ -321,6 +377,102 @@ SIMPLE_INLINE void vst3_u8x32_avx(__m256i c0, __m256i c1, __m256i c2, uint8_t* d
     _mm256_storeu_si256((__m256i*)(dst + 32), _mm256_permute2x128_si256(bgr2, bgr0, 0b00110000));
     _mm256_storeu_si256((__m256i*)(dst + 64), _mm256_permute2x128_si256(bgr1, bgr2, 0b00110001));
 }
+
+SIMPLE_INLINE void
+vld4_u8x32_avx(const uint8_t* src, __m256i* c0, __m256i* c1, __m256i* c2, __m256i* c3)
+{
+    // channels of 4 pixels to 4 dwords of every lane, then dwords of 8 pixels to qwords
+    const __m256i group_shuff =
+        _mm256_set_epi8(15, 11, 7, 3, 14, 10, 6, 2, 13, 9, 5, 1, 12, 8, 4, 0, 15, 11, 7, 3, 14, 10,
+                        6, 2, 13, 9, 5, 1, 12, 8, 4, 0);
+    const __m256i qword_perm = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+    __m256i q[4];
+    for (int i = 0; i < 4; ++i) {
+        q[i] = _mm256_loadu_si256((const __m256i*)(src + 32 * i));
+        q[i] = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(q[i], group_shuff), qword_perm);
+    }
+    const __m256i t0 = _mm256_unpacklo_epi64(q[0], q[1]);
+    const __m256i t1 = _mm256_unpackhi_epi64(q[0], q[1]);
+    const __m256i t2 = _mm256_unpacklo_epi64(q[2], q[3]);
+    const __m256i t3 = _mm256_unpackhi_epi64(q[2], q[3]);
+
+    *c0 = _mm256_permute2x128_si256(t0, t2, 0b00100000);
+    *c1 = _mm256_permute2x128_si256(t1, t3, 0b00100000);
+    *c2 = _mm256_permute2x128_si256(t0, t2, 0b00110001);
+    *c3 = _mm256_permute2x128_si256(t1, t3, 0b00110001);
+}
+
+SIMPLE_INLINE void vst4_u8x32_avx(__m256i c0, __m256i c1, __m256i c2, __m256i c3, uint8_t* dst)
+{
+    // pixels of every 128 bits lane: p0 [0-3|16-19], p1 [4-7|20-23], p2 [8-11|24-27] ...
+    const __m256i c01_lo = _mm256_unpacklo_epi8(c0, c1);
+    const __m256i c01_hi = _mm256_unpackhi_epi8(c0, c1);
+    const __m256i c23_lo = _mm256_unpacklo_epi8(c2, c3);
+    const __m256i c23_hi = _mm256_unpackhi_epi8(c2, c3);
+    const __m256i p0     = _mm256_unpacklo_epi16(c01_lo, c23_lo);
+    const __m256i p1     = _mm256_unpackhi_epi16(c01_lo, c23_lo);
+    const __m256i p2     = _mm256_unpacklo_epi16(c01_hi, c23_hi);
+    const __m256i p3     = _mm256_unpackhi_epi16(c01_hi, c23_hi);
+
+    _mm256_storeu_si256((__m256i*)(dst + 0), _mm256_permute2x128_si256(p0, p1, 0b00100000));
+    _mm256_storeu_si256((__m256i*)(dst + 32), _mm256_permute2x128_si256(p2, p3, 0b00100000));
+    _mm256_storeu_si256((__m256i*)(dst + 64), _mm256_permute2x128_si256(p0, p1, 0b00110001));
+    _mm256_storeu_si256((__m256i*)(dst + 96), _mm256_permute2x128_si256(p2, p3, 0b00110001));
+}
+
+SIMPLE_INLINE float vhsum_f32x8_avx(__m256 v)
+{
+    __m128 v4 = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    v4        = _mm_add_ps(v4, _mm_movehl_ps(v4, v4));
+    v4        = _mm_add_ss(v4, _mm_movehdup_ps(v4));
+    return _mm_cvtss_f32(v4);
+}
+
+SIMPLE_INLINE float vhmax_f32x8_avx(__m256 v)
+{
+    __m128 v4 = _mm_max_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    v4        = _mm_max_ps(v4, _mm_movehl_ps(v4, v4));
+    v4        = _mm_max_ss(v4, _mm_movehdup_ps(v4));
+    return _mm_cvtss_f32(v4);
+}
+
+SIMPLE_INLINE float vhmin_f32x8_avx(__m256 v)
+{
+    __m128 v4 = _mm_min_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    v4        = _mm_min_ps(v4, _mm_movehl_ps(v4, v4));
+    v4        = _mm_min_ss(v4, _mm_movehdup_ps(v4));
+    return _mm_cvtss_f32(v4);
+}
+
+// cephes exp, relative error about 1e-7 in [-88, 88]
+SIMPLE_INLINE __m256 vexp_f32x8_avx(__m256 x)
+{
+    const __m256 exp_hi = _mm256_set1_ps(88.3762626647949f);
+    const __m256 exp_lo = _mm256_set1_ps(-88.3762626647949f);
+    const __m256 log2ef = _mm256_set1_ps(1.44269504088896341f);
+    const __m256 c1     = _mm256_set1_ps(0.693359375f);
+    const __m256 c2     = _mm256_set1_ps(-2.12194440e-4f);
+    const __m256 half   = _mm256_set1_ps(0.5f);
+    const __m256 one    = _mm256_set1_ps(1.f);
+
+    x         = _mm256_min_ps(_mm256_max_ps(x, exp_lo), exp_hi);
+    __m256 fx = _mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(x, log2ef), half));
+    x         = _mm256_sub_ps(x, _mm256_mul_ps(fx, c1));
+    x         = _mm256_sub_ps(x, _mm256_mul_ps(fx, c2));
+
+    const __m256 z = _mm256_mul_ps(x, x);
+    __m256 y       = _mm256_set1_ps(1.9875691500E-4f);
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.3981999507E-3f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(8.3334519073E-3f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(4.1665795894E-2f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(1.6666665459E-1f));
+    y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(5.0000001201E-1f));
+    y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(y, z), x), one);
+
+    __m256i n = _mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(0x7f));
+    n         = _mm256_slli_epi32(n, 23);
+    return _mm256_mul_ps(y, _mm256_castsi256_ps(n));
+}
 #endif // USE_AVX
 
 #endif // SIMPLE_BASE_MATH_H_
\ No newline at end of file
@@ -51,13 +51,8 @@ inline T_ AlignDownN(const T_ v, uint32_t r) {
 #define IS_ALIGN_2(x) (((x) & 0x1) == 0x0)
 
 // the alignment of all the allocated buffers
-#if AVX512
+// one cache line, so padded rows of tensor start at cache line boundary
 #define MALLOC_ALIGN 64
-#elif AVX
-#define MALLOC_ALIGN 32
-#else
-#define MALLOC_ALIGN 16
-#endif
 
 // we have some optimized kernels that may overread buffer a bit in loop
 // it is common to interleave next-loop data load with arithmetic instructions
@@ -97,6 +92,17 @@ static inline void fast_free(void* ptr) {
     }
 }
 
+// scratch buffers of one thread, see GetScratch
+#define SCRATCH_SLOTS 4
+
+/// @brief Get scratch buffer of current thread for temporaries of compute kernels
+/// @param[in] slot : index of buffer, buffers used at the same time take different slots
+/// @param[in] size : bytes of buffer
+/// @note
+/// buffer is MALLOC_ALIGN aligned and only grows, so a warmed up kernel does no allocation.
+/// content is undefined, buffer stays valid until next GetScratch of the slot on this thread
+void* GetScratch(const uint32_t slot, const size_t size);
+
 class EXPORT_API DataManager {
 public:
     DataManager()
@@ -162,10 +168,15 @@ public:
     void* Setptr(void* ptr, uint32_t size) override;
 
 
-    std::shared_ptr<DataManager> Create() const override { return data_manager_->Create(); }
-    void* GetDataPtr() const override { return data_manager_->GetDataPtr(); }
-    MStatus SyncCache(bool io = true) override { return data_manager_->SyncCache(io); };
-    uint32_t GetSize() const override { return data_manager_->GetSize(); };
+    // data_manager_ is empty before Malloc or Setptr
+    std::shared_ptr<DataManager> Create() const override { return DataManager::Create(); }
+    void* GetDataPtr() const override {
+        return data_manager_ ? data_manager_->GetDataPtr() : nullptr;
+    }
+    MStatus SyncCache(bool io = true) override {
+        return data_manager_ ? data_manager_->SyncCache(io) : MStatus::M_OK;
+    };
+    uint32_t GetSize() const override { return data_manager_ ? data_manager_->GetSize() : 0U; };
 
 private:
     uint32_t size_                             = 0;
@@ -173,6 +184,74 @@ private:
     std::shared_ptr<DataManager> data_manager_ = nullptr;
 };
 
+/// @brief Data manager of a byte range of other data manager, no memory is owned
+/// @note
+/// the parent is held, so views stay valid after the tensor or image of parent released.
+/// the address follows parent, it works with the pooled DataMgrCache
+class SubDataManager final : public DataManager {
+public:
+    SubDataManager(const std::shared_ptr<DataManager>& parent,
+                   const uint32_t offset,
+                   const uint32_t size);
+    void* Malloc(const uint32_t size) override;
+    void Free(void* p) override { UNUSED_WARN(p); }
+    void* Setptr(void* ptr, uint32_t size) override;
+
+    std::shared_ptr<DataManager> Create() const override { return DataManager::Create(); }
+    void* GetDataPtr() const override;
+    MStatus SyncCache(bool io = true) override {
+        return parent_ ? parent_->SyncCache(io) : MStatus::M_FAILED;
+    };
+    uint32_t GetSize() const override { return size_; };
+
+    inline const std::shared_ptr<DataManager>& GetParent() const { return parent_; }
+    inline uint32_t GetOffset() const { return offset_; }
+
+private:
+    std::shared_ptr<DataManager> parent_ = nullptr;
+    uint32_t offset_                     = 0;
+    uint32_t size_                       = 0;
+};
+
+/// @brief Private mapping of a whole file, unmapped when the last holder is released
+/// @note
+/// pages are readable and writable, writes to the mapping don't change the file
+class MappedFile final {
+public:
+    MappedFile(void* addr, size_t size) : addr_(addr), size_(size) {}
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// @brief Map file of path
+    /// @return M_FILE_NOT_FOUND if file can't be opened, M_INVALID_FILE_FORMAT if it is empty
+    static MStatus Map(const std::string& path, std::shared_ptr<MappedFile>& file);
+
+    inline uint8_t* GetData() const { return static_cast<uint8_t*>(addr_); }
+    inline size_t GetSize() const { return size_; }
+
+private:
+    void* addr_;
+    size_t size_;
+};
+
+/// @brief Data manager of a region in the mapping, never owns the memory
+/// @note
+/// the mapping is held, so tensors and images on it stay valid after their reader released
+class MappedDataManager final : public DataManager {
+public:
+    MappedDataManager(const std::shared_ptr<MappedFile>& file, void* ptr, const uint32_t size)
+        : DataManager(), file_(file) {
+        Setptr(ptr, size);
+    }
+    void* Malloc(const uint32_t size) override {
+        SIMPLE_LOG_WARN("can't malloc %u bytes on mapped file", size);
+        return GetDataPtr();
+    }
+
+private:
+    std::shared_ptr<MappedFile> file_;
+};
 
 } // namespace base
 #endif // SIMPLE_BASE_DATA_MANAGER_H_
\ No newline at end of file
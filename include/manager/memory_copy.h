@@ -0,0 +1,55 @@
+#ifndef SIMPLE_BASE_MEMORY_COPY_H_
+#define SIMPLE_BASE_MEMORY_COPY_H_
+
+#include "common.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+namespace base {
+
+// copies larger than this bypass cache with non-temporal stores
+#define STREAM_COPY_THRESHOLD (2U << 20)
+// minimum bytes of one parallel copy task
+#define PARALLEL_COPY_GRAIN (256U << 10)
+
+/// @brief Copy with non-temporal stores
+/// @note
+/// the destination is not pulled into cache, use it for buffers larger than cache
+/// which are not read again right away
+void StreamCopy(void* dst, const void* src, const size_t size);
+
+/// @brief Copy buffer, large buffers are split over the compute pipe
+/// @note
+/// uses memcpy below PARALLEL_COPY_GRAIN, each task uses StreamCopy above
+/// STREAM_COPY_THRESHOLD. src and dst must not overlap
+void FastCopy(void* dst, const void* src, const size_t size);
+
+/// @brief Copy rows between buffers of different row pitch, rows are split over the compute pipe
+/// @param[in] row_size : valid bytes of one row, no more than both pitches
+/// @note
+/// same as FastCopy when both pitches equal row_size, padding of dst is not written
+void FastCopy2D(void* dst,
+                const size_t dst_pitch,
+                const void* src,
+                const size_t src_pitch,
+                const size_t row_size,
+                const size_t rows);
+
+/// @brief One region of BatchCopy
+struct CopyTask {
+    CopyTask(void* d, const void* s, const size_t n) : dst(d), src(s), size(n) {}
+    void* dst;
+    const void* src;
+    size_t size;
+};
+
+/// @brief Copy a list of regions, regions are regrouped into tasks of about
+/// PARALLEL_COPY_GRAIN bytes and run on the compute pipe
+/// @note
+/// use it when every region is small, such as items of a batch or rows of an image
+void BatchCopy(const std::vector<CopyTask>& tasks);
+
+} // namespace base
+#endif // SIMPLE_BASE_MEMORY_COPY_H_
@@ -4,6 +4,7 @@
 #include "common.h"
 #include "log.h"
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <functional>
@@ -126,5 +127,67 @@ private:
     std::atomic<int> idl_thread_num_{0}; // number of idle threads
 };
 
+/// @brief Get the thread pool shared by compute kernels
+/// @note
+/// the caller thread always takes part in ParallelFor, so the pool holds one thread less
+/// than the hardware concurrency
+inline PipeManager& GetComputePipe() {
+    static PipeManager pipe(static_cast<unsigned short>(
+        std::max(1U, std::thread::hardware_concurrency()) - 1U));
+    return pipe;
+}
+
+/// @brief Whether current thread is a worker of ParallelFor
+inline bool& InParallelRegion() {
+    static thread_local bool in_region = false;
+    return in_region;
+}
+
+/// @brief Split [0, total) into chunks at least grain large and run func(begin, end) on them
+/// @param[in] total : The number of items.
+/// @param[in] grain : The minimum number of items of one chunk.
+/// @param[in] func : The task of items [begin, end).
+/// @note
+/// Blocks until all chunks done, the first chunk runs on the caller thread.
+/// Nested calls run serially on the calling worker to avoid waiting on the own pool.
+inline void ParallelFor(const uint32_t total,
+                        const uint32_t grain,
+                        const std::function<void(uint32_t, uint32_t)>& func) {
+    if (total == 0) {
+        return;
+    }
+    PipeManager& pipe   = GetComputePipe();
+    const uint32_t size = std::max(grain, 1U);
+    uint32_t chunks     = std::min(static_cast<uint32_t>(pipe.GetThreadCount()) + 1U,
+                               (total + size - 1U) / size);
+    if (chunks <= 1 || InParallelRegion()) {
+        func(0, total);
+        return;
+    }
+
+    const uint32_t step = (total + chunks - 1U) / chunks;
+    std::vector<std::future<void>> futures;
+    for (uint32_t begin = step; begin < total; begin += step) {
+        const uint32_t end = std::min(total, begin + step);
+        auto future         = pipe.Commit([&func, begin, end]() {
+            InParallelRegion() = true;
+            func(begin, end);
+            InParallelRegion() = false;
+        });
+        if (!future.valid()) {
+            // pipe is stopped, keep the result complete
+            func(begin, end);
+            continue;
+        }
+        futures.emplace_back(std::move(future));
+    }
+    InParallelRegion() = true;
+    func(0, std::min(total, step));
+    InParallelRegion() = false;
+    for (auto& future : futures) {
+        future.get();
+    }
+}
+
 } // namespace base
 #endif // SIMPLE_BASE_PIPE_MANAGER_H_
\ No newline at end of file
@@ -43,6 +43,12 @@ public:
         return creator_map_[key]();
     }
 
+    /// @brief Whether key is registered, lookup without error log
+    bool IsRegistered(const std::string& key) const { return creator_map_.count(key) > 0; }
+
+    /// @brief Registered keys, grows when a library registering more keys is loaded
+    size_t GetSize() const { return creator_map_.size(); }
+
 private:
     RegisterMap creator_map_;
 };
@@ -0,0 +1,61 @@
+#ifndef SIMPLE_BASE_BATCH_H_
+#define SIMPLE_BASE_BATCH_H_
+
+#include "common.h"
+#include "image/image.h"
+#include "tensor/tensor.h"
+
+#include <memory>
+#include <vector>
+
+namespace base {
+
+/// @brief concat tensors along axis into out
+/// @param inputs tensors of shape 4Dims, same layout, data type and shape except axis
+/// @param axis index of shape, 0 is N, C is 1 for NCHW and 3 for NHWC, blocked layouts only 0
+/// @param out batch tensor
+/// @return M_OK on success
+/// @note
+/// buffer of out is reused when it already has the result shape, layout and type,
+/// otherwise out gets a new buffer (from memory pool with low memory config) with padding
+/// of the first input. inputs and out may have different row pitch.
+/// out must not share buffer with inputs. copies run on the compute pipe
+MStatus
+concat(const std::vector<std::shared_ptr<Tensor>>& inputs, const uint32_t axis, Tensor& out);
+
+/// @brief concat tensors along axis
+/// @return new tensor, nullptr if failed
+std::shared_ptr<Tensor> concat(const std::vector<std::shared_ptr<Tensor>>& inputs,
+                               const uint32_t axis);
+
+/// @brief stack tensors along N, same as concat(inputs, 0, out)
+/// @note eg: N * {1, C, H, W} --> {N, C, H, W}
+MStatus stack(const std::vector<std::shared_ptr<Tensor>>& inputs, Tensor& out);
+
+/// @brief stack tensors along N
+/// @return new tensor, nullptr if failed
+std::shared_ptr<Tensor> stack(const std::vector<std::shared_ptr<Tensor>>& inputs);
+
+/// @brief stack images of the same pixel format and size into one tensor
+/// @param images input images, every number of an image is one item
+/// @param out batch tensor, buffer is reused as concat
+/// @return M_OK on success
+/// @note
+/// packed format gives NHWC {N, H, W, C}, planar format gives NCHW {N, C, H, W}.
+/// data type follows type size of format: uint8, fp16 or fp32. yuv formats are not supported.
+/// images with row padding are copied row by row
+MStatus stack(const std::vector<std::shared_ptr<Image>>& images, Tensor& out);
+
+/// @brief stack images into one tensor
+/// @return new tensor, nullptr if failed
+std::shared_ptr<Tensor> stack(const std::vector<std::shared_ptr<Image>>& images);
+
+/// @brief split tensor along N, No data copy
+/// @param tensor input tensor of shape 4Dims
+/// @return N tensors of shape {1, ...} with padding of tensor
+/// @note
+/// items share buffer of tensor and hold it, they stay valid after tensor released
+std::vector<std::shared_ptr<Tensor>> unstack(const std::shared_ptr<Tensor>& tensor);
+
+} // namespace base
+#endif // SIMPLE_BASE_BATCH_H_
@@ -0,0 +1,75 @@
+#ifndef SIMPLE_BASE_CONV2D_H_
+#define SIMPLE_BASE_CONV2D_H_
+
+#include "common.h"
+#include "tensor/tensor.h"
+
+#include <memory>
+
+namespace base {
+
+/** A enum of activation fused into compute operator */
+typedef enum ActivationType {
+    M_ACTIVATION_NONE     = 0, /**< identity */
+    M_ACTIVATION_RELU     = 1, /**< max(x, 0) */
+    M_ACTIVATION_RELU6    = 2, /**< min(max(x, 0), 6) */
+    M_ACTIVATION_MAX_TYPE = 3  /**< activation type is invalid */
+} ActivationType;
+
+/// @brief Paramter of conv2d
+typedef struct Conv2dParam {
+    Conv2dParam(const uint32_t stride = 1, const uint32_t pad = 0, const uint32_t group = 1)
+        : stride_h(stride),
+          stride_w(stride),
+          pad_top(pad),
+          pad_left(pad),
+          pad_bottom(pad),
+          pad_right(pad),
+          dilation_h(1),
+          dilation_w(1),
+          group(group),
+          activation(M_ACTIVATION_NONE) {}
+    uint32_t stride_h;         ///< stride along H
+    uint32_t stride_w;         ///< stride along W
+    uint32_t pad_top;          ///< zero padding before H
+    uint32_t pad_left;         ///< zero padding before W
+    uint32_t pad_bottom;       ///< zero padding after H
+    uint32_t pad_right;        ///< zero padding after W
+    uint32_t dilation_h;       ///< dilation of kernel along H
+    uint32_t dilation_w;       ///< dilation of kernel along W
+    uint32_t group;            ///< input and output channels are split into group parts
+    ActivationType activation; ///< activation after bias
+} Conv2dParam;
+
+/// @brief 2D convolution as activation(input (*) weight + bias) into out
+/// @param out output tensor of the same layout and padding as input, buffer reused as
+/// Tensor::Reset, must not be an input
+/// @return M_OK on success, M_OUT_OF_MEMORY if scratch buffers can't be allocated
+/// @note see conv2d below
+MStatus conv2d(const std::shared_ptr<Tensor>& input,
+               const std::shared_ptr<Tensor>& weight,
+               const std::shared_ptr<Tensor>& bias,
+               const Conv2dParam& param,
+               Tensor& out);
+
+/// @brief 2D convolution as activation(input (*) weight + bias)
+/// @param input fp32 tensor of NCHW or blocked {N, C, H, W} or NHWC {N, H, W, C}
+/// @param weight fp32 NCHW tensor of {OC, C / group, KH, KW}
+/// @param bias fp32 bias of OC elements, can be nullptr
+/// @param param stride, padding, dilation, group and activation
+/// @return output tensor of the same layout and padding as input, nullptr if failed
+/// @note
+/// 1x1 kernel of stride 1 without padding runs GEMM on input in place,
+/// depthwise 3x3 (group == C == OC) runs a direct SIMD kernel,
+/// other kernels run im2col + GEMM. bias and activation are fused after GEMM of each part.
+/// blocked layouts run depthwise 3x3 in place and other kernels through NCHW.
+/// NCHW runs parallel over output channels, NHWC runs parallel over output rows.
+/// repacked weight, im2col buffers and NCHW copies of blocked input and output are per
+/// thread scratch buffers reused across calls
+std::shared_ptr<Tensor> conv2d(const std::shared_ptr<Tensor>& input,
+                               const std::shared_ptr<Tensor>& weight,
+                               const std::shared_ptr<Tensor>& bias,
+                               const Conv2dParam& param = Conv2dParam());
+
+} // namespace base
+#endif // SIMPLE_BASE_CONV2D_H_
@@ -0,0 +1,152 @@
+#ifndef SIMPLE_BASE_INNERPRODUCT_H_
+#define SIMPLE_BASE_INNERPRODUCT_H_
+
+#include "common.h"
+#include "tensor/tensor.h"
+
+#include <memory>
+#include <vector>
+
+namespace base {
+
+/// @brief Affine quantization paramter, real = scale * (quant - zero_point)
+typedef struct QuantParam {
+    QuantParam(const float s = 1.f, const int32_t z = 0) : scale(s), zero_point(z) {}
+    float scale;        ///< scale of quantized value
+    int32_t zero_point; ///< zero point of quantized value
+} QuantParam;
+
+/// @brief fp32 gemm on raw buffers, c[M, N] = a[M, K] * b[K, N] + bias[N]
+/// @param[in] a : left matrix, row pitch is lda elements
+/// @param[in] b : right matrix, row pitch is ldb elements
+/// @param[in] bias : N elements, can be nullptr
+/// @param[out] c : result matrix, row pitch is ldc elements
+/// @note
+/// runs on the caller thread, operators split rows or columns of c to run it in parallel.
+/// b is read in place in panels of 256 rows * 128 columns, which stay in L2 for all rows of a,
+/// c is computed in register tiles of 4 rows * 16 columns by fma
+void gemm_fp32(const float* a,
+               const uint32_t lda,
+               const float* b,
+               const uint32_t ldb,
+               const float* bias,
+               float* c,
+               const uint32_t ldc,
+               const uint32_t M,
+               const uint32_t N,
+               const uint32_t K);
+
+/// @brief Offline packed int8 weight of innerproduct
+/// @note
+/// weight of {1, 1, K, N} is packed into blocks of 16 output columns * 4 reduction rows,
+/// which is the operand layout of vpdpbusd (AVX512-VNNI) and vpmaddubsw (AVX2),
+/// K is padded to 4 and N is padded to 16 with zeros.
+class EXPORT_API Int8Weight final {
+public:
+    static constexpr uint32_t kBlockN = 16;
+    static constexpr uint32_t kBlockK = 4;
+
+    Int8Weight() = default;
+
+    /// @brief Pack int8 weight
+    /// @param[in] weight : weight tensor of shape {1, 1, K, N} with M_DATA_TYPE_INT8
+    /// @param[in] scales : per output channel scale of weight, size 1 or N
+    /// @return packed weight, nullptr if failed
+    static std::shared_ptr<Int8Weight> Pack(const std::shared_ptr<Tensor>& weight,
+                                            const std::vector<float>& scales);
+
+    /// @brief Pack int8 weight into packed, buffers of packed are reused when sizes match
+    /// @return M_OK on success
+    static MStatus Pack(const std::shared_ptr<Tensor>& weight,
+                        const std::vector<float>& scales,
+                        Int8Weight& packed);
+
+    /// @brief Get packed data, block (n / 16, k / 4) is 64 bytes
+    inline const int8_t* GetData() const { return packed_->GetData<int8_t>(0); }
+
+    /// @brief Get packed tensor of shape {1, 1, N_pad / 16, K_pad * 16}
+    inline const std::shared_ptr<Tensor>& GetTensor() const { return packed_; }
+
+    inline uint32_t GetK() const { return k_; }
+    inline uint32_t GetN() const { return n_; }
+    inline uint32_t GetPaddedK() const { return k_pad_; }
+    inline uint32_t GetPaddedN() const { return n_pad_; }
+
+    /// @brief Get column sum of weight, used for zero point compensation of input
+    inline const std::vector<int32_t>& GetColumnSum() const { return col_sum_; }
+
+    /// @brief Get per output channel scale
+    inline const std::vector<float>& GetScales() const { return scales_; }
+
+    /// @brief Whether all weights in [-64, 63]
+    /// @note
+    /// vpmaddubsw saturates int16 pairs, u8 * s8 * 2 only fits when weight is 7bits,
+    /// otherwise the AVX2 kernel widens to int16 and uses vpmaddwd
+    inline bool IsReducedRange() const { return reduced_range_; }
+
+private:
+    uint32_t k_{0};
+    uint32_t n_{0};
+    uint32_t k_pad_{0};
+    uint32_t n_pad_{0};
+    bool reduced_range_{false};
+    std::vector<int32_t> col_sum_;
+    std::vector<float> scales_;
+    std::shared_ptr<Tensor> packed_{nullptr};
+};
+
+/// @brief int8 innerproduct as dequant(left * right) + bias into out
+/// @param out output tensor of shape {1, 1, M, N} with padding of left, buffer reused as
+/// Tensor::Reset
+/// @return M_OK on success
+/// @note see innerproduct_int8 below
+MStatus innerproduct_int8(const std::shared_ptr<Tensor>& left,
+                          const QuantParam& left_param,
+                          const Int8Weight& right,
+                          const std::shared_ptr<Tensor>& bias,
+                          const DataType out_type,
+                          const QuantParam& out_param,
+                          Tensor& out);
+
+/// @brief int8 innerproduct as dequant(left * right) + bias
+/// @param left input tensor of shape {1, 1, M, K} with M_DATA_TYPE_UINT8
+/// @param left_param quantization paramter of left
+/// @param right packed int8 weight
+/// @param bias fp32 bias of N elements, can be nullptr
+/// @param out_type M_DATA_TYPE_FLOAT32 for dequantize or M_DATA_TYPE_UINT8 for requantize
+/// @param out_param quantization paramter of output, only used for M_DATA_TYPE_UINT8
+/// @return output tensor of shape {1, 1, M, N}
+/// @note
+/// accumulate in int32, dequantize with left scale * weight scale, then add bias.
+/// tiles of 4 rows * 128 columns run on the compute pipe, padded rows of left are kept in
+/// per thread scratch buffers
+std::shared_ptr<Tensor> innerproduct_int8(const std::shared_ptr<Tensor>& left,
+                                          const QuantParam& left_param,
+                                          const Int8Weight& right,
+                                          const std::shared_ptr<Tensor>& bias,
+                                          const DataType out_type     = M_DATA_TYPE_FLOAT32,
+                                          const QuantParam& out_param = QuantParam());
+
+/// @brief innerproduct of uint8 left and packed int8 weight as left * right + bias into out
+/// @param out fp32 output tensor of shape {1, 1, M, N} with padding of left
+/// @return M_OK on success
+/// @note see innerproduct below
+MStatus innerproduct(const std::shared_ptr<Tensor>& left,
+                     const std::shared_ptr<Int8Weight>& right,
+                     const std::shared_ptr<Tensor>& bias,
+                     Tensor& out);
+
+/// @brief innerproduct of uint8 left and packed int8 weight as left * right + bias
+/// @param left input tensor of shape {1, 1, M, K} with M_DATA_TYPE_UINT8, taken as integers
+/// @param right weight packed once by Int8Weight::Pack, dequantized by its scales
+/// @param bias fp32 bias of N elements, can be nullptr
+/// @return fp32 output tensor of shape {1, 1, M, N}
+/// @note
+/// innerproduct of uint8 * int8 tensors packs right on every call into a buffer of the thread,
+/// layers run more than once should pack weight once and call this
+std::shared_ptr<Tensor> innerproduct(const std::shared_ptr<Tensor>& left,
+                                     const std::shared_ptr<Int8Weight>& right,
+                                     const std::shared_ptr<Tensor>& bias);
+
+} // namespace base
+#endif // SIMPLE_BASE_INNERPRODUCT_H_
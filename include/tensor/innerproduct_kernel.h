@@ -0,0 +1,198 @@
+#ifndef SIMPLE_BASE_INNERPRODUCT_KERNEL_H_
+#define SIMPLE_BASE_INNERPRODUCT_KERNEL_H_
+
+#include "common.h"
+#include "intrinsic.h"
+#include "register.h"
+
+#include <memory>
+#include <string>
+
+namespace base {
+
+/// @brief fp32 innerproduct kernel of fixed shape
+/// @note
+/// kernels are registered to RegisterBase<InnerProductKernel> with key of Key(M, N, K),
+/// innerproduct looks up the key of its shape and falls back to the generic path if missing.
+/// more shapes can be registered by user as:
+/// namespace base { typedef FixedInnerProduct<2, 16, 32> IP_2x16x32; }
+/// REGISTER_COMMON_ENGINE(base, ip_fp32_2x16x32, InnerProductKernel, IP_2x16x32)
+class EXPORT_API InnerProductKernel {
+public:
+    virtual ~InnerProductKernel() = default;
+
+    /// @brief c[M, N] = a[M, K] * b[K, N] + bias[N]
+    /// @param[in] a : left matrix, row pitch is lda elements
+    /// @param[in] b : right matrix, row pitch is ldb elements
+    /// @param[in] bias : N elements, can be nullptr
+    /// @param[out] c : result matrix, row pitch is ldc elements
+    virtual void Run(const float* a,
+                     const uint32_t lda,
+                     const float* b,
+                     const uint32_t ldb,
+                     const float* bias,
+                     float* c,
+                     const uint32_t ldc) const = 0;
+
+    /// @brief Get register key of shape, eg: ip_fp32_1x10x256
+    static std::string Key(const uint32_t M, const uint32_t N, const uint32_t K) {
+        return "ip_fp32_" + std::to_string(M) + "x" + std::to_string(N) + "x" + std::to_string(K);
+    }
+};
+
+// columns of a chunk, 8 accumulators of 8 floats are 8 independent fma chains, which hide
+// latency 4 of fma on 2 ports and leave 8 of 16 ymm registers for broadcast and loads
+#define FIXED_IP_COLS 64U
+// reduction rows of one step of the unrolled loop over K
+#define FIXED_IP_UNROLL_K 4U
+
+namespace detail {
+
+/// @brief call f(0), f(1) ... f(N - 1), expanded at compile time
+template <uint32_t N>
+struct Unroll {
+    template <typename F>
+    static SIMPLE_INLINE void Run(F& f) {
+        Unroll<N - 1>::Run(f);
+        f(N - 1);
+    }
+};
+
+template <>
+struct Unroll<0> {
+    template <typename F>
+    static SIMPLE_INLINE void Run(F&) {}
+};
+
+/// @brief call f(0), f(1) ... f(K - 1) in a loop of FIXED_IP_UNROLL_K expanded calls
+template <uint32_t K, typename F>
+SIMPLE_INLINE void UnrollK(F& f) {
+    for (uint32_t k = 0; k + FIXED_IP_UNROLL_K <= K; k += FIXED_IP_UNROLL_K) {
+        auto step = [&](uint32_t u) { f(k + u); };
+        Unroll<FIXED_IP_UNROLL_K>::Run(step);
+    }
+    auto tail = [&](uint32_t u) { f(K / FIXED_IP_UNROLL_K * FIXED_IP_UNROLL_K + u); };
+    Unroll<K % FIXED_IP_UNROLL_K>::Run(tail);
+}
+
+/// @brief c[0, C) = a[0, K) * b[K, C) + bias[0, C) of one row
+/// @note C is at most FIXED_IP_COLS, so accumulators of 8 floats stay in registers
+template <uint32_t K, uint32_t C>
+SIMPLE_INLINE void FixedRowChunk(const float* a,
+                                 const float* b,
+                                 const uint32_t ldb,
+                                 const float* bias,
+                                 float* c) {
+#if defined(USE_AVX) && defined(__AVX2__) && defined(__FMA__)
+    constexpr uint32_t kFull   = C / 8;
+    constexpr uint32_t kTail   = C % 8;
+    constexpr uint32_t kBlocks = kFull + (kTail ? 1 : 0);
+    const __m256i mask =
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(kTail), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+    __m256 acc[kBlocks];
+    auto init = [&](uint32_t j) {
+        acc[j] = bias ? _mm256_loadu_ps(bias + j * 8) : _mm256_setzero_ps();
+    };
+    Unroll<kFull>::Run(init);
+    if (kTail) {
+        acc[kBlocks - 1] =
+            bias ? _mm256_maskload_ps(bias + kFull * 8, mask) : _mm256_setzero_ps();
+    }
+
+    auto row = [&](uint32_t k) {
+        const __m256 va    = _mm256_set1_ps(a[k]);
+        const float* b_row = b + k * ldb;
+        auto fma           = [&](uint32_t j) {
+            acc[j] = _mm256_fmadd_ps(va, _mm256_loadu_ps(b_row + j * 8), acc[j]);
+        };
+        Unroll<kFull>::Run(fma);
+        if (kTail) {
+            acc[kBlocks - 1] = _mm256_fmadd_ps(
+                va, _mm256_maskload_ps(b_row + kFull * 8, mask), acc[kBlocks - 1]);
+        }
+    };
+    UnrollK<K>(row);
+
+    auto store = [&](uint32_t j) { _mm256_storeu_ps(c + j * 8, acc[j]); };
+    Unroll<kFull>::Run(store);
+    if (kTail) {
+        _mm256_maskstore_ps(c + kFull * 8, mask, acc[kBlocks - 1]);
+    }
+#else
+    float acc[C];
+    for (uint32_t j = 0; j < C; ++j) {
+        acc[j] = bias ? bias[j] : 0.f;
+    }
+    auto row = [&](uint32_t k) {
+        const float a_val  = a[k];
+        const float* b_row = b + k * ldb;
+        for (uint32_t j = 0; j < C; ++j) {
+            acc[j] += a_val * b_row[j];
+        }
+    };
+    UnrollK<K>(row);
+    for (uint32_t j = 0; j < C; ++j) {
+        c[j] = acc[j];
+    }
+#endif
+}
+
+/// @brief split N columns into chunks of FIXED_IP_COLS, each chunk runs FixedRowChunk of all
+/// M rows, so K * FIXED_IP_COLS floats of b are read from memory once and stay in L1 or L2
+/// for the following rows
+template <uint32_t M, uint32_t K, uint32_t N, uint32_t J, bool kDone = (J >= N)>
+struct FixedColumns {
+    static SIMPLE_INLINE void Run(const float* a,
+                                  const uint32_t lda,
+                                  const float* b,
+                                  const uint32_t ldb,
+                                  const float* bias,
+                                  float* c,
+                                  const uint32_t ldc) {
+        constexpr uint32_t kCols = N - J < FIXED_IP_COLS ? N - J : FIXED_IP_COLS;
+        for (uint32_t i = 0; i < M; ++i) {
+            FixedRowChunk<K, kCols>(
+                a + i * lda, b + J, ldb, bias ? bias + J : nullptr, c + i * ldc + J);
+        }
+        FixedColumns<M, K, N, J + FIXED_IP_COLS>::Run(a, lda, b, ldb, bias, c, ldc);
+    }
+};
+
+template <uint32_t M, uint32_t K, uint32_t N, uint32_t J>
+struct FixedColumns<M, K, N, J, true> {
+    static SIMPLE_INLINE void Run(const float*,
+                                  const uint32_t,
+                                  const float*,
+                                  const uint32_t,
+                                  const float*,
+                                  float*,
+                                  const uint32_t) {}
+};
+
+} // namespace detail
+
+/// @brief innerproduct kernel of compile time M, N, K
+/// @note
+/// columns are cut into chunks of FIXED_IP_COLS, vector loops of a chunk are fully unrolled,
+/// the loop over K is unrolled by FIXED_IP_UNROLL_K and accumulators are register resident,
+/// b is read in place without packing. without AVX2 and FMA it is a plain loop with fixed
+/// trip count
+template <uint32_t M, uint32_t N, uint32_t K>
+class FixedInnerProduct final : public InnerProductKernel {
+    static_assert(M > 0 && N > 0 && K > 0, "shape of FixedInnerProduct must not be empty");
+
+public:
+    void Run(const float* a,
+             const uint32_t lda,
+             const float* b,
+             const uint32_t ldb,
+             const float* bias,
+             float* c,
+             const uint32_t ldc) const override {
+        detail::FixedColumns<M, K, N, 0>::Run(a, lda, b, ldb, bias, c, ldc);
+    }
+};
+
+} // namespace base
+#endif // SIMPLE_BASE_INNERPRODUCT_KERNEL_H_
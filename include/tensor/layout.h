@@ -0,0 +1,30 @@
+#ifndef SIMPLE_BASE_LAYOUT_H_
+#define SIMPLE_BASE_LAYOUT_H_
+
+#include "common.h"
+#include "tensor/tensor.h"
+
+#include <memory>
+
+namespace base {
+
+/// @brief convert tensor to another layout into out
+/// @param input tensor of shape 4Dims in any layout
+/// @param layout layout of out
+/// @param out converted tensor, {N, C, H, W} of NCHW and blocked layouts or {N, H, W, C} of NHWC
+/// @return M_OK on success
+/// @note
+/// buffer of out is reused when it already has the result shape, layout and type,
+/// otherwise out gets a new buffer with padding of input. tail channels of blocked out
+/// are zero. fp32 NCHW <-> blocked runs 8x8 SIMD transposes, NHWC <-> blocked copies
+/// channel blocks of every pixel, other pairs run a generic element loop.
+/// rows run on the compute pipe
+MStatus convert_layout(const Tensor& input, const TensorLayout layout, Tensor& out);
+
+/// @brief convert tensor to another layout
+/// @return new tensor, nullptr if failed
+std::shared_ptr<Tensor> convert_layout(const std::shared_ptr<Tensor>& input,
+                                       const TensorLayout layout);
+
+} // namespace base
+#endif // SIMPLE_BASE_LAYOUT_H_
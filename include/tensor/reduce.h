@@ -0,0 +1,56 @@
+#ifndef SIMPLE_BASE_REDUCE_H_
+#define SIMPLE_BASE_REDUCE_H_
+
+#include "common.h"
+#include "tensor/tensor.h"
+
+#include <memory>
+
+namespace base {
+
+/** A enum of reduction along one axis */
+typedef enum ReduceType {
+    M_REDUCE_SUM         = 0, /**< sum */
+    M_REDUCE_MEAN        = 1, /**< mean */
+    M_REDUCE_MIN         = 2, /**< min */
+    M_REDUCE_MAX         = 3, /**< max */
+    M_REDUCE_ARGMIN      = 4, /**< index of first min, int32 output */
+    M_REDUCE_ARGMAX      = 5, /**< index of first max, int32 output */
+    M_REDUCE_L2          = 6, /**< sqrt of sum of squares */
+    M_REDUCE_LOG_SUM_EXP = 7, /**< log(sum(exp(x))), numerically stable */
+    M_REDUCE_MAX_TYPE    = 8  /**< reduce type is invalid */
+} ReduceType;
+
+/// @brief reduce tensor along axis into out
+/// @param out tensor with shape[axis] == 1 without padding, buffer reused as Tensor::Reset
+/// @return M_OK on success
+/// @note see reduce below
+MStatus reduce(const Tensor& tensor, const uint32_t axis, const ReduceType type, Tensor& out);
+
+/// @brief reduce tensor along axis
+/// @param tensor input fp32 tensor of shape 4Dims
+/// @param axis index of shape to reduce, in the order of GetShape()
+/// @param type reduce type
+/// @return tensor with shape[axis] == 1, fp32 or int32 for arg reduction
+/// @note
+/// inner axis (axis == 3) reduces each row with SIMD horizontal ops,
+/// outer axes accumulate whole rows to keep access contiguous,
+/// independent slices run on the compute pipe.
+/// padded rows are read in place through the row stride along every axis. result is dense
+std::shared_ptr<Tensor>
+reduce(const std::shared_ptr<Tensor>& tensor, const uint32_t axis, const ReduceType type);
+
+/// @brief softmax along axis into out
+/// @param out softmax of tensor, buffer reused as Tensor::Reset
+/// @return M_OK on success
+/// @note see softmax below
+MStatus softmax(const Tensor& tensor, const uint32_t axis, Tensor& out);
+
+/// @brief softmax along axis, computed as exp(x - max) / sum(exp(x - max))
+/// @param tensor input fp32 tensor of shape 4Dims
+/// @param axis index of shape to normalize
+/// @return softmax of tensor with the same shape and padding
+std::shared_ptr<Tensor> softmax(const std::shared_ptr<Tensor>& tensor, const uint32_t axis);
+
+} // namespace base
+#endif // SIMPLE_BASE_REDUCE_H_
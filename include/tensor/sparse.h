@@ -0,0 +1,106 @@
+#ifndef SIMPLE_BASE_SPARSE_H_
+#define SIMPLE_BASE_SPARSE_H_
+
+#include "common.h"
+#include "tensor/tensor.h"
+
+#include <memory>
+#include <vector>
+
+namespace base {
+
+/// @brief Sparse fp32 matrix in blocked CSR
+/// @note
+/// a block is 1 row * block columns starting at a multiple of block, it is stored when
+/// any |value| > threshold, zeros inside a stored block are kept. block 1 is plain CSR,
+/// block 8 or 16 lets one SIMD op handle a block. blocks of row r are
+/// [GetRowPtr()[r], GetRowPtr()[r + 1]), their first columns are in GetColumns() and
+/// values of block b are GetValues()[b * block, (b + 1) * block)
+class EXPORT_API SparseMatrix final {
+public:
+    /// @brief Build sparse matrix from dense tensor
+    /// @param[in] dense : fp32 tensor of shape {1, 1, rows, cols}
+    /// @param[in] threshold : values with |value| <= threshold are dropped
+    /// @param[in] block : columns of one block, 1 for CSR
+    /// @return sparse matrix, nullptr if failed
+    static std::shared_ptr<SparseMatrix> FromDense(const std::shared_ptr<Tensor>& dense,
+                                                   const float threshold = 0.f,
+                                                   const uint32_t block  = 1);
+
+    /// @brief Expand to dense tensor of shape {1, 1, rows, cols}
+    std::shared_ptr<Tensor> ToDense() const;
+
+    inline uint32_t GetRows() const { return rows_; }
+    inline uint32_t GetCols() const { return cols_; }
+    inline uint32_t GetBlock() const { return block_; }
+
+    /// @brief Get count of stored blocks
+    inline uint32_t GetBlockCount() const { return static_cast<uint32_t>(columns_.size()); }
+
+    /// @brief Get ratio of stored values to rows * cols, zeros of tail blocks included
+    inline float GetDensity() const {
+        return rows_ * cols_ == 0 ? 0.f
+                                  : static_cast<float>(values_.size()) / (1.f * rows_ * cols_);
+    }
+
+    inline const std::vector<uint32_t>& GetRowPtr() const { return row_ptr_; }
+    inline const std::vector<uint32_t>& GetColumns() const { return columns_; }
+    inline const std::vector<float>& GetValues() const { return values_; }
+
+private:
+    SparseMatrix() = default;
+
+    uint32_t rows_{0};
+    uint32_t cols_{0};
+    uint32_t block_{1};
+    std::vector<uint32_t> row_ptr_;
+    std::vector<uint32_t> columns_;
+    std::vector<float> values_;
+};
+
+/// @brief sparse * dense as left * right + bias into out
+/// @param out output tensor of shape {1, 1, R, N}, buffer reused as Tensor::Reset
+/// @return M_OK on success
+/// @note see spmm below
+MStatus spmm(const SparseMatrix& left,
+             const std::shared_ptr<Tensor>& right,
+             const std::shared_ptr<Tensor>& bias,
+             Tensor& out);
+
+/// @brief sparse * dense as left * right + bias
+/// @param left sparse matrix of rows R and cols K
+/// @param right fp32 tensor of shape {1, 1, K, N}
+/// @param bias fp32 bias of R elements added to every row, can be nullptr
+/// @return output tensor of shape {1, 1, R, N}
+/// @note
+/// every stored value adds a scaled row of right, SIMD along N,
+/// output rows run parallel on the compute pipe
+std::shared_ptr<Tensor> spmm(const SparseMatrix& left,
+                             const std::shared_ptr<Tensor>& right,
+                             const std::shared_ptr<Tensor>& bias);
+
+/// @brief innerproduct with sparse weight as left * right + bias into out
+/// @param out output tensor of shape {1, 1, M, N}, buffer reused as Tensor::Reset
+/// @return M_OK on success
+/// @note see innerproduct_sparse below
+MStatus innerproduct_sparse(const std::shared_ptr<Tensor>& left,
+                            const SparseMatrix& right,
+                            const std::shared_ptr<Tensor>& bias,
+                            Tensor& out);
+
+/// @brief innerproduct with sparse weight as left * right + bias
+/// @param left fp32 tensor of shape {1, 1, M, K}
+/// @param right sparse weight of rows K and cols N, as FromDense of a {1, 1, K, N} weight
+/// @param bias fp32 bias of N elements, can be nullptr
+/// @return output tensor of shape {1, 1, M, N}, with padding of left
+/// @note
+/// every nonzero input adds its stored weight blocks to the output row, a block of
+/// 8 or 16 is one SIMD op. zero inputs (as after relu) are skipped.
+/// output rows run parallel on the compute pipe.
+/// see samples/sample_sparse.cc for the density where it beats dense innerproduct
+std::shared_ptr<Tensor> innerproduct_sparse(const std::shared_ptr<Tensor>& left,
+                                            const SparseMatrix& right,
+                                            const std::shared_ptr<Tensor>& bias);
+
+} // namespace base
+#endif // SIMPLE_BASE_SPARSE_H_
@@ -14,24 +14,58 @@ namespace base {
 #define TENSOR_SHAPE_MODE_NCHW ("NCHW")
 #define TENSOR_SHAPE_MODE_NHWC ("NHWC")
 
+// row pitch of padded tensor is multiple of one cache line
+#define TENSOR_PITCH_ALIGN (64U)
+// padded pitch of this multiple maps rows to few cache sets, de-aliasing adds one cache line
+#define TENSOR_DEALIAS_PITCH (512U)
+
+/** A enum of row padding of tensor */
+typedef enum TensorPadding {
+    M_TENSOR_PADDING_NONE       = 0, /**< dense rows, pitch is row size */
+    M_TENSOR_PADDING_CACHE_LINE = 1, /**< pitch aligned up to cache line */
+    M_TENSOR_PADDING_DEALIAS    = 2, /**< cache line pitch, plus one line for aliasing pitch */
+} TensorPadding;
+
+/// @brief channels of one block of layout, 1 for NCHW and NHWC
+inline uint32_t LayoutChannelBlock(const TensorLayout layout) {
+    return layout == M_LAYOUT_NC8HW8 ? 8U : (layout == M_LAYOUT_NC16HW16 ? 16U : 1U);
+}
+
+class Image;
+
 class EXPORT_API Tensor final {
 public:
     Tensor();
 
     ~Tensor() {}
 
+    /// @brief Copy tensor, the copy shares buffer of other
+    Tensor(const Tensor& other) = default;
+
+    /// @brief Move tensor, other is left empty without buffer
+    Tensor(Tensor&& other) noexcept = default;
+
+    Tensor& operator=(const Tensor& other) = default;
+
+    Tensor& operator=(Tensor&& other) noexcept = default;
+
     /// @brief Construct tensor
     /// @param[in] shape  : The shape of tensor
     /// @param[in] layout : The layout of tensor
     /// @param[in] mem_type : The memory type of tensor
     /// @param[in] element_type : The data type of tensor
+    /// @param[in] padding : The row padding of tensor
     /// @note
     /// Now interface currently only supports fp32 data on the CPU
-    /// layout can select NCHW or NHWC
+    /// layout can select NCHW, NHWC or channel blocked NC8HW8 and NC16HW16
+    /// a row is W of NCHW or W * C of NHWC, padded rows start at cache line boundary.
+    /// shape of blocked layout is {N, C, H, W}, stored as {N, C / block, H, W, block} with
+    /// C rounded up to block, a row is W * block
     Tensor(const std::vector<uint32_t>& shape,
            const TensorLayout& layout,
            const MemoryType& mem_type,
-           const DataType& element_type);
+           const DataType& element_type,
+           const TensorPadding padding = M_TENSOR_PADDING_NONE);
 
     /// @brief Construct tensor without  memory allocate and data copy
     /// @param[in] data_ptr  : The address of tensor for user
@@ -54,6 +88,7 @@ public:
     /// @param[in] layout : The layout of tensor
     /// @param[in] mem_type : The memory type of tensor
     /// @param[in] element_type : The data type of tensor
+    /// @param[in] padding : The row padding of data in data manager
     /// @note
     /// Now interface currently only supports fp32 data on the CPU
     /// layout can select NCHW or NHWC
@@ -61,7 +96,8 @@ public:
            const std::vector<uint32_t>& shape,
            const TensorLayout& layout,
            const MemoryType& mem_type,
-           const DataType& element_type);
+           const DataType& element_type,
+           const TensorPadding padding = M_TENSOR_PADDING_NONE);
 
     /// @brief Clone tensor, with data deep copy
     /// @param[out] replica : output Tensor.
@@ -71,10 +107,61 @@ public:
     /// User need to manager replica data
     std::shared_ptr<Tensor> Clone() const;
 
+    /// @brief Clone tensor with another row padding
+    /// @param[in] padding : The row padding of replica
+    /// @note
+    /// Clone(M_TENSOR_PADDING_NONE) gives a dense tensor for kernels without pitch support
+    std::shared_ptr<Tensor> Clone(const TensorPadding padding) const;
+
+    /// @brief Copy elements to dense buffer
+    /// @param[out] dst : buffer of GetCount() elements, rows without padding
+    MStatus CopyToDense(void* dst) const;
+
+    /// @brief Copy elements from dense buffer into rows of tensor
+    /// @param[in] src : buffer of GetCount() elements, rows without padding
+    MStatus CopyFromDense(const void* src);
+
+    /// @brief Deep copy tensor into target
+    /// @param[out] target : output Tensor.
+    /// @note
+    /// buffer of target is reused when it has the same byte size, otherwise target gets
+    /// a new buffer. target takes shape, layout, data type and name of this tensor.
+    /// large tensors are copied on compute pipe with non-temporal stores
+    MStatus CloneInto(Tensor& target) const;
+
+    /// @brief Deep copy other into this tensor, same as other.CloneInto(*this)
+    /// @param[in] other : input Tensor.
+    MStatus CopyFrom(const Tensor& other);
+
+    /// @brief Make tensor ready as output of an operator
+    /// @param[in] shape  : The shape of output
+    /// @param[in] layout : The layout of output
+    /// @param[in] element_type : The data type of output
+    /// @param[in] padding : The row padding of output
+    /// @note
+    /// buffer is kept when tensor already has the shape, layout, data type and padding,
+    /// so an output tensor reused across calls allocates only on the first call.
+    /// otherwise tensor gets a new CPU buffer, content of the buffer is undefined
+    MStatus Reset(const std::vector<uint32_t>& shape,
+                  const TensorLayout layout,
+                  const DataType element_type,
+                  const TensorPadding padding = M_TENSOR_PADDING_NONE);
+
+    /// @brief View image as tensor, No data copy
+    /// @param[in] image : image on cpu of rgb or gray format, packed or planar
+    /// @param[out] out : {N, C, H, W} NCHW of planar formats or {N, H, W, C} NHWC of packed
+    /// formats, data type of ImageDataType, sharing the data manager of image
+    /// @return M_OK on success, M_NOT_SUPPORT if image can't be seen as tensor
+    /// @note
+    /// pitch of image must be the stride of a TensorPadding, planes must follow each other
+    /// and images of batch rows after rows. yuv formats, crops of part of a row and detached
+    /// planes are refused, copy them by convert_color or CloneInto first
+    static MStatus FromImage(const Image& image, Tensor& out);
+
     /// @brief GetShape of tensor
     /// @note
     /// shape of tensor, Now only support shape.size() == 4
-    inline std::vector<uint32_t> GetShape() const { return shape_; }
+    inline const std::vector<uint32_t>& GetShape() const { return shape_; }
 
     /// @brief GetShape of tensor
     /// @note
@@ -89,11 +176,34 @@ public:
 
     /// @brief GetStride of tensor
     /// @note
-    /// stride of tensor is w * datetype
+    /// stride of tensor is byte distance of rows, w * datetype for dense NCHW tensor
     /// as 1 * 3 * 224 * 224 with NCHW layout data type is float,
-    /// stride = 224 * GetTypeSize()
+    /// stride = 224 * GetTypeSize(), w = 225 gives 960 with padding,
+    /// w = 256 gives 1024 with padding and 1088 with de-aliasing padding
     inline uint32_t GetStride() const { return stride_; }
 
+    /// @brief GetRowSize of tensor
+    /// @note
+    /// valid bytes of a row, w * datetype of NCHW or w * c * datetype of NHWC,
+    /// w * block * datetype of blocked layout
+    inline uint32_t GetRowSize() const { return row_size_; }
+
+    /// @brief GetRows of tensor
+    /// @note
+    /// rows of one batch, c * h of NCHW or h of NHWC, c / block * h of blocked layout
+    inline uint32_t GetRows() const { return rows_; }
+
+    /// @brief GetChannelBlock of tensor
+    /// @note
+    /// channels of one block, 8 or 16 of blocked layout and 1 of NCHW or NHWC
+    inline uint32_t GetChannelBlock() const { return LayoutChannelBlock(shape_mode_); }
+
+    /// @brief GetPadding of tensor
+    inline TensorPadding GetPadding() const { return padding_; }
+
+    /// @brief Whether rows of tensor are contiguous
+    inline bool IsDense() const { return stride_ == row_size_; }
+
     /// @brief GetElemType of tensor
     /// @note
     /// elemtype of tensor
@@ -110,31 +220,33 @@ public:
     /// @note
     /// scalar of tensor, with N = 1 of tensor total byte count
     /// as 4 * 3 * 224 * 224 with NCHW layout data type is float,
-    /// scalar = 1 * 3 * 224 * 224 * GetTypeSize()
+    /// scalar = 1 * 3 * 224 * 224 * GetTypeSize(), or GetRows() * GetStride() with padding
     inline uint32_t GetScalar() const { return nscalar_; }
 
     /// @brief GetSize of tensor
     /// @note
-    /// size of tensor, tensor total byte count
+    /// size of tensor, tensor total byte count with padding
     /// as 4 * 3 * 224 * 224 with NCHW layout data type is float,
     /// size = 4 * GetScalar() [3 * 224 * 224 * GetTypeSize()]
     inline uint32_t GetSize() const { return size_; }
 
     /// @brief GetCount of tensor
     /// @note
-    /// count of tensor, tensor total byte count
+    /// count of tensor, tensor total element count without padding
     /// as 4 * 3 * 224 * 224 with NCHW layout data type is float,
-    /// count = 4 * 3 * 224 * 224
-    inline uint32_t GetCount() const { return size_ / type_size_; }
+    /// count = 4 * 3 * 224 * 224, count of blocked layout includes channels of the tail block
+    inline uint32_t GetCount() const {
+        return (shape_.empty() || type_size_ == 0U) ? 0U : shape_[0] * rows_ * (row_size_ / type_size_);
+    }
 
     /// @brief GetShapeMode of tensor
     /// @note
-    /// layout of tensor, now only support NCHW or NHWC
+    /// layout of tensor, NCHW, NHWC, NC8HW8 or NC16HW16
     inline TensorLayout GetShapeMode() const { return shape_mode_; }
 
     /// @brief GetShapeModeStr of tensor
     /// @note
-    /// layout of tensor, now only support NCHW or NHWC
+    /// layout of tensor, NCHW, NHWC, NC8HW8 or NC16HW16
     inline const std::string& GetShapeModeStr() const { return TensorLayoutStr[shape_mode_]; }
 
     /// @brief GetName of tensor
@@ -179,17 +291,31 @@ public:
         return static_cast<T*>(v_data);
     }
 
+    /// @brief Get Address pointer of row
+    /// @param[in] n  : The idx of tensor number.
+    /// @param[in] row  : The idx of row in one number, c * h + y of NCHW or y of NHWC,
+    /// c / block * h + y of blocked layout
+    template <typename T>
+    inline T* GetRow(const size_t n, const size_t row) const {
+        uint8_t* data = GetData<uint8_t>(n);
+        if (nullptr == data) {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(data + row * stride_);
+    }
+
     /// @brief GetDataAt, get tensor data with index offset value
     /// @param[in] offset offset
-    /// @note is equal GetData<T>(0)[offset]
+    /// @note is equal GetData<T>(0)[offset] of dense tensor, offset skips padding
     template <typename T>
     inline T GetDataAt(const uint32_t offset = 0) {
-        if (offset > GetCount() || data_manager_ == nullptr) {
+        if (offset >= GetCount() || data_manager_ == nullptr) {
             SIMPLE_LOG_ERROR("input error {} vs {}", offset, GetCount());
             return T(0);
         }
-        T* data = static_cast<T*>(data_manager_->GetDataPtr());
-        return data[offset];
+        const uint32_t row_count = row_size_ / type_size_;
+        const uint8_t* data      = static_cast<uint8_t*>(data_manager_->GetDataPtr());
+        return reinterpret_cast<const T*>(data + (offset / row_count) * stride_)[offset % row_count];
     }
     bool operator==(const Tensor& other);
     bool operator!=(const Tensor& other);
@@ -203,6 +329,9 @@ private:
     uint32_t nscalar_;
     uint32_t size_;
     uint32_t type_size_;
+    uint32_t row_size_{0};
+    uint32_t rows_{0};
+    TensorPadding padding_{M_TENSOR_PADDING_NONE};
 
     TensorLayout shape_mode_;
     DataType elem_type_;
@@ -232,25 +361,58 @@ inline std::string LogTensor(std::string prefix, const Tensor& tensor) {
 }
 
 // Tensor API
+// every operator has a variant writing into a caller provided out tensor, buffer of out is
+// reused as Tensor::Reset, and a variant returning a new tensor
 
-/// @brief reshape tensor, and 2 Dims of shape as transpose
+/// @brief reshape tensor into out, No data copy
 /// @param tensor input tensor of shape 4Dims
-/// @return reshape of tensor
-std::shared_ptr<Tensor> reshape(const std::shared_ptr<Tensor>& tensor);
+/// @param shape new shape of 4Dims with the same element count
+/// @param out view of tensor buffer in new shape, layout and data type of tensor
+/// @return M_OK on success
+/// @note
+/// tensor must be dense, or padded NCHW keeping W so rows keep their pitch
+MStatus reshape(const Tensor& tensor, const std::vector<uint32_t>& shape, Tensor& out);
+
+/// @brief reshape tensor, No data copy
+/// @return view of tensor, nullptr if failed
+std::shared_ptr<Tensor> reshape(const std::shared_ptr<Tensor>& tensor,
+                                const std::vector<uint32_t>& shape);
+
+/// @brief Transpose matrix operation of 2D into out
+/// @param tensor input tensor of shape 2Dims
+/// @param out transpose of tensor, with padding of tensor
+/// @return M_OK on success
+/// @note now supports two dimensions
+/// eg: {1, 1, rows, cols}-->{1, 1, cols, rows}
+MStatus transpose(const Tensor& tensor, Tensor& out);
 
 /// @brief Transpose matrix operation of 2D
 /// @param tensor input tensor of shape 2Dims
-/// @return transpose of tensor, as swap rows and cols of matrix
+/// @return transpose of tensor, as swap rows and cols of matrix, with padding of tensor
 /// @note now supports two dimensions
 /// eg: {1, 1, rows, cols}-->{1, 1, cols, rows}
 std::shared_ptr<Tensor> transpose(const std::shared_ptr<Tensor>& tensor);
 
+/// @brief innerproduct tensor as left * right + bias into out
+/// @param out result of shape {1, 1, M, N} with padding of left, must not be an input
+/// @return M_OK on success
+/// @note see innerproduct below
+MStatus innerproduct(const std::shared_ptr<Tensor>& left,
+                     const std::shared_ptr<Tensor>& right,
+                     const std::shared_ptr<Tensor>& bias,
+                     Tensor& out);
+
 /// @brief innerproduct tensor as left * right + bias
 /// @param left left tensor
 /// @param right right tensor
 /// @param bias add bias of tensor
 /// @return return left * right + bias
 /// @note now supports two dimensions
+/// eg: {1, 1, M, K} * {1, 1, K, N} + {N} --> {1, 1, M, N}
+/// fp32 * fp32 runs the fp32 path, uint8 * int8 runs the int8 path (see tensor/innerproduct.h),
+/// which packs right on every call, pass weight packed by Int8Weight::Pack instead in loops
+/// fp32 shapes registered as InnerProductKernel run the fixed kernel (see tensor/innerproduct_kernel.h)
+/// row pitch of inputs is respected, result takes padding of left
 std::shared_ptr<Tensor> innerproduct(const std::shared_ptr<Tensor>& left,
                                      const std::shared_ptr<Tensor>& right,
                                      const std::shared_ptr<Tensor>& bias);
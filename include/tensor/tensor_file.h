@@ -0,0 +1,92 @@
+#ifndef SIMPLE_BASE_TENSOR_FILE_H_
+#define SIMPLE_BASE_TENSOR_FILE_H_
+
+#include "common.h"
+#include "tensor/tensor.h"
+
+#include <memory>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+/// @brief Binary container of named tensors
+/// @note
+/// layout of file, all numbers are little endian
+/// [file header 64B] [entry header 64B + name, padded to 64B] [payload, padded to 64B] ...
+/// payload offsets are 64 bytes aligned, so a mapped file can be used by SIMD kernels directly
+namespace base {
+
+#define TENSOR_FILE_MAGIC ("SBTENSOR")
+#define TENSOR_FILE_VERSION (1U)
+#define TENSOR_FILE_ALIGN (64U)
+
+/// @brief Streaming writer, every tensor goes to disk when written
+class EXPORT_API TensorFileWriter final {
+public:
+    TensorFileWriter() = default;
+    ~TensorFileWriter() { Close(); }
+
+    /// @brief Create file
+    /// @param[in] path : The path of file.
+    /// @param[in] checksum : Store crc32c of every payload.
+    MStatus Open(const std::string& path, const bool checksum = true);
+
+    /// @brief Append tensor with its name, only cpu tensor is supported
+    /// @note padded rows are stored dense, reader always gives dense tensors
+    MStatus Write(const Tensor& tensor);
+
+    /// @brief Append tensor with name
+    MStatus Write(const std::string& name, const Tensor& tensor);
+
+    /// @brief Flush count of tensors and close file
+    MStatus Close();
+
+private:
+    MStatus WritePadding(const uint64_t align);
+
+    FILE* file_{nullptr};
+    bool checksum_{false};
+    uint32_t count_{0};
+    uint64_t offset_{0};
+};
+
+/// @brief Zero copy reader, maps file and creates tensors point into the mapping
+/// @note
+/// tensors hold the mapping, so they stay valid after reader is closed or released.
+/// the mapping is private, writing to a tensor doesn't change the file
+class EXPORT_API TensorFileReader final {
+public:
+    TensorFileReader() = default;
+    ~TensorFileReader() { Close(); }
+
+    /// @brief Map file and parse headers
+    /// @param[in] path : The path of file.
+    /// @param[in] verify : Check crc32c of every payload which has checksum.
+    MStatus Open(const std::string& path, const bool verify = false);
+
+    /// @brief Release reader's reference of the mapping
+    void Close();
+
+    /// @brief Get number of tensors in file
+    inline uint32_t GetCount() const { return static_cast<uint32_t>(tensors_.size()); }
+
+    /// @brief Get names of tensors in file order
+    inline const std::vector<std::string>& GetNames() const { return names_; }
+
+    /// @brief Get tensor by index, nullptr if out of range
+    std::shared_ptr<Tensor> Get(const uint32_t idx) const;
+
+    /// @brief Get tensor by name, nullptr if not found
+    std::shared_ptr<Tensor> Get(const std::string& name) const;
+
+private:
+    std::vector<std::string> names_;
+    std::vector<std::shared_ptr<Tensor>> tensors_;
+};
+
+/// @brief crc32c (Castagnoli) of buffer
+/// @param[in] crc : crc of previous buffer, 0 for the first
+uint32_t Crc32c(const void* data, const size_t size, const uint32_t crc = 0);
+
+} // namespace base
+#endif // SIMPLE_BASE_TENSOR_FILE_H_
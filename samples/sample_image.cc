@@ -1,10 +1,12 @@
 #include "image/image.h"
+#include "image/image_operator.h"
 #include "log.h"
 #include "manager/data_manager.h"
 #include "register.h"
 #include "common.h"
 
 #include <iostream>
+#include <string.h>
 
 int main() {
     base::DataManager manager;
@@ -16,6 +18,15 @@ int main() {
     SIMPLE_LOG_DEBUG("hello world\n");
     SIMPLE_LOG_WARN("hello world\n");
     SIMPLE_LOG_ERROR("hello world\n");
-    auto op = RegisterBase<base::Image>::GetInstance().Create("resize");
+
+    base::Image image(640, 480, 1, M_PIX_FMT_BGR888, TimeStamp(), M_MEM_ON_CPU);
+    memset(image.GetData<uint8_t>(), 128, image.GetSize());
+    base::Image resized(image, 320, 240);
+    auto op = base::ImageOperator::Create("resize");
+    if (nullptr == op || op->Run(image, resized) != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("resize failed\n");
+        return -1;
+    }
+    SIMPLE_LOG_INFO("%s\n", base::LogImage("resized", resized).c_str());
     return 0;
 }
\ No newline at end of file
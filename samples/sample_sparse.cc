@@ -0,0 +1,72 @@
+#include "benchmark.h"
+#include "common.h"
+#include "log.h"
+#include "tensor/innerproduct.h"
+#include "tensor/sparse.h"
+#include "tensor/tensor.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace base;
+
+/// average cost in us of func over loop runs after one warm up
+template <typename Func>
+static double Measure(Func func, const uint32_t loop) {
+    func();
+    const uint64_t start = Timer::GetTimeUs();
+    for (uint32_t i = 0; i < loop; ++i) {
+        func();
+    }
+    return static_cast<double>(Timer::GetTimeUs() - start) / loop;
+}
+
+/// keep density of weight, whole 1 x block groups are kept or dropped together
+static void Prune(float* w, const uint32_t count, const uint32_t block, const float density) {
+    for (uint32_t i = 0; i < count; i += block) {
+        const bool keep = static_cast<float>(rand()) / RAND_MAX < density;
+        for (uint32_t t = i; t < i + block && t < count; ++t) {
+            w[t] = keep ? static_cast<float>(rand()) / RAND_MAX - 0.5f : 0.f;
+        }
+    }
+}
+
+/// usage: sample_sparse [M] [K] [N], compares dense innerproduct, CSR and BCSR of 1x8
+int main(int argc, char* argv[]) {
+    const uint32_t M    = argc > 1 ? atoi(argv[1]) : 1;
+    const uint32_t K    = argc > 2 ? atoi(argv[2]) : 1024;
+    const uint32_t N    = argc > 3 ? atoi(argv[3]) : 1024;
+    const uint32_t loop = 20;
+    set_level(Loger::INFO);
+
+    auto left   = std::make_shared<Tensor>(
+        std::vector<uint32_t>{1, 1, M, K}, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32);
+    auto weight = std::make_shared<Tensor>(
+        std::vector<uint32_t>{1, 1, K, N}, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32);
+    for (uint32_t i = 0; i < M * K; ++i) {
+        left->GetData<float>(0)[i] = static_cast<float>(rand()) / RAND_MAX - 0.5f;
+    }
+
+    printf("innerproduct [%u, %u] x [%u, %u], cost in us\n", M, K, K, N);
+    printf("%8s %10s %10s %10s\n", "density", "dense", "csr", "bcsr8");
+    const float densities[] = {0.02f, 0.05f, 0.1f, 0.2f, 0.3f, 0.5f, 0.7f, 1.0f};
+    for (const float density : densities) {
+        double cost[3] = {0.0, 0.0, 0.0};
+        for (uint32_t mode = 0; mode < 2; ++mode) {
+            const uint32_t block = mode == 0 ? 1 : 8;
+            Prune(weight->GetData<float>(0), K * N, block, density);
+            auto sparse = SparseMatrix::FromDense(weight, 0.f, block);
+            if (nullptr == sparse) {
+                return -1;
+            }
+            if (mode == 0) {
+                cost[0] = Measure([&]() { innerproduct(left, weight, nullptr); }, loop);
+            }
+            cost[mode + 1] =
+                Measure([&]() { innerproduct_sparse(left, *sparse, nullptr); }, loop);
+        }
+        printf("%8.2f %10.1f %10.1f %10.1f\n", density, cost[0], cost[1], cost[2]);
+    }
+    return 0;
+}
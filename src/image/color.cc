@@ -0,0 +1,684 @@
+#include "image/color.h"
+
+#include "intrinsic.h"
+#include "manager/pipe_manager.h"
+
+#include <algorithm>
+
+namespace base {
+
+/// fixed-point yuv matrix, Y scale in Q14 and chroma scales in Q13 of the mulhrs inputs
+typedef struct YuvCoeff {
+    int16_t y_offset; ///< 16 of limited range, 0 of full range
+    int16_t cy;       ///< Y scale
+    int16_t crv;      ///< V to R
+    int16_t cgu;      ///< U to G, subtracted
+    int16_t cgv;      ///< V to G, subtracted
+    int16_t cbu;      ///< U to B
+} YuvCoeff;
+
+#define Q14(x) static_cast<int16_t>((x) * 16384 + 0.5)
+#define Q13(x) static_cast<int16_t>((x) * 8192 + 0.5)
+
+static const YuvCoeff kYuvCoeff[M_COLOR_MAX] = {
+    {16, Q14(1.164383), Q13(1.596027), Q13(0.391762), Q13(0.812968), Q13(2.017232)},
+    {0, Q14(1.0), Q13(1.402), Q13(0.344136), Q13(0.714136), Q13(1.772)},
+    {16, Q14(1.164383), Q13(1.792741), Q13(0.213249), Q13(0.532909), Q13(2.112402)},
+    {0, Q14(1.0), Q13(1.5748), Q13(0.187324), Q13(0.468124), Q13(1.8556)},
+};
+
+#undef Q14
+#undef Q13
+
+/// pointers to the first pixel of one yuv row
+typedef struct YuvRow {
+    const uint8_t* y;
+    const uint8_t* u;
+    const uint8_t* v;
+    uint32_t y_step;  ///< bytes between Y of neighbour pixels, 2 of packed 4:2:2
+    uint32_t uv_step; ///< bytes between neighbour U samples
+} YuvRow;
+
+/// pointers to the first pixel of one rgb row, every channel of packed formats in one row
+typedef struct RgbRow {
+    uint8_t* b;
+    uint8_t* g;
+    uint8_t* r;
+    uint8_t* a;    ///< nullptr without alpha
+    uint32_t step; ///< elements between neighbour pixels of one channel
+} RgbRow;
+
+static bool IsYuv(const PixelFormat format) {
+    switch (format) {
+        case M_PIX_FMT_NV12:
+        case M_PIX_FMT_NV21:
+        case M_PIX_FMT_NV12_DETACH:
+        case M_PIX_FMT_NV21_DETACH:
+        case M_PIX_FMT_YUV420P:
+        case M_PIX_FMT_YU12:
+        case M_PIX_FMT_YV12:
+        case M_PIX_FMT_YUYV:
+        case M_PIX_FMT_UYVY:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// channel order and layout of rgb formats
+typedef struct RgbFormat {
+    uint32_t type_size;
+    uint32_t channel;
+    bool planar;
+    bool bgr; ///< b is the first channel
+} RgbFormat;
+
+static bool GetRgbFormat(const PixelFormat format, RgbFormat& desc) {
+    switch (format) {
+        case M_PIX_FMT_BGR888:
+        case M_PIX_FMT_RGB888:
+            desc = {1, 3, false, format == M_PIX_FMT_BGR888};
+            return true;
+        case M_PIX_FMT_BGRA8888:
+        case M_PIX_FMT_RGBA8888:
+            desc = {1, 4, false, format == M_PIX_FMT_BGRA8888};
+            return true;
+        case M_PIX_FMT_BGR888_PLANAR:
+        case M_PIX_FMT_RGB888_PLANAR:
+            desc = {1, 3, true, format == M_PIX_FMT_BGR888_PLANAR};
+            return true;
+        case M_PIX_FMT_BGR161616:
+        case M_PIX_FMT_RGB161616:
+            desc = {2, 3, false, format == M_PIX_FMT_BGR161616};
+            return true;
+        case M_PIX_FMT_BGR161616_PLANAR:
+        case M_PIX_FMT_RGB161616_PLANAR:
+            desc = {2, 3, true, format == M_PIX_FMT_BGR161616_PLANAR};
+            return true;
+        case M_PIX_FMT_BGR323232:
+        case M_PIX_FMT_RGB323232:
+            desc = {4, 3, false, format == M_PIX_FMT_BGR323232};
+            return true;
+        case M_PIX_FMT_BGR323232_PLANAR:
+        case M_PIX_FMT_RGB323232_PLANAR:
+            desc = {4, 3, true, format == M_PIX_FMT_BGR323232_PLANAR};
+            return true;
+        default:
+            return false;
+    }
+}
+
+static YuvRow GetYuvRow(const Image& image, const uint32_t n, const uint32_t i) {
+    const PixelFormat format = image.GetPixelFormat();
+    ImagePlane planes[IMAGE_MAX_PLANES];
+    image.GetPlanes(n, planes);
+
+    YuvRow row;
+    row.y       = planes[0].data + i * planes[0].pitch;
+    row.y_step  = 1;
+    row.uv_step = 1;
+    switch (format) {
+        case M_PIX_FMT_NV12:
+        case M_PIX_FMT_NV21:
+        case M_PIX_FMT_NV12_DETACH:
+        case M_PIX_FMT_NV21_DETACH: {
+            const uint8_t* uv = planes[1].data + i / 2 * planes[1].pitch;
+            const bool nv12   = format == M_PIX_FMT_NV12 || format == M_PIX_FMT_NV12_DETACH;
+            row.u             = nv12 ? uv : uv + 1;
+            row.v             = nv12 ? uv + 1 : uv;
+            row.uv_step       = 2;
+            break;
+        }
+        case M_PIX_FMT_YUV420P:
+        case M_PIX_FMT_YU12:
+        case M_PIX_FMT_YV12: {
+            // YV12 stores V before U
+            const uint8_t* first  = planes[1].data + i / 2 * planes[1].pitch;
+            const uint8_t* second = planes[2].data + i / 2 * planes[2].pitch;
+            row.u                 = format == M_PIX_FMT_YV12 ? second : first;
+            row.v                 = format == M_PIX_FMT_YV12 ? first : second;
+            break;
+        }
+        default: {
+            // YUYV and UYVY, chroma is U V in both
+            const uint8_t* packed = row.y;
+            row.y                 = format == M_PIX_FMT_YUYV ? packed : packed + 1;
+            row.u                 = format == M_PIX_FMT_YUYV ? packed + 1 : packed;
+            row.v                 = row.u + 2;
+            row.y_step            = 2;
+            row.uv_step           = 4;
+            break;
+        }
+    }
+    return row;
+}
+
+static RgbRow
+GetRgbRow(const Image& image, const RgbFormat& desc, const uint32_t n, const uint32_t i) {
+    ImagePlane planes[IMAGE_MAX_PLANES];
+    image.GetPlanes(n, planes);
+    uint8_t* p = planes[0].data + i * planes[0].pitch;
+
+    RgbRow row;
+    row.a = nullptr;
+    if (desc.planar) {
+        uint8_t* second = desc.channel > 1 ? planes[1].data + i * planes[1].pitch : p;
+        uint8_t* third  = desc.channel > 2 ? planes[2].data + i * planes[2].pitch : p;
+        row.b           = desc.bgr ? p : third;
+        row.g           = second;
+        row.r           = desc.bgr ? third : p;
+        row.step        = 1;
+        return row;
+    }
+    const uint32_t ts = desc.type_size;
+    row.b             = desc.bgr ? p : p + 2 * ts;
+    row.g             = p + ts;
+    row.r             = desc.bgr ? p + 2 * ts : p;
+    row.a             = desc.channel == 4 ? p + 3 * ts : nullptr;
+    row.step          = desc.channel;
+    return row;
+}
+
+/// (a * b + 2^14) >> 15, same as _mm256_mulhrs_epi16
+static inline int MulHrs(const int a, const int b) {
+    return (a * b + 16384) >> 15;
+}
+
+static inline uint8_t Clamp8(const int value) {
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+/// one pixel, the same integer steps as YuvToRgb32 so both give the same result
+static inline void
+YuvToRgb(const int y, const int u, const int v, const YuvCoeff& k, uint8_t* bgr) {
+    const int yy = MulHrs((y - k.y_offset) * 128, k.cy);
+    const int uu = (u - 128) * 256, vv = (v - 128) * 256;
+    bgr[0]       = Clamp8((yy + MulHrs(uu, k.cbu) + 32) >> 6);
+    bgr[1]       = Clamp8((yy - (MulHrs(uu, k.cgu) + MulHrs(vv, k.cgv)) + 32) >> 6);
+    bgr[2]       = Clamp8((yy + MulHrs(vv, k.crv) + 32) >> 6);
+}
+
+#ifdef USE_AVX
+/// 32 Y, 16 U and 16 V of 32 pixels
+static inline void
+LoadYuv32(const YuvRow& row, const uint32_t x, __m256i& y, __m128i& u, __m128i& v) {
+    if (row.y_step == 2) {
+        const __m128i even =
+            _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 14, 12, 10, 8, 6, 4, 2, 0);
+        const __m128i odd =
+            _mm_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1, 15, 13, 11, 9, 7, 5, 3, 1);
+        const bool y_first = row.y < row.u;
+        const uint8_t* p   = (y_first ? row.y : row.u) + 2 * x;
+        __m128i e0, o0, e1, o1;
+        vld2_u8x16_avx(p, &e0, &o0);
+        vld2_u8x16_avx(p + 32, &e1, &o1);
+        const __m128i c0 = y_first ? o0 : e0;
+        const __m128i c1 = y_first ? o1 : e1;
+        y = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(y_first ? e0 : o0), y_first ? e1 : o1, 1);
+        u = _mm_unpacklo_epi64(_mm_shuffle_epi8(c0, even), _mm_shuffle_epi8(c1, even));
+        v = _mm_unpacklo_epi64(_mm_shuffle_epi8(c0, odd), _mm_shuffle_epi8(c1, odd));
+        return;
+    }
+    y = _mm256_loadu_si256((const __m256i*)(row.y + x));
+    if (row.uv_step == 1) {
+        u = _mm_loadu_si128((const __m128i*)(row.u + x / 2));
+        v = _mm_loadu_si128((const __m128i*)(row.v + x / 2));
+    } else {
+        const bool u_first = row.u < row.v;
+        __m128i c0, c1;
+        vld2_u8x16_avx((u_first ? row.u : row.v) + x, &c0, &c1);
+        u = u_first ? c0 : c1;
+        v = u_first ? c1 : c0;
+    }
+}
+
+/// every chroma term of 16 lanes to the 2 pixels of 32 lanes
+static inline void Upsample(const __m256i t, __m256i& lo, __m256i& hi) {
+    const __m256i a = _mm256_unpacklo_epi16(t, t);
+    const __m256i b = _mm256_unpackhi_epi16(t, t);
+    lo              = _mm256_permute2x128_si256(a, b, 0x20);
+    hi              = _mm256_permute2x128_si256(a, b, 0x31);
+}
+
+/// round Q6 of 2 * 16 pixels to u8, lanes back to pixel order
+static inline __m256i Pack(const __m256i lo, const __m256i hi) {
+    const __m256i round = _mm256_set1_epi16(32);
+    const __m256i l     = _mm256_srai_epi16(_mm256_adds_epi16(lo, round), 6);
+    const __m256i h     = _mm256_srai_epi16(_mm256_adds_epi16(hi, round), 6);
+    return _mm256_permute4x64_epi64(_mm256_packus_epi16(l, h), 0xD8);
+}
+
+/// 32 pixels, 16 bits lanes, saturation only happens to values over 255
+static inline void YuvToRgb32(const __m256i y8,
+                              const __m128i u8,
+                              const __m128i v8,
+                              const YuvCoeff& k,
+                              __m256i& b,
+                              __m256i& g,
+                              __m256i& r) {
+    const __m256i half   = _mm256_set1_epi16(128);
+    const __m256i offset = _mm256_set1_epi16(k.y_offset);
+    const __m256i cy     = _mm256_set1_epi16(k.cy);
+    const __m256i uu     = _mm256_slli_epi16(_mm256_sub_epi16(_mm256_cvtepu8_epi16(u8), half), 8);
+    const __m256i vv     = _mm256_slli_epi16(_mm256_sub_epi16(_mm256_cvtepu8_epi16(v8), half), 8);
+
+    __m256i rv_lo, rv_hi, gc_lo, gc_hi, bu_lo, bu_hi;
+    Upsample(_mm256_mulhrs_epi16(vv, _mm256_set1_epi16(k.crv)), rv_lo, rv_hi);
+    Upsample(_mm256_adds_epi16(_mm256_mulhrs_epi16(uu, _mm256_set1_epi16(k.cgu)),
+                               _mm256_mulhrs_epi16(vv, _mm256_set1_epi16(k.cgv))),
+             gc_lo,
+             gc_hi);
+    Upsample(_mm256_mulhrs_epi16(uu, _mm256_set1_epi16(k.cbu)), bu_lo, bu_hi);
+
+    const __m128i y8_lo = _mm256_castsi256_si128(y8);
+    const __m128i y8_hi = _mm256_extracti128_si256(y8, 1);
+    const __m256i y0    = _mm256_sub_epi16(_mm256_cvtepu8_epi16(y8_lo), offset);
+    const __m256i y1    = _mm256_sub_epi16(_mm256_cvtepu8_epi16(y8_hi), offset);
+    const __m256i y_lo  = _mm256_mulhrs_epi16(_mm256_slli_epi16(y0, 7), cy);
+    const __m256i y_hi  = _mm256_mulhrs_epi16(_mm256_slli_epi16(y1, 7), cy);
+    b = Pack(_mm256_adds_epi16(y_lo, bu_lo), _mm256_adds_epi16(y_hi, bu_hi));
+    g = Pack(_mm256_subs_epi16(y_lo, gc_lo), _mm256_subs_epi16(y_hi, gc_hi));
+    r = Pack(_mm256_adds_epi16(y_lo, rv_lo), _mm256_adds_epi16(y_hi, rv_hi));
+}
+
+/// 32 pixels of 8 bits rgb, alpha is 255 without alpha channel
+static inline void
+LoadRgb32(const RgbRow& row, const uint32_t x, __m256i& b, __m256i& g, __m256i& r, __m256i& a) {
+    a = _mm256_set1_epi8(-1);
+    if (row.step == 1) {
+        b = _mm256_loadu_si256((const __m256i*)(row.b + x));
+        g = _mm256_loadu_si256((const __m256i*)(row.g + x));
+        r = _mm256_loadu_si256((const __m256i*)(row.r + x));
+    } else if (row.step == 3) {
+        if (row.b < row.r) {
+            vld3_u8x32_avx(row.b + 3 * x, &b, &g, &r);
+        } else {
+            vld3_u8x32_avx(row.r + 3 * x, &r, &g, &b);
+        }
+    } else {
+        if (row.b < row.r) {
+            vld4_u8x32_avx(row.b + 4 * x, &b, &g, &r, &a);
+        } else {
+            vld4_u8x32_avx(row.r + 4 * x, &r, &g, &b, &a);
+        }
+    }
+}
+
+static inline void StoreRgb32(const RgbRow& row,
+                              const uint32_t x,
+                              const __m256i b,
+                              const __m256i g,
+                              const __m256i r,
+                              const __m256i a) {
+    if (row.step == 1) {
+        _mm256_storeu_si256((__m256i*)(row.b + x), b);
+        _mm256_storeu_si256((__m256i*)(row.g + x), g);
+        _mm256_storeu_si256((__m256i*)(row.r + x), r);
+    } else if (row.step == 3) {
+        if (row.b < row.r) {
+            vst3_u8x32_avx(b, g, r, row.b + 3 * x);
+        } else {
+            vst3_u8x32_avx(r, g, b, row.r + 3 * x);
+        }
+    } else {
+        if (row.b < row.r) {
+            vst4_u8x32_avx(b, g, r, a, row.b + 4 * x);
+        } else {
+            vst4_u8x32_avx(r, g, b, a, row.r + 4 * x);
+        }
+    }
+}
+#endif // USE_AVX
+
+static void
+YuvRowToRgb(const YuvRow& src, const RgbRow& dst, const uint32_t width, const YuvCoeff& k) {
+    uint32_t x = 0;
+#ifdef USE_AVX
+    for (; x + 32 <= width; x += 32) {
+        __m256i y, b, g, r;
+        __m128i u, v;
+        LoadYuv32(src, x, y, u, v);
+        YuvToRgb32(y, u, v, k, b, g, r);
+        StoreRgb32(dst, x, b, g, r, _mm256_set1_epi8(-1));
+    }
+#endif
+    uint8_t bgr[3];
+    for (; x < width; ++x) {
+        const uint32_t c = x / 2 * src.uv_step;
+        YuvToRgb(src.y[x * src.y_step], src.u[c], src.v[c], k, bgr);
+        dst.b[x * dst.step] = bgr[0];
+        dst.g[x * dst.step] = bgr[1];
+        dst.r[x * dst.step] = bgr[2];
+        if (nullptr != dst.a) {
+            dst.a[x * dst.step] = 255;
+        }
+    }
+}
+
+/// vectorized part of RgbRowToRgb, returns count of pixels done
+template <typename T>
+static uint32_t SimdRgbRow(const RgbRow&, const RgbRow&, const uint32_t) {
+    return 0;
+}
+
+#ifdef USE_AVX
+template <>
+uint32_t SimdRgbRow<uint8_t>(const RgbRow& src, const RgbRow& dst, const uint32_t width) {
+    uint32_t x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i b, g, r, a;
+        LoadRgb32(src, x, b, g, r, a);
+        StoreRgb32(dst, x, b, g, r, a);
+    }
+    return x;
+}
+#endif // USE_AVX
+
+/// one row between rgb formats of T, every pixel is read before written, so it works in
+/// place when both formats have the same layout. only 8 bits formats have alpha
+template <typename T>
+static void RgbRowToRgb(const RgbRow& src, const RgbRow& dst, const uint32_t width) {
+    const T* sb = reinterpret_cast<const T*>(src.b);
+    const T* sg = reinterpret_cast<const T*>(src.g);
+    const T* sr = reinterpret_cast<const T*>(src.r);
+    const T* sa = reinterpret_cast<const T*>(src.a);
+    T* db       = reinterpret_cast<T*>(dst.b);
+    T* dg       = reinterpret_cast<T*>(dst.g);
+    T* dr       = reinterpret_cast<T*>(dst.r);
+    T* da       = reinterpret_cast<T*>(dst.a);
+    for (uint32_t x = SimdRgbRow<T>(src, dst, width); x < width; ++x) {
+        const T b = sb[x * src.step], g = sg[x * src.step], r = sr[x * src.step];
+        const T a = nullptr == sa ? T(255) : sa[x * src.step];
+        db[x * dst.step] = b;
+        dg[x * dst.step] = g;
+        dr[x * dst.step] = r;
+        if (nullptr != da) {
+            da[x * dst.step] = a;
+        }
+    }
+}
+
+MStatus convert_color(const Image& input,
+                      const PixelFormat format,
+                      Image& out,
+                      const ColorSpace space) {
+    if (nullptr == input.GetData<void>()) {
+        SIMPLE_LOG_ERROR("convert_color failed, input image is empty");
+        return MStatus::M_INVALID_ARG;
+    }
+    const PixelFormat in_format = input.GetPixelFormat();
+    const uint32_t width = input.GetWidth(), height = input.GetHeight();
+    const uint32_t number = input.GetNumber();
+    const bool yuv        = IsYuv(in_format);
+    const bool yuv422     = in_format == M_PIX_FMT_YUYV || in_format == M_PIX_FMT_UYVY;
+    RgbFormat in_desc     = {}, out_desc = {};
+    const bool supported  = GetRgbFormat(format, out_desc) &&
+                           (yuv ? out_desc.type_size == 1 && width % 2 == 0 &&
+                                      (yuv422 || height % 2 == 0) && space < M_COLOR_MAX
+                                : GetRgbFormat(in_format, in_desc) &&
+                                      in_desc.type_size == out_desc.type_size);
+    if (!supported || input.GetMemType() != M_MEM_ON_CPU) {
+        SIMPLE_LOG_ERROR("convert_color can't support %s [%u x %u] to %s, color space %i",
+                         input.GetPixelFormatStr().c_str(),
+                         width,
+                         height,
+                         format < M_PIX_FMT_MAX ? FormatStr[format].c_str() : "INVALID",
+                         static_cast<int>(space));
+        return MStatus::M_NOT_SUPPORT;
+    }
+
+    // in place needs the same byte size, layout changes run from a copy of input
+    Image source         = input;
+    const uint32_t size  = number * height * width * out_desc.channel * out_desc.type_size;
+    const bool in_place  = input.GetData<void>() == out.GetData<void>();
+    const bool same_rows = in_desc.planar == out_desc.planar && in_desc.channel == out_desc.channel;
+    if (in_place) {
+        if (yuv || size != input.GetSize()) {
+            SIMPLE_LOG_ERROR("convert_color %s to %s can't run in place",
+                             input.GetPixelFormatStr().c_str(),
+                             FormatStr[format].c_str());
+            return MStatus::M_INVALID_ARG;
+        }
+        if (!same_rows) {
+            source = input.Clone();
+            if (nullptr == source.GetData<void>()) {
+                return MStatus::M_OUT_OF_MEMORY;
+            }
+        }
+        MStatus status = out.ImageReshape(width, height, number, format);
+        if (status != MStatus::M_OK) {
+            return status;
+        }
+    } else if (nullptr == out.GetData<void>() || out.GetWidth() != width ||
+               out.GetHeight() != height || out.GetNumber() != number ||
+               out.GetPixelFormat() != format) {
+        out = Image(width, height, number, format, input.GetTimestamp(), M_MEM_ON_CPU);
+        if (nullptr == out.GetData<void>()) {
+            SIMPLE_LOG_ERROR("convert_color failed, malloc %u bytes failed", size);
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+    }
+    source.GetDataManager()->SyncCache(false);
+
+    const YuvCoeff& k    = kYuvCoeff[yuv ? space : M_COLOR_BT601_LIMITED];
+    const uint32_t grain = std::max(1U, 65536U / width);
+    ParallelFor(number * height, grain, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t t = begin; t < end; ++t) {
+            const uint32_t n = t / height, i = t % height;
+            const RgbRow dst = GetRgbRow(out, out_desc, n, i);
+            if (yuv) {
+                YuvRowToRgb(GetYuvRow(source, n, i), dst, width, k);
+                continue;
+            }
+            const RgbRow src = GetRgbRow(source, in_desc, n, i);
+            switch (out_desc.type_size) {
+                case 1U:
+                    RgbRowToRgb<uint8_t>(src, dst, width);
+                    break;
+                case 2U:
+                    RgbRowToRgb<uint16_t>(src, dst, width);
+                    break;
+                default:
+                    RgbRowToRgb<uint32_t>(src, dst, width);
+                    break;
+            }
+        }
+    });
+    out.GetDataManager()->SyncCache(true);
+    return MStatus::M_OK;
+}
+
+#ifdef USE_AVX
+/// 8 pixels of lane group k of 32 u8 pixels as fp32
+static inline __m256 Widen8(const __m256i v, const uint32_t k) {
+    __m128i half = k < 2 ? _mm256_castsi256_si128(v) : _mm256_extracti128_si256(v, 1);
+    half         = (k & 1) ? _mm_srli_si128(half, 8) : half;
+    return _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(half));
+}
+
+static inline void Store8(const __m256 v, float* dst) {
+    _mm256_storeu_ps(dst, v);
+}
+
+static inline void Store8(const __m256 v, uint16_t* dst) {
+    _mm_storeu_si128((__m128i*)dst, _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+}
+
+static inline void Store24(const __m256 c0, const __m256 c1, const __m256 c2, float* dst) {
+    vst3_f32x8_avx(c0, c1, c2, dst);
+}
+
+static inline void Store24(const __m256 c0, const __m256 c1, const __m256 c2, uint16_t* dst) {
+    float packed[24];
+    vst3_f32x8_avx(c0, c1, c2, packed);
+    for (uint32_t k = 0; k < 3; ++k) {
+        Store8(_mm256_loadu_ps(packed + 8 * k), dst + 8 * k);
+    }
+}
+#endif // USE_AVX
+
+static inline void Store1(const float v, float* dst) {
+    *dst = v;
+}
+
+static inline void Store1(const float v, uint16_t* dst) {
+    *dst = fp32_to_fp16(v);
+}
+
+/// one row of 8 bits rgb or gray to T as pixel * scale + offset, scale and offset in order
+/// b, g, r. gray rows have b only
+template <typename T>
+static void NormalizeRow(const RgbRow& src,
+                         const RgbRow& dst,
+                         const bool gray,
+                         const float* scale,
+                         const float* offset,
+                         const uint32_t width) {
+    T* db      = reinterpret_cast<T*>(dst.b);
+    T* dg      = reinterpret_cast<T*>(dst.g);
+    T* dr      = reinterpret_cast<T*>(dst.r);
+    uint32_t x = 0;
+#ifdef USE_AVX
+    const __m256 sb = _mm256_set1_ps(scale[0]), ob = _mm256_set1_ps(offset[0]);
+    const __m256 sg = _mm256_set1_ps(scale[1]), og = _mm256_set1_ps(offset[1]);
+    const __m256 sr = _mm256_set1_ps(scale[2]), orr = _mm256_set1_ps(offset[2]);
+    for (; x + 32 <= width; x += 32) {
+        __m256i b, g, r, a;
+        if (gray) {
+            b = _mm256_loadu_si256((const __m256i*)(src.b + x));
+            for (uint32_t k = 0; k < 4; ++k) {
+                Store8(_mm256_fmadd_ps(Widen8(b, k), sb, ob), db + x + 8 * k);
+            }
+            continue;
+        }
+        LoadRgb32(src, x, b, g, r, a);
+        for (uint32_t k = 0; k < 4; ++k) {
+            const __m256 fb = _mm256_fmadd_ps(Widen8(b, k), sb, ob);
+            const __m256 fg = _mm256_fmadd_ps(Widen8(g, k), sg, og);
+            const __m256 fr = _mm256_fmadd_ps(Widen8(r, k), sr, orr);
+            const uint32_t p = x + 8 * k;
+            if (dst.step == 1) {
+                Store8(fb, db + p);
+                Store8(fg, dg + p);
+                Store8(fr, dr + p);
+            } else if (db < dr) {
+                Store24(fb, fg, fr, db + 3 * p);
+            } else {
+                Store24(fr, fg, fb, dr + 3 * p);
+            }
+        }
+    }
+#endif
+    for (; x < width; ++x) {
+        const uint32_t s = x * src.step, d = x * dst.step;
+        Store1(src.b[s] * scale[0] + offset[0], db + d);
+        if (!gray) {
+            Store1(src.g[s] * scale[1] + offset[1], dg + d);
+            Store1(src.r[s] * scale[2] + offset[2], dr + d);
+        }
+    }
+}
+
+MStatus normalize(const Image& input,
+                  const PixelFormat format,
+                  const float scale[3],
+                  const float offset[3],
+                  Image& out) {
+    const PixelFormat in_format = input.GetPixelFormat();
+    const bool gray             = in_format == M_PIX_FMT_GRAY8;
+    RgbFormat in_desc, out_desc;
+    const bool supported = gray ? format == M_PIX_FMT_GRAY32 || format == M_PIX_FMT_GRAY16
+                                : GetRgbFormat(in_format, in_desc) && in_desc.type_size == 1 &&
+                                      GetRgbFormat(format, out_desc) && out_desc.type_size != 1;
+    if (nullptr == input.GetData<void>() || nullptr == scale || nullptr == offset ||
+        input.GetData<void>() == out.GetData<void>()) {
+        SIMPLE_LOG_ERROR("normalize failed, input image is empty or same as out");
+        return MStatus::M_INVALID_ARG;
+    }
+    if (!supported || input.GetMemType() != M_MEM_ON_CPU) {
+        SIMPLE_LOG_ERROR("normalize can't support %s to %s",
+                         input.GetPixelFormatStr().c_str(),
+                         format < M_PIX_FMT_MAX ? FormatStr[format].c_str() : "INVALID");
+        return MStatus::M_NOT_SUPPORT;
+    }
+    if (gray) {
+        in_desc  = {1, 1, true, true};
+        out_desc = {format == M_PIX_FMT_GRAY32 ? 4U : 2U, 1, true, true};
+    }
+
+    const uint32_t width = input.GetWidth(), height = input.GetHeight();
+    const uint32_t number = input.GetNumber();
+    if (nullptr == out.GetData<void>() || out.GetWidth() != width || out.GetHeight() != height ||
+        out.GetNumber() != number || out.GetPixelFormat() != format) {
+        out = Image(width, height, number, format, input.GetTimestamp(), M_MEM_ON_CPU);
+        if (nullptr == out.GetData<void>()) {
+            SIMPLE_LOG_ERROR("normalize failed, malloc [%u x %u] of %s failed",
+                             width,
+                             height,
+                             FormatStr[format].c_str());
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+    }
+    input.GetDataManager()->SyncCache(false);
+
+    // channel c of scale and offset is channel c of out, rows take them in order b, g, r
+    const uint32_t b = out_desc.bgr ? 0 : 2, r = out_desc.bgr ? 2 : 0;
+    float row_scale[3]  = {scale[0], scale[0], scale[0]};
+    float row_offset[3] = {offset[0], offset[0], offset[0]};
+    if (!gray) {
+        row_scale[0]  = scale[b];
+        row_scale[1]  = scale[1];
+        row_scale[2]  = scale[r];
+        row_offset[0] = offset[b];
+        row_offset[1] = offset[1];
+        row_offset[2] = offset[r];
+    }
+    const uint32_t grain      = std::max(1U, 65536U / width);
+    ParallelFor(number * height, grain, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t t = begin; t < end; ++t) {
+            const uint32_t n = t / height, i = t % height;
+            // gray rows are planar rows of one channel
+            const RgbRow src = GetRgbRow(input, in_desc, n, i);
+            const RgbRow dst = GetRgbRow(out, out_desc, n, i);
+            if (out_desc.type_size == 4U) {
+                NormalizeRow<float>(src, dst, gray, row_scale, row_offset, width);
+            } else {
+                NormalizeRow<uint16_t>(src, dst, gray, row_scale, row_offset, width);
+            }
+        }
+    });
+    out.GetDataManager()->SyncCache(true);
+    return MStatus::M_OK;
+}
+
+MStatus convert_color_row(const Image& input,
+                          const uint32_t n,
+                          const uint32_t i,
+                          const PixelFormat format,
+                          uint8_t* dst,
+                          const ColorSpace space) {
+    RgbFormat in_desc;
+    const bool yuv = IsYuv(input.GetPixelFormat());
+    if (nullptr == input.GetData<void>() || nullptr == dst || n >= input.GetNumber() ||
+        i >= input.GetHeight() || (format != M_PIX_FMT_BGR888 && format != M_PIX_FMT_RGB888) ||
+        (yuv ? space >= M_COLOR_MAX
+             : !GetRgbFormat(input.GetPixelFormat(), in_desc) || in_desc.type_size != 1)) {
+        SIMPLE_LOG_ERROR("convert_color_row can't support %s row %u of %u to %s",
+                         input.GetPixelFormatStr().c_str(),
+                         i,
+                         n,
+                         format < M_PIX_FMT_MAX ? FormatStr[format].c_str() : "INVALID");
+        return MStatus::M_NOT_SUPPORT;
+    }
+    const bool bgr   = format == M_PIX_FMT_BGR888;
+    const RgbRow row = {bgr ? dst : dst + 2, dst + 1, bgr ? dst + 2 : dst, nullptr, 3};
+    if (yuv) {
+        YuvRowToRgb(GetYuvRow(input, n, i), row, input.GetWidth(), kYuvCoeff[space]);
+    } else {
+        RgbRowToRgb<uint8_t>(GetRgbRow(input, in_desc, n, i), row, input.GetWidth());
+    }
+    return MStatus::M_OK;
+}
+
+} // namespace base
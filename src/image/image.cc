@@ -5,7 +5,10 @@
 #include "image/image.h"
 #include "log.h"
 #include "manager/data_manager.h"
+#include "manager/memory_copy.h"
+#include "tensor/tensor.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iomanip>
 
@@ -19,10 +22,16 @@ Image::Image()
       stride_{0},
       nscalar_{0},
       type_size_{0},
+      aligned_height_{0},
+      pitch_{},
+      offset_{},
+      plane_size_{},
+      dense_{true},
       time_stamp_{},
       pixel_format_{},
       pixel_format_str_{},
       data_manager_{nullptr},
+      plane_data_{},
       init_done_{false} {}
 
 Image::Image(const uint32_t width,
@@ -55,6 +64,119 @@ Image::Image(const uint32_t width,
     this->data_manager_->Setptr(const_cast<void*>(data), this->nscalar_ * this->number_);
     init_done_ = true;
 }
+
+Image::Image(const uint32_t width,
+             const uint32_t height,
+             const uint32_t number,
+             const PixelFormat format,
+             const TimeStamp& time_stamp,
+             const void* data,
+             const std::vector<uint32_t>& pitch,
+             const uint32_t aligned_height,
+             const MemoryType mem_type) {
+    width_        = width;
+    height_       = height;
+    number_       = number;
+    pixel_format_ = format;
+    time_stamp_   = time_stamp;
+
+    if (nullptr == data) {
+        SIMPLE_LOG_ERROR("construct image failed, input ptr nullptr");
+        return;
+    }
+
+    if (this->CreatDataManager(mem_type) != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("construct image failed, init image manager failed");
+        return;
+    }
+
+    if (this->InitImageParamters() != MStatus::M_OK ||
+        this->InitPlanes(pitch, aligned_height) != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("construct image failed, init image paramters failed");
+        return;
+    }
+    this->data_manager_->Setptr(const_cast<void*>(data), this->nscalar_ * this->number_);
+    init_done_ = true;
+}
+
+Image::Image(const uint32_t width,
+             const uint32_t height,
+             const uint32_t number,
+             const PixelFormat format,
+             const TimeStamp& time_stamp,
+             const std::vector<const void*>& planes,
+             const std::vector<uint32_t>& pitch,
+             const uint32_t aligned_height,
+             const MemoryType mem_type) {
+    width_        = width;
+    height_       = height;
+    number_       = number;
+    pixel_format_ = format;
+    time_stamp_   = time_stamp;
+
+    if (planes.empty() || std::find(planes.begin(), planes.end(), nullptr) != planes.end()) {
+        SIMPLE_LOG_ERROR("construct image failed, input ptr nullptr");
+        return;
+    }
+
+    if (this->CreatDataManager(mem_type) != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("construct image failed, init image manager failed");
+        return;
+    }
+
+    if (this->InitImageParamters() != MStatus::M_OK ||
+        this->InitPlanes(pitch, aligned_height, true) != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("construct image failed, init image paramters failed");
+        return;
+    }
+
+    const uint32_t count = 1U + (plane_size_[1] > 0) + (plane_size_[2] > 0);
+    if (count < 2U || count != planes.size()) {
+        SIMPLE_LOG_ERROR("construct image failed, %s has %u planes, but %zu planes input",
+                         pixel_format_str_.c_str(),
+                         count,
+                         planes.size());
+        return;
+    }
+    this->data_manager_->Setptr(const_cast<void*>(planes[0]), this->nscalar_ * this->number_);
+    if (this->InitPlaneData(mem_type, planes) != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("construct image failed, init plane data failed");
+        return;
+    }
+    init_done_ = true;
+}
+
+Image::Image(const uint32_t width,
+             const uint32_t height,
+             const uint32_t number,
+             const PixelFormat format,
+             const TimeStamp& time_stamp,
+             const std::vector<uint32_t>& pitch,
+             const uint32_t aligned_height,
+             const MemoryType mem_type) {
+    width_        = width;
+    height_       = height;
+    number_       = number;
+    pixel_format_ = format;
+    time_stamp_   = time_stamp;
+
+    if (this->CreatDataManager(mem_type) != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("construct image failed, init image manager failed");
+        return;
+    }
+
+    if (this->InitImageParamters() != MStatus::M_OK ||
+        this->InitPlanes(pitch, aligned_height) != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("construct image failed, init image paramters failed");
+        return;
+    }
+
+    if (this->MallocData() != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("construct image failed, malloc image failed");
+        return;
+    }
+    init_done_ = true;
+}
 Image::Image(const uint32_t width,
              const uint32_t height,
              const uint32_t number,
@@ -73,8 +195,9 @@ Image::Image(const uint32_t width,
         return;
     }
 
-    if (!mem_alloced) {
-        this->data_manager_->Malloc(this->nscalar_ * this->number_);
+    if (!mem_alloced && this->MallocData() != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("construct image failed, malloc image failed");
+        return;
     }
     init_done_ = true;
 }
@@ -101,14 +224,90 @@ Image::Image(const uint32_t width,
         return;
     }
 
-    this->data_manager_->Malloc(this->nscalar_ * this->number_);
+    if (this->MallocData() != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("construct image failed, malloc image failed");
+        return;
+    }
     init_done_ = true;
 }
 
 MStatus Image::ImageSplit(const uint32_t idx, Image& image_out) const {
-    SIMPLE_LOG_WARN("now can't support ImageSplit for %i", idx);
-    UNUSED_WARN(idx);
-    UNUSED_WARN(image_out);
+    if (idx >= this->number_) {
+        SIMPLE_LOG_ERROR("ImageSplit failed, index %u out of number %u", idx, this->number_);
+        return MStatus::M_INVALID_ARG;
+    }
+    return MakeView(idx, 1, 0, 0, this->width_, this->height_, image_out);
+}
+
+MStatus Image::Crop(const uint32_t x,
+                    const uint32_t y,
+                    const uint32_t width,
+                    const uint32_t height,
+                    Image& image_out) const {
+    return MakeView(0, this->number_, x, y, width, height, image_out);
+}
+
+MStatus Image::MakeView(const uint32_t first,
+                        const uint32_t number,
+                        const uint32_t x,
+                        const uint32_t y,
+                        const uint32_t width,
+                        const uint32_t height,
+                        Image& image_out) const {
+    ImagePlane planes[IMAGE_MAX_PLANES];
+    const uint32_t count = this->GetPlanes(0, planes);
+    if (!init_done_ || 0 == count || this->GetMemType() != MemoryType::M_MEM_ON_CPU) {
+        SIMPLE_LOG_ERROR("make view failed, image is empty or not on cpu");
+        return MStatus::M_INVALID_ARG;
+    }
+    if (0 == width || 0 == height || x + width > this->width_ || y + height > this->height_) {
+        SIMPLE_LOG_ERROR("region [%u, %u, %u, %u] out of image [%u x %u]",
+                         x,
+                         y,
+                         width,
+                         height,
+                         this->width_,
+                         this->height_);
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // bytes from image to the first pixel of region in every plane, chroma is subsampled by 2
+    uint32_t offsets[IMAGE_MAX_PLANES] = {0, 0, 0};
+    for (uint32_t p = 0; p < count; ++p) {
+        const uint32_t sub_x = planes[p].width < this->width_ ? 2U : 1U;
+        const uint32_t sub_y = planes[p].height < this->height_ ? 2U : 1U;
+        if (x % sub_x != 0 || y % sub_y != 0) {
+            SIMPLE_LOG_ERROR("region [%u, %u] of %s must be even",
+                             x,
+                             y,
+                             this->pixel_format_str_.c_str());
+            return MStatus::M_INVALID_ARG;
+        }
+        offsets[p] = y / sub_y * this->pitch_[p] +
+                     x / sub_x * planes[p].channel * planes[p].type_size;
+    }
+
+    // planes of one buffer follow plane 0, so offsets to plane 0 of view stay positive
+    Image view           = *this;
+    const uint32_t start = first * this->nscalar_ + this->offset_[0] + offsets[0];
+    view.data_manager_   = std::make_shared<SubDataManager>(
+        this->data_manager_, start, this->data_manager_->GetSize() - start);
+    for (uint32_t p = 1; p < count; ++p) {
+        if (nullptr == this->plane_data_[p]) {
+            view.offset_[p] = this->offset_[p] + offsets[p] - offsets[0];
+            continue;
+        }
+        const uint32_t plane_start = first * this->plane_size_[p] + offsets[p];
+        view.plane_data_[p]        = std::make_shared<SubDataManager>(
+            this->plane_data_[p], plane_start, this->plane_data_[p]->GetSize() - plane_start);
+    }
+    view.offset_[0] = 0;
+    view.number_    = number;
+    view.width_     = width;
+    view.height_    = height;
+    view.dense_     = this->dense_ && width == this->width_ && height == this->height_;
+
+    image_out = std::move(view);
     return MStatus::M_OK;
 }
 
@@ -136,20 +335,25 @@ Image::ImageSplitChannel(const uint32_t batch, const uint32_t channel, Image& im
     }
 
     auto mem_type = this->data_manager_->GetMemType();
-    auto offset   = (mem_type == MemoryType::M_MEM_ON_OCL)
-                        ? 0
-                        : batch * this->nscalar_ + channel * (this->width_ * this->height_);
+    ImagePlane planes[IMAGE_MAX_PLANES];
+    const uint32_t count = (mem_type == MemoryType::M_MEM_ON_OCL) ? 0 : GetPlanes(batch, planes);
+    uint8_t* data        = static_cast<uint8_t*>(this->data_manager_->GetDataPtr());
+    data                 = count > channel ? planes[channel].data : data;
+    const PixelFormat format = this->type_size_ == 4U   ? PixelFormat::M_PIX_FMT_GRAY32
+                               : this->type_size_ == 2U ? PixelFormat::M_PIX_FMT_GRAY16
+                                                        : PixelFormat::M_PIX_FMT_GRAY8;
 
     Image split_image(this->width_,
                       this->height_,
                       1,
-                      PixelFormat::M_PIX_FMT_GRAY8,
+                      format,
                       this->time_stamp_,
-                      static_cast<uint8_t*>(this->data_manager_->GetDataPtr()) + offset,
+                      data,
+                      std::vector<uint32_t>{this->pitch_[channel]},
+                      this->aligned_height_,
                       mem_type);
 
-    // todo use move operator to optimizer
-    image_out = split_image;
+    image_out = std::move(split_image);
     return MStatus::M_OK;
 }
 
@@ -169,7 +373,7 @@ bool Image::operator!=(const Image& other) {
 }
 
 MStatus Image::InitImageParamters() {
-    pixel_format_str_ = FormatStr[static_cast<int>(pixel_format_) - 1];
+    pixel_format_str_ = pixel_format_ < M_PIX_FMT_MAX ? FormatStr[pixel_format_] : "INVALID";
 
     auto SetParams = [&](uint32_t c, uint32_t t, bool chanel_on_stide) -> bool {
         channel_   = c;
@@ -261,66 +465,343 @@ MStatus Image::InitImageParamters() {
             m_status = MStatus::M_INVALID_FILE_FORMAT;
         }
     }
+    if (m_status == MStatus::M_OK) {
+        m_status = InitPlanes(std::vector<uint32_t>(), 0);
+    }
 
-    SIMPLE_LOG_DEBUG("%s", LogImage("InitImageParamters", *this));
+    SIMPLE_LOG_DEBUG("%s", LogImage("InitImageParamters", *this).c_str());
     return m_status;
 }
 
+MStatus Image::InitPlanes(const std::vector<uint32_t>& pitch,
+                          const uint32_t aligned_height,
+                          const bool detached) {
+    const uint32_t rows = aligned_height ? aligned_height : height_;
+    if (rows < height_) {
+        SIMPLE_LOG_ERROR("aligned height %u is less than height %u", rows, height_);
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // row bytes, dense pitch and rows in buffer of every plane
+    uint32_t count = 1, row_bytes[IMAGE_MAX_PLANES] = {stride_, 0, 0};
+    uint32_t dense[IMAGE_MAX_PLANES] = {stride_, 0, 0}, plane_rows[IMAGE_MAX_PLANES] = {rows, 0, 0};
+    bool half_pitch = false;
+    switch (pixel_format_) {
+        case PixelFormat::M_PIX_FMT_RGB888_PLANAR:
+        case PixelFormat::M_PIX_FMT_BGR888_PLANAR:
+        case PixelFormat::M_PIX_FMT_RGB161616_PLANAR:
+        case PixelFormat::M_PIX_FMT_BGR161616_PLANAR:
+        case PixelFormat::M_PIX_FMT_RGB323232_PLANAR:
+        case PixelFormat::M_PIX_FMT_BGR323232_PLANAR: {
+            count = 3;
+            for (uint32_t p = 1; p < count; ++p) {
+                row_bytes[p]  = stride_;
+                dense[p]      = stride_;
+                plane_rows[p] = rows;
+            }
+            break;
+        }
+        case PixelFormat::M_PIX_FMT_NV12:
+        case PixelFormat::M_PIX_FMT_NV21:
+        case PixelFormat::M_PIX_FMT_NV12_DETACH:
+        case PixelFormat::M_PIX_FMT_NV21_DETACH: {
+            count         = 2;
+            row_bytes[1]  = width_ / 2 * 2;
+            dense[1]      = stride_;
+            plane_rows[1] = rows / 2;
+            break;
+        }
+        case PixelFormat::M_PIX_FMT_YUV420P:
+        case PixelFormat::M_PIX_FMT_YU12:
+        case PixelFormat::M_PIX_FMT_YV12: {
+            count      = 3;
+            half_pitch = true;
+            for (uint32_t p = 1; p < count; ++p) {
+                row_bytes[p]  = width_ / 2;
+                dense[p]      = stride_ / 2;
+                plane_rows[p] = rows / 2;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+
+    uint32_t pitches[IMAGE_MAX_PLANES] = {0, 0, 0}, offsets[IMAGE_MAX_PLANES] = {0, 0, 0};
+    uint32_t sizes[IMAGE_MAX_PLANES] = {0, 0, 0}, size = 0;
+    bool is_dense = rows == height_ && !detached;
+    for (uint32_t p = 0; p < count; ++p) {
+        const uint32_t fallback = half_pitch && p > 0 ? pitches[0] / 2 : dense[p];
+        pitches[p]              = p < pitch.size() && pitch[p] ? pitch[p] : fallback;
+        if (pitches[p] < row_bytes[p]) {
+            SIMPLE_LOG_ERROR("pitch %u of plane %u is less than %u bytes of row",
+                             pitches[p],
+                             p,
+                             row_bytes[p]);
+            return MStatus::M_INVALID_ARG;
+        }
+        sizes[p] = pitches[p] * plane_rows[p];
+        if (p == 0 || !detached) {
+            offsets[p] = size;
+            size += sizes[p];
+        }
+        is_dense = is_dense && pitches[p] == dense[p];
+    }
+
+    memcpy(pitch_, pitches, sizeof(pitch_));
+    memcpy(offset_, offsets, sizeof(offset_));
+    memcpy(plane_size_, sizes, sizeof(plane_size_));
+    aligned_height_ = rows;
+    dense_          = is_dense;
+    stride_         = pitch_[0];
+    // dense images keep the size of odd yuv sizes
+    nscalar_ = is_dense ? std::max(nscalar_, size) : size;
+    return MStatus::M_OK;
+}
+
+static std::shared_ptr<DataManager> NewDataManager(const MemoryType mem_type) {
+#ifdef CONFIG_SIMPLE_BASE_ENABLE_LOW_MEMORY
+    return std::make_shared<DataMgrCache>(DataManager::MemTypeToMemTypeStr(mem_type));
+#else
+    UNUSED_WARN(mem_type);
+    return std::make_shared<DataManager>();
+#endif // CONFIG_SIMPLE_BASE_ENABLE_LOW_MEMORY
+}
+
+MStatus Image::MallocData() {
+    if (this->pixel_format_ == PixelFormat::M_PIX_FMT_NV12_DETACH ||
+        this->pixel_format_ == PixelFormat::M_PIX_FMT_NV21_DETACH) {
+        MStatus status = InitPlanes(
+            std::vector<uint32_t>(this->pitch_, this->pitch_ + IMAGE_MAX_PLANES),
+            this->aligned_height_,
+            true);
+        if (status != MStatus::M_OK) {
+            return status;
+        }
+        status = InitPlaneData(this->data_manager_->GetMemType(), std::vector<const void*>());
+        if (status != MStatus::M_OK) {
+            return status;
+        }
+    }
+    if (nullptr == this->data_manager_->Malloc(this->nscalar_ * this->number_)) {
+        SIMPLE_LOG_ERROR("malloc %u bytes of image failed", this->nscalar_ * this->number_);
+        return MStatus::M_OUT_OF_MEMORY;
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Image::InitPlaneData(const MemoryType mem_type, const std::vector<const void*>& planes) {
+    for (uint32_t p = 1; p < IMAGE_MAX_PLANES; ++p) {
+        this->plane_data_[p] = nullptr;
+        if (0 == this->plane_size_[p]) {
+            continue;
+        }
+        this->plane_data_[p] = NewDataManager(mem_type);
+        const uint32_t size  = this->plane_size_[p] * this->number_;
+        void* data = p < planes.size()
+                         ? this->plane_data_[p]->Setptr(const_cast<void*>(planes[p]), size)
+                         : this->plane_data_[p]->Malloc(size);
+        if (nullptr == data) {
+            SIMPLE_LOG_ERROR("init %u bytes of plane %u failed", size, p);
+            this->plane_data_[p] = nullptr;
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+    }
+    return MStatus::M_OK;
+}
+
+void Image::CopyData(Image& target) const {
+    for (uint32_t p = 0; p < IMAGE_MAX_PLANES; ++p) {
+        if (0 == p || this->plane_data_[p]) {
+            this->GetPlaneDataManager(p)->SyncCache(false);
+        }
+    }
+    // views hold less than GetSize bytes from their first pixel
+    if (!this->IsDetached() && !target.IsDetached() && this->nscalar_ == target.nscalar_ &&
+        this->data_manager_->GetSize() >= this->GetSize() &&
+        memcmp(this->pitch_, target.pitch_, sizeof(pitch_)) == 0 &&
+        memcmp(this->offset_, target.offset_, sizeof(offset_)) == 0) {
+        FastCopy(target.GetData<void>(), this->GetData<void>(), this->GetSize());
+    } else {
+        ImagePlane src[IMAGE_MAX_PLANES], dst[IMAGE_MAX_PLANES];
+        for (uint32_t n = 0; n < this->number_; ++n) {
+            const uint32_t count = this->GetPlanes(n, src);
+            target.GetPlanes(n, dst);
+            for (uint32_t p = 0; p < count; ++p) {
+                FastCopy2D(dst[p].data,
+                           dst[p].pitch,
+                           src[p].data,
+                           src[p].pitch,
+                           src[p].width * src[p].channel * src[p].type_size,
+                           src[p].height);
+            }
+        }
+    }
+    for (uint32_t p = 0; p < IMAGE_MAX_PLANES; ++p) {
+        if (0 == p || target.plane_data_[p]) {
+            target.GetPlaneDataManager(p)->SyncCache(true);
+        }
+    }
+}
+
 Image Image::Clone(MemoryType type) const {
-    this->GetDataManager()->SyncCache(false);
+    if (nullptr == this->GetData<void>()) {
+        SIMPLE_LOG_ERROR("clone image failed, input image is empty");
+        return Image();
+    }
     Image target(width_, height_, number_, pixel_format_, time_stamp_, type);
-    // const auto src_data_height = static_cast<uint32_t>(this->nscalar_) / this->stride_;
-    // const auto dst_data_height = static_cast<uint32_t>(target.nscalar_) / target.stride_;
-    // const auto batch           = this->number_;
-
-    // auto src_last_batch_height = src_data_height - (batch * this->aligned_height_);
-    // auto dst_last_batch_height = dst_data_height - (batch * target.aligned_height_);
-    // if ((src_last_batch_height > 0) != (dst_last_batch_height > 0)) {
-    //     SDK_LOG_ERROR("Image CopyDataInner error last batch: {} vs {}",
-    //                   src_last_batch_height,
-    //                   dst_last_batch_height);
-    //     return target;
-    // }
-    // const auto last_batch_height = (std::min)(src_last_batch_height, dst_last_batch_height);
-    // const auto min_stride        = (std::min)(this->stride_, target.stride_);
-    // const auto pad_num           = target.stride_ - min_stride; // zero if target stride is min
-
-    // for (size_t i = 0; i < number_; ++i) {
-    //     auto src = this->GetData<uint8_t>(i);
-    //     auto dst = target.GetData<uint8_t>(i);
-
-    //     // optimize whole image copy
-    //     if (src_data_height == dst_data_height && this->stride_ == target.stride_) {
-    //         memcpy(dst, src, this->nscalar_);
-    //         continue;
-    //     }
-
-    //     for (uint32_t b = 0; b < batch; b++) {
-    //         auto src_row = src;
-    //         auto dst_row = dst;
-    //         for (uint32_t h = 0; h < this->height_; h++) {
-    //             memcpy(dst_row, src_row, min_stride);
-    //             // set to zero to avoid resize result rand, zero is safe for pad_num
-    //             memset(dst_row + min_stride, 0, pad_num);
-    //             src_row += this->stride_;
-    //             dst_row += target.stride_;
-    //         }
-    //         src += this->aligned_height_ * this->stride_;
-    //         dst += target.aligned_height_ * target.stride_;
-    //     }
-
-    //     if (last_batch_height > 0) {
-    //         for (uint32_t h = 0; h < last_batch_height; h++) {
-    //             memcpy(dst, src, min_stride);
-    //             src += this->stride_;
-    //             dst += target.stride_;
-    //         }
-    //     }
-    // }
-    // target.GetDataManager()->SyncCache(true);
+    if (nullptr == target.GetData<void>()) {
+        SIMPLE_LOG_ERROR("clone image failed, malloc %u bytes failed", this->GetSize());
+        return Image();
+    }
+    this->CopyData(target);
     return target;
 }
 
+MStatus Image::CloneInto(Image& target) const {
+    if (&target == this) {
+        return MStatus::M_OK;
+    }
+    if (nullptr == this->GetData<void>()) {
+        SIMPLE_LOG_ERROR("clone image failed, input image is empty");
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // a new buffer is dense, layout of this image only fits a reused buffer of its size.
+    // views keep nscalar of their parent, GetSize of a crop covers pixels of the parent
+    // around it, so only dense images on buffers of their own are reused
+    const bool reuse = target.GetData<void>() != nullptr && !this->IsDetached() &&
+                       !target.IsDetached() && target.IsDense() &&
+                       nullptr == std::dynamic_pointer_cast<SubDataManager>(target.data_manager_) &&
+                       target.GetSize() == this->GetSize() &&
+                       target.data_manager_->GetSize() >= this->GetSize();
+    if (!reuse) {
+        target = Image(width_, height_, number_, pixel_format_, time_stamp_, this->GetMemType());
+        if (nullptr == target.GetData<void>()) {
+            SIMPLE_LOG_ERROR("clone image failed, malloc %u bytes failed", this->GetSize());
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+        this->CopyData(target);
+        return MStatus::M_OK;
+    }
+    target.number_           = this->number_;
+    target.width_            = this->width_;
+    target.height_           = this->height_;
+    target.channel_          = this->channel_;
+    target.stride_           = this->stride_;
+    target.nscalar_          = this->nscalar_;
+    target.type_size_        = this->type_size_;
+    target.aligned_height_   = this->aligned_height_;
+    target.dense_            = this->dense_;
+    target.time_stamp_       = this->time_stamp_;
+    target.pixel_format_     = this->pixel_format_;
+    target.pixel_format_str_ = this->pixel_format_str_;
+    target.init_done_        = this->init_done_;
+    memcpy(target.pitch_, this->pitch_, sizeof(pitch_));
+    memcpy(target.offset_, this->offset_, sizeof(offset_));
+    memcpy(target.plane_size_, this->plane_size_, sizeof(plane_size_));
+
+    this->CopyData(target);
+    return MStatus::M_OK;
+}
+
+MStatus Image::FromTensor(const Tensor& tensor, const PixelFormat format, Image& image_out) {
+    const std::vector<uint32_t>& shape = tensor.GetShape();
+    if (nullptr == tensor.GetData<void>() || tensor.GetMemType() != M_MEM_ON_CPU ||
+        shape.size() != 4U) {
+        SIMPLE_LOG_ERROR("image from tensor failed, tensor is empty or not on cpu");
+        return MStatus::M_INVALID_ARG;
+    }
+    const bool nchw       = tensor.GetShapeMode() == M_LAYOUT_NCHW;
+    const uint32_t stride = tensor.GetStride();
+    Image image(nchw ? shape[3] : shape[2],
+                nchw ? shape[2] : shape[1],
+                shape[0],
+                format,
+                TimeStamp(),
+                tensor.GetData<void>(),
+                std::vector<uint32_t>{stride, stride, stride},
+                0,
+                M_MEM_ON_CPU);
+
+    // planes of planar formats are channels of NCHW, pixels of packed formats rows of NHWC
+    ImagePlane planes[IMAGE_MAX_PLANES];
+    const uint32_t count = image.init_done_ ? image.GetPlanes(0, planes) : 0U;
+    const bool planar    = count > 1U && count == image.channel_;
+    const bool packed    = count == 1U && planes[0].channel == image.channel_;
+    const uint32_t c     = nchw ? shape[1] : shape[3];
+    if (!(planar ? nchw : packed && tensor.GetShapeMode() == M_LAYOUT_NHWC) ||
+        c != image.channel_ || tensor.GetElemType() != ImageDataType(image.type_size_) ||
+        image.GetSize() > tensor.GetDataManager()->GetSize()) {
+        SIMPLE_LOG_ERROR("image from tensor can't see %s %s of %u channels as %s",
+                         tensor.GetShapeModeStr().c_str(),
+                         DataTypeStr[tensor.GetElemType()].c_str(),
+                         c,
+                         FormatStr[format < M_PIX_FMT_MAX ? format : M_PIX_FMT_GRAY8].c_str());
+        return MStatus::M_NOT_SUPPORT;
+    }
+    image.data_manager_ = tensor.GetDataManager();
+    image_out           = std::move(image);
+    return MStatus::M_OK;
+}
+
+uint32_t Image::GetPlanes(const uint32_t n, ImagePlane* planes) const {
+    if (nullptr == this->GetData<void>() || n >= this->number_ || nullptr == planes) {
+        return 0;
+    }
+    uint8_t* base = this->GetData<uint8_t>(n);
+    auto SetPlane = [&](uint32_t idx, uint32_t w, uint32_t h, uint32_t c) {
+        planes[idx].data      = this->plane_data_[idx]
+                                    ? static_cast<uint8_t*>(this->plane_data_[idx]->GetDataPtr()) +
+                                          n * this->plane_size_[idx]
+                                    : base + this->offset_[idx];
+        planes[idx].width     = w;
+        planes[idx].height    = h;
+        planes[idx].pitch     = this->pitch_[idx];
+        planes[idx].channel   = c;
+        planes[idx].type_size = this->type_size_;
+    };
+
+    switch (this->pixel_format_) {
+        case PixelFormat::M_PIX_FMT_RGB888_PLANAR:
+        case PixelFormat::M_PIX_FMT_BGR888_PLANAR:
+        case PixelFormat::M_PIX_FMT_RGB161616_PLANAR:
+        case PixelFormat::M_PIX_FMT_BGR161616_PLANAR:
+        case PixelFormat::M_PIX_FMT_RGB323232_PLANAR:
+        case PixelFormat::M_PIX_FMT_BGR323232_PLANAR: {
+            for (uint32_t i = 0; i < 3; ++i) {
+                SetPlane(i, this->width_, this->height_, 1);
+            }
+            return 3;
+        }
+        case PixelFormat::M_PIX_FMT_NV12:
+        case PixelFormat::M_PIX_FMT_NV21:
+        case PixelFormat::M_PIX_FMT_NV12_DETACH:
+        case PixelFormat::M_PIX_FMT_NV21_DETACH: {
+            SetPlane(0, this->width_, this->height_, 1);
+            SetPlane(1, this->width_ / 2, this->height_ / 2, 2);
+            return 2;
+        }
+        case PixelFormat::M_PIX_FMT_YUV420P:
+        case PixelFormat::M_PIX_FMT_YU12:
+        case PixelFormat::M_PIX_FMT_YV12: {
+            SetPlane(0, this->width_, this->height_, 1);
+            SetPlane(1, this->width_ / 2, this->height_ / 2, 1);
+            SetPlane(2, this->width_ / 2, this->height_ / 2, 1);
+            return 3;
+        }
+        case PixelFormat::M_PIX_FMT_YUYV:
+        case PixelFormat::M_PIX_FMT_UYVY: {
+            SetPlane(0, this->width_ / 2, this->height_, 4);
+            return 1;
+        }
+        default: {
+            SetPlane(0, this->width_, this->height_, this->channel_);
+            return 1;
+        }
+    }
+}
+
 MStatus Image::ImageReshape(const uint32_t width,
                             const uint32_t height,
                             const uint32_t number,
@@ -329,6 +810,10 @@ MStatus Image::ImageReshape(const uint32_t width,
         SIMPLE_LOG_ERROR("splict channel failed, construct image no init success");
         return MStatus::M_INTERNAL_FAILED;
     }
+    if (!dense_) {
+        SIMPLE_LOG_ERROR("ImageReshape can't support image with row padding");
+        return MStatus::M_NOT_SUPPORT;
+    }
     this->pixel_format_ = pixel_format;
     this->width_        = width;
     this->height_       = height;
@@ -348,11 +833,7 @@ MStatus Image::CreatDataManager(const MemoryType mem_type) {
     SIMPLE_LOG_DEBUG("Image::CreatDataManager %s", mem_type_str.c_str());
 
     if (nullptr == this->data_manager_) {
-#ifdef CONFIG_SIMPLE_BASE_ENABLE_LOW_MEMORY
-        this->data_manager_ = std::make_shared<DataMgrCache>(mem_type_str);
-#else
-        this->data_manager_ = std::make_shared<DataManager>();
-#endif // CONFIG_SIMPLE_BASE_ENABLE_LOW_MEMORY
+        this->data_manager_ = NewDataManager(mem_type);
     }
 
     if (nullptr == this->data_manager_) {
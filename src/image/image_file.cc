@@ -0,0 +1,335 @@
+#include "image/image_file.h"
+
+#include "manager/data_manager.h"
+#include "manager/pipe_manager.h"
+
+#include <algorithm>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace base {
+
+// bytes of rows gathered before one write(2)
+#define IMAGE_FILE_CHUNK (1U << 20)
+
+/// @brief skip spaces and comments of PNM header and read a number
+static bool PnmNumber(const uint8_t* data, const size_t size, size_t& pos, uint32_t& value) {
+    while (pos < size && (isspace(data[pos]) || data[pos] == '#')) {
+        if (data[pos] == '#') {
+            while (pos < size && data[pos] != '\n') {
+                ++pos;
+            }
+        } else {
+            ++pos;
+        }
+    }
+    if (pos >= size || !isdigit(data[pos])) {
+        return false;
+    }
+    uint64_t number = 0;
+    for (; pos < size && isdigit(data[pos]); ++pos) {
+        number = number * 10U + (data[pos] - '0');
+        if (number > UINT32_MAX) {
+            return false;
+        }
+    }
+    value = static_cast<uint32_t>(number);
+    return true;
+}
+
+/// @brief give the mapping to image built on pixels in it
+static MStatus HoldMapping(const std::shared_ptr<MappedFile>& file,
+                           const size_t offset,
+                           Image& image,
+                           Image& out) {
+    if (nullptr == image.GetData<void>() || offset + image.GetSize() > file->GetSize()) {
+        SIMPLE_LOG_ERROR("file of %zu bytes is smaller than %s",
+                         file->GetSize(),
+                         LogImage("image", image).c_str());
+        return MStatus::M_INVALID_FILE_FORMAT;
+    }
+    auto data_mgr =
+        std::make_shared<MappedDataManager>(file, file->GetData() + offset, image.GetSize());
+    MStatus status = image.ImageDataManagerReplace(data_mgr);
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+    out = std::move(image);
+    return MStatus::M_OK;
+}
+
+MStatus read_pnm(const std::string& path, Image& out) {
+    std::shared_ptr<MappedFile> file;
+    MStatus status = MappedFile::Map(path, file);
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+    const uint8_t* data = file->GetData();
+    const size_t size   = file->GetSize();
+    if (size < 2U || data[0] != 'P' || data[1] < '1' || data[1] > '6') {
+        SIMPLE_LOG_ERROR("read_pnm %s is not a pnm file", path.c_str());
+        return MStatus::M_INVALID_FILE_FORMAT;
+    }
+    if (data[1] != '5' && data[1] != '6') {
+        SIMPLE_LOG_ERROR("read_pnm can't support P%c of %s", data[1], path.c_str());
+        return MStatus::M_NOT_SUPPORT;
+    }
+
+    // one space follows max value, then pixels
+    size_t pos       = 2U;
+    uint32_t width   = 0U;
+    uint32_t height  = 0U;
+    uint32_t max_val = 0U;
+    if (!PnmNumber(data, size, pos, width) || !PnmNumber(data, size, pos, height) ||
+        !PnmNumber(data, size, pos, max_val) || pos >= size || !isspace(data[pos]) ||
+        0U == width || 0U == height || 0U == max_val || max_val > 65535U) {
+        SIMPLE_LOG_ERROR("read_pnm header of %s is broken", path.c_str());
+        return MStatus::M_INVALID_FILE_FORMAT;
+    }
+    if (max_val > 255U) {
+        SIMPLE_LOG_ERROR("read_pnm can't support 16 bits %s", path.c_str());
+        return MStatus::M_NOT_SUPPORT;
+    }
+    ++pos;
+    const uint32_t channel = data[1] == '5' ? 1U : 3U;
+    if (static_cast<uint64_t>(width) * height * channel > size - pos) {
+        SIMPLE_LOG_ERROR("read_pnm pixels of %s are truncated", path.c_str());
+        return MStatus::M_INVALID_FILE_FORMAT;
+    }
+    Image image(width,
+                height,
+                1,
+                channel == 1U ? M_PIX_FMT_GRAY8 : M_PIX_FMT_RGB888,
+                TimeStamp(),
+                data + pos,
+                M_MEM_ON_CPU);
+    return HoldMapping(file, pos, image, out);
+}
+
+MStatus read_raw(const std::string& path,
+                 const uint32_t width,
+                 const uint32_t height,
+                 const uint32_t number,
+                 const PixelFormat format,
+                 Image& out,
+                 const std::vector<uint32_t>& pitch,
+                 const uint32_t aligned_height) {
+    std::shared_ptr<MappedFile> file;
+    MStatus status = MappedFile::Map(path, file);
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+    Image image(
+        width, height, number, format, TimeStamp(), file->GetData(), pitch, aligned_height);
+    // the constructor leaves image empty for bad size, pitch or aligned height
+    if (nullptr == image.GetData<void>()) {
+        SIMPLE_LOG_ERROR("read_raw of %s can't make %u images of [%u x %u], aligned height %u",
+                         path.c_str(),
+                         number,
+                         width,
+                         height,
+                         aligned_height);
+        return MStatus::M_INVALID_ARG;
+    }
+    return HoldMapping(file, 0U, image, out);
+}
+
+/// @brief gathers small writes into chunks of IMAGE_FILE_CHUNK bytes before write(2)
+class ChunkWriter final {
+public:
+    explicit ChunkWriter(const std::string& path)
+        : fd_(open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)) {}
+    ~ChunkWriter() { Close(); }
+
+    inline bool IsOpen() const { return fd_ >= 0; }
+
+    /// @brief buffer of size bytes at the end of chunk, size is IMAGE_FILE_CHUNK at most
+    uint8_t* Reserve(const size_t size) {
+        if (used_ + size > IMAGE_FILE_CHUNK && !Flush()) {
+            return nullptr;
+        }
+        chunk_.resize(IMAGE_FILE_CHUNK);
+        uint8_t* ptr = chunk_.data() + used_;
+        used_ += size;
+        return ptr;
+    }
+
+    /// @brief large buffers skip the chunk
+    bool Write(const void* data, const size_t size) {
+        if (size >= IMAGE_FILE_CHUNK) {
+            return Flush() && WriteAll(static_cast<const uint8_t*>(data), size);
+        }
+        uint8_t* ptr = Reserve(size);
+        if (nullptr == ptr) {
+            return false;
+        }
+        memcpy(ptr, data, size);
+        return true;
+    }
+
+    bool Flush() {
+        const bool ok = WriteAll(chunk_.data(), used_);
+        used_         = 0;
+        return ok;
+    }
+
+    bool Close() {
+        if (fd_ < 0) {
+            return false;
+        }
+        bool ok = Flush();
+        ok      = close(fd_) == 0 && ok;
+        fd_     = -1;
+        return ok;
+    }
+
+private:
+    /// @brief write(2) until all bytes are written
+    bool WriteAll(const uint8_t* data, size_t size) {
+        while (size > 0) {
+            const ssize_t done = write(fd_, data, size);
+            if (done < 0 && errno == EINTR) {
+                continue;
+            }
+            if (done <= 0) {
+                return false;
+            }
+            data += done;
+            size -= static_cast<size_t>(done);
+        }
+        return true;
+    }
+
+    int fd_{-1};
+    size_t used_{0};
+    std::vector<uint8_t> chunk_;
+};
+
+MStatus write_pnm(const std::string& path, const Image& image, const uint32_t n) {
+    const PixelFormat format = image.GetPixelFormat();
+    if (nullptr == image.GetData<void>() || image.GetMemType() != M_MEM_ON_CPU ||
+        n >= image.GetNumber()) {
+        SIMPLE_LOG_ERROR("write_pnm failed, image is empty, not on cpu or has no image %u", n);
+        return MStatus::M_INVALID_ARG;
+    }
+    if (format != M_PIX_FMT_GRAY8 && format != M_PIX_FMT_RGB888 && format != M_PIX_FMT_BGR888) {
+        SIMPLE_LOG_ERROR("write_pnm can't support %s", image.GetPixelFormatStr().c_str());
+        return MStatus::M_NOT_SUPPORT;
+    }
+    ChunkWriter writer(path);
+    if (!writer.IsOpen()) {
+        SIMPLE_LOG_ERROR("write_pnm can't open %s", path.c_str());
+        return MStatus::M_FILE_NOT_FOUND;
+    }
+    image.GetDataManager()->SyncCache(false);
+
+    ImagePlane plane;
+    image.GetPlanes(n, &plane);
+    char header[64];
+    const int header_size = snprintf(header,
+                                     sizeof(header),
+                                     "P%c\n%u %u\n255\n",
+                                     format == M_PIX_FMT_GRAY8 ? '5' : '6',
+                                     plane.width,
+                                     plane.height);
+    bool ok = writer.Write(header, static_cast<size_t>(header_size));
+
+    const size_t row = static_cast<size_t>(plane.width) * plane.channel;
+    if (format != M_PIX_FMT_BGR888 && plane.pitch == row) {
+        ok = ok && writer.Write(plane.data, row * plane.height);
+    } else {
+        for (uint32_t y = 0; ok && y < plane.height; ++y) {
+            const uint8_t* src = plane.data + static_cast<size_t>(y) * plane.pitch;
+            if (format != M_PIX_FMT_BGR888) {
+                ok = writer.Write(src, row);
+                continue;
+            }
+            // pixels are swapped into the chunk in pieces which fit it
+            for (uint32_t x = 0; ok && x < plane.width;) {
+                const uint32_t count = std::min(plane.width - x, IMAGE_FILE_CHUNK / 3U);
+                uint8_t* dst         = writer.Reserve(count * 3U);
+                ok                   = nullptr != dst;
+                for (uint32_t i = 0; ok && i < count; ++i, ++x) {
+                    dst[3 * i]     = src[3 * x + 2];
+                    dst[3 * i + 1] = src[3 * x + 1];
+                    dst[3 * i + 2] = src[3 * x];
+                }
+            }
+        }
+    }
+    ok = writer.Close() && ok;
+    if (!ok) {
+        SIMPLE_LOG_ERROR("write_pnm write %s failed", path.c_str());
+        return MStatus::M_FAILED;
+    }
+    return MStatus::M_OK;
+}
+
+MStatus write_raw(const std::string& path, const Image& image) {
+    if (nullptr == image.GetData<void>() || image.GetMemType() != M_MEM_ON_CPU) {
+        SIMPLE_LOG_ERROR("write_raw failed, image is empty or not on cpu");
+        return MStatus::M_INVALID_ARG;
+    }
+    ChunkWriter writer(path);
+    if (!writer.IsOpen()) {
+        SIMPLE_LOG_ERROR("write_raw can't open %s", path.c_str());
+        return MStatus::M_FILE_NOT_FOUND;
+    }
+
+    ImagePlane planes[IMAGE_MAX_PLANES];
+    const uint32_t count = image.GetPlanes(0, planes);
+    for (uint32_t p = 0; p < count; ++p) {
+        image.GetPlaneDataManager(p)->SyncCache(false);
+    }
+    bool ok = true;
+    if (image.IsDense() && !image.IsDetached()) {
+        ok = writer.Write(image.GetData<void>(), image.GetSize());
+    } else {
+        for (uint32_t n = 0; ok && n < image.GetNumber(); ++n) {
+            image.GetPlanes(n, planes);
+            for (uint32_t p = 0; ok && p < count; ++p) {
+                const size_t row = static_cast<size_t>(planes[p].width) * planes[p].channel *
+                                   planes[p].type_size;
+                for (uint32_t y = 0; ok && y < planes[p].height; ++y) {
+                    ok = writer.Write(planes[p].data + static_cast<size_t>(y) * planes[p].pitch,
+                                      row);
+                }
+            }
+        }
+    }
+    ok = writer.Close() && ok;
+    if (!ok) {
+        SIMPLE_LOG_ERROR("write_raw write %s failed", path.c_str());
+        return MStatus::M_FAILED;
+    }
+    return MStatus::M_OK;
+}
+
+MStatus write_images(const std::vector<std::string>& paths,
+                     const std::vector<Image>& images,
+                     const bool pnm) {
+    if (paths.size() != images.size()) {
+        SIMPLE_LOG_ERROR("write_images failed, %zu paths of %zu images",
+                         paths.size(),
+                         images.size());
+        return MStatus::M_INVALID_ARG;
+    }
+    std::vector<MStatus> status(images.size(), MStatus::M_OK);
+    ParallelFor(static_cast<uint32_t>(images.size()), 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            status[i] = pnm ? write_pnm(paths[i], images[i]) : write_raw(paths[i], images[i]);
+        }
+    });
+    for (const MStatus s : status) {
+        if (s != MStatus::M_OK) {
+            return s;
+        }
+    }
+    return MStatus::M_OK;
+}
+
+} // namespace base
@@ -0,0 +1,15 @@
+#include "image/image_operator.h"
+
+#include "image/resize.h"
+
+namespace base {
+
+std::shared_ptr<ImageOperator> ImageOperator::Create(const std::string& key) {
+    return RegisterBase<ImageOperator>::GetInstance().Create(key);
+}
+
+} // namespace base
+
+REGISTER_COMMON_ENGINE(base, resize, ImageOperator, ResizeLinear)
+REGISTER_COMMON_ENGINE(base, resize_nearest, ImageOperator, ResizeNearest)
+REGISTER_COMMON_ENGINE(base, resize_area, ImageOperator, ResizeArea)
@@ -0,0 +1,516 @@
+#include "image/preprocess.h"
+
+#include "intrinsic.h"
+#include "manager/data_manager.h"
+#include "manager/pipe_manager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <string.h>
+#include <vector>
+
+namespace base {
+
+// bits of fixed-point weights, a blended value is pixel << (2 * PRE_BITS)
+#define PRE_BITS 11
+#define PRE_ONE (1 << PRE_BITS)
+
+/// source index and fixed-point weight of the second tap along one axis
+typedef struct PreAxis {
+    std::vector<uint32_t> i0;
+    std::vector<uint32_t> i1;
+    std::vector<int32_t> fix1;
+} PreAxis;
+
+/// taps of elements of a filtered row, in channel order of out
+typedef struct PreRowTable {
+    std::vector<int32_t> ofs0;    ///< byte offset of first tap in source row
+    std::vector<int32_t> ofs1;    ///< byte offset of second tap in source row
+    std::vector<int32_t> weights; ///< fixed-point weights of both taps as 2 int16
+} PreRowTable;
+
+/// taps of a region resized to the content of out, shared by regions of the same size
+typedef struct PreTaps {
+    PreRowTable x; ///< taps along W of all elements, padding elements have zero weights
+    PreAxis y;     ///< taps along H of content rows
+} PreTaps;
+
+/// normalization of elements of an out row, shared by all items
+typedef struct PreNorm {
+    std::vector<float> scale; ///< norm of element over 2 ^ (2 * PRE_BITS)
+    std::vector<float> bias;  ///< -mean * norm of element
+    std::vector<float> pad;   ///< normalized padding of element
+} PreNorm;
+
+/// region of source resized into one item of out
+typedef struct PreJob {
+    Image view;    ///< region of source, rows are converted across the region only
+    uint32_t n;    ///< index of image in view
+    uint32_t taps; ///< index of taps
+    uint32_t left; ///< first content column of out
+    uint32_t top;  ///< first content row of out
+    uint32_t cols; ///< content columns of out, less than out width with letterbox
+    uint32_t rows; ///< content rows of out
+} PreJob;
+
+/// taps of out index i along one axis, sampled at start + (i + 0.5) * length / out of
+/// [0, in) and clamped into it
+static void BuildAxis(const double start,
+                      const double length,
+                      const uint32_t in,
+                      const uint32_t out,
+                      const InterpolationType type,
+                      PreAxis& axis) {
+    const double scale = length / out;
+    axis.i0.resize(out);
+    axis.i1.resize(out);
+    axis.fix1.resize(out);
+    for (uint32_t i = 0; i < out; ++i) {
+        if (type == M_INTER_NEAREST) {
+            const double s = std::max(start + (i + 0.5) * scale, 0.0);
+            axis.i0[i]     = std::min(static_cast<uint32_t>(s), in - 1);
+            axis.i1[i]     = axis.i0[i];
+            axis.fix1[i]   = 0;
+            continue;
+        }
+        const double s = std::min(std::max(start + (i + 0.5) * scale - 0.5, 0.0), in - 1.0);
+        axis.i0[i]     = static_cast<uint32_t>(s);
+        axis.i1[i]     = std::min(axis.i0[i] + 1, in - 1);
+        axis.fix1[i]   = static_cast<int32_t>(std::lround((s - axis.i0[i]) * PRE_ONE));
+    }
+}
+
+/// content of out for a region of [width x height], centered in out with letterbox
+static void Content(const double width,
+                    const double height,
+                    const PreprocessParam& param,
+                    const uint32_t out_w,
+                    const uint32_t out_h,
+                    PreJob& job) {
+    job.cols = out_w;
+    job.rows = out_h;
+    if (param.letterbox) {
+        const double scale = std::min(out_w / width, out_h / height);
+        const auto cols    = static_cast<uint32_t>(std::max(std::lround(width * scale), 1L));
+        const auto rows    = static_cast<uint32_t>(std::max(std::lround(height * scale), 1L));
+        job.cols           = std::min(out_w, cols);
+        job.rows           = std::min(out_h, rows);
+    }
+    job.left = (out_w - job.cols) / 2;
+    job.top  = (out_h - job.rows) / 2;
+}
+
+/// taps of region [x, x + width) x [y, y + height) of the view of job into its content
+static void BuildTaps(const double x,
+                      const double y,
+                      const double width,
+                      const double height,
+                      const PreprocessParam& param,
+                      const uint32_t out_w,
+                      const PreJob& job,
+                      PreTaps& taps) {
+    const uint32_t cn = param.format == M_PIX_FMT_GRAY8 ? 1 : 3, count = out_w * cn;
+    PreAxis x_axis;
+    BuildAxis(x, width, job.view.GetWidth(), job.cols, param.interpolation, x_axis);
+    BuildAxis(y, height, job.view.GetHeight(), job.rows, param.interpolation, taps.y);
+    // elements of NCHW rows are channel major, the filtered row is planar already
+    const bool planar = param.layout == M_LAYOUT_NCHW;
+    taps.x.ofs0.assign(count, 0);
+    taps.x.ofs1.assign(count, 0);
+    taps.x.weights.assign(count, 0);
+    for (uint32_t j = 0; j < count; ++j) {
+        const uint32_t col = planar ? j % out_w : j / cn, c = planar ? j / out_w : j % cn;
+        if (col < job.left || col >= job.left + job.cols) {
+            continue;
+        }
+        const uint32_t i  = col - job.left;
+        taps.x.ofs0[j]    = static_cast<int32_t>(x_axis.i0[i] * cn + c);
+        taps.x.ofs1[j]    = static_cast<int32_t>(x_axis.i1[i] * cn + c);
+        taps.x.weights[j] = (PRE_ONE - x_axis.fix1[i]) | (x_axis.fix1[i] << 16);
+    }
+}
+
+static bool IsYuv420(const PixelFormat format) {
+    return format == M_PIX_FMT_NV12 || format == M_PIX_FMT_NV21 ||
+           format == M_PIX_FMT_NV12_DETACH || format == M_PIX_FMT_NV21_DETACH ||
+           format == M_PIX_FMT_YUV420P || format == M_PIX_FMT_YU12 || format == M_PIX_FMT_YV12;
+}
+
+static bool IsPreprocessInput(const PixelFormat format) {
+    switch (format) {
+        case M_PIX_FMT_NV12:
+        case M_PIX_FMT_NV21:
+        case M_PIX_FMT_NV12_DETACH:
+        case M_PIX_FMT_NV21_DETACH:
+        case M_PIX_FMT_YUV420P:
+        case M_PIX_FMT_YU12:
+        case M_PIX_FMT_YV12:
+        case M_PIX_FMT_YUYV:
+        case M_PIX_FMT_UYVY:
+        case M_PIX_FMT_BGR888:
+        case M_PIX_FMT_RGB888:
+        case M_PIX_FMT_BGRA8888:
+        case M_PIX_FMT_RGBA8888:
+        case M_PIX_FMT_BGR888_PLANAR:
+        case M_PIX_FMT_RGB888_PLANAR:
+        case M_PIX_FMT_GRAY8:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// packed row sy of image n in format of out, scratch holds converted rows.
+/// a gather of 4 bytes may read 3 bytes past the row, rows read in place must have them
+static const uint8_t* SourceRow(const Image& input,
+                                const PreprocessParam& param,
+                                const uint32_t n,
+                                const uint32_t sy,
+                                const uint32_t bytes,
+                                uint8_t* scratch) {
+    const PixelFormat format = input.GetPixelFormat();
+    if (format == param.format || (param.format == M_PIX_FMT_GRAY8 && IsYuv420(format))) {
+        // views end with the buffer they share
+        const auto& data_mgr = input.GetDataManager();
+        const uint8_t* end   = static_cast<const uint8_t*>(data_mgr->GetDataPtr());
+        const uint8_t* row   = input.GetData<uint8_t>(n) + sy * input.GetStride();
+        end += data_mgr->GetSize();
+        if (row + bytes + 4 <= end) {
+            return row;
+        }
+        memcpy(scratch, row, bytes);
+        return scratch;
+    }
+    if (convert_color_row(input, n, sy, param.format, scratch, param.space) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return scratch;
+}
+
+/// filter source row along W, elements are pixel << PRE_BITS
+static void Horizontal(const uint8_t* src, const PreRowTable& table, int32_t* dst, uint32_t n) {
+    uint32_t j = 0;
+#ifdef USE_AVX
+    const __m256i low = _mm256_set1_epi32(0xFF);
+    for (; j + 8 <= n; j += 8) {
+        const __m256i o0 = _mm256_loadu_si256((const __m256i*)(table.ofs0.data() + j));
+        const __m256i o1 = _mm256_loadu_si256((const __m256i*)(table.ofs1.data() + j));
+        const __m256i s0 = _mm256_and_si256(_mm256_i32gather_epi32((const int*)src, o0, 1), low);
+        const __m256i s1 = _mm256_and_si256(_mm256_i32gather_epi32((const int*)src, o1, 1), low);
+        const __m256i w  = _mm256_loadu_si256((const __m256i*)(table.weights.data() + j));
+        const __m256i s  = _mm256_or_si256(s0, _mm256_slli_epi32(s1, 16));
+        _mm256_storeu_si256((__m256i*)(dst + j), _mm256_madd_epi16(s, w));
+    }
+#endif
+    for (; j < n; ++j) {
+        const int32_t w = table.weights[j];
+        dst[j] = src[table.ofs0[j]] * (w & 0xFFFF) + src[table.ofs1[j]] * (w >> 16);
+    }
+}
+
+#ifdef USE_AVX
+static inline void Store8(const __m256 v, float* dst) {
+    _mm256_storeu_ps(dst, v);
+}
+
+static inline void Store8(const __m256 v, uint16_t* dst) {
+    _mm_storeu_si128((__m128i*)dst, _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+}
+#endif // USE_AVX
+
+static inline void Store1(const float v, float* dst) {
+    *dst = v;
+}
+
+static inline void Store1(const float v, uint16_t* dst) {
+    *dst = fp32_to_fp16(v);
+}
+
+/// blend 2 filtered rows along H, normalize and store elements [begin, end) of the row
+template <typename T>
+static void Vertical(const int32_t* h0,
+                     const int32_t* h1,
+                     const int32_t fix1,
+                     const PreNorm& norm,
+                     const uint32_t begin,
+                     const uint32_t end,
+                     T* dst) {
+    const int32_t fix0 = PRE_ONE - fix1;
+    const float* scale = norm.scale.data();
+    const float* bias  = norm.bias.data();
+    uint32_t j         = begin;
+#ifdef USE_AVX
+    const __m256i b0 = _mm256_set1_epi32(fix0), b1 = _mm256_set1_epi32(fix1);
+    for (; j + 8 <= end; j += 8) {
+        const __m256i r0 = _mm256_loadu_si256((const __m256i*)(h0 + j));
+        const __m256i r1 = _mm256_loadu_si256((const __m256i*)(h1 + j));
+        const __m256i v  = _mm256_add_epi32(_mm256_mullo_epi32(r0, b0), _mm256_mullo_epi32(r1, b1));
+        const __m256 f   = _mm256_fmadd_ps(
+            _mm256_cvtepi32_ps(v), _mm256_loadu_ps(scale + j), _mm256_loadu_ps(bias + j));
+        Store8(f, dst + j - begin);
+    }
+#endif
+    for (; j < end; ++j) {
+        const float v = static_cast<float>(h0[j] * fix0 + h1[j] * fix1);
+        Store1(v * scale[j] + bias[j], dst + j - begin);
+    }
+}
+
+/// padding elements [begin, end) of the row
+template <typename T>
+static void Pad(const PreNorm& norm, const uint32_t begin, const uint32_t end, T* dst) {
+    for (uint32_t j = begin; j < end; ++j) {
+        Store1(norm.pad[j], dst + j - begin);
+    }
+}
+
+/// output rows [begin, end) of item of out
+template <typename T>
+static void PreprocessRows(const PreJob& job,
+                           const PreTaps& taps,
+                           const PreprocessParam& param,
+                           const PreNorm& norm,
+                           const uint32_t item,
+                           const uint32_t begin,
+                           const uint32_t end,
+                           Tensor& out) {
+    const bool planar    = param.layout == M_LAYOUT_NCHW;
+    const uint32_t cn    = param.format == M_PIX_FMT_GRAY8 ? 1 : 3;
+    const uint32_t count = static_cast<uint32_t>(norm.scale.size()), w = count / cn;
+    const uint32_t h     = out.GetShape(planar ? 2 : 1);
+    const uint32_t bytes = job.view.GetWidth() * cn;
+    int32_t* ring        = static_cast<int32_t*>(GetScratch(0, 2 * count * sizeof(int32_t)));
+    uint8_t* scratch     = static_cast<uint8_t*>(GetScratch(1, bytes + 32));
+    if (nullptr == ring || nullptr == scratch) {
+        SIMPLE_LOG_ERROR("preprocess malloc scratch of %u elements failed", 2 * count);
+        return;
+    }
+    int64_t tags[2] = {-1, -1};
+    auto Row        = [&](const uint32_t sy) -> const int32_t* {
+        int32_t* row = ring + (sy & 1) * count;
+        if (tags[sy & 1] != sy) {
+            const uint8_t* src = SourceRow(job.view, param, job.n, sy, bytes, scratch);
+            if (nullptr == src) {
+                memset(row, 0, count * sizeof(int32_t));
+            } else {
+                Horizontal(src, taps.x, row, count);
+            }
+            tags[sy & 1] = sy;
+        }
+        return row;
+    };
+
+    // content elements of a row of every plane, rows of NHWC are one plane
+    const uint32_t planes = planar ? cn : 1, span = planar ? w : count;
+    const uint32_t first = planar ? job.left : job.left * cn;
+    const uint32_t last  = first + (planar ? job.cols : job.cols * cn);
+    for (uint32_t y = begin; y < end; ++y) {
+        const bool content = y >= job.top && y < job.top + job.rows;
+        const int32_t *h0 = nullptr, *h1 = nullptr;
+        int32_t fix1 = 0;
+        if (content) {
+            h0   = Row(taps.y.i0[y - job.top]);
+            h1   = Row(taps.y.i1[y - job.top]);
+            fix1 = taps.y.fix1[y - job.top];
+        }
+        for (uint32_t p = 0; p < planes; ++p) {
+            T* dst              = out.GetRow<T>(item, planar ? p * h + y : y);
+            const uint32_t base = p * span;
+            if (!content) {
+                Pad(norm, base, base + span, dst);
+                continue;
+            }
+            Pad(norm, base, base + first, dst);
+            Vertical(h0, h1, fix1, norm, base + first, base + last, dst + first);
+            Pad(norm, base + last, base + span, dst + last);
+        }
+    }
+}
+
+/// check input and param, log the unsupported case
+static MStatus CheckInput(const Image& input, const PreprocessParam& param, const char* name) {
+    const PixelFormat format = input.GetPixelFormat();
+    const bool gray          = param.format == M_PIX_FMT_GRAY8;
+    const bool yuv422        = format == M_PIX_FMT_YUYV || format == M_PIX_FMT_UYVY;
+    const bool yuv           = IsYuv420(format) || yuv422;
+    if (nullptr == input.GetData<void>() || input.GetMemType() != M_MEM_ON_CPU ||
+        !IsPreprocessInput(format) ||
+        (gray ? format != M_PIX_FMT_GRAY8 && !IsYuv420(format)
+              : param.format != M_PIX_FMT_RGB888 && param.format != M_PIX_FMT_BGR888) ||
+        (!gray && format == M_PIX_FMT_GRAY8) ||
+        (yuv && (input.GetWidth() % 2 != 0 || (!yuv422 && input.GetHeight() % 2 != 0))) ||
+        (param.layout != M_LAYOUT_NCHW && param.layout != M_LAYOUT_NHWC) ||
+        (param.elem_type != M_DATA_TYPE_FLOAT32 && param.elem_type != M_DATA_TYPE_FLOAT16) ||
+        param.interpolation > M_INTER_LINEAR || param.space >= M_COLOR_MAX) {
+        SIMPLE_LOG_ERROR("%s can't support %s [%u x %u] to %s %s %s, interpolation %i",
+                         name,
+                         input.GetPixelFormatStr().c_str(),
+                         input.GetWidth(),
+                         input.GetHeight(),
+                         param.format < M_PIX_FMT_MAX ? FormatStr[param.format].c_str() : "INVALID",
+                         param.layout < M_LAYOUT_MAX ? TensorLayoutStr[param.layout].c_str() : "",
+                         param.elem_type < M_DATA_TYPE_MAX ? DataTypeStr[param.elem_type].c_str()
+                                                           : "",
+                         static_cast<int>(param.interpolation));
+        return MStatus::M_NOT_SUPPORT;
+    }
+    return MStatus::M_OK;
+}
+
+// output rows of one item taken by a worker at a time
+#define PRE_BAND 8
+
+/// resize every job into its item of out of [width x height]
+static MStatus RunJobs(const Image& input,
+                       const std::vector<PreJob>& jobs,
+                       const std::vector<PreTaps>& taps,
+                       const PreprocessParam& param,
+                       const uint32_t width,
+                       const uint32_t height,
+                       Tensor& out) {
+    const uint32_t cn = param.format == M_PIX_FMT_GRAY8 ? 1 : 3;
+    const uint32_t number = static_cast<uint32_t>(jobs.size());
+    const std::vector<uint32_t> shape = param.layout == M_LAYOUT_NCHW
+                                            ? std::vector<uint32_t>{number, cn, height, width}
+                                            : std::vector<uint32_t>{number, height, width, cn};
+    MStatus status = out.Reset(shape, param.layout, param.elem_type, out.GetPadding());
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+    input.GetDataManager()->SyncCache(false);
+
+    PreNorm norm;
+    const uint32_t count = width * cn;
+    norm.scale.resize(count);
+    norm.bias.resize(count);
+    norm.pad.resize(count);
+    for (uint32_t j = 0; j < count; ++j) {
+        const uint32_t c = param.layout == M_LAYOUT_NCHW ? j / width : j % cn;
+        norm.scale[j]    = param.norm[c] / (1 << (2 * PRE_BITS));
+        norm.bias[j]     = -param.mean[c] * param.norm[c];
+        norm.pad[j]      = (param.pad - param.mean[c]) * param.norm[c];
+    }
+
+    // workers take bands of rows in turn, items of large regions don't hold back the others
+    const uint32_t bands = (height + PRE_BAND - 1) / PRE_BAND, total = number * bands;
+    const uint32_t workers =
+        std::min(total, static_cast<uint32_t>(GetComputePipe().GetThreadCount()) + 1U);
+    std::atomic<uint32_t> next(0);
+    ParallelFor(workers, 1, [&](uint32_t, uint32_t) {
+        for (uint32_t t = next++; t < total; t = next++) {
+            const uint32_t item = t / bands, y0 = t % bands * PRE_BAND;
+            const uint32_t y1 = std::min(height, y0 + PRE_BAND);
+            const PreJob& job = jobs[item];
+            if (param.elem_type == M_DATA_TYPE_FLOAT32) {
+                PreprocessRows<float>(job, taps[job.taps], param, norm, item, y0, y1, out);
+            } else {
+                PreprocessRows<uint16_t>(job, taps[job.taps], param, norm, item, y0, y1, out);
+            }
+        }
+    });
+    out.GetDataManager()->SyncCache(true);
+    return MStatus::M_OK;
+}
+
+MStatus preprocess(const Image& input, const PreprocessParam& param, Tensor& out) {
+    MStatus status = CheckInput(input, param, "preprocess");
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+    const uint32_t width  = param.width ? param.width : input.GetWidth();
+    const uint32_t height = param.height ? param.height : input.GetHeight();
+
+    // all images share the taps of the whole image
+    std::vector<PreTaps> taps(1);
+    std::vector<PreJob> jobs(input.GetNumber());
+    PreJob job = {input, 0, 0, 0, 0, 0, 0};
+    Content(input.GetWidth(), input.GetHeight(), param, width, height, job);
+    BuildTaps(0.0, 0.0, input.GetWidth(), input.GetHeight(), param, width, job, taps[0]);
+    for (uint32_t n = 0; n < input.GetNumber(); ++n) {
+        jobs[n]   = job;
+        jobs[n].n = n;
+    }
+    return RunJobs(input, jobs, taps, param, width, height, out);
+}
+
+MStatus crop_resize(const Image& input,
+                    const std::vector<CropBox>& boxes,
+                    const PreprocessParam& param,
+                    Tensor& out) {
+    MStatus status = CheckInput(input, param, "crop_resize");
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+    const uint32_t width = input.GetWidth(), height = input.GetHeight();
+    if (boxes.empty() || 0 == param.width || 0 == param.height) {
+        SIMPLE_LOG_ERROR("crop_resize failed, %zu boxes to [%u x %u]",
+                         boxes.size(),
+                         param.width,
+                         param.height);
+        return MStatus::M_INVALID_ARG;
+    }
+    for (const CropBox& box : boxes) {
+        if (box.index >= input.GetNumber() || !(box.x0 < box.x1) || !(box.y0 < box.y1) ||
+            box.x1 <= 0.f || box.y1 <= 0.f || box.x0 >= width || box.y0 >= height) {
+            SIMPLE_LOG_ERROR("crop_resize failed, box [%f, %f, %f, %f] of image %u out of "
+                             "[%u x %u] of %u images",
+                             box.x0,
+                             box.y0,
+                             box.x1,
+                             box.y1,
+                             box.index,
+                             width,
+                             height,
+                             input.GetNumber());
+            return MStatus::M_INVALID_ARG;
+        }
+    }
+
+    // region of a box with a pixel around for the second taps, chroma of yuv needs even
+    // region, rows are converted across the region only
+    const PixelFormat format = input.GetPixelFormat();
+    const bool yuv422        = format == M_PIX_FMT_YUYV || format == M_PIX_FMT_UYVY;
+    const int32_t align_x    = IsYuv420(format) || yuv422 ? 2 : 1;
+    const int32_t align_y    = IsYuv420(format) ? 2 : 1;
+    const uint32_t number    = static_cast<uint32_t>(boxes.size());
+    std::vector<PreTaps> taps(number);
+    std::vector<PreJob> jobs(number);
+    std::atomic<uint32_t> failed(0);
+    auto Range = [](float lo, float hi, int32_t size, int32_t align, int32_t& begin) {
+        begin       = std::max(0, static_cast<int32_t>(std::floor(lo)) - 1) / align * align;
+        int32_t end = std::min(size, static_cast<int32_t>(std::ceil(hi)) + 1);
+        end         = std::min(size, (end + align - 1) / align * align);
+        return static_cast<uint32_t>(end - begin);
+    };
+    ParallelFor(number, 16, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            const CropBox& box = boxes[i];
+            int32_t x = 0, y = 0;
+            const uint32_t w = Range(box.x0, box.x1, static_cast<int32_t>(width), align_x, x);
+            const uint32_t h = Range(box.y0, box.y1, static_cast<int32_t>(height), align_y, y);
+            PreJob& job      = jobs[i];
+            job.n            = box.index;
+            job.taps         = i;
+            if (input.Crop(x, y, w, h, job.view) != MStatus::M_OK) {
+                ++failed;
+                continue;
+            }
+            Content(box.x1 - box.x0, box.y1 - box.y0, param, param.width, param.height, job);
+            BuildTaps(box.x0 - x,
+                      box.y0 - y,
+                      box.x1 - box.x0,
+                      box.y1 - box.y0,
+                      param,
+                      param.width,
+                      job,
+                      taps[i]);
+        }
+    });
+    if (failed > 0) {
+        return MStatus::M_INVALID_ARG;
+    }
+    return RunJobs(input, jobs, taps, param, param.width, param.height, out);
+}
+
+} // namespace base
@@ -0,0 +1,600 @@
+#include "image/resize.h"
+
+#include "intrinsic.h"
+#include "manager/data_manager.h"
+#include "manager/pipe_manager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+#include <vector>
+
+namespace base {
+
+// bits of fixed-point bilinear weights of u8 images
+#define RESIZE_BITS 11
+#define RESIZE_ONE (1 << RESIZE_BITS)
+
+static bool IsResizeFormat(const PixelFormat format) {
+    switch (format) {
+        case M_PIX_FMT_GRAY8:
+        case M_PIX_FMT_BGR888:
+        case M_PIX_FMT_RGB888:
+        case M_PIX_FMT_BGRA8888:
+        case M_PIX_FMT_RGBA8888:
+        case M_PIX_FMT_BGR888_PLANAR:
+        case M_PIX_FMT_RGB888_PLANAR:
+        case M_PIX_FMT_GRAY32:
+        case M_PIX_FMT_BGR323232:
+        case M_PIX_FMT_RGB323232:
+        case M_PIX_FMT_BGR323232_PLANAR:
+        case M_PIX_FMT_RGB323232_PLANAR:
+        case M_PIX_FMT_FLOAT32C4:
+        case M_PIX_FMT_NV12:
+        case M_PIX_FMT_NV21:
+        case M_PIX_FMT_NV12_DETACH:
+        case M_PIX_FMT_NV21_DETACH:
+        case M_PIX_FMT_YUV420P:
+        case M_PIX_FMT_YU12:
+        case M_PIX_FMT_YV12:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool IsYuv420(const PixelFormat format) {
+    return format == M_PIX_FMT_NV12 || format == M_PIX_FMT_NV21 ||
+           format == M_PIX_FMT_NV12_DETACH || format == M_PIX_FMT_NV21_DETACH ||
+           format == M_PIX_FMT_YUV420P || format == M_PIX_FMT_YU12 || format == M_PIX_FMT_YV12;
+}
+
+/// 2 taps of every output index along one axis
+typedef struct LinearAxis {
+    std::vector<uint32_t> i0;  ///< first source index
+    std::vector<uint32_t> i1;  ///< second source index, i0 + 1 inside the source
+    std::vector<float> w1;     ///< weight of second tap
+    std::vector<int32_t> fix1; ///< weight of second tap in RESIZE_BITS
+} LinearAxis;
+
+/// taps of every output index along one axis, taps of index i are [first[i], first[i + 1])
+typedef struct AreaAxis {
+    std::vector<uint32_t> first;
+    std::vector<uint32_t> index;
+    std::vector<float> weight;
+    uint32_t max_taps;
+} AreaAxis;
+
+/// tables of elements of an output row, element j is channel j % cn of pixel j / cn
+typedef struct LinearRowTable {
+    std::vector<int32_t> ofs0;    ///< element offset of first tap
+    std::vector<int32_t> ofs1;    ///< element offset of second tap
+    std::vector<float> w1;        ///< weight of second tap
+    std::vector<int32_t> weights; ///< fixed-point weights of both taps as 2 int16
+    uint32_t gather;              ///< leading elements where 4 bytes gather of u8 stays in row
+} LinearRowTable;
+
+/// taps of elements of an output row, tap t of element j at t * n + j, short taps weigh 0
+typedef struct AreaRowTable {
+    std::vector<int32_t> ofs;  ///< element offset of tap
+    std::vector<float> weight; ///< weight of tap
+    uint32_t taps;             ///< taps of every element, max_taps of axis
+} AreaRowTable;
+
+static void BuildLinearAxis(const uint32_t in, const uint32_t out, LinearAxis& axis) {
+    const double scale = static_cast<double>(in) / out;
+    axis.i0.resize(out);
+    axis.i1.resize(out);
+    axis.w1.resize(out);
+    axis.fix1.resize(out);
+    for (uint32_t i = 0; i < out; ++i) {
+        const double s = (i + 0.5) * scale - 0.5;
+        int64_t x      = static_cast<int64_t>(std::floor(s));
+        float f        = static_cast<float>(s - x);
+        if (x < 0) {
+            x = 0;
+            f = 0.f;
+        }
+        if (x >= static_cast<int64_t>(in) - 1) {
+            x = in - 1;
+            f = 0.f;
+        }
+        axis.i0[i]   = static_cast<uint32_t>(x);
+        axis.i1[i]   = std::min(axis.i0[i] + 1, in - 1);
+        axis.w1[i]   = f;
+        axis.fix1[i] = static_cast<int32_t>(std::lround(f * RESIZE_ONE));
+    }
+}
+
+static void BuildLinearRow(const LinearAxis& axis,
+                           const uint32_t channel,
+                           const uint32_t in_width,
+                           LinearRowTable& table) {
+    const uint32_t count = static_cast<uint32_t>(axis.i0.size()) * channel;
+    table.ofs0.resize(count);
+    table.ofs1.resize(count);
+    table.w1.resize(count);
+    table.weights.resize(count);
+    table.gather    = 0;
+    bool in_row     = true;
+    const int32_t n = static_cast<int32_t>(in_width * channel);
+    for (uint32_t j = 0; j < count; ++j) {
+        const uint32_t x = j / channel, c = j % channel;
+        table.ofs0[j]    = static_cast<int32_t>(axis.i0[x] * channel + c);
+        table.ofs1[j]    = static_cast<int32_t>(axis.i1[x] * channel + c);
+        table.w1[j]      = axis.w1[x];
+        table.weights[j] = (RESIZE_ONE - axis.fix1[x]) | (axis.fix1[x] << 16);
+        in_row           = in_row && table.ofs1[j] + 4 <= n;
+        table.gather     = in_row ? j + 1 : table.gather;
+    }
+}
+
+static void BuildAreaAxis(const uint32_t in, const uint32_t out, AreaAxis& axis) {
+    axis.first.assign(1, 0);
+    axis.index.clear();
+    axis.weight.clear();
+    axis.max_taps = 1;
+    if (in <= out) {
+        // enlarging, the same taps as bilinear
+        LinearAxis linear;
+        BuildLinearAxis(in, out, linear);
+        for (uint32_t i = 0; i < out; ++i) {
+            axis.index.push_back(linear.i0[i]);
+            axis.weight.push_back(1.f - linear.w1[i]);
+            axis.index.push_back(linear.i1[i]);
+            axis.weight.push_back(linear.w1[i]);
+            axis.first.push_back(static_cast<uint32_t>(axis.index.size()));
+        }
+        axis.max_taps = 2;
+        return;
+    }
+    const double scale = static_cast<double>(in) / out;
+    for (uint32_t i = 0; i < out; ++i) {
+        const double s0 = i * scale, s1 = std::min(s0 + scale, static_cast<double>(in));
+        for (uint32_t k = static_cast<uint32_t>(s0); k < in && k < s1; ++k) {
+            const double w = (std::min(s1, k + 1.0) - std::max(s0, static_cast<double>(k))) / scale;
+            if (w > 1e-6) {
+                axis.index.push_back(k);
+                axis.weight.push_back(static_cast<float>(w));
+            }
+        }
+        axis.first.push_back(static_cast<uint32_t>(axis.index.size()));
+        axis.max_taps = std::max(axis.max_taps, axis.first[i + 1] - axis.first[i]);
+    }
+}
+
+static void BuildAreaRow(const AreaAxis& axis, const uint32_t channel, AreaRowTable& table) {
+    const uint32_t width = static_cast<uint32_t>(axis.first.size()) - 1, n = width * channel;
+    table.taps           = axis.max_taps;
+    table.ofs.resize(table.taps * n);
+    table.weight.resize(table.taps * n);
+    for (uint32_t j = 0; j < n; ++j) {
+        const uint32_t x     = j / channel, c = j % channel;
+        const uint32_t first = axis.first[x], count = axis.first[x + 1] - first;
+        for (uint32_t t = 0; t < table.taps; ++t) {
+            // padding taps read the last tap, so gathers stay in row
+            const uint32_t k        = first + std::min(t, count - 1);
+            table.ofs[t * n + j]    = static_cast<int32_t>(axis.index[k] * channel + c);
+            table.weight[t * n + j] = t < count ? axis.weight[k] : 0.f;
+        }
+    }
+}
+
+/// horizontal bilinear of u8 row, 2 taps in RESIZE_BITS
+static void
+HorizontalLinear(const uint8_t* src, const LinearRowTable& table, int32_t* dst, const uint32_t n) {
+    uint32_t j = 0;
+#ifdef USE_AVX
+    const __m256i low = _mm256_set1_epi32(0xFF);
+    for (; j + 8 <= table.gather; j += 8) {
+        const __m256i o0 = _mm256_loadu_si256((const __m256i*)(table.ofs0.data() + j));
+        const __m256i o1 = _mm256_loadu_si256((const __m256i*)(table.ofs1.data() + j));
+        const __m256i s0 = _mm256_and_si256(_mm256_i32gather_epi32((const int*)src, o0, 1), low);
+        const __m256i s1 = _mm256_and_si256(_mm256_i32gather_epi32((const int*)src, o1, 1), low);
+        const __m256i w  = _mm256_loadu_si256((const __m256i*)(table.weights.data() + j));
+        // s0 * w0 + s1 * w1 of int16 pairs
+        const __m256i s = _mm256_or_si256(s0, _mm256_slli_epi32(s1, 16));
+        _mm256_storeu_si256((__m256i*)(dst + j), _mm256_madd_epi16(s, w));
+    }
+#endif
+    for (; j < n; ++j) {
+        const int32_t w = table.weights[j];
+        dst[j] = src[table.ofs0[j]] * (w & 0xFFFF) + src[table.ofs1[j]] * (w >> 16);
+    }
+}
+
+/// horizontal bilinear of fp32 row
+static void
+HorizontalLinear(const float* src, const LinearRowTable& table, float* dst, const uint32_t n) {
+    uint32_t j = 0;
+#ifdef USE_AVX
+    for (; j + 8 <= n; j += 8) {
+        const __m256i o0 = _mm256_loadu_si256((const __m256i*)(table.ofs0.data() + j));
+        const __m256i o1 = _mm256_loadu_si256((const __m256i*)(table.ofs1.data() + j));
+        const __m256 s0  = _mm256_i32gather_ps(src, o0, 4);
+        const __m256 s1  = _mm256_i32gather_ps(src, o1, 4);
+        const __m256 w   = _mm256_loadu_ps(table.w1.data() + j);
+        _mm256_storeu_ps(dst + j, _mm256_add_ps(s0, _mm256_mul_ps(_mm256_sub_ps(s1, s0), w)));
+    }
+#endif
+    for (; j < n; ++j) {
+        const float s0 = src[table.ofs0[j]];
+        dst[j]         = s0 + (src[table.ofs1[j]] - s0) * table.w1[j];
+    }
+}
+
+#ifdef USE_AVX
+/// 16 int32 to u8 with saturation, in order
+static inline __m128i PackU8(const __m256i v0, const __m256i v1) {
+    const __m256i p = _mm256_permute4x64_epi64(_mm256_packs_epi32(v0, v1), 0xD8);
+    return _mm_packus_epi16(_mm256_castsi256_si128(p), _mm256_extracti128_si256(p, 1));
+}
+#endif
+
+/// vertical bilinear of u8 rows, sums of 2 * RESIZE_BITS are rounded
+static void VerticalLinear(const int32_t* h0,
+                           const int32_t* h1,
+                           const float,
+                           const int32_t fix1,
+                           uint8_t* dst,
+                           const uint32_t n) {
+    const int32_t fix0 = RESIZE_ONE - fix1;
+    const int32_t half = 1 << (2 * RESIZE_BITS - 1);
+    uint32_t j         = 0;
+#ifdef USE_AVX
+    const __m256i b0 = _mm256_set1_epi32(fix0), b1 = _mm256_set1_epi32(fix1);
+    const __m256i vh = _mm256_set1_epi32(half);
+    for (; j + 16 <= n; j += 16) {
+        __m256i v[2];
+        for (uint32_t k = 0; k < 2; ++k) {
+            const __m256i r0 = _mm256_loadu_si256((const __m256i*)(h0 + j + 8 * k));
+            const __m256i r1 = _mm256_loadu_si256((const __m256i*)(h1 + j + 8 * k));
+            v[k] = _mm256_add_epi32(_mm256_mullo_epi32(r0, b0), _mm256_mullo_epi32(r1, b1));
+            v[k] = _mm256_srai_epi32(_mm256_add_epi32(v[k], vh), 2 * RESIZE_BITS);
+        }
+        _mm_storeu_si128((__m128i*)(dst + j), PackU8(v[0], v[1]));
+    }
+#endif
+    for (; j < n; ++j) {
+        dst[j] = static_cast<uint8_t>((h0[j] * fix0 + h1[j] * fix1 + half) >> (2 * RESIZE_BITS));
+    }
+}
+
+/// vertical bilinear of fp32 rows
+static void VerticalLinear(const float* h0,
+                           const float* h1,
+                           const float w1,
+                           const int32_t,
+                           float* dst,
+                           const uint32_t n) {
+    uint32_t j = 0;
+#ifdef USE_AVX
+    const __m256 w = _mm256_set1_ps(w1);
+    for (; j + 8 <= n; j += 8) {
+        const __m256 r0 = _mm256_loadu_ps(h0 + j);
+        const __m256 r1 = _mm256_loadu_ps(h1 + j);
+        _mm256_storeu_ps(dst + j, _mm256_add_ps(r0, _mm256_mul_ps(_mm256_sub_ps(r1, r0), w)));
+    }
+#endif
+    for (; j < n; ++j) {
+        dst[j] = h0[j] + (h1[j] - h0[j]) * w1;
+    }
+}
+
+/// bilinear of output rows [begin, end), T is pixel type and R is type of filtered rows
+template <typename T, typename R>
+static void LinearRows(const ImagePlane& in,
+                       const ImagePlane& out,
+                       const LinearRowTable& row_table,
+                       const LinearAxis& y_axis,
+                       const uint32_t begin,
+                       const uint32_t end) {
+    const uint32_t n = out.width * out.channel;
+    R* ring          = static_cast<R*>(GetScratch(0, 2 * n * sizeof(R)));
+    if (nullptr == ring) {
+        SIMPLE_LOG_ERROR("resize malloc ring buffer of %u elements failed", 2 * n);
+        return;
+    }
+    // source row in every slot, a row is filtered once for all output rows using it
+    int64_t tags[2] = {-1, -1};
+    auto Row        = [&](const uint32_t sy) -> const R* {
+        R* row = ring + (sy & 1) * n;
+        if (tags[sy & 1] != sy) {
+            const T* src = reinterpret_cast<const T*>(in.data + sy * in.pitch);
+            HorizontalLinear(src, row_table, row, n);
+            tags[sy & 1] = sy;
+        }
+        return row;
+    };
+    for (uint32_t y = begin; y < end; ++y) {
+        const R* h0 = Row(y_axis.i0[y]);
+        const R* h1 = Row(y_axis.i1[y]);
+        VerticalLinear(h0,
+                       h1,
+                       y_axis.w1[y],
+                       y_axis.fix1[y],
+                       reinterpret_cast<T*>(out.data + y * out.pitch),
+                       n);
+    }
+}
+
+/// y[i] += alpha * x[i]
+static void Axpy(float* y, const float* x, const float alpha, const uint32_t size) {
+    uint32_t i = 0;
+#ifdef USE_AVX
+    const __m256 va = _mm256_set1_ps(alpha);
+    for (; i + 8 <= size; i += 8) {
+        const __m256 vy = _mm256_loadu_ps(y + i);
+        _mm256_storeu_ps(y + i, _mm256_add_ps(vy, _mm256_mul_ps(va, _mm256_loadu_ps(x + i))));
+    }
+#endif
+    for (; i < size; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+/// u8 row to fp32, so taps of u8 are gathered as fp32
+static const float* AreaSource(const uint8_t* src, float* buffer, const uint32_t n) {
+    uint32_t i = 0;
+#ifdef USE_AVX
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(src + i)));
+        _mm256_storeu_ps(buffer + i, _mm256_cvtepi32_ps(v));
+    }
+#endif
+    for (; i < n; ++i) {
+        buffer[i] = src[i];
+    }
+    return buffer;
+}
+
+static const float* AreaSource(const float* src, float*, const uint32_t) { return src; }
+
+/// horizontal area of fp32 row, taps of 8 elements are gathered at once
+static void
+HorizontalArea(const float* src, const AreaRowTable& table, float* dst, const uint32_t n) {
+    const int32_t* ofs  = table.ofs.data();
+    const float* weight = table.weight.data();
+    uint32_t j          = 0;
+#ifdef USE_AVX
+    for (; j + 8 <= n; j += 8) {
+        __m256 sum = _mm256_setzero_ps();
+        for (uint32_t t = 0; t < table.taps; ++t) {
+            const __m256i o = _mm256_loadu_si256((const __m256i*)(ofs + t * n + j));
+            const __m256 w  = _mm256_loadu_ps(weight + t * n + j);
+            const __m256 v  = _mm256_i32gather_ps(src, o, 4);
+            sum             = _mm256_add_ps(sum, _mm256_mul_ps(w, v));
+        }
+        _mm256_storeu_ps(dst + j, sum);
+    }
+#endif
+    for (; j < n; ++j) {
+        float sum = 0.f;
+        for (uint32_t t = 0; t < table.taps; ++t) {
+            sum += weight[t * n + j] * src[ofs[t * n + j]];
+        }
+        dst[j] = sum;
+    }
+}
+
+/// both paths round in the current rounding mode, half to even by default
+static void StoreArea(const float* acc, uint8_t* dst, const uint32_t n) {
+    uint32_t j = 0;
+#ifdef USE_AVX
+    for (; j + 16 <= n; j += 16) {
+        const __m256i v0 = _mm256_cvtps_epi32(_mm256_loadu_ps(acc + j));
+        const __m256i v1 = _mm256_cvtps_epi32(_mm256_loadu_ps(acc + j + 8));
+        _mm_storeu_si128((__m128i*)(dst + j), PackU8(v0, v1));
+    }
+#endif
+    for (; j < n; ++j) {
+        dst[j] = static_cast<uint8_t>(std::min(255.f, std::max(0.f, std::nearbyint(acc[j]))));
+    }
+}
+
+static void StoreArea(const float* acc, float* dst, const uint32_t n) {
+    memcpy(dst, acc, n * sizeof(float));
+}
+
+/// area of output rows [begin, end), taps of x are summed per element
+template <typename T>
+static void AreaRows(const ImagePlane& in,
+                     const ImagePlane& out,
+                     const AreaRowTable& row_table,
+                     const AreaAxis& y_axis,
+                     const uint32_t begin,
+                     const uint32_t end) {
+    const uint32_t cn = out.channel, n = out.width * cn, slots = y_axis.max_taps;
+    float* ring       = static_cast<float*>(GetScratch(0, (slots + 1) * n * sizeof(float)));
+    if (nullptr == ring) {
+        SIMPLE_LOG_ERROR("resize malloc ring buffer of %u elements failed", (slots + 1) * n);
+        return;
+    }
+    const uint32_t in_n = in.width * cn;
+    float* buffer       = static_cast<float*>(GetScratch(1, in_n * sizeof(float)));
+    if (nullptr == buffer) {
+        SIMPLE_LOG_ERROR("resize malloc source row of %u elements failed", in_n);
+        return;
+    }
+    float* acc = ring + slots * n;
+    // taps of one output row are consecutive source rows, they take different slots
+    std::vector<int64_t> tags(slots, -1);
+    auto Row = [&](const uint32_t sy) -> const float* {
+        float* row = ring + (sy % slots) * n;
+        if (tags[sy % slots] != sy) {
+            const T* src = reinterpret_cast<const T*>(in.data + sy * in.pitch);
+            HorizontalArea(AreaSource(src, buffer, in_n), row_table, row, n);
+            tags[sy % slots] = sy;
+        }
+        return row;
+    };
+    for (uint32_t y = begin; y < end; ++y) {
+        memset(acc, 0, n * sizeof(float));
+        for (uint32_t t = y_axis.first[y]; t < y_axis.first[y + 1]; ++t) {
+            Axpy(acc, Row(y_axis.index[t]), y_axis.weight[t], n);
+        }
+        StoreArea(acc, reinterpret_cast<T*>(out.data + y * out.pitch), n);
+    }
+}
+
+template <uint32_t kBytes>
+static void NearestRow(const uint8_t* src, const uint32_t* xofs, uint8_t* dst, const uint32_t w) {
+    for (uint32_t x = 0; x < w; ++x) {
+        memcpy(dst + x * kBytes, src + xofs[x], kBytes);
+    }
+}
+
+/// nearest of output rows [begin, end), pixels are copied as a whole
+static void NearestRows(const ImagePlane& in,
+                        const ImagePlane& out,
+                        const std::vector<uint32_t>& xofs,
+                        const std::vector<uint32_t>& ysrc,
+                        const uint32_t begin,
+                        const uint32_t end) {
+    const uint32_t bytes = out.channel * out.type_size;
+    for (uint32_t y = begin; y < end; ++y) {
+        const uint8_t* src = in.data + ysrc[y] * in.pitch;
+        uint8_t* dst       = out.data + y * out.pitch;
+        switch (bytes) {
+            case 1U:
+                NearestRow<1>(src, xofs.data(), dst, out.width);
+                break;
+            case 2U:
+                NearestRow<2>(src, xofs.data(), dst, out.width);
+                break;
+            case 3U:
+                NearestRow<3>(src, xofs.data(), dst, out.width);
+                break;
+            case 4U:
+                NearestRow<4>(src, xofs.data(), dst, out.width);
+                break;
+            case 12U:
+                NearestRow<12>(src, xofs.data(), dst, out.width);
+                break;
+            default:
+                for (uint32_t x = 0; x < out.width; ++x) {
+                    memcpy(dst + x * bytes, src + xofs[x], bytes);
+                }
+                break;
+        }
+    }
+}
+
+static std::vector<uint32_t> NearestAxis(const uint32_t in, const uint32_t out) {
+    std::vector<uint32_t> index(out);
+    const double scale = static_cast<double>(in) / out;
+    for (uint32_t i = 0; i < out; ++i) {
+        index[i] = std::min(static_cast<uint32_t>((i + 0.5) * scale), in - 1);
+    }
+    return index;
+}
+
+/// resize plane p of every image, tables are shared by all images and rows
+static void ResizePlanes(const Image& input,
+                         Image& out,
+                         const uint32_t p,
+                         const InterpolationType type) {
+    ImagePlane in_planes[IMAGE_MAX_PLANES], out_planes[IMAGE_MAX_PLANES];
+    input.GetPlanes(0, in_planes);
+    out.GetPlanes(0, out_planes);
+    const ImagePlane& ip = in_planes[p];
+    const ImagePlane& op = out_planes[p];
+    const uint32_t cn = op.channel, ts = op.type_size;
+
+    std::vector<uint32_t> xofs, ysrc;
+    LinearAxis x_linear, y_linear;
+    LinearRowTable row_table;
+    AreaAxis x_area, y_area;
+    AreaRowTable area_table;
+    switch (type) {
+        case M_INTER_NEAREST:
+            xofs = NearestAxis(ip.width, op.width);
+            for (uint32_t& x : xofs) {
+                x *= cn * ts;
+            }
+            ysrc = NearestAxis(ip.height, op.height);
+            break;
+        case M_INTER_LINEAR:
+            BuildLinearAxis(ip.width, op.width, x_linear);
+            BuildLinearAxis(ip.height, op.height, y_linear);
+            BuildLinearRow(x_linear, cn, ip.width, row_table);
+            break;
+        default:
+            BuildAreaAxis(ip.width, op.width, x_area);
+            BuildAreaAxis(ip.height, op.height, y_area);
+            BuildAreaRow(x_area, cn, area_table);
+            break;
+    }
+
+    const uint32_t rows  = op.height;
+    const uint32_t grain = std::max(4U, 65536U / std::max(1U, op.width * cn * ts));
+    ParallelFor(input.GetNumber() * rows, grain, [&](uint32_t begin, uint32_t end) {
+        // a chunk may cross images, rows of every image run with their own ring
+        while (begin < end) {
+            const uint32_t n = begin / rows, y0 = begin % rows;
+            const uint32_t y1 = std::min(rows, y0 + (end - begin));
+            ImagePlane src[IMAGE_MAX_PLANES], dst[IMAGE_MAX_PLANES];
+            input.GetPlanes(n, src);
+            out.GetPlanes(n, dst);
+            if (type == M_INTER_NEAREST) {
+                NearestRows(src[p], dst[p], xofs, ysrc, y0, y1);
+            } else if (type == M_INTER_LINEAR && ts == 1) {
+                LinearRows<uint8_t, int32_t>(src[p], dst[p], row_table, y_linear, y0, y1);
+            } else if (type == M_INTER_LINEAR) {
+                LinearRows<float, float>(src[p], dst[p], row_table, y_linear, y0, y1);
+            } else if (ts == 1) {
+                AreaRows<uint8_t>(src[p], dst[p], area_table, y_area, y0, y1);
+            } else {
+                AreaRows<float>(src[p], dst[p], area_table, y_area, y0, y1);
+            }
+            begin += y1 - y0;
+        }
+    });
+}
+
+MStatus resize(const Image& input,
+               const uint32_t width,
+               const uint32_t height,
+               Image& out,
+               const InterpolationType type) {
+    if (nullptr == input.GetData<void>() || &input == &out ||
+        input.GetData<void>() == out.GetData<void>()) {
+        SIMPLE_LOG_ERROR("resize failed, input image is empty or same as out");
+        return MStatus::M_INVALID_ARG;
+    }
+    const PixelFormat format = input.GetPixelFormat();
+    const bool yuv           = IsYuv420(format);
+    if (!IsResizeFormat(format) || type >= M_INTER_MAX || width == 0 || height == 0 ||
+        input.GetMemType() != M_MEM_ON_CPU ||
+        (yuv && (width % 2 != 0 || height % 2 != 0 || input.GetWidth() % 2 != 0 ||
+                 input.GetHeight() % 2 != 0))) {
+        SIMPLE_LOG_ERROR("resize can't support %s [%u x %u] to [%u x %u], interpolation %i",
+                         input.GetPixelFormatStr().c_str(),
+                         input.GetWidth(),
+                         input.GetHeight(),
+                         width,
+                         height,
+                         static_cast<int>(type));
+        return MStatus::M_NOT_SUPPORT;
+    }
+
+    if (nullptr == out.GetData<void>() || out.GetWidth() != width || out.GetHeight() != height ||
+        out.GetNumber() != input.GetNumber() || out.GetPixelFormat() != format) {
+        out = Image(width, height, input.GetNumber(), format, input.GetTimestamp(), M_MEM_ON_CPU);
+        if (nullptr == out.GetData<void>()) {
+            SIMPLE_LOG_ERROR("resize failed, malloc [%u x %u] failed", width, height);
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+    }
+    input.GetDataManager()->SyncCache(false);
+
+    ImagePlane planes[IMAGE_MAX_PLANES];
+    const uint32_t count = input.GetPlanes(0, planes);
+    for (uint32_t p = 0; p < count; ++p) {
+        ResizePlanes(input, out, p, type);
+    }
+    out.GetDataManager()->SyncCache(true);
+    return MStatus::M_OK;
+}
+
+} // namespace base
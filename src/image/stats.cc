@@ -0,0 +1,367 @@
+#include "image/stats.h"
+
+#include "intrinsic.h"
+#include "manager/pipe_manager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <string.h>
+
+namespace base {
+
+// values of a block, channel of lane l is l % channel for 1, 3 and 4 channels
+#define STATS_LANES_U8 48U
+#define STATS_LANES_F32 24U
+// blocks summed in 16 bits or fp32 lanes before flushed into doubles
+#define STATS_SEGMENT 256U
+// sub-histograms of consecutive pixels
+#define HIST_SUB 4U
+// values of a band of rows taken by a worker at least
+#define STATS_GRAIN (1U << 14)
+
+/// moments of every lane of a block of one plane
+typedef struct StatsLanes {
+    double count[STATS_LANES_U8]; ///< values of lane
+    double mean[STATS_LANES_U8];  ///< mean of values
+    double m2[STATS_LANES_U8];    ///< sum of squared deviations from mean
+    double min[STATS_LANES_U8];
+    double max[STATS_LANES_U8];
+} StatsLanes;
+
+static void InitLanes(StatsLanes& lanes) {
+    for (uint32_t l = 0; l < STATS_LANES_U8; ++l) {
+        lanes.count[l] = 0.0;
+        lanes.mean[l]  = 0.0;
+        lanes.m2[l]    = 0.0;
+        lanes.min[l]   = std::numeric_limits<double>::infinity();
+        lanes.max[l]   = -std::numeric_limits<double>::infinity();
+    }
+}
+
+/// merge moments of n values into lane l by Chan's formula, no sums of squares cancel
+static inline void MergeMoments(StatsLanes& lanes,
+                                const uint32_t l,
+                                const double n,
+                                const double mean,
+                                const double m2) {
+    if (n <= 0.0) {
+        return;
+    }
+    const double count = lanes.count[l] + n, delta = mean - lanes.mean[l];
+    lanes.mean[l] += delta * n / count;
+    lanes.m2[l] += std::max(m2, 0.0) + delta * delta * lanes.count[l] * n / count;
+    lanes.count[l] = count;
+}
+
+static inline void AddValue(StatsLanes& lanes, const uint32_t l, const double v) {
+    MergeMoments(lanes, l, 1.0, v, 0.0);
+    lanes.min[l] = std::min(lanes.min[l], v);
+    lanes.max[l] = std::max(lanes.max[l], v);
+}
+
+static void StatsRowU8(const uint8_t* row, const uint32_t n, StatsLanes& lanes) {
+    uint32_t i = 0;
+#ifdef USE_AVX
+    const __m256i even = _mm256_set1_epi32(0x0000FFFF);
+    while (i + STATS_LANES_U8 <= n) {
+        const uint32_t blocks = std::min((n - i) / STATS_LANES_U8, STATS_SEGMENT);
+        __m256i sum[3], sq_even[3], sq_odd[3];
+        __m128i vmin[3], vmax[3];
+        for (uint32_t k = 0; k < 3; ++k) {
+            sum[k]     = _mm256_setzero_si256();
+            sq_even[k] = _mm256_setzero_si256();
+            sq_odd[k]  = _mm256_setzero_si256();
+            vmin[k]    = _mm_set1_epi8(static_cast<char>(0xFF));
+            vmax[k]    = _mm_setzero_si128();
+        }
+        for (uint32_t b = 0; b < blocks; ++b, i += STATS_LANES_U8) {
+            for (uint32_t k = 0; k < 3; ++k) {
+                const __m128i v8 = _mm_loadu_si128((const __m128i*)(row + i + 16 * k));
+                const __m256i v  = _mm256_cvtepu8_epi16(v8);
+                vmin[k]          = _mm_min_epu8(vmin[k], v8);
+                vmax[k]          = _mm_max_epu8(vmax[k], v8);
+                sum[k]           = _mm256_add_epi16(sum[k], v);
+                sq_even[k] =
+                    _mm256_add_epi32(sq_even[k], _mm256_madd_epi16(v, _mm256_and_si256(v, even)));
+                sq_odd[k] =
+                    _mm256_add_epi32(sq_odd[k], _mm256_madd_epi16(v, _mm256_andnot_si256(even, v)));
+            }
+        }
+        for (uint32_t k = 0; k < 3; ++k) {
+            uint16_t s[16];
+            int32_t e[8], o[8];
+            uint8_t lo[16], hi[16];
+            _mm256_storeu_si256((__m256i*)s, sum[k]);
+            _mm256_storeu_si256((__m256i*)e, sq_even[k]);
+            _mm256_storeu_si256((__m256i*)o, sq_odd[k]);
+            _mm_storeu_si128((__m128i*)lo, vmin[k]);
+            _mm_storeu_si128((__m128i*)hi, vmax[k]);
+            // sums of a segment are exact integers, its moments are taken in double
+            for (uint32_t j = 0; j < 16; ++j) {
+                const uint32_t l  = 16 * k + j;
+                const double sum  = s[j];
+                const double mean = sum / blocks;
+                MergeMoments(lanes, l, blocks, mean, ((j & 1) ? o[j / 2] : e[j / 2]) - sum * mean);
+                lanes.min[l] = std::min(lanes.min[l], static_cast<double>(lo[j]));
+                lanes.max[l] = std::max(lanes.max[l], static_cast<double>(hi[j]));
+            }
+        }
+    }
+#endif
+    for (uint32_t l = i % STATS_LANES_U8; i < n; ++i) {
+        AddValue(lanes, l, row[i]);
+        l = l + 1 == STATS_LANES_U8 ? 0 : l + 1;
+    }
+}
+
+template <typename T>
+static inline float ToFloat(const T v);
+
+template <>
+inline float ToFloat<float>(const float v) {
+    return v;
+}
+
+template <>
+inline float ToFloat<uint16_t>(const uint16_t v) {
+    return fp16_to_fp32(v);
+}
+
+#ifdef USE_AVX
+template <typename T>
+static inline __m256 Load8(const T* p);
+
+template <>
+inline __m256 Load8<float>(const float* p) {
+    return _mm256_loadu_ps(p);
+}
+
+template <>
+inline __m256 Load8<uint16_t>(const uint16_t* p) {
+    return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)p));
+}
+#endif
+
+template <typename T>
+static void StatsRowF32(const T* row, const uint32_t n, StatsLanes& lanes) {
+    uint32_t i = 0;
+#ifdef USE_AVX
+    while (i + STATS_LANES_F32 <= n) {
+        const uint32_t blocks = std::min((n - i) / STATS_LANES_F32, STATS_SEGMENT);
+        // values are summed as differences to the first block, so squares of large means
+        // don't take the bits of fp32
+        __m256 shift[3], sum[3], sq[3], vmin[3], vmax[3];
+        for (uint32_t k = 0; k < 3; ++k) {
+            shift[k] = Load8<T>(row + i + 8 * k);
+            sum[k]   = _mm256_setzero_ps();
+            sq[k]    = _mm256_setzero_ps();
+            vmin[k]  = _mm256_set1_ps(std::numeric_limits<float>::infinity());
+            vmax[k]  = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+        }
+        for (uint32_t b = 0; b < blocks; ++b, i += STATS_LANES_F32) {
+            for (uint32_t k = 0; k < 3; ++k) {
+                const __m256 v = Load8<T>(row + i + 8 * k);
+                const __m256 d = _mm256_sub_ps(v, shift[k]);
+                sum[k]         = _mm256_add_ps(sum[k], d);
+                sq[k]          = _mm256_fmadd_ps(d, d, sq[k]);
+                vmin[k]        = _mm256_min_ps(vmin[k], v);
+                vmax[k]        = _mm256_max_ps(vmax[k], v);
+            }
+        }
+        for (uint32_t k = 0; k < 3; ++k) {
+            float base[8], s[8], q[8], lo[8], hi[8];
+            _mm256_storeu_ps(base, shift[k]);
+            _mm256_storeu_ps(s, sum[k]);
+            _mm256_storeu_ps(q, sq[k]);
+            _mm256_storeu_ps(lo, vmin[k]);
+            _mm256_storeu_ps(hi, vmax[k]);
+            for (uint32_t j = 0; j < 8; ++j) {
+                const uint32_t l  = 8 * k + j;
+                const double mean = base[j] + 1.0 * s[j] / blocks;
+                MergeMoments(lanes, l, blocks, mean, q[j] - 1.0 * s[j] * s[j] / blocks);
+                lanes.min[l] = std::min(lanes.min[l], static_cast<double>(lo[j]));
+                lanes.max[l] = std::max(lanes.max[l], static_cast<double>(hi[j]));
+            }
+        }
+    }
+#endif
+    for (uint32_t l = i % STATS_LANES_F32; i < n; ++i) {
+        AddValue(lanes, l, ToFloat<T>(row[i]));
+        l = l + 1 == STATS_LANES_F32 ? 0 : l + 1;
+    }
+}
+
+static bool IsStatsFormat(const PixelFormat format) {
+    switch (format) {
+        case M_PIX_FMT_GRAY8:
+        case M_PIX_FMT_BGR888:
+        case M_PIX_FMT_RGB888:
+        case M_PIX_FMT_BGRA8888:
+        case M_PIX_FMT_RGBA8888:
+        case M_PIX_FMT_BGR888_PLANAR:
+        case M_PIX_FMT_RGB888_PLANAR:
+        case M_PIX_FMT_GRAY16:
+        case M_PIX_FMT_BGR161616:
+        case M_PIX_FMT_RGB161616:
+        case M_PIX_FMT_BGR161616_PLANAR:
+        case M_PIX_FMT_RGB161616_PLANAR:
+        case M_PIX_FMT_GRAY32:
+        case M_PIX_FMT_BGR323232:
+        case M_PIX_FMT_RGB323232:
+        case M_PIX_FMT_BGR323232_PLANAR:
+        case M_PIX_FMT_RGB323232_PLANAR:
+        case M_PIX_FMT_FLOAT32C4:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// rows of all planes of all images, a unit is row y of plane p of image n
+typedef struct StatsRows {
+    uint32_t planes;  ///< planes of an image
+    uint32_t height;  ///< rows of a plane
+    uint32_t total;   ///< rows of all planes of all images
+    uint32_t grain;   ///< rows of a band at least
+} StatsRows;
+
+static bool CheckStatsInput(const Image& input,
+                            const bool hist,
+                            StatsRows& rows,
+                            const char* name) {
+    ImagePlane planes[IMAGE_MAX_PLANES];
+    const uint32_t count = nullptr == input.GetData<void>() ? 0U : input.GetPlanes(0, planes);
+    if (0U == count || input.GetMemType() != M_MEM_ON_CPU ||
+        !IsStatsFormat(input.GetPixelFormat()) || (hist && input.GetTypeSize() != 1U)) {
+        SIMPLE_LOG_ERROR("%s can't support %s",
+                         name,
+                         count ? input.GetPixelFormatStr().c_str() : "empty image");
+        return false;
+    }
+    const uint32_t values = planes[0].width * planes[0].channel;
+    rows.planes           = count;
+    rows.height           = planes[0].height;
+    rows.total            = input.GetNumber() * count * rows.height;
+    rows.grain            = std::max(1U, STATS_GRAIN / std::max(values, 1U));
+    input.GetDataManager()->SyncCache(false);
+    return true;
+}
+
+MStatus image_stats(const Image& input, ImageStats& stats) {
+    StatsRows rows;
+    if (!CheckStatsInput(input, false, rows, "image_stats")) {
+        return MStatus::M_NOT_SUPPORT;
+    }
+
+    // lanes of every plane, reduced over bands
+    StatsLanes total[IMAGE_MAX_PLANES];
+    for (uint32_t p = 0; p < IMAGE_MAX_PLANES; ++p) {
+        InitLanes(total[p]);
+    }
+    std::mutex mutex;
+    ParallelFor(rows.total, rows.grain, [&](uint32_t begin, uint32_t end) {
+        StatsLanes lanes[IMAGE_MAX_PLANES];
+        for (uint32_t p = 0; p < rows.planes; ++p) {
+            InitLanes(lanes[p]);
+        }
+        ImagePlane planes[IMAGE_MAX_PLANES];
+        for (uint32_t u = begin; u < end; ++u) {
+            const uint32_t n = u / (rows.planes * rows.height);
+            const uint32_t p = u / rows.height % rows.planes, y = u % rows.height;
+            input.GetPlanes(n, planes);
+            const uint8_t* row = planes[p].data + static_cast<size_t>(y) * planes[p].pitch;
+            const uint32_t count = planes[p].width * planes[p].channel;
+            if (planes[p].type_size == 1U) {
+                StatsRowU8(row, count, lanes[p]);
+            } else if (planes[p].type_size == 2U) {
+                StatsRowF32(reinterpret_cast<const uint16_t*>(row), count, lanes[p]);
+            } else {
+                StatsRowF32(reinterpret_cast<const float*>(row), count, lanes[p]);
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t p = 0; p < rows.planes; ++p) {
+            for (uint32_t l = 0; l < STATS_LANES_U8; ++l) {
+                MergeMoments(total[p], l, lanes[p].count[l], lanes[p].mean[l], lanes[p].m2[l]);
+                total[p].min[l] = std::min(total[p].min[l], lanes[p].min[l]);
+                total[p].max[l] = std::max(total[p].max[l], lanes[p].max[l]);
+            }
+        }
+    });
+
+    // lane l of packed plane is channel l % channel, planes of planar formats are channels,
+    // lane c of channels takes all lanes of channel c
+    ImageStats result;
+    const uint32_t channel = input.GetChannel();
+    StatsLanes channels;
+    InitLanes(channels);
+    for (uint32_t p = 0; p < rows.planes; ++p) {
+        for (uint32_t l = 0; l < STATS_LANES_U8; ++l) {
+            const uint32_t c = rows.planes > 1U ? p : l % channel;
+            MergeMoments(channels, c, total[p].count[l], total[p].mean[l], total[p].m2[l]);
+            channels.min[c] = std::min(channels.min[c], total[p].min[l]);
+            channels.max[c] = std::max(channels.max[c], total[p].max[l]);
+        }
+    }
+    result.channel = channel;
+    result.count   = static_cast<uint64_t>(input.GetWidth()) * input.GetHeight() *
+                   input.GetNumber();
+    for (uint32_t c = 0; c < channel; ++c) {
+        result.mean[c]   = channels.mean[c];
+        result.stddev[c] = std::sqrt(channels.m2[c] / result.count);
+        result.min[c]    = channels.min[c];
+        result.max[c]    = channels.max[c];
+    }
+    stats = result;
+    return MStatus::M_OK;
+}
+
+MStatus image_histogram(const Image& input, std::vector<uint32_t>& hist) {
+    StatsRows rows;
+    if (!CheckStatsInput(input, true, rows, "image_histogram")) {
+        return MStatus::M_NOT_SUPPORT;
+    }
+    const uint32_t channel = input.GetChannel();
+    hist.assign(channel * IMAGE_HIST_BINS, 0U);
+    std::mutex mutex;
+    ParallelFor(rows.total, rows.grain, [&](uint32_t begin, uint32_t end) {
+        // sub-histogram s of channel c takes pixels x % HIST_SUB == s
+        uint32_t sub[HIST_SUB][IMAGE_STATS_MAX_CHANNEL][IMAGE_HIST_BINS];
+        memset(sub, 0, sizeof(sub));
+        ImagePlane planes[IMAGE_MAX_PLANES];
+        for (uint32_t u = begin; u < end; ++u) {
+            const uint32_t n = u / (rows.planes * rows.height);
+            const uint32_t p = u / rows.height % rows.planes, y = u % rows.height;
+            input.GetPlanes(n, planes);
+            const uint8_t* row = planes[p].data + static_cast<size_t>(y) * planes[p].pitch;
+            const uint32_t cn = planes[p].channel, width = planes[p].width;
+            uint32_t x        = 0;
+            for (; x + HIST_SUB <= width; x += HIST_SUB) {
+                for (uint32_t c = 0; c < cn; ++c) {
+                    const uint32_t hc = rows.planes > 1U ? p : c;
+                    sub[0][hc][row[x * cn + c]]++;
+                    sub[1][hc][row[(x + 1) * cn + c]]++;
+                    sub[2][hc][row[(x + 2) * cn + c]]++;
+                    sub[3][hc][row[(x + 3) * cn + c]]++;
+                }
+            }
+            for (; x < width; ++x) {
+                for (uint32_t c = 0; c < cn; ++c) {
+                    sub[0][rows.planes > 1U ? p : c][row[x * cn + c]]++;
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        for (uint32_t c = 0; c < channel; ++c) {
+            uint32_t* dst = hist.data() + c * IMAGE_HIST_BINS;
+            for (uint32_t b = 0; b < IMAGE_HIST_BINS; ++b) {
+                dst[b] += sub[0][c][b] + sub[1][c][b] + sub[2][c][b] + sub[3][c][b];
+            }
+        }
+    });
+    return MStatus::M_OK;
+}
+
+} // namespace base
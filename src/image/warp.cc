@@ -0,0 +1,468 @@
+#include "image/warp.h"
+
+#include "intrinsic.h"
+#include "manager/data_manager.h"
+#include "manager/pipe_manager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+#include <vector>
+
+namespace base {
+
+// bits of fraction of source coordinates, bilinear weights are 2 * WARP_BITS bits
+#define WARP_BITS 5
+#define WARP_ONE (1 << WARP_BITS)
+// bits of fraction of affine coordinates stepping along a row
+#define WARP_AB_BITS 10
+#define WARP_AB_ONE (1 << WARP_AB_BITS)
+#define WARP_AB_ROUND (1 << (WARP_AB_BITS - WARP_BITS - 1))
+// coordinates are clamped far out of any image, sums of them stay in int32
+#define WARP_LIMIT (1 << 28)
+// pixels of a tile of out
+#define WARP_TILE_W 64U
+#define WARP_TILE_H 16U
+
+static bool IsWarpFormat(const PixelFormat format) {
+    switch (format) {
+        case M_PIX_FMT_GRAY8:
+        case M_PIX_FMT_BGR888:
+        case M_PIX_FMT_RGB888:
+        case M_PIX_FMT_BGRA8888:
+        case M_PIX_FMT_RGBA8888:
+        case M_PIX_FMT_BGR888_PLANAR:
+        case M_PIX_FMT_RGB888_PLANAR:
+        case M_PIX_FMT_GRAY32:
+        case M_PIX_FMT_BGR323232:
+        case M_PIX_FMT_RGB323232:
+        case M_PIX_FMT_BGR323232_PLANAR:
+        case M_PIX_FMT_RGB323232_PLANAR:
+        case M_PIX_FMT_FLOAT32C4:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/// map of out to input and tables shared by all tiles
+typedef struct WarpMap {
+    float m[9];                  ///< out to input of row major 3 x 3
+    bool perspective;            ///< affine without
+    std::vector<int32_t> adelta; ///< m[0] * x of every column in 1 / WARP_AB_ONE pixel
+    std::vector<int32_t> bdelta; ///< m[3] * x of every column in 1 / WARP_AB_ONE pixel
+} WarpMap;
+
+static inline int32_t Saturate(const double v) {
+    return static_cast<int32_t>(std::lround(std::min(std::max(v, -1.0 * WARP_LIMIT),
+                                                     1.0 * WARP_LIMIT)));
+}
+
+/// source coordinates of columns [x0, x0 + count) of row y in 1 / WARP_ONE pixel
+static void AffineRow(const WarpMap& map,
+                      const uint32_t x0,
+                      const uint32_t count,
+                      const uint32_t y,
+                      int32_t* sx,
+                      int32_t* sy) {
+    const int32_t bx = Saturate((1.0 * map.m[1] * y + map.m[2]) * WARP_AB_ONE) + WARP_AB_ROUND;
+    const int32_t by = Saturate((1.0 * map.m[4] * y + map.m[5]) * WARP_AB_ONE) + WARP_AB_ROUND;
+    const int32_t* a = map.adelta.data() + x0;
+    const int32_t* b = map.bdelta.data() + x0;
+    uint32_t j       = 0;
+#ifdef USE_AVX
+    const __m256i vx = _mm256_set1_epi32(bx), vy = _mm256_set1_epi32(by);
+    for (; j + 8 <= count; j += 8) {
+        const __m256i ax = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(a + j)), vx);
+        const __m256i ay = _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(b + j)), vy);
+        _mm256_storeu_si256((__m256i*)(sx + j), _mm256_srai_epi32(ax, WARP_AB_BITS - WARP_BITS));
+        _mm256_storeu_si256((__m256i*)(sy + j), _mm256_srai_epi32(ay, WARP_AB_BITS - WARP_BITS));
+    }
+#endif
+    for (; j < count; ++j) {
+        sx[j] = (a[j] + bx) >> (WARP_AB_BITS - WARP_BITS);
+        sy[j] = (b[j] + by) >> (WARP_AB_BITS - WARP_BITS);
+    }
+}
+
+static inline int32_t PerspectiveCoord(const float v) {
+    const float limit = static_cast<float>(WARP_LIMIT);
+    return static_cast<int32_t>(std::lrint(v > -limit ? (v < limit ? v : limit) : -limit));
+}
+
+/// source coordinates of columns [x0, x0 + count) of row y in 1 / WARP_ONE pixel
+static void PerspectiveRow(const WarpMap& map,
+                           const uint32_t x0,
+                           const uint32_t count,
+                           const uint32_t y,
+                           int32_t* sx,
+                           int32_t* sy) {
+    const float* m = map.m;
+    const float bx = m[1] * y + m[2], by = m[4] * y + m[5], bw = m[7] * y + m[8];
+    uint32_t j     = 0;
+#ifdef USE_AVX
+    const __m256 limit = _mm256_set1_ps(static_cast<float>(WARP_LIMIT));
+    const __m256 low   = _mm256_set1_ps(-static_cast<float>(WARP_LIMIT));
+    const __m256 one   = _mm256_set1_ps(static_cast<float>(WARP_ONE));
+    const __m256 step  = _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f);
+    for (; j + 8 <= count; j += 8) {
+        const __m256 x = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x0 + j)), step);
+        const __m256 w = _mm256_fmadd_ps(_mm256_set1_ps(m[6]), x, _mm256_set1_ps(bw));
+        // zero divisor takes the border, far out of image
+        const __m256 valid = _mm256_cmp_ps(w, _mm256_setzero_ps(), _CMP_NEQ_OQ);
+        const __m256 s     = _mm256_div_ps(one, w);
+        __m256 fx = _mm256_mul_ps(_mm256_fmadd_ps(_mm256_set1_ps(m[0]), x, _mm256_set1_ps(bx)), s);
+        __m256 fy = _mm256_mul_ps(_mm256_fmadd_ps(_mm256_set1_ps(m[3]), x, _mm256_set1_ps(by)), s);
+        fx        = _mm256_max_ps(_mm256_min_ps(_mm256_blendv_ps(low, fx, valid), limit), low);
+        fy        = _mm256_max_ps(_mm256_min_ps(_mm256_blendv_ps(low, fy, valid), limit), low);
+        _mm256_storeu_si256((__m256i*)(sx + j), _mm256_cvtps_epi32(fx));
+        _mm256_storeu_si256((__m256i*)(sy + j), _mm256_cvtps_epi32(fy));
+    }
+#endif
+    for (; j < count; ++j) {
+        const float x = static_cast<float>(x0 + j);
+        const float w = m[6] * x + bw;
+        if (w == 0.f) {
+            sx[j] = sy[j] = -WARP_LIMIT;
+            continue;
+        }
+        const float s = WARP_ONE / w;
+        sx[j]         = PerspectiveCoord((m[0] * x + bx) * s);
+        sy[j]         = PerspectiveCoord((m[3] * x + by) * s);
+    }
+}
+
+/// pixel (x, y) of plane, pixels out of plane are the border
+static inline const uint8_t* Tap(const ImagePlane& src,
+                                 int32_t x,
+                                 int32_t y,
+                                 const BorderType border,
+                                 const uint8_t* value) {
+    const int32_t w = static_cast<int32_t>(src.width), h = static_cast<int32_t>(src.height);
+    if (x < 0 || y < 0 || x >= w || y >= h) {
+        if (border == M_BORDER_CONSTANT) {
+            return value;
+        }
+        x = std::min(std::max(x, 0), w - 1);
+        y = std::min(std::max(y, 0), h - 1);
+    }
+    return src.data + static_cast<size_t>(y) * src.pitch + x * src.channel * src.type_size;
+}
+
+static void NearestBlock(const ImagePlane& src,
+                         const int32_t* sx,
+                         const int32_t* sy,
+                         const uint32_t count,
+                         const BorderType border,
+                         const uint8_t* value,
+                         uint8_t* dst) {
+    const uint32_t bytes = src.channel * src.type_size;
+    for (uint32_t k = 0; k < count; ++k, dst += bytes) {
+        const uint8_t* p = Tap(src,
+                               (sx[k] + WARP_ONE / 2) >> WARP_BITS,
+                               (sy[k] + WARP_ONE / 2) >> WARP_BITS,
+                               border,
+                               value);
+        switch (bytes) {
+            case 1U:
+                dst[0] = p[0];
+                break;
+            case 3U:
+                dst[0] = p[0];
+                dst[1] = p[1];
+                dst[2] = p[2];
+                break;
+            default:
+                memcpy(dst, p, bytes);
+                break;
+        }
+    }
+}
+
+/// blend n channels, top and bottom hold the left and right taps of a channel side by side
+static void BlendU8(const uint8_t* top,
+                    const uint8_t* bottom,
+                    const int32_t* wtop,
+                    const int32_t* wbottom,
+                    const uint32_t n,
+                    uint8_t* dst) {
+    const int32_t half = 1 << (2 * WARP_BITS - 1);
+    uint32_t j         = 0;
+#ifdef USE_AVX
+    const __m256i vhalf = _mm256_set1_epi32(half);
+    auto Blend8         = [&](const uint32_t i) {
+        const __m256i t = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(top + 2 * i)));
+        const __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(bottom + 2 * i)));
+        const __m256i s = _mm256_add_epi32(
+            _mm256_madd_epi16(t, _mm256_loadu_si256((const __m256i*)(wtop + i))),
+            _mm256_madd_epi16(b, _mm256_loadu_si256((const __m256i*)(wbottom + i))));
+        return _mm256_srai_epi32(_mm256_add_epi32(s, vhalf), 2 * WARP_BITS);
+    };
+    for (; j + 16 <= n; j += 16) {
+        const __m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi32(Blend8(j), Blend8(j + 8)),
+                                                   0xD8);
+        _mm_storeu_si128(
+            (__m128i*)(dst + j),
+            _mm_packus_epi16(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+    }
+#endif
+    for (; j < n; ++j) {
+        const int32_t s = top[2 * j] * (wtop[j] & 0xFFFF) + top[2 * j + 1] * (wtop[j] >> 16) +
+                          bottom[2 * j] * (wbottom[j] & 0xFFFF) +
+                          bottom[2 * j + 1] * (wbottom[j] >> 16);
+        dst[j] = static_cast<uint8_t>((s + half) >> (2 * WARP_BITS));
+    }
+}
+
+static void LinearBlockU8(const ImagePlane& src,
+                          const int32_t* sx,
+                          const int32_t* sy,
+                          const uint32_t count,
+                          const BorderType border,
+                          const uint8_t* value,
+                          uint8_t* dst) {
+    // taps of a block are copied side by side, blending needs no gather
+    uint8_t top[2 * WARP_TILE_W * 4], bottom[2 * WARP_TILE_W * 4];
+    int32_t wtop[WARP_TILE_W * 4], wbottom[WARP_TILE_W * 4];
+    const uint32_t cn = src.channel, pitch = src.pitch;
+    const int32_t w1 = static_cast<int32_t>(src.width) - 1;
+    const int32_t h1 = static_cast<int32_t>(src.height) - 1;
+    uint32_t e       = 0;
+    for (uint32_t k = 0; k < count; ++k) {
+        const int32_t x = sx[k] >> WARP_BITS, y = sy[k] >> WARP_BITS;
+        const int32_t fx = sx[k] & (WARP_ONE - 1), fy = sy[k] & (WARP_ONE - 1);
+        const int32_t wt = ((WARP_ONE - fx) * (WARP_ONE - fy)) | ((fx * (WARP_ONE - fy)) << 16);
+        const int32_t wb = ((WARP_ONE - fx) * fy) | ((fx * fy) << 16);
+        const uint8_t *p0, *p1, *q0, *q1;
+        if (x >= 0 && y >= 0 && x < w1 && y < h1) {
+            p0 = src.data + static_cast<size_t>(y) * pitch + x * cn;
+            p1 = p0 + cn;
+            q0 = p0 + pitch;
+            q1 = q0 + cn;
+        } else {
+            p0 = Tap(src, x, y, border, value);
+            p1 = Tap(src, x + 1, y, border, value);
+            q0 = Tap(src, x, y + 1, border, value);
+            q1 = Tap(src, x + 1, y + 1, border, value);
+        }
+        for (uint32_t c = 0; c < cn; ++c, ++e) {
+            top[2 * e]        = p0[c];
+            top[2 * e + 1]    = p1[c];
+            bottom[2 * e]     = q0[c];
+            bottom[2 * e + 1] = q1[c];
+            wtop[e]           = wt;
+            wbottom[e]        = wb;
+        }
+    }
+    BlendU8(top, bottom, wtop, wbottom, e, dst);
+}
+
+static void LinearBlockF32(const ImagePlane& src,
+                           const int32_t* sx,
+                           const int32_t* sy,
+                           const uint32_t count,
+                           const BorderType border,
+                           const uint8_t* value,
+                           float* dst) {
+    const uint32_t cn = src.channel;
+    const float scale = 1.f / WARP_ONE;
+    for (uint32_t k = 0; k < count; ++k, dst += cn) {
+        const int32_t x = sx[k] >> WARP_BITS, y = sy[k] >> WARP_BITS;
+        const float fx = (sx[k] & (WARP_ONE - 1)) * scale, fy = (sy[k] & (WARP_ONE - 1)) * scale;
+        const float* p0 = reinterpret_cast<const float*>(Tap(src, x, y, border, value));
+        const float* p1 = reinterpret_cast<const float*>(Tap(src, x + 1, y, border, value));
+        const float* q0 = reinterpret_cast<const float*>(Tap(src, x, y + 1, border, value));
+        const float* q1 = reinterpret_cast<const float*>(Tap(src, x + 1, y + 1, border, value));
+        for (uint32_t c = 0; c < cn; ++c) {
+            const float t = p0[c] + (p1[c] - p0[c]) * fx;
+            const float b = q0[c] + (q1[c] - q0[c]) * fx;
+            dst[c]        = t + (b - t) * fy;
+        }
+    }
+}
+
+/// tile (tx, ty) of image n, planes share the coordinates of a row
+static void WarpTile(const Image& input,
+                     Image& out,
+                     const WarpMap& map,
+                     const uint32_t n,
+                     const uint32_t tx,
+                     const uint32_t ty,
+                     const InterpolationType type,
+                     const BorderType border,
+                     const uint8_t* value) {
+    ImagePlane src[IMAGE_MAX_PLANES], dst[IMAGE_MAX_PLANES];
+    const uint32_t count = input.GetPlanes(n, src);
+    out.GetPlanes(n, dst);
+    const uint32_t x0 = tx * WARP_TILE_W, cols = std::min(WARP_TILE_W, out.GetWidth() - x0);
+    const uint32_t y0 = ty * WARP_TILE_H, y1 = std::min(out.GetHeight(), y0 + WARP_TILE_H);
+    int32_t sx[WARP_TILE_W], sy[WARP_TILE_W];
+    for (uint32_t y = y0; y < y1; ++y) {
+        if (map.perspective) {
+            PerspectiveRow(map, x0, cols, y, sx, sy);
+        } else {
+            AffineRow(map, x0, cols, y, sx, sy);
+        }
+        for (uint32_t p = 0; p < count; ++p) {
+            uint8_t* row = dst[p].data + static_cast<size_t>(y) * dst[p].pitch +
+                           x0 * dst[p].channel * dst[p].type_size;
+            if (type == M_INTER_NEAREST) {
+                NearestBlock(src[p], sx, sy, cols, border, value, row);
+            } else if (src[p].type_size == 1U) {
+                LinearBlockU8(src[p], sx, sy, cols, border, value, row);
+            } else {
+                LinearBlockF32(src[p], sx, sy, cols, border, value, reinterpret_cast<float*>(row));
+            }
+        }
+    }
+}
+
+static MStatus Warp(const Image& input,
+                    const double inverse[9],
+                    const bool perspective,
+                    const uint32_t width,
+                    const uint32_t height,
+                    Image& out,
+                    const InterpolationType type,
+                    const BorderType border,
+                    const float value,
+                    const char* name) {
+    const PixelFormat format = input.GetPixelFormat();
+    if (!IsWarpFormat(format) || type > M_INTER_LINEAR || border >= M_BORDER_MAX || width == 0 ||
+        height == 0 || input.GetMemType() != M_MEM_ON_CPU) {
+        SIMPLE_LOG_ERROR("%s can't support %s [%u x %u] to [%u x %u], interpolation %i, "
+                         "border %i",
+                         name,
+                         input.GetPixelFormatStr().c_str(),
+                         input.GetWidth(),
+                         input.GetHeight(),
+                         width,
+                         height,
+                         static_cast<int>(type),
+                         static_cast<int>(border));
+        return MStatus::M_NOT_SUPPORT;
+    }
+
+    if (nullptr == out.GetData<void>() || out.GetWidth() != width || out.GetHeight() != height ||
+        out.GetNumber() != input.GetNumber() || out.GetPixelFormat() != format) {
+        out = Image(width, height, input.GetNumber(), format, input.GetTimestamp(), M_MEM_ON_CPU);
+        if (nullptr == out.GetData<void>()) {
+            SIMPLE_LOG_ERROR("%s failed, malloc [%u x %u] failed", name, width, height);
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+    }
+    input.GetDataManager()->SyncCache(false);
+
+    WarpMap map;
+    map.perspective = perspective;
+    for (uint32_t i = 0; i < 9; ++i) {
+        map.m[i] = static_cast<float>(inverse[i]);
+    }
+    if (!perspective) {
+        map.adelta.resize(width);
+        map.bdelta.resize(width);
+        for (uint32_t x = 0; x < width; ++x) {
+            map.adelta[x] = Saturate(inverse[0] * x * WARP_AB_ONE);
+            map.bdelta[x] = Saturate(inverse[3] * x * WARP_AB_ONE);
+        }
+    }
+    // border pixel of every channel in the type of input
+    uint8_t border_value[4 * sizeof(float)];
+    for (uint32_t c = 0; c < 4; ++c) {
+        if (input.GetTypeSize() == 1U) {
+            border_value[c] = static_cast<uint8_t>(std::min(std::max(value, 0.f), 255.f) + 0.5f);
+        } else {
+            memcpy(border_value + c * sizeof(float), &value, sizeof(float));
+        }
+    }
+
+    const uint32_t tiles_x = (width + WARP_TILE_W - 1) / WARP_TILE_W;
+    const uint32_t tiles   = tiles_x * ((height + WARP_TILE_H - 1) / WARP_TILE_H);
+    ParallelFor(input.GetNumber() * tiles, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t t = begin; t < end; ++t) {
+            const uint32_t n = t / tiles, tile = t % tiles;
+            const uint32_t tx = tile % tiles_x, ty = tile / tiles_x;
+            WarpTile(input, out, map, n, tx, ty, type, border, border_value);
+        }
+    });
+    out.GetDataManager()->SyncCache(true);
+    return MStatus::M_OK;
+}
+
+static bool CheckWarpInput(const Image& input, const Image& out, const char* name) {
+    if (nullptr == input.GetData<void>() || &input == &out ||
+        input.GetData<void>() == out.GetData<void>()) {
+        SIMPLE_LOG_ERROR("%s failed, input image is empty or same as out", name);
+        return false;
+    }
+    return true;
+}
+
+MStatus warp_affine(const Image& input,
+                    const float matrix[6],
+                    const uint32_t width,
+                    const uint32_t height,
+                    Image& out,
+                    const InterpolationType type,
+                    const BorderType border,
+                    const float value) {
+    if (!CheckWarpInput(input, out, "warp_affine") || nullptr == matrix) {
+        return MStatus::M_INVALID_ARG;
+    }
+    const double a = matrix[0], b = matrix[1], c = matrix[2];
+    const double d = matrix[3], e = matrix[4], f = matrix[5];
+    const double det = a * e - b * d;
+    if (det == 0.0 || !std::isfinite(det)) {
+        SIMPLE_LOG_ERROR("warp_affine failed, matrix can't be inverted");
+        return MStatus::M_INVALID_ARG;
+    }
+    const double inverse[9] = {e / det,
+                               -b / det,
+                               (b * f - e * c) / det,
+                               -d / det,
+                               a / det,
+                               (d * c - a * f) / det,
+                               0.0,
+                               0.0,
+                               1.0};
+    return Warp(input, inverse, false, width, height, out, type, border, value, "warp_affine");
+}
+
+MStatus warp_perspective(const Image& input,
+                         const float matrix[9],
+                         const uint32_t width,
+                         const uint32_t height,
+                         Image& out,
+                         const InterpolationType type,
+                         const BorderType border,
+                         const float value) {
+    if (!CheckWarpInput(input, out, "warp_perspective") || nullptr == matrix) {
+        return MStatus::M_INVALID_ARG;
+    }
+    double m[9];
+    for (uint32_t i = 0; i < 9; ++i) {
+        m[i] = matrix[i];
+    }
+    // adjugate over determinant
+    const double inverse[9] = {m[4] * m[8] - m[5] * m[7],
+                               m[2] * m[7] - m[1] * m[8],
+                               m[1] * m[5] - m[2] * m[4],
+                               m[5] * m[6] - m[3] * m[8],
+                               m[0] * m[8] - m[2] * m[6],
+                               m[2] * m[3] - m[0] * m[5],
+                               m[3] * m[7] - m[4] * m[6],
+                               m[1] * m[6] - m[0] * m[7],
+                               m[0] * m[4] - m[1] * m[3]};
+    const double det = m[0] * inverse[0] + m[1] * inverse[3] + m[2] * inverse[6];
+    if (det == 0.0 || !std::isfinite(det)) {
+        SIMPLE_LOG_ERROR("warp_perspective failed, matrix can't be inverted");
+        return MStatus::M_INVALID_ARG;
+    }
+    double scaled[9];
+    for (uint32_t i = 0; i < 9; ++i) {
+        scaled[i] = inverse[i] / det;
+    }
+    return Warp(input, scaled, true, width, height, out, type, border, value, "warp_perspective");
+}
+
+} // namespace base
@@ -1,11 +1,42 @@
 #include "manager/data_manager.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <list>
 #include <mutex>
 #include <sstream>
 #include <vector>
 namespace base {
 
+namespace {
+struct ScratchBuffers {
+    ~ScratchBuffers() {
+        for (uint32_t i = 0; i < SCRATCH_SLOTS; ++i) {
+            fast_free(data[i]);
+        }
+    }
+    void* data[SCRATCH_SLOTS]  = {nullptr};
+    size_t size[SCRATCH_SLOTS] = {0};
+};
+} // namespace
+
+void* GetScratch(const uint32_t slot, const size_t size) {
+    static thread_local ScratchBuffers buffers;
+    if (slot >= SCRATCH_SLOTS) {
+        SIMPLE_LOG_ERROR("scratch slot %u out of range", slot);
+        return nullptr;
+    }
+    if (buffers.size[slot] < size) {
+        fast_free(buffers.data[slot]);
+        buffers.data[slot] = fast_malloc(size);
+        buffers.size[slot] = buffers.data[slot] ? size : 0;
+    }
+    return buffers.data[slot];
+}
+
 void* DataManager::Malloc(const uint32_t size) {
     data_ = static_cast<uint8_t*>(fast_malloc(size));
     size_ = size;
@@ -216,7 +247,10 @@ std::pair<uint32_t, std::shared_ptr<DataManager>> MemoryPool::Allocate(const Mem
     auto type_it = pool_.find(mem_type);
     if (type_it == pool_.end()) {
         SIMPLE_LOG_DEBUG("cache pool for #BlockType_%i is empty", static_cast<int>(mem_type));
-        auto ret        = CreateDataMgr(mem_type, size);
+        auto ret = CreateDataMgr(mem_type, size);
+        if (nullptr == ret.second) {
+            return ret;
+        }
         auto data_block = std::make_shared<DataBlock>(ret.second, true);
         auto id_item    = std::make_pair(ret.first, data_block);
         IdPool id_pool;
@@ -236,7 +270,10 @@ std::pair<uint32_t, std::shared_ptr<DataManager>> MemoryPool::Allocate(const Mem
         SIMPLE_LOG_DEBUG("MemoryType(%i) cache pool for #BlockSize_%i is empty",
                          static_cast<int>(mem_type),
                          size);
-        auto ret        = CreateDataMgr(mem_type, size);
+        auto ret = CreateDataMgr(mem_type, size);
+        if (nullptr == ret.second) {
+            return ret;
+        }
         auto data_block = std::make_shared<DataBlock>(ret.second, true);
         auto id_item    = std::make_pair(ret.first, data_block);
         IdPool id_pool;
@@ -263,7 +300,10 @@ std::pair<uint32_t, std::shared_ptr<DataManager>> MemoryPool::Allocate(const Mem
             }
             return true;
         }()) {
-        auto ret        = CreateDataMgr(mem_type, size);
+        auto ret = CreateDataMgr(mem_type, size);
+        if (nullptr == ret.second) {
+            return ret;
+        }
         auto data_block = std::make_shared<DataBlock>(ret.second, true);
         auto id_item    = std::make_pair(ret.first, data_block);
         size_pool.insert(id_item);
@@ -331,7 +371,7 @@ void MemoryPool::PrintPool() {
 DataMgrCache::~DataMgrCache() {
     // for debug
     // MemoryPool::GetInstance().PrintPool();
-    if (data_manager_->IsOwner()) {
+    if (data_manager_ && data_manager_->IsOwner()) {
         MemoryPool::GetInstance().Release(GetMemType(), size_, id_);
     }
 }
@@ -348,6 +388,10 @@ void* DataMgrCache::Malloc(const uint32_t size) {
     size_         = size;
     id_           = ret.first;
     data_manager_ = ret.second;
+    if (nullptr == data_manager_) {
+        SIMPLE_LOG_ERROR("DataMgrCache::Malloc %u bytes failed, memory pool is full", size);
+        return nullptr;
+    }
 
     // for debug
     // MemoryPool::GetInstance().PrintPool();
@@ -370,4 +414,67 @@ void* DataMgrCache::Setptr(void* ptr, uint32_t size) {
     return data_manager_->Setptr(ptr, size);
 }
 
-} // namespace base
\ No newline at end of file
+SubDataManager::SubDataManager(const std::shared_ptr<DataManager>& parent,
+                               const uint32_t offset,
+                               const uint32_t size)
+    : DataManager(), parent_(parent), offset_(offset), size_(size) {
+    if (nullptr == parent_ || offset_ + size_ > parent_->GetSize()) {
+        SIMPLE_LOG_ERROR("SubDataManager range [%u, %u) out of parent %u",
+                         offset,
+                         offset + size,
+                         parent_ ? parent_->GetSize() : 0U);
+        parent_ = nullptr;
+        size_   = 0U;
+        return;
+    }
+    SetOwer(false);
+    SetMemType(parent_->GetMemTypeStr());
+}
+
+void* SubDataManager::Malloc(const uint32_t size) {
+    SIMPLE_LOG_WARN("can't malloc %u bytes on sub data manager", size);
+    return GetDataPtr();
+}
+
+void* SubDataManager::Setptr(void* ptr, uint32_t size) {
+    SIMPLE_LOG_WARN("can't set %p with %u bytes on sub data manager", ptr, size);
+    return GetDataPtr();
+}
+
+void* SubDataManager::GetDataPtr() const {
+    if (nullptr == parent_) {
+        return nullptr;
+    }
+    return static_cast<uint8_t*>(parent_->GetDataPtr()) + offset_;
+}
+
+MappedFile::~MappedFile() {
+    if (addr_ != nullptr && addr_ != MAP_FAILED) {
+        munmap(addr_, size_);
+    }
+}
+
+MStatus MappedFile::Map(const std::string& path, std::shared_ptr<MappedFile>& file) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        SIMPLE_LOG_ERROR("MappedFile can't open %s", path.c_str());
+        return MStatus::M_FILE_NOT_FOUND;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        SIMPLE_LOG_ERROR("MappedFile %s is empty", path.c_str());
+        return MStatus::M_INVALID_FILE_FORMAT;
+    }
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* addr        = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        SIMPLE_LOG_ERROR("MappedFile mmap %s failed", path.c_str());
+        return MStatus::M_FAILED;
+    }
+    file = std::make_shared<MappedFile>(addr, size);
+    return MStatus::M_OK;
+}
+
+} // namespace base
@@ -0,0 +1,111 @@
+#include "manager/memory_copy.h"
+
+#include "intrinsic.h"
+#include "manager/pipe_manager.h"
+
+#include <string.h>
+
+namespace base {
+
+void StreamCopy(void* dst, const void* src, const size_t size) {
+    uint8_t* d       = static_cast<uint8_t*>(dst);
+    const uint8_t* s = static_cast<const uint8_t*>(src);
+    size_t i         = 0;
+#ifdef USE_AVX
+    // align destination to 32 bytes, non-temporal stores need aligned address
+    const size_t head = (32U - (reinterpret_cast<size_t>(d) & 31U)) & 31U;
+    if (size >= head + 128U) {
+        memcpy(d, s, head);
+        for (i = head; i + 128U <= size; i += 128U) {
+            const __m256i v0 = _mm256_loadu_si256((const __m256i*)(s + i));
+            const __m256i v1 = _mm256_loadu_si256((const __m256i*)(s + i + 32));
+            const __m256i v2 = _mm256_loadu_si256((const __m256i*)(s + i + 64));
+            const __m256i v3 = _mm256_loadu_si256((const __m256i*)(s + i + 96));
+            _mm256_stream_si256((__m256i*)(d + i), v0);
+            _mm256_stream_si256((__m256i*)(d + i + 32), v1);
+            _mm256_stream_si256((__m256i*)(d + i + 64), v2);
+            _mm256_stream_si256((__m256i*)(d + i + 96), v3);
+        }
+        _mm_sfence();
+    }
+#endif
+    memcpy(d + i, s + i, size - i);
+}
+
+void FastCopy(void* dst, const void* src, const size_t size) {
+    if (dst == src || size == 0) {
+        return;
+    }
+    if (size < PARALLEL_COPY_GRAIN) {
+        memcpy(dst, src, size);
+        return;
+    }
+    BatchCopy(std::vector<CopyTask>{CopyTask(dst, src, size)});
+}
+
+void FastCopy2D(void* dst,
+                const size_t dst_pitch,
+                const void* src,
+                const size_t src_pitch,
+                const size_t row_size,
+                const size_t rows) {
+    if (dst_pitch == row_size && src_pitch == row_size) {
+        FastCopy(dst, src, row_size * rows);
+        return;
+    }
+    if (dst == src || row_size == 0 || rows == 0) {
+        return;
+    }
+
+    uint8_t* d           = static_cast<uint8_t*>(dst);
+    const uint8_t* s     = static_cast<const uint8_t*>(src);
+    const bool stream    = row_size * rows >= STREAM_COPY_THRESHOLD;
+    const uint32_t grain = static_cast<uint32_t>(
+        std::max(static_cast<size_t>(1), PARALLEL_COPY_GRAIN / row_size));
+    ParallelFor(static_cast<uint32_t>(rows), grain, [&](uint32_t begin, uint32_t end) {
+        for (size_t r = begin; r < end; ++r) {
+            if (stream) {
+                StreamCopy(d + r * dst_pitch, s + r * src_pitch, row_size);
+            } else {
+                memcpy(d + r * dst_pitch, s + r * src_pitch, row_size);
+            }
+        }
+    });
+}
+
+void BatchCopy(const std::vector<CopyTask>& tasks) {
+    // cut large regions, so every piece is at most one grain
+    std::vector<CopyTask> pieces;
+    size_t total = 0;
+    for (const auto& task : tasks) {
+        if (task.dst == task.src) {
+            continue;
+        }
+        uint8_t* d       = static_cast<uint8_t*>(task.dst);
+        const uint8_t* s = static_cast<const uint8_t*>(task.src);
+        for (size_t offset = 0; offset < task.size; offset += PARALLEL_COPY_GRAIN) {
+            const size_t bytes = std::min(static_cast<size_t>(PARALLEL_COPY_GRAIN), task.size - offset);
+            pieces.emplace_back(d + offset, s + offset, bytes);
+        }
+        total += task.size;
+    }
+    if (pieces.empty()) {
+        return;
+    }
+
+    const bool stream    = total >= STREAM_COPY_THRESHOLD;
+    const uint32_t count = static_cast<uint32_t>(pieces.size());
+    const uint32_t grain = static_cast<uint32_t>(
+        std::max(static_cast<size_t>(1), PARALLEL_COPY_GRAIN * pieces.size() / total));
+    ParallelFor(count, grain, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            if (stream) {
+                StreamCopy(pieces[i].dst, pieces[i].src, pieces[i].size);
+            } else {
+                memcpy(pieces[i].dst, pieces[i].src, pieces[i].size);
+            }
+        }
+    });
+}
+
+} // namespace base
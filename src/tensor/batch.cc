@@ -0,0 +1,313 @@
+#include "tensor/batch.h"
+
+#include "manager/memory_copy.h"
+#include "manager/pipe_manager.h"
+
+#include <string.h>
+
+namespace base {
+
+/// @brief reuse out when it matches, otherwise allocate a new tensor
+static MStatus PrepareOutput(const std::vector<uint32_t>& shape,
+                             const TensorLayout layout,
+                             const DataType elem_type,
+                             const TensorPadding padding,
+                             Tensor& out) {
+    if (out.GetData<void>() != nullptr && out.GetShape() == shape &&
+        out.GetShapeMode() == layout && out.GetElemType() == elem_type) {
+        return MStatus::M_OK;
+    }
+    out = Tensor(shape, layout, M_MEM_ON_CPU, elem_type, padding);
+    if (nullptr == out.GetData<void>()) {
+        SIMPLE_LOG_ERROR("batch output malloc [%u, %u, %u, %u] failed",
+                         shape[0],
+                         shape[1],
+                         shape[2],
+                         shape[3]);
+        return MStatus::M_OUT_OF_MEMORY;
+    }
+    return MStatus::M_OK;
+}
+
+MStatus
+concat(const std::vector<std::shared_ptr<Tensor>>& inputs, const uint32_t axis, Tensor& out) {
+    if (inputs.empty() || axis >= 4) {
+        SIMPLE_LOG_ERROR("concat failed, %zu inputs, axis %u", inputs.size(), axis);
+        return MStatus::M_INVALID_ARG;
+    }
+    for (const auto& input : inputs) {
+        if (nullptr == input || nullptr == input->GetData<void>() ||
+            input->GetShape().size() != 4) {
+            SIMPLE_LOG_ERROR("concat failed, input tensor is empty");
+            return MStatus::M_INVALID_ARG;
+        }
+    }
+
+    const auto& first = inputs[0];
+    if (first->GetChannelBlock() != 1U && axis != 0) {
+        SIMPLE_LOG_ERROR("concat of layout %s only support axis 0",
+                         first->GetShapeModeStr().c_str());
+        return MStatus::M_NOT_SUPPORT;
+    }
+    std::vector<uint32_t> shape = first->GetShape();
+    shape[axis]                 = 0;
+    for (const auto& input : inputs) {
+        shape[axis] += input->GetShape(axis);
+    }
+    for (const auto& input : inputs) {
+        const std::vector<uint32_t> item = input->GetShape();
+        bool same                        = input->GetShapeMode() == first->GetShapeMode();
+        same = same && input->GetElemType() == first->GetElemType();
+        for (uint32_t i = 0; i < 4; ++i) {
+            same = same && (i == axis || item[i] == shape[i]);
+        }
+        if (!same) {
+            SIMPLE_LOG_ERROR("concat failed, %s vs %s",
+                             LogTensor("input", *input).c_str(),
+                             LogTensor("first", *first).c_str());
+            return MStatus::M_INVALID_ARG;
+        }
+    }
+
+    MStatus status = PrepareOutput(
+        shape, first->GetShapeMode(), first->GetElemType(), first->GetPadding(), out);
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+    for (const auto& input : inputs) {
+        input->GetDataManager()->SyncCache(false);
+    }
+
+    // a row is W of NCHW or W * C of NHWC, rows of different tensors may have different pitch
+    const uint32_t row_axis = first->GetShapeMode() == M_LAYOUT_NCHW ? 3 : 2;
+    const size_t row_size   = out.GetRowSize();
+    size_t outer            = 1;
+    for (uint32_t i = 0; i < axis; ++i) {
+        outer *= shape[i];
+    }
+
+    if (axis >= row_axis) {
+        // every row of out is made of segments of input rows
+        size_t segments = 1, inner = first->GetTypeSize();
+        for (uint32_t i = row_axis; i < axis; ++i) {
+            segments *= shape[i];
+        }
+        for (uint32_t i = axis + 1; i < 4; ++i) {
+            inner *= shape[i];
+        }
+        const size_t rows    = static_cast<size_t>(shape[0]) * out.GetRows();
+        const uint32_t grain = static_cast<uint32_t>(
+            std::max(static_cast<size_t>(1), PARALLEL_COPY_GRAIN / row_size));
+        ParallelFor(static_cast<uint32_t>(rows), grain, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t r = begin; r < end; ++r) {
+                uint8_t* dst = out.GetRow<uint8_t>(0, r);
+                for (size_t seg = 0; seg < segments; ++seg) {
+                    for (const auto& input : inputs) {
+                        const size_t chunk = input->GetShape(axis) * inner;
+                        memcpy(dst, input->GetRow<uint8_t>(0, r) + seg * chunk, chunk);
+                        dst += chunk;
+                    }
+                }
+            }
+        });
+        return MStatus::M_OK;
+    }
+
+    // rows stay whole, each input is a block of rows per outer index
+    size_t inner_rows = out.GetRows();
+    for (uint32_t i = 1; i <= axis; ++i) {
+        inner_rows /= shape[i];
+    }
+    if (outer == 1) {
+        bool dense = out.IsDense();
+        for (const auto& input : inputs) {
+            dense = dense && input->IsDense();
+        }
+        std::vector<CopyTask> tasks;
+        size_t offset = 0;
+        for (const auto& input : inputs) {
+            const size_t rows = input->GetShape(axis) * inner_rows;
+            if (dense) {
+                tasks.emplace_back(out.GetRow<uint8_t>(0, offset), input->GetData<void>(0), rows * row_size);
+            } else {
+                FastCopy2D(out.GetRow<uint8_t>(0, offset),
+                           out.GetStride(),
+                           input->GetData<void>(0),
+                           input->GetStride(),
+                           row_size,
+                           rows);
+            }
+            offset += rows;
+        }
+        BatchCopy(tasks);
+        return MStatus::M_OK;
+    }
+
+    const size_t out_rows = shape[axis] * inner_rows;
+    const uint32_t grain  = static_cast<uint32_t>(
+        std::max(static_cast<size_t>(1), PARALLEL_COPY_GRAIN / (out_rows * row_size)));
+    ParallelFor(static_cast<uint32_t>(outer), grain, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t o = begin; o < end; ++o) {
+            size_t offset = o * out_rows;
+            for (const auto& input : inputs) {
+                const size_t rows = input->GetShape(axis) * inner_rows;
+                for (size_t k = 0; k < rows; ++k) {
+                    memcpy(out.GetRow<uint8_t>(0, offset + k),
+                           input->GetRow<uint8_t>(0, o * rows + k),
+                           row_size);
+                }
+                offset += rows;
+            }
+        }
+    });
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor> concat(const std::vector<std::shared_ptr<Tensor>>& inputs,
+                               const uint32_t axis) {
+    auto out = std::make_shared<Tensor>();
+    if (nullptr == out || concat(inputs, axis, *out) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return out;
+}
+
+MStatus stack(const std::vector<std::shared_ptr<Tensor>>& inputs, Tensor& out) {
+    return concat(inputs, 0, out);
+}
+
+std::shared_ptr<Tensor> stack(const std::vector<std::shared_ptr<Tensor>>& inputs) {
+    return concat(inputs, 0);
+}
+
+MStatus stack(const std::vector<std::shared_ptr<Image>>& images, Tensor& out) {
+    if (images.empty() || nullptr == images[0] || nullptr == images[0]->GetData<void>()) {
+        SIMPLE_LOG_ERROR("stack images failed, input image is empty");
+        return MStatus::M_INVALID_ARG;
+    }
+    const auto& first = images[0];
+
+    TensorLayout layout = M_LAYOUT_NHWC;
+    switch (first->GetPixelFormat()) {
+        case M_PIX_FMT_GRAY8:
+        case M_PIX_FMT_GRAY16:
+        case M_PIX_FMT_GRAY32:
+        case M_PIX_FMT_RGB888:
+        case M_PIX_FMT_BGR888:
+        case M_PIX_FMT_RGBA8888:
+        case M_PIX_FMT_BGRA8888:
+        case M_PIX_FMT_RGB161616:
+        case M_PIX_FMT_BGR161616:
+        case M_PIX_FMT_RGB323232:
+        case M_PIX_FMT_BGR323232:
+        case M_PIX_FMT_FLOAT32C4:
+            layout = M_LAYOUT_NHWC;
+            break;
+        case M_PIX_FMT_RGB888_PLANAR:
+        case M_PIX_FMT_BGR888_PLANAR:
+        case M_PIX_FMT_RGB161616_PLANAR:
+        case M_PIX_FMT_BGR161616_PLANAR:
+        case M_PIX_FMT_RGB323232_PLANAR:
+        case M_PIX_FMT_BGR323232_PLANAR:
+            layout = M_LAYOUT_NCHW;
+            break;
+        default:
+            SIMPLE_LOG_ERROR("stack images can't support format %s",
+                             first->GetPixelFormatStr().c_str());
+            return MStatus::M_NOT_SUPPORT;
+    }
+    const DataType elem_type = first->GetTypeSize() == 1U   ? M_DATA_TYPE_UINT8
+                               : first->GetTypeSize() == 2U ? M_DATA_TYPE_FLOAT16
+                                                            : M_DATA_TYPE_FLOAT32;
+
+    uint32_t number = 0;
+    for (const auto& image : images) {
+        if (nullptr == image || nullptr == image->GetData<void>() ||
+            image->GetPixelFormat() != first->GetPixelFormat() ||
+            image->GetWidth() != first->GetWidth() || image->GetHeight() != first->GetHeight()) {
+            SIMPLE_LOG_ERROR("stack images failed, format and size of images must be the same");
+            return MStatus::M_INVALID_ARG;
+        }
+        number += image->GetNumber();
+    }
+
+    const uint32_t w = first->GetWidth(), h = first->GetHeight(), c = first->GetChannel();
+    std::vector<uint32_t> shape =
+        layout == M_LAYOUT_NHWC ? std::vector<uint32_t>{number, h, w, c}
+                                : std::vector<uint32_t>{number, c, h, w};
+    MStatus status = PrepareOutput(shape, layout, elem_type, M_TENSOR_PADDING_NONE, out);
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+
+    // rows of image match rows of tensor, reused out may be padded
+    std::vector<CopyTask> tasks;
+    uint32_t n = 0;
+    for (const auto& image : images) {
+        image->GetDataManager()->SyncCache(false);
+        if (!image->IsDense()) {
+            // rows of every plane with own pitch, planes of planar formats are channels
+            ImagePlane planes[IMAGE_MAX_PLANES];
+            for (uint32_t k = 0; k < image->GetNumber(); ++k) {
+                const uint32_t count = image->GetPlanes(k, planes);
+                for (uint32_t p = 0; p < count; ++p) {
+                    FastCopy2D(out.GetRow<uint8_t>(n + k, p * h),
+                               out.GetStride(),
+                               planes[p].data,
+                               planes[p].pitch,
+                               out.GetRowSize(),
+                               h);
+                }
+            }
+        } else if (out.IsDense()) {
+            tasks.emplace_back(out.GetData<void>(n), image->GetData<void>(0), image->GetSize());
+        } else {
+            FastCopy2D(out.GetData<void>(n),
+                       out.GetStride(),
+                       image->GetData<void>(0),
+                       out.GetRowSize(),
+                       out.GetRowSize(),
+                       static_cast<size_t>(out.GetRows()) * image->GetNumber());
+        }
+        n += image->GetNumber();
+    }
+    BatchCopy(tasks);
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor> stack(const std::vector<std::shared_ptr<Image>>& images) {
+    auto out = std::make_shared<Tensor>();
+    if (nullptr == out || stack(images, *out) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return out;
+}
+
+std::vector<std::shared_ptr<Tensor>> unstack(const std::shared_ptr<Tensor>& tensor) {
+    std::vector<std::shared_ptr<Tensor>> items;
+    if (nullptr == tensor || nullptr == tensor->GetData<void>() ||
+        tensor->GetShape().size() != 4) {
+        SIMPLE_LOG_ERROR("unstack failed, input tensor is empty");
+        return items;
+    }
+
+    std::vector<uint32_t> shape = tensor->GetShape();
+    const uint32_t number       = shape[0];
+    shape[0]                    = 1;
+    items.reserve(number);
+    for (uint32_t n = 0; n < number; ++n) {
+        auto data_mgr = std::make_shared<SubDataManager>(
+            tensor->GetDataManager(), n * tensor->GetScalar(), tensor->GetScalar());
+        auto item = std::make_shared<Tensor>(data_mgr,
+                                             shape,
+                                             tensor->GetShapeMode(),
+                                             tensor->GetDataManager()->GetMemType(),
+                                             tensor->GetElemType(),
+                                             tensor->GetPadding());
+        item->SetName(tensor->GetName());
+        items.emplace_back(item);
+    }
+    return items;
+}
+
+} // namespace base
@@ -0,0 +1,555 @@
+#include "tensor/conv2d.h"
+
+#include "intrinsic.h"
+#include "manager/data_manager.h"
+#include "manager/pipe_manager.h"
+#include "tensor/innerproduct.h"
+#include "tensor/layout.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string.h>
+#include <vector>
+
+namespace base {
+
+/// sizes of convolution, channels of weight are split by group
+typedef struct ConvShape {
+    uint32_t n, c, h, w;
+    uint32_t oc, oh, ow;
+    uint32_t kh, kw;
+    uint32_t ic_g, oc_g;
+} ConvShape;
+
+static void Activate(float* data, const uint32_t size, const ActivationType activation) {
+    switch (activation) {
+        case M_ACTIVATION_RELU:
+            for (uint32_t i = 0; i < size; ++i) {
+                data[i] = std::max(data[i], 0.f);
+            }
+            break;
+        case M_ACTIVATION_RELU6:
+            for (uint32_t i = 0; i < size; ++i) {
+                data[i] = std::min(std::max(data[i], 0.f), 6.f);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/// y[i] += alpha * x[i]
+static void Axpy(float* y, const float* x, const float alpha, const uint32_t size) {
+    uint32_t i = 0;
+#ifdef USE_AVX
+    const __m256 va = _mm256_set1_ps(alpha);
+    for (; i + 8 <= size; i += 8) {
+        const __m256 vy = _mm256_loadu_ps(y + i);
+        _mm256_storeu_ps(y + i, _mm256_add_ps(vy, _mm256_mul_ps(va, _mm256_loadu_ps(x + i))));
+    }
+#endif
+    for (; i < size; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+/// y[i] += a[i] * x[i]
+static void MulAdd(float* y, const float* a, const float* x, const uint32_t size) {
+    uint32_t i = 0;
+#ifdef USE_AVX
+    for (; i + 8 <= size; i += 8) {
+        const __m256 vy = _mm256_loadu_ps(y + i);
+        const __m256 va = _mm256_loadu_ps(a + i);
+        _mm256_storeu_ps(y + i, _mm256_add_ps(vy, _mm256_mul_ps(va, _mm256_loadu_ps(x + i))));
+    }
+#endif
+    for (; i < size; ++i) {
+        y[i] += a[i] * x[i];
+    }
+}
+
+/// output size of one spatial axis, 0 if the dilated kernel is larger than padded input
+static uint32_t OutputSize(const uint32_t size,
+                           const uint32_t pad_before,
+                           const uint32_t pad_after,
+                           const uint32_t kernel,
+                           const uint32_t stride,
+                           const uint32_t dilation) {
+    const int64_t span   = static_cast<int64_t>(dilation) * (kernel - 1) + 1;
+    const int64_t padded = static_cast<int64_t>(size) + pad_before + pad_after;
+    return padded < span ? 0 : static_cast<uint32_t>((padded - span) / stride + 1);
+}
+
+/// [lo, hi) of output index o, whose input index o * stride + offset - pad is in [0, size)
+static void ValidRange(const uint32_t size,
+                       const uint32_t pad,
+                       const uint32_t offset,
+                       const uint32_t stride,
+                       const uint32_t out_size,
+                       uint32_t& lo,
+                       uint32_t& hi) {
+    const int64_t begin = static_cast<int64_t>(pad) - offset;
+    const int64_t end   = static_cast<int64_t>(size) - 1 + pad - offset;
+    lo = begin <= 0 ? 0 : static_cast<uint32_t>((begin + stride - 1) / stride);
+    hi = end < 0 ? 0 : static_cast<uint32_t>(std::min<int64_t>(end / stride + 1, out_size));
+    lo = std::min(lo, hi);
+}
+
+/// input row of output row oy and kernel row ky, -1 if it falls in padding
+static int64_t
+InputRow(const ConvShape& s, const Conv2dParam& p, const uint32_t oy, const uint32_t ky) {
+    const int64_t iy = static_cast<int64_t>(oy) * p.stride_h + ky * p.dilation_h - p.pad_top;
+    return iy < 0 || iy >= s.h ? -1 : iy;
+}
+
+/// col[k][oy * ow + ox] with k of (ic, ky, kx), padding gives zeros
+static void Im2colNCHW(const Tensor& input,
+                       const uint32_t n,
+                       const ConvShape& s,
+                       const Conv2dParam& p,
+                       float* col) {
+    const uint32_t taps = s.kh * s.kw;
+    const size_t plane  = static_cast<size_t>(s.oh) * s.ow;
+    ParallelFor(s.c * taps, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t k = begin; k < end; ++k) {
+            const uint32_t ic = k / taps, ky = k % taps / s.kw, kx = k % s.kw;
+            uint32_t lo = 0, hi = 0;
+            ValidRange(s.w, p.pad_left, kx * p.dilation_w, p.stride_w, s.ow, lo, hi);
+            for (uint32_t oy = 0; oy < s.oh; ++oy) {
+                float* dst       = col + k * plane + oy * s.ow;
+                const int64_t iy = InputRow(s, p, oy, ky);
+                if (iy < 0 || lo == hi) {
+                    memset(dst, 0, s.ow * sizeof(float));
+                    continue;
+                }
+                const float* src = input.GetRow<float>(n, ic * s.h + static_cast<uint32_t>(iy));
+                memset(dst, 0, lo * sizeof(float));
+                for (uint32_t ox = lo; ox < hi; ++ox) {
+                    dst[ox] = src[ox * p.stride_w + kx * p.dilation_w - p.pad_left];
+                }
+                memset(dst + hi, 0, (s.ow - hi) * sizeof(float));
+            }
+        }
+    });
+}
+
+/// col[ox][k] of output row oy with k of (ky, kx, ic) in group g, padding gives zeros
+static void Im2colRowNHWC(const Tensor& input,
+                          const uint32_t n,
+                          const uint32_t oy,
+                          const uint32_t g,
+                          const ConvShape& s,
+                          const Conv2dParam& p,
+                          float* col) {
+    const uint32_t K = s.kh * s.kw * s.ic_g;
+    for (uint32_t ky = 0; ky < s.kh; ++ky) {
+        const int64_t iy = InputRow(s, p, oy, ky);
+        const float* src =
+            iy < 0 ? nullptr : input.GetRow<float>(n, static_cast<uint32_t>(iy)) + g * s.ic_g;
+        for (uint32_t kx = 0; kx < s.kw; ++kx) {
+            uint32_t lo = 0, hi = 0;
+            ValidRange(s.w, p.pad_left, kx * p.dilation_w, p.stride_w, s.ow, lo, hi);
+            if (nullptr == src) {
+                lo = hi = s.ow;
+            }
+            float* dst = col + (ky * s.kw + kx) * s.ic_g;
+            for (uint32_t ox = 0; ox < s.ow; ++ox) {
+                if (ox < lo || ox >= hi) {
+                    memset(dst + ox * K, 0, s.ic_g * sizeof(float));
+                    continue;
+                }
+                const uint32_t ix = ox * p.stride_w + kx * p.dilation_w - p.pad_left;
+                memcpy(dst + ox * K, src + ix * s.c, s.ic_g * sizeof(float));
+            }
+        }
+    }
+}
+
+/// out[oc] = weight[oc] * col of group + bias, parallel over output channels
+static MStatus ConvNCHW(const Tensor& input,
+                        const Tensor& weight,
+                        const float* bias,
+                        const ConvShape& s,
+                        const Conv2dParam& p,
+                        Tensor& out) {
+    const uint32_t K         = s.ic_g * s.kh * s.kw;
+    const uint32_t plane     = s.oh * s.ow;
+    const uint32_t in_pitch  = input.GetStride() / sizeof(float);
+    const uint32_t out_pitch = out.GetStride() / sizeof(float);
+    const bool pointwise = s.kh == 1 && s.kw == 1 && p.stride_h == 1 && p.stride_w == 1 &&
+                           p.pad_top == 0 && p.pad_left == 0 && p.pad_bottom == 0 &&
+                           p.pad_right == 0;
+
+    // dense weight of [oc][k], k of (ic, ky, kx)
+    const size_t col_size = pointwise ? 0 : static_cast<size_t>(s.c) * s.kh * s.kw * plane;
+    float* wd  = static_cast<float*>(GetScratch(0, static_cast<size_t>(s.oc) * K * sizeof(float)));
+    float* col = pointwise ? nullptr : static_cast<float*>(GetScratch(1, col_size * sizeof(float)));
+    if (nullptr == wd || (!pointwise && nullptr == col)) {
+        SIMPLE_LOG_ERROR("conv2d malloc weight or col of %zu elements failed", col_size);
+        return MStatus::M_OUT_OF_MEMORY;
+    }
+    for (uint32_t oc = 0; oc < s.oc; ++oc) {
+        for (uint32_t r = 0; r < s.ic_g * s.kh; ++r) {
+            memcpy(wd + oc * K + r * s.kw, weight.GetRow<float>(oc, r), s.kw * sizeof(float));
+        }
+    }
+
+    for (uint32_t n = 0; n < s.n; ++n) {
+        // b[k][r * row_pitch + x], pointwise reads channel planes of input in place
+        const float* b         = pointwise ? input.GetRow<float>(n, 0) : col;
+        const uint32_t ldb     = pointwise ? s.h * in_pitch : plane;
+        const uint32_t b_pitch = pointwise ? in_pitch : s.ow;
+        if (!pointwise) {
+            Im2colNCHW(input, n, s, p, col);
+        }
+        // channels of a task in one group are rows of one gemm, so panels of b are read once
+        // for all of them
+        ParallelFor(s.oc, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t oc0 = begin; oc0 < end;) {
+                const uint32_t oc1 = std::min(end, (oc0 / s.oc_g + 1) * s.oc_g);
+                const float* a     = wd + static_cast<size_t>(oc0) * K;
+                const float* b_g   = b + static_cast<size_t>(oc0 / s.oc_g) * K * ldb;
+                float* c           = out.GetRow<float>(n, oc0 * s.oh);
+                const uint32_t ldc = s.oh * out_pitch;
+                if (b_pitch == s.ow && out_pitch == s.ow) {
+                    gemm_fp32(a, K, b_g, ldb, nullptr, c, ldc, oc1 - oc0, plane, K);
+                } else {
+                    for (uint32_t r = 0; r < s.oh; ++r) {
+                        gemm_fp32(a,
+                                  K,
+                                  b_g + r * b_pitch,
+                                  ldb,
+                                  nullptr,
+                                  c + r * out_pitch,
+                                  ldc,
+                                  oc1 - oc0,
+                                  s.ow,
+                                  K);
+                    }
+                }
+                oc0 = oc1;
+            }
+            for (uint32_t oc = begin; oc < end; ++oc) {
+                float* c = out.GetRow<float>(n, oc * s.oh);
+                for (uint32_t r = 0; r < s.oh; ++r) {
+                    float* row = c + r * out_pitch;
+                    for (uint32_t x = 0; bias && x < s.ow; ++x) {
+                        row[x] += bias[oc];
+                    }
+                    Activate(row, s.ow, p.activation);
+                }
+            }
+        });
+    }
+    return MStatus::M_OK;
+}
+
+/// out row = col of row * weight + bias, parallel over output rows
+static MStatus ConvNHWC(const Tensor& input,
+                        const Tensor& weight,
+                        const float* bias,
+                        const ConvShape& s,
+                        const Conv2dParam& p,
+                        Tensor& out) {
+    const uint32_t K     = s.kh * s.kw * s.ic_g;
+    const bool pointwise = s.kh == 1 && s.kw == 1 && p.stride_h == 1 && p.stride_w == 1 &&
+                           p.pad_top == 0 && p.pad_left == 0 && p.pad_bottom == 0 &&
+                           p.pad_right == 0;
+
+    // dense weight of [g][k][oc of group], k of (ky, kx, ic)
+    const uint32_t group = s.c / s.ic_g;
+    float* wt =
+        static_cast<float*>(GetScratch(0, static_cast<size_t>(group) * K * s.oc_g * sizeof(float)));
+    if (nullptr == wt) {
+        SIMPLE_LOG_ERROR("conv2d malloc weight of %u elements failed", group * K * s.oc_g);
+        return MStatus::M_OUT_OF_MEMORY;
+    }
+    for (uint32_t oc = 0; oc < s.oc; ++oc) {
+        const uint32_t g = oc / s.oc_g, o = oc % s.oc_g;
+        for (uint32_t ic = 0; ic < s.ic_g; ++ic) {
+            for (uint32_t ky = 0; ky < s.kh; ++ky) {
+                const float* src = weight.GetRow<float>(oc, ic * s.kh + ky);
+                for (uint32_t kx = 0; kx < s.kw; ++kx) {
+                    const uint32_t k = (ky * s.kw + kx) * s.ic_g + ic;
+                    wt[(static_cast<size_t>(g) * K + k) * s.oc_g + o] = src[kx];
+                }
+            }
+        }
+    }
+
+    std::atomic<bool> failed{false};
+    for (uint32_t n = 0; n < s.n && !failed; ++n) {
+        ParallelFor(s.oh, 1, [&](uint32_t begin, uint32_t end) {
+            float* col = pointwise ? nullptr
+                                   : static_cast<float*>(GetScratch(
+                                         1, static_cast<size_t>(s.ow) * K * sizeof(float)));
+            if (!pointwise && nullptr == col) {
+                failed = true;
+                return;
+            }
+            for (uint32_t oy = begin; oy < end; ++oy) {
+                float* c = out.GetRow<float>(n, oy);
+                for (uint32_t g = 0; g < group; ++g) {
+                    const float* a = nullptr;
+                    uint32_t lda   = K;
+                    if (pointwise) {
+                        a   = input.GetRow<float>(n, oy) + g * s.ic_g;
+                        lda = s.c;
+                    } else {
+                        Im2colRowNHWC(input, n, oy, g, s, p, col);
+                        a = col;
+                    }
+                    gemm_fp32(a,
+                              lda,
+                              wt + static_cast<size_t>(g) * K * s.oc_g,
+                              s.oc_g,
+                              bias ? bias + g * s.oc_g : nullptr,
+                              c + g * s.oc_g,
+                              s.oc,
+                              s.ow,
+                              s.oc_g,
+                              K);
+                }
+                Activate(c, s.ow * s.oc, p.activation);
+            }
+        });
+    }
+    if (failed) {
+        SIMPLE_LOG_ERROR("conv2d malloc col of %u elements failed", s.ow * K);
+        return MStatus::M_OUT_OF_MEMORY;
+    }
+    return MStatus::M_OK;
+}
+
+/// depthwise 3x3 of NCHW, taps outer so every tap is a SIMD axpy along the output row
+static void DepthwiseNCHW(const Tensor& input,
+                          const Tensor& weight,
+                          const float* bias,
+                          const ConvShape& s,
+                          const Conv2dParam& p,
+                          Tensor& out) {
+    for (uint32_t n = 0; n < s.n; ++n) {
+        ParallelFor(s.c * s.oh, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t idx = begin; idx < end; ++idx) {
+                const uint32_t ch = idx / s.oh, oy = idx % s.oh;
+                float* dst        = out.GetRow<float>(n, idx);
+                std::fill(dst, dst + s.ow, bias ? bias[ch] : 0.f);
+                for (uint32_t ky = 0; ky < 3; ++ky) {
+                    const int64_t iy = InputRow(s, p, oy, ky);
+                    if (iy < 0) {
+                        continue;
+                    }
+                    const float* src = input.GetRow<float>(n, ch * s.h + static_cast<uint32_t>(iy));
+                    const float* w   = weight.GetRow<float>(ch, ky);
+                    for (uint32_t kx = 0; kx < 3; ++kx) {
+                        uint32_t lo = 0, hi = 0;
+                        ValidRange(s.w, p.pad_left, kx * p.dilation_w, p.stride_w, s.ow, lo, hi);
+                        if (lo == hi) {
+                            continue;
+                        }
+                        // x is the input of output lo, later outputs step by stride
+                        const float* x = src + lo * p.stride_w + kx * p.dilation_w - p.pad_left;
+                        if (p.stride_w == 1) {
+                            Axpy(dst + lo, x, w[kx], hi - lo);
+                        } else {
+                            for (uint32_t ox = lo; ox < hi; ++ox) {
+                                dst[ox] += w[kx] * x[(ox - lo) * p.stride_w];
+                            }
+                        }
+                    }
+                }
+                Activate(dst, s.ow, p.activation);
+            }
+        });
+    }
+}
+
+/// depthwise 3x3 of NHWC and blocked layouts, SIMD along channels of each pixel
+/// @note NHWC is one block of all channels, row of block cb and y is cb * h + y
+static MStatus DepthwisePixels(const Tensor& input,
+                               const Tensor& weight,
+                               const float* bias,
+                               const ConvShape& s,
+                               const Conv2dParam& p,
+                               Tensor& out) {
+    const uint32_t block  = out.GetChannelBlock() == 1U ? s.c : out.GetChannelBlock();
+    const uint32_t blocks = (s.c + block - 1) / block;
+    const uint32_t c_pad  = blocks * block;
+
+    // dense weight of [tap][c] and bias, zeros of tail channels keep tail of out zero
+    float* wt       = static_cast<float*>(GetScratch(0, 9U * c_pad * sizeof(float)));
+    float* bias_pad = static_cast<float*>(GetScratch(1, c_pad * sizeof(float)));
+    if (nullptr == wt || nullptr == bias_pad) {
+        SIMPLE_LOG_ERROR("conv2d malloc depthwise weight of %u channels failed", c_pad);
+        return MStatus::M_OUT_OF_MEMORY;
+    }
+    memset(wt, 0, 9U * c_pad * sizeof(float));
+    memset(bias_pad, 0, c_pad * sizeof(float));
+    for (uint32_t ch = 0; ch < s.c; ++ch) {
+        for (uint32_t ky = 0; ky < 3; ++ky) {
+            for (uint32_t kx = 0; kx < 3; ++kx) {
+                wt[(ky * 3 + kx) * c_pad + ch] = weight.GetRow<float>(ch, ky)[kx];
+            }
+        }
+        bias_pad[ch] = bias ? bias[ch] : 0.f;
+    }
+
+    for (uint32_t n = 0; n < s.n; ++n) {
+        ParallelFor(blocks * s.oh, 1, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t t = begin; t < end; ++t) {
+                const uint32_t cb = t / s.oh, oy = t % s.oh;
+                float* row        = out.GetRow<float>(n, t);
+                for (uint32_t ox = 0; ox < s.ow; ++ox) {
+                    float* dst = row + ox * block;
+                    memcpy(dst, &bias_pad[cb * block], block * sizeof(float));
+                    for (uint32_t ky = 0; ky < 3; ++ky) {
+                        const int64_t iy = InputRow(s, p, oy, ky);
+                        if (iy < 0) {
+                            continue;
+                        }
+                        const float* src =
+                            input.GetRow<float>(n, cb * s.h + static_cast<uint32_t>(iy));
+                        for (uint32_t kx = 0; kx < 3; ++kx) {
+                            const int64_t ix = static_cast<int64_t>(ox) * p.stride_w +
+                                               kx * p.dilation_w - p.pad_left;
+                            if (ix < 0 || ix >= s.w) {
+                                continue;
+                            }
+                            MulAdd(dst,
+                                   &wt[(ky * 3 + kx) * c_pad + cb * block],
+                                   src + ix * block,
+                                   block);
+                        }
+                    }
+                }
+                Activate(row, s.ow * block, p.activation);
+            }
+        });
+    }
+    return MStatus::M_OK;
+}
+
+MStatus conv2d(const std::shared_ptr<Tensor>& input,
+               const std::shared_ptr<Tensor>& weight,
+               const std::shared_ptr<Tensor>& bias,
+               const Conv2dParam& param,
+               Tensor& out) {
+    if (nullptr == input || nullptr == weight || nullptr == input->GetData<void>() ||
+        nullptr == weight->GetData<void>()) {
+        SIMPLE_LOG_ERROR("conv2d failed, input or weight is empty");
+        return MStatus::M_INVALID_ARG;
+    }
+    if (input.get() == &out || weight.get() == &out || bias.get() == &out) {
+        SIMPLE_LOG_ERROR("conv2d output must not be an input");
+        return MStatus::M_INVALID_ARG;
+    }
+    if (input->GetElemType() != M_DATA_TYPE_FLOAT32 ||
+        weight->GetElemType() != M_DATA_TYPE_FLOAT32 || weight->GetShapeMode() != M_LAYOUT_NCHW) {
+        SIMPLE_LOG_ERROR("conv2d only support fp32 input and fp32 NCHW weight");
+        return MStatus::M_NOT_SUPPORT;
+    }
+    if (param.stride_h == 0 || param.stride_w == 0 || param.dilation_h == 0 ||
+        param.dilation_w == 0 || param.group == 0 || param.activation >= M_ACTIVATION_MAX_TYPE) {
+        SIMPLE_LOG_ERROR("conv2d invalid paramter, stride %u x %u, dilation %u x %u, group %u",
+                         param.stride_h,
+                         param.stride_w,
+                         param.dilation_h,
+                         param.dilation_w,
+                         param.group);
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // shape of blocked layout is {N, C, H, W} as NCHW
+    const bool nhwc = input->GetShapeMode() == M_LAYOUT_NHWC;
+    ConvShape s;
+    s.n    = input->GetShape(0);
+    s.c    = nhwc ? input->GetShape(3) : input->GetShape(1);
+    s.h    = nhwc ? input->GetShape(1) : input->GetShape(2);
+    s.w    = nhwc ? input->GetShape(2) : input->GetShape(3);
+    s.oc   = weight->GetShape(0);
+    s.ic_g = weight->GetShape(1);
+    s.kh   = weight->GetShape(2);
+    s.kw   = weight->GetShape(3);
+    if (s.ic_g * param.group != s.c || s.oc % param.group != 0) {
+        SIMPLE_LOG_ERROR("conv2d channel mismatch, input %u, weight %u x %u, group %u",
+                         s.c,
+                         s.oc,
+                         s.ic_g,
+                         param.group);
+        return MStatus::M_INVALID_ARG;
+    }
+    s.oc_g = s.oc / param.group;
+    s.oh   = OutputSize(
+        s.h, param.pad_top, param.pad_bottom, s.kh, param.stride_h, param.dilation_h);
+    s.ow   = OutputSize(
+        s.w, param.pad_left, param.pad_right, s.kw, param.stride_w, param.dilation_w);
+    if (s.oh == 0 || s.ow == 0) {
+        SIMPLE_LOG_ERROR(
+            "conv2d kernel %u x %u is larger than input %u x %u", s.kh, s.kw, s.h, s.w);
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // blocked layout keeps its layout through the NCHW kernels, planar input and output are
+    // tensors of the thread whose buffers are reused across calls as scratch buffers
+    static thread_local Tensor planar_in, planar_out;
+    const bool depthwise = param.group == s.c && s.oc == s.c && s.kh == 3 && s.kw == 3;
+    const bool blocked   = input->GetChannelBlock() != 1U && !depthwise;
+    const Tensor& in     = blocked ? planar_in : *input;
+    Tensor& dst          = blocked ? planar_out : out;
+    MStatus status       = MStatus::M_OK;
+    if (blocked) {
+        status = convert_layout(*input, M_LAYOUT_NCHW, planar_in);
+        if (status != MStatus::M_OK) {
+            return status;
+        }
+    }
+
+    const float* b = nullptr;
+    if (bias) {
+        if (bias->GetElemType() != M_DATA_TYPE_FLOAT32 || bias->GetCount() != s.oc) {
+            SIMPLE_LOG_ERROR("conv2d bias must be fp32 with %u elements", s.oc);
+            return MStatus::M_INVALID_ARG;
+        }
+        float* bias_data = static_cast<float*>(GetScratch(2, s.oc * sizeof(float)));
+        if (nullptr == bias_data) {
+            SIMPLE_LOG_ERROR("conv2d malloc bias of %u elements failed", s.oc);
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+        bias->CopyToDense(bias_data);
+        b = bias_data;
+    }
+
+    std::vector<uint32_t> shape = nhwc ? std::vector<uint32_t>{s.n, s.oh, s.ow, s.oc}
+                                       : std::vector<uint32_t>{s.n, s.oc, s.oh, s.ow};
+    status = dst.Reset(shape, in.GetShapeMode(), M_DATA_TYPE_FLOAT32, input->GetPadding());
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+
+    if (depthwise && input->GetShapeMode() == M_LAYOUT_NCHW) {
+        DepthwiseNCHW(in, *weight, b, s, param, dst);
+    } else if (depthwise) {
+        status = DepthwisePixels(in, *weight, b, s, param, dst);
+    } else if (nhwc) {
+        status = ConvNHWC(in, *weight, b, s, param, dst);
+    } else {
+        status = ConvNCHW(in, *weight, b, s, param, dst);
+    }
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+    return blocked ? convert_layout(planar_out, input->GetShapeMode(), out) : MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor> conv2d(const std::shared_ptr<Tensor>& input,
+                               const std::shared_ptr<Tensor>& weight,
+                               const std::shared_ptr<Tensor>& bias,
+                               const Conv2dParam& param) {
+    auto out = std::make_shared<Tensor>();
+    if (conv2d(input, weight, bias, param, *out) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return out;
+}
+
+} // namespace base
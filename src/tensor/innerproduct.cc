@@ -0,0 +1,679 @@
+#include "tensor/innerproduct.h"
+
+#include "intrinsic.h"
+#include "tensor/innerproduct_kernel.h"
+
+#include "manager/data_manager.h"
+#include "manager/pipe_manager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <string.h>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace base {
+
+// int8 tiles of rows * column blocks of 16, and multiply-adds a task takes at least
+#define INT8_TILE_ROWS 4U
+#define INT8_TILE_BLOCKS 8U
+#define INT8_TASK_MACS (1U << 18)
+// fp32 register tile of rows * columns, 8 ymm accumulators are 8 independent fma chains
+#define GEMM_MR 4U
+#define GEMM_NR 16U
+// fp32 panel of b of K * N, 128 KB stay in L2 and a GEMM_KC * GEMM_NR slice of 16 KB in L1
+#define GEMM_KC 256U
+#define GEMM_NC 128U
+// fp32 rows of a task of innerproduct, and multiply-adds a task takes at least
+#define FP32_TILE_ROWS 64U
+#define FP32_TASK_MACS (1U << 18)
+
+static bool IsMatrix(const std::shared_ptr<Tensor>& tensor) {
+    return tensor != nullptr && tensor->GetShape().size() == 4 && tensor->GetShape(0) == 1 &&
+           tensor->GetShape(1) == 1 && tensor->GetData<void>() != nullptr &&
+           tensor->GetChannelBlock() == 1U;
+}
+
+/// elements between rows of 2D matrix, padded pitch of NCHW or contiguous rows of NHWC
+static uint32_t RowPitch(const std::shared_ptr<Tensor>& tensor) {
+    if (tensor->GetShapeMode() == M_LAYOUT_NHWC) {
+        return tensor->GetShape(3);
+    }
+    return tensor->GetStride() / tensor->GetTypeSize();
+}
+
+static bool CheckBias(const std::shared_ptr<Tensor>& bias, const uint32_t n) {
+    if (nullptr == bias) {
+        return true;
+    }
+    if (bias->GetElemType() != M_DATA_TYPE_FLOAT32 || bias->GetCount() != n) {
+        SIMPLE_LOG_ERROR("innerproduct bias must be fp32 with %u elements", n);
+        return false;
+    }
+    return true;
+}
+
+/// @brief c[R, cols] = a[R, K] * b[K, cols] + c or bias, register tile of gemm_fp32
+/// @param accumulate add to c of previous K blocks, otherwise start from bias or zero
+/// @note kFull tiles have GEMM_NR columns, others mask the columns past cols
+template <uint32_t R, bool kFull>
+static void GemmKernelF32(const float* a,
+                        const uint32_t lda,
+                        const float* b,
+                        const uint32_t ldb,
+                        const float* bias,
+                        const bool accumulate,
+                        float* c,
+                        const uint32_t ldc,
+                        const uint32_t K,
+                        const uint32_t cols) {
+#if defined(USE_AVX) && defined(__AVX2__) && defined(__FMA__)
+    const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i mask[2] = {
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(cols)), lane),
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int32_t>(cols) - 8), lane)};
+    auto load = [&](const float* p, const uint32_t h) {
+        return kFull ? _mm256_loadu_ps(p + h * 8) : _mm256_maskload_ps(p + h * 8, mask[h]);
+    };
+
+    __m256 acc[R][2];
+    for (uint32_t r = 0; r < R; ++r) {
+        for (uint32_t h = 0; h < 2; ++h) {
+            acc[r][h] = accumulate ? load(c + r * ldc, h)
+                                   : (bias ? load(bias, h) : _mm256_setzero_ps());
+        }
+    }
+    for (uint32_t k = 0; k < K; ++k) {
+        const float* b_row = b + static_cast<size_t>(k) * ldb;
+        const __m256 b0    = load(b_row, 0);
+        const __m256 b1    = load(b_row, 1);
+        for (uint32_t r = 0; r < R; ++r) {
+            const __m256 va = _mm256_set1_ps(a[r * lda + k]);
+            acc[r][0]       = _mm256_fmadd_ps(va, b0, acc[r][0]);
+            acc[r][1]       = _mm256_fmadd_ps(va, b1, acc[r][1]);
+        }
+    }
+    for (uint32_t r = 0; r < R; ++r) {
+        for (uint32_t h = 0; h < 2; ++h) {
+            if (kFull) {
+                _mm256_storeu_ps(c + r * ldc + h * 8, acc[r][h]);
+            } else {
+                _mm256_maskstore_ps(c + r * ldc + h * 8, mask[h], acc[r][h]);
+            }
+        }
+    }
+#else
+    const uint32_t n = kFull ? GEMM_NR : cols;
+    float acc[R][GEMM_NR];
+    for (uint32_t r = 0; r < R; ++r) {
+        for (uint32_t j = 0; j < n; ++j) {
+            acc[r][j] = accumulate ? c[r * ldc + j] : (bias ? bias[j] : 0.f);
+        }
+    }
+    for (uint32_t k = 0; k < K; ++k) {
+        const float* b_row = b + static_cast<size_t>(k) * ldb;
+        for (uint32_t r = 0; r < R; ++r) {
+            const float a_val = a[r * lda + k];
+            for (uint32_t j = 0; j < n; ++j) {
+                acc[r][j] += a_val * b_row[j];
+            }
+        }
+    }
+    for (uint32_t r = 0; r < R; ++r) {
+        for (uint32_t j = 0; j < n; ++j) {
+            c[r * ldc + j] = acc[r][j];
+        }
+    }
+#endif
+}
+
+template <uint32_t R>
+static void GemmTileF32(const float* a,
+                        const uint32_t lda,
+                        const float* b,
+                        const uint32_t ldb,
+                        const float* bias,
+                        const bool accumulate,
+                        float* c,
+                        const uint32_t ldc,
+                        const uint32_t K,
+                        const uint32_t cols) {
+    if (cols == GEMM_NR) {
+        GemmKernelF32<R, true>(a, lda, b, ldb, bias, accumulate, c, ldc, K, cols);
+    } else {
+        GemmKernelF32<R, false>(a, lda, b, ldb, bias, accumulate, c, ldc, K, cols);
+    }
+}
+
+void gemm_fp32(const float* a,
+               const uint32_t lda,
+               const float* b,
+               const uint32_t ldb,
+               const float* bias,
+               float* c,
+               const uint32_t ldc,
+               const uint32_t M,
+               const uint32_t N,
+               const uint32_t K) {
+    typedef void (*GemmTile)(const float*,
+                             const uint32_t,
+                             const float*,
+                             const uint32_t,
+                             const float*,
+                             const bool,
+                             float*,
+                             const uint32_t,
+                             const uint32_t,
+                             const uint32_t);
+    static const GemmTile tiles[GEMM_MR] = {
+        GemmTileF32<1>, GemmTileF32<2>, GemmTileF32<3>, GemmTileF32<4>};
+
+    // panel of GEMM_KC * GEMM_NC of b stays in L2 for all rows, GEMM_KC * GEMM_NR of it stays
+    // in L1 for the register tiles of all rows
+    for (uint32_t n0 = 0; n0 < N; n0 += GEMM_NC) {
+        const uint32_t n1 = std::min(N, n0 + GEMM_NC);
+        uint32_t k0       = 0;
+        do {
+            const uint32_t kc = std::min(GEMM_KC, K - k0);
+            for (uint32_t j = n0; j < n1; j += GEMM_NR) {
+                const uint32_t cols = std::min(GEMM_NR, n1 - j);
+                const float* b_blk  = b + static_cast<size_t>(k0) * ldb + j;
+                const float* bias_j = bias ? bias + j : nullptr;
+                for (uint32_t i = 0; i < M; i += GEMM_MR) {
+                    const float* a_blk = a + static_cast<size_t>(i) * lda + k0;
+                    float* c_blk       = c + static_cast<size_t>(i) * ldc + j;
+                    tiles[std::min(GEMM_MR, M - i) - 1](a_blk,
+                                                        lda,
+                                                        b_blk,
+                                                        ldb,
+                                                        bias_j,
+                                                        k0 > 0,
+                                                        c_blk,
+                                                        ldc,
+                                                        kc,
+                                                        cols);
+                }
+            }
+            k0 += kc;
+        } while (k0 < K);
+    }
+}
+
+/// @brief u8 * s8 -> s32 micro kernel of R rows and column blocks [nb_begin, nb_end)
+/// @param a R rows of k_pad u8, each row stride is a_stride
+/// @param w packed weight
+/// @param c R rows of (nb_end - nb_begin) * 16 s32 of the column blocks
+template <int R>
+static void GemmU8S8(const uint8_t* a,
+                     const uint32_t a_stride,
+                     const Int8Weight& w,
+                     const uint32_t nb_begin,
+                     const uint32_t nb_end,
+                     int32_t* c,
+                     const uint32_t c_stride) {
+    const uint32_t kb_num = w.GetPaddedK() / Int8Weight::kBlockK;
+    const int8_t* b       = w.GetData();
+    int32_t a_quad[R];
+
+#if defined(USE_AVX) && defined(__AVX512VNNI__)
+    for (uint32_t nb = nb_begin; nb < nb_end; ++nb) {
+        const int8_t* b_blk = b + nb * kb_num * 64;
+        __m512i acc[R];
+        for (int r = 0; r < R; ++r) {
+            acc[r] = _mm512_setzero_si512();
+        }
+        for (uint32_t kb = 0; kb < kb_num; ++kb) {
+            const __m512i vb = _mm512_loadu_si512((const void*)(b_blk + kb * 64));
+            for (int r = 0; r < R; ++r) {
+                memcpy(&a_quad[r], a + r * a_stride + kb * 4, sizeof(int32_t));
+                acc[r] = _mm512_dpbusd_epi32(acc[r], _mm512_set1_epi32(a_quad[r]), vb);
+            }
+        }
+        for (int r = 0; r < R; ++r) {
+            _mm512_storeu_si512((void*)(c + r * c_stride + (nb - nb_begin) * 16), acc[r]);
+        }
+    }
+#elif defined(USE_AVX) && defined(__AVX2__)
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (uint32_t nb = nb_begin; nb < nb_end; ++nb) {
+        const int8_t* b_blk = b + nb * kb_num * 64;
+        for (int half = 0; half < 2; ++half) {
+            __m256i acc[R];
+            for (int r = 0; r < R; ++r) {
+                acc[r] = _mm256_setzero_si256();
+            }
+            if (w.IsReducedRange()) {
+                for (uint32_t kb = 0; kb < kb_num; ++kb) {
+                    const __m256i vb =
+                        _mm256_loadu_si256((const __m256i*)(b_blk + kb * 64 + half * 32));
+                    for (int r = 0; r < R; ++r) {
+                        memcpy(&a_quad[r], a + r * a_stride + kb * 4, sizeof(int32_t));
+                        const __m256i pair = _mm256_maddubs_epi16(_mm256_set1_epi32(a_quad[r]), vb);
+                        acc[r] = _mm256_add_epi32(acc[r], _mm256_madd_epi16(pair, ones));
+                    }
+                }
+            } else {
+                // cols [0, 4) and [4, 8) of this half, widen to s16 to avoid pair saturation
+                __m256i acc_hi[R];
+                for (int r = 0; r < R; ++r) {
+                    acc_hi[r] = _mm256_setzero_si256();
+                }
+                for (uint32_t kb = 0; kb < kb_num; ++kb) {
+                    const __m128i* vb = (const __m128i*)(b_blk + kb * 64 + half * 32);
+                    const __m256i b_lo = _mm256_cvtepi8_epi16(_mm_loadu_si128(vb));
+                    const __m256i b_hi = _mm256_cvtepi8_epi16(_mm_loadu_si128(vb + 1));
+                    for (int r = 0; r < R; ++r) {
+                        memcpy(&a_quad[r], a + r * a_stride + kb * 4, sizeof(int32_t));
+                        const __m256i va =
+                            _mm256_cvtepu8_epi16(_mm_set1_epi32(a_quad[r]));
+                        acc[r]    = _mm256_add_epi32(acc[r], _mm256_madd_epi16(va, b_lo));
+                        acc_hi[r] = _mm256_add_epi32(acc_hi[r], _mm256_madd_epi16(va, b_hi));
+                    }
+                }
+                // hadd gives {c0, c1, c4, c5, c2, c3, c6, c7}, restore column order
+                for (int r = 0; r < R; ++r) {
+                    acc[r] = _mm256_permute4x64_epi64(_mm256_hadd_epi32(acc[r], acc_hi[r]), 0xD8);
+                }
+            }
+            for (int r = 0; r < R; ++r) {
+                _mm256_storeu_si256((__m256i*)(c + r * c_stride + (nb - nb_begin) * 16 + half * 8),
+                                    acc[r]);
+            }
+        }
+    }
+#else
+    UNUSED_WARN(a_quad);
+    for (int r = 0; r < R; ++r) {
+        const uint8_t* a_row = a + r * a_stride;
+        int32_t* c_row       = c + r * c_stride;
+        memset(c_row, 0, (nb_end - nb_begin) * 16 * sizeof(int32_t));
+        for (uint32_t nb = nb_begin; nb < nb_end; ++nb) {
+            const int8_t* b_blk = b + nb * kb_num * 64;
+            int32_t* c_blk      = c_row + (nb - nb_begin) * 16;
+            for (uint32_t kb = 0; kb < kb_num; ++kb) {
+                const uint8_t* a_quad_ptr = a_row + kb * 4;
+                const int8_t* b_quad      = b_blk + kb * 64;
+                for (uint32_t j = 0; j < 16; ++j) {
+                    int32_t sum = 0;
+                    for (uint32_t t = 0; t < 4; ++t) {
+                        sum += static_cast<int32_t>(a_quad_ptr[t]) * b_quad[j * 4 + t];
+                    }
+                    c_blk[j] += sum;
+                }
+            }
+        }
+    }
+#endif
+}
+
+MStatus Int8Weight::Pack(const std::shared_ptr<Tensor>& weight,
+                         const std::vector<float>& scales,
+                         Int8Weight& packed) {
+    if (!IsMatrix(weight) || weight->GetElemType() != M_DATA_TYPE_INT8) {
+        SIMPLE_LOG_ERROR("Int8Weight::Pack only support int8 2D matrix");
+        return MStatus::M_INVALID_ARG;
+    }
+    const uint32_t K = weight->GetShape(2), N = weight->GetShape(3);
+    if (scales.size() != 1 && scales.size() != N) {
+        SIMPLE_LOG_ERROR("Int8Weight::Pack scales size %zu vs %u", scales.size(), N);
+        return MStatus::M_INVALID_ARG;
+    }
+
+    packed.k_     = K;
+    packed.n_     = N;
+    packed.k_pad_ = static_cast<uint32_t>(align_size(K, kBlockK));
+    packed.n_pad_ = static_cast<uint32_t>(align_size(N, kBlockN));
+    packed.scales_.resize(N);
+    for (uint32_t n = 0; n < N; ++n) {
+        packed.scales_[n] = scales.size() == 1 ? scales[0] : scales[n];
+    }
+    packed.col_sum_.assign(N, 0);
+
+    if (nullptr == packed.packed_) {
+        packed.packed_ = std::make_shared<Tensor>();
+    }
+    std::vector<uint32_t> shape{1, 1, packed.n_pad_ / kBlockN, packed.k_pad_ * kBlockN};
+    MStatus status = packed.packed_->Reset(shape, M_LAYOUT_NCHW, M_DATA_TYPE_INT8);
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+    int8_t* dst = packed.packed_->GetData<int8_t>(0);
+    memset(dst, 0, packed.packed_->GetSize());
+
+    const uint32_t kb_num = packed.k_pad_ / kBlockK;
+    const int8_t* src     = weight->GetData<int8_t>(0);
+    const uint32_t ldb    = RowPitch(weight);
+    bool reduced_range    = true;
+    for (uint32_t k = 0; k < K; ++k) {
+        for (uint32_t n = 0; n < N; ++n) {
+            const int8_t v      = src[k * ldb + n];
+            const uint32_t blk  = (n / kBlockN) * kb_num + k / kBlockK;
+            dst[blk * kBlockN * kBlockK + (n % kBlockN) * kBlockK + k % kBlockK] = v;
+            packed.col_sum_[n] += v;
+            reduced_range = reduced_range && v >= -64 && v <= 63;
+        }
+    }
+    packed.reduced_range_ = reduced_range;
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Int8Weight> Int8Weight::Pack(const std::shared_ptr<Tensor>& weight,
+                                             const std::vector<float>& scales) {
+    auto result = std::make_shared<Int8Weight>();
+    if (Pack(weight, scales, *result) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return result;
+}
+
+MStatus innerproduct_int8(const std::shared_ptr<Tensor>& left,
+                          const QuantParam& left_param,
+                          const Int8Weight& right,
+                          const std::shared_ptr<Tensor>& bias,
+                          const DataType out_type,
+                          const QuantParam& out_param,
+                          Tensor& out) {
+    if (!IsMatrix(left) || left->GetElemType() != M_DATA_TYPE_UINT8 || left.get() == &out) {
+        SIMPLE_LOG_ERROR("innerproduct_int8 left must be uint8 2D matrix");
+        return MStatus::M_INVALID_ARG;
+    }
+    if (left->GetShape(3) != right.GetK()) {
+        SIMPLE_LOG_ERROR("innerproduct_int8 shape mismatch, %u vs %u",
+                         left->GetShape(3),
+                         right.GetK());
+        return MStatus::M_INVALID_ARG;
+    }
+    if (out_type != M_DATA_TYPE_FLOAT32 && out_type != M_DATA_TYPE_UINT8) {
+        SIMPLE_LOG_ERROR("innerproduct_int8 can't support output %s", DataTypeStr[out_type].c_str());
+        return MStatus::M_NOT_SUPPORT;
+    }
+    if (out_type == M_DATA_TYPE_UINT8 && out_param.scale <= 0.f) {
+        SIMPLE_LOG_ERROR("innerproduct_int8 invalid output scale %f", out_param.scale);
+        return MStatus::M_INVALID_ARG;
+    }
+    const uint32_t M = left->GetShape(2), N = right.GetN(), K = right.GetK();
+    if (!CheckBias(bias, N) || bias.get() == &out) {
+        return MStatus::M_INVALID_ARG;
+    }
+
+    std::vector<uint32_t> shape{1, 1, M, N};
+    MStatus status = out.Reset(shape, M_LAYOUT_NCHW, out_type, left->GetPadding());
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+
+    const uint32_t k_pad   = right.GetPaddedK();
+    const uint32_t nb_num  = right.GetPaddedN() / Int8Weight::kBlockN;
+    const uint8_t* a       = left->GetData<uint8_t>(0);
+    const uint32_t lda     = RowPitch(left);
+    const uint32_t ldc     = out.GetStride() / out.GetTypeSize();
+    const float* bias_data = bias ? bias->GetData<float>(0) : nullptr;
+    const int32_t* col_sum = right.GetColumnSum().data();
+    const float* w_scales  = right.GetScales().data();
+    const float inv_out    = 1.f / out_param.scale;
+
+    // tiles of INT8_TILE_ROWS rows * INT8_TILE_BLOCKS column blocks, row major over tiles so
+    // a worker copies rows of left once for its consecutive column tiles
+    const uint32_t row_tiles = (M + INT8_TILE_ROWS - 1) / INT8_TILE_ROWS;
+    const uint32_t col_tiles = (nb_num + INT8_TILE_BLOCKS - 1) / INT8_TILE_BLOCKS;
+    const uint32_t c_stride  = INT8_TILE_BLOCKS * Int8Weight::kBlockN;
+    const uint32_t grain =
+        std::max(1U, INT8_TASK_MACS / (INT8_TILE_ROWS * c_stride) / std::max(1U, k_pad));
+    std::atomic<bool> failed{false};
+    ParallelFor(row_tiles * col_tiles, grain, [&](uint32_t begin, uint32_t end) {
+        // rows are copied into a K padded buffer so the kernels always read whole quads
+        uint8_t* a_pad = static_cast<uint8_t*>(GetScratch(0, INT8_TILE_ROWS * k_pad));
+        int32_t* acc =
+            static_cast<int32_t*>(GetScratch(1, INT8_TILE_ROWS * c_stride * sizeof(int32_t)));
+        if (nullptr == a_pad || nullptr == acc) {
+            failed = true;
+            return;
+        }
+        uint32_t copied = row_tiles;
+        for (uint32_t t = begin; t < end; ++t) {
+            const uint32_t i    = t / col_tiles * INT8_TILE_ROWS;
+            const uint32_t rows = std::min(INT8_TILE_ROWS, M - i);
+            if (copied != t / col_tiles) {
+                copied = t / col_tiles;
+                for (uint32_t r = 0; r < rows; ++r) {
+                    memcpy(a_pad + r * k_pad, a + (i + r) * lda, K);
+                    memset(a_pad + r * k_pad + K, 0, k_pad - K);
+                }
+            }
+            const uint32_t nb0 = t % col_tiles * INT8_TILE_BLOCKS;
+            const uint32_t nb1 = std::min(nb_num, nb0 + INT8_TILE_BLOCKS);
+            switch (rows) {
+                case 4:
+                    GemmU8S8<4>(a_pad, k_pad, right, nb0, nb1, acc, c_stride);
+                    break;
+                case 3:
+                    GemmU8S8<3>(a_pad, k_pad, right, nb0, nb1, acc, c_stride);
+                    break;
+                case 2:
+                    GemmU8S8<2>(a_pad, k_pad, right, nb0, nb1, acc, c_stride);
+                    break;
+                default:
+                    GemmU8S8<1>(a_pad, k_pad, right, nb0, nb1, acc, c_stride);
+                    break;
+            }
+
+            // fused dequantize + bias (+ requantize)
+            const uint32_t n0 = nb0 * Int8Weight::kBlockN;
+            const uint32_t n1 = std::min(N, nb1 * Int8Weight::kBlockN);
+            for (uint32_t r = 0; r < rows; ++r) {
+                const int32_t* acc_row = acc + r * c_stride;
+                for (uint32_t n = n0; n < n1; ++n) {
+                    const int32_t v = acc_row[n - n0] - left_param.zero_point * col_sum[n];
+                    float y         = left_param.scale * w_scales[n] * static_cast<float>(v);
+                    y += bias_data ? bias_data[n] : 0.f;
+                    if (out_type == M_DATA_TYPE_FLOAT32) {
+                        out.GetData<float>(0)[(i + r) * ldc + n] = y;
+                    } else {
+                        const long q = lrintf(y * inv_out) + out_param.zero_point;
+                        out.GetData<uint8_t>(0)[(i + r) * ldc + n] =
+                            static_cast<uint8_t>(std::min(std::max(q, 0L), 255L));
+                    }
+                }
+            }
+        }
+    });
+    if (failed) {
+        SIMPLE_LOG_ERROR("innerproduct_int8 failed, malloc scratch failed");
+        return MStatus::M_OUT_OF_MEMORY;
+    }
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor> innerproduct_int8(const std::shared_ptr<Tensor>& left,
+                                          const QuantParam& left_param,
+                                          const Int8Weight& right,
+                                          const std::shared_ptr<Tensor>& bias,
+                                          const DataType out_type,
+                                          const QuantParam& out_param) {
+    auto out = std::make_shared<Tensor>();
+    if (innerproduct_int8(left, left_param, right, bias, out_type, out_param, *out) !=
+        MStatus::M_OK) {
+        return nullptr;
+    }
+    return out;
+}
+
+/// @brief registered kernel of shape, nullptr if missing
+/// @note
+/// kernels found are cached, so a shape builds its key and creates its kernel only once.
+/// misses are cached until the registry grows, eg. by a library loaded later
+static const InnerProductKernel* FindKernel(const uint32_t M, const uint32_t N, const uint32_t K) {
+    static std::mutex mutex;
+    static std::unordered_map<uint64_t, std::shared_ptr<InnerProductKernel>> kernels;
+    static std::unordered_set<uint64_t> misses;
+    static size_t registered = 0;
+    if (M >= (1U << 16) || N >= (1U << 24) || K >= (1U << 24)) {
+        return nullptr;
+    }
+    const uint64_t shape = (static_cast<uint64_t>(M) << 48) | (static_cast<uint64_t>(N) << 24) | K;
+    auto& registry       = RegisterBase<InnerProductKernel>::GetInstance();
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = kernels.find(shape);
+    if (iter != kernels.end()) {
+        return iter->second.get();
+    }
+    if (registry.GetSize() != registered) {
+        misses.clear();
+        registered = registry.GetSize();
+    }
+    if (misses.count(shape)) {
+        return nullptr;
+    }
+    const std::string key = InnerProductKernel::Key(M, N, K);
+    if (!registry.IsRegistered(key)) {
+        misses.insert(shape);
+        return nullptr;
+    }
+    return kernels.emplace(shape, registry.Create(key)).first->second.get();
+}
+
+MStatus innerproduct(const std::shared_ptr<Tensor>& left,
+                     const std::shared_ptr<Tensor>& right,
+                     const std::shared_ptr<Tensor>& bias,
+                     Tensor& out) {
+    if (!IsMatrix(left) || !IsMatrix(right)) {
+        SIMPLE_LOG_ERROR("tensor innerproduct only support 2D matrix");
+        return MStatus::M_INVALID_ARG;
+    }
+    if (left->GetShape(3) != right->GetShape(2)) {
+        SIMPLE_LOG_ERROR("innerproduct shape mismatch, left cols %u vs right rows %u",
+                         left->GetShape(3),
+                         right->GetShape(2));
+        return MStatus::M_INVALID_ARG;
+    }
+    if (left.get() == &out || right.get() == &out || bias.get() == &out) {
+        SIMPLE_LOG_ERROR("innerproduct output must not be an input");
+        return MStatus::M_INVALID_ARG;
+    }
+
+    // integer path, selected by element type of inputs, weight is packed into a buffer of
+    // the thread which is reused across calls
+    if (left->GetElemType() == M_DATA_TYPE_UINT8 && right->GetElemType() == M_DATA_TYPE_INT8) {
+        static const std::vector<float> unit_scale(1, 1.f);
+        static thread_local Int8Weight packed;
+        MStatus status = Int8Weight::Pack(right, unit_scale, packed);
+        if (status != MStatus::M_OK) {
+            return status;
+        }
+        return innerproduct_int8(
+            left, QuantParam(), packed, bias, M_DATA_TYPE_FLOAT32, QuantParam(), out);
+    }
+
+    if (left->GetElemType() != M_DATA_TYPE_FLOAT32 || right->GetElemType() != M_DATA_TYPE_FLOAT32) {
+        SIMPLE_LOG_ERROR("innerproduct can't support %s * %s",
+                         DataTypeStr[left->GetElemType()].c_str(),
+                         DataTypeStr[right->GetElemType()].c_str());
+        return MStatus::M_NOT_SUPPORT;
+    }
+
+    const uint32_t M = left->GetShape(2), K = left->GetShape(3), N = right->GetShape(3);
+    if (!CheckBias(bias, N)) {
+        return MStatus::M_INVALID_ARG;
+    }
+    std::vector<uint32_t> shape{1, 1, M, N};
+    MStatus status = out.Reset(shape, M_LAYOUT_NCHW, M_DATA_TYPE_FLOAT32, left->GetPadding());
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+
+    // fixed shape kernel skips the generic loops of small layers
+    const InnerProductKernel* kernel = FindKernel(M, N, K);
+    if (kernel != nullptr) {
+        kernel->Run(left->GetData<float>(0),
+                    RowPitch(left),
+                    right->GetData<float>(0),
+                    RowPitch(right),
+                    bias ? bias->GetData<float>(0) : nullptr,
+                    out.GetData<float>(0),
+                    out.GetStride() / sizeof(float));
+        return MStatus::M_OK;
+    }
+
+    // tiles of FP32_TILE_ROWS rows * GEMM_NC columns run on the compute pipe
+    const float* a         = left->GetData<float>(0);
+    const float* b         = right->GetData<float>(0);
+    const float* bias_data = bias ? bias->GetData<float>(0) : nullptr;
+    const uint32_t lda = RowPitch(left), ldb = RowPitch(right);
+    const uint32_t ldc       = out.GetStride() / sizeof(float);
+    const uint32_t row_tiles = (M + FP32_TILE_ROWS - 1) / FP32_TILE_ROWS;
+    const uint32_t col_tiles = (N + GEMM_NC - 1) / GEMM_NC;
+    const uint64_t tile_macs =
+        static_cast<uint64_t>(std::min(M, FP32_TILE_ROWS)) * std::min(N, GEMM_NC) * K;
+    const uint32_t grain = static_cast<uint32_t>(
+        std::max<uint64_t>(1U, FP32_TASK_MACS / std::max<uint64_t>(1U, tile_macs)));
+    ParallelFor(row_tiles * col_tiles, grain, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t t = begin; t < end; ++t) {
+            const uint32_t i = t / col_tiles * FP32_TILE_ROWS, j = t % col_tiles * GEMM_NC;
+            gemm_fp32(a + static_cast<size_t>(i) * lda,
+                      lda,
+                      b + j,
+                      ldb,
+                      bias_data ? bias_data + j : nullptr,
+                      out.GetData<float>(0) + static_cast<size_t>(i) * ldc + j,
+                      ldc,
+                      std::min(FP32_TILE_ROWS, M - i),
+                      std::min(GEMM_NC, N - j),
+                      K);
+        }
+    });
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor> innerproduct(const std::shared_ptr<Tensor>& left,
+                                     const std::shared_ptr<Tensor>& right,
+                                     const std::shared_ptr<Tensor>& bias) {
+    auto out = std::make_shared<Tensor>();
+    if (innerproduct(left, right, bias, *out) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return out;
+}
+
+MStatus innerproduct(const std::shared_ptr<Tensor>& left,
+                     const std::shared_ptr<Int8Weight>& right,
+                     const std::shared_ptr<Tensor>& bias,
+                     Tensor& out) {
+    if (nullptr == right) {
+        SIMPLE_LOG_ERROR("innerproduct packed weight is empty");
+        return MStatus::M_INVALID_ARG;
+    }
+    return innerproduct_int8(
+        left, QuantParam(), *right, bias, M_DATA_TYPE_FLOAT32, QuantParam(), out);
+}
+
+std::shared_ptr<Tensor> innerproduct(const std::shared_ptr<Tensor>& left,
+                                     const std::shared_ptr<Int8Weight>& right,
+                                     const std::shared_ptr<Tensor>& bias) {
+    auto out = std::make_shared<Tensor>();
+    if (innerproduct(left, right, bias, *out) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return out;
+}
+
+// fixed shapes of common small fc layers, M is batch
+typedef FixedInnerProduct<1, 10, 128> IP_1x10x128;
+typedef FixedInnerProduct<1, 10, 256> IP_1x10x256;
+typedef FixedInnerProduct<1, 32, 64> IP_1x32x64;
+typedef FixedInnerProduct<1, 64, 128> IP_1x64x128;
+typedef FixedInnerProduct<1, 128, 256> IP_1x128x256;
+typedef FixedInnerProduct<4, 64, 128> IP_4x64x128;
+typedef FixedInnerProduct<8, 64, 128> IP_8x64x128;
+
+} // namespace base
+
+REGISTER_COMMON_ENGINE(base, ip_fp32_1x10x128, InnerProductKernel, IP_1x10x128)
+REGISTER_COMMON_ENGINE(base, ip_fp32_1x10x256, InnerProductKernel, IP_1x10x256)
+REGISTER_COMMON_ENGINE(base, ip_fp32_1x32x64, InnerProductKernel, IP_1x32x64)
+REGISTER_COMMON_ENGINE(base, ip_fp32_1x64x128, InnerProductKernel, IP_1x64x128)
+REGISTER_COMMON_ENGINE(base, ip_fp32_1x128x256, InnerProductKernel, IP_1x128x256)
+REGISTER_COMMON_ENGINE(base, ip_fp32_4x64x128, InnerProductKernel, IP_4x64x128)
+REGISTER_COMMON_ENGINE(base, ip_fp32_8x64x128, InnerProductKernel, IP_8x64x128)
+
@@ -0,0 +1,273 @@
+#include "tensor/layout.h"
+
+#include "intrinsic.h"
+#include "manager/pipe_manager.h"
+
+#include <string.h>
+#include <vector>
+
+namespace base {
+
+/// logical sizes of tensor, independent of layout
+typedef struct LayoutDims {
+    uint32_t n, c, h, w;
+} LayoutDims;
+
+static LayoutDims GetDims(const Tensor& tensor) {
+    LayoutDims d;
+    d.n = tensor.GetShape(0);
+    if (tensor.GetShapeMode() == M_LAYOUT_NHWC) {
+        d.h = tensor.GetShape(1);
+        d.w = tensor.GetShape(2);
+        d.c = tensor.GetShape(3);
+    } else {
+        d.c = tensor.GetShape(1);
+        d.h = tensor.GetShape(2);
+        d.w = tensor.GetShape(3);
+    }
+    return d;
+}
+
+/// address of element (n, c, y, x), c may be in the tail block of blocked layout
+template <typename T>
+static T* ElementPtr(const Tensor& tensor,
+                     const LayoutDims& d,
+                     const uint32_t n,
+                     const uint32_t c,
+                     const uint32_t y,
+                     const uint32_t x) {
+    switch (tensor.GetShapeMode()) {
+        case M_LAYOUT_NCHW:
+            return tensor.GetRow<T>(n, c * d.h + y) + x;
+        case M_LAYOUT_NHWC:
+            return tensor.GetRow<T>(n, y) + x * d.c + c;
+        default: {
+            const uint32_t block = tensor.GetChannelBlock();
+            return tensor.GetRow<T>(n, c / block * d.h + y) + x * block + c % block;
+        }
+    }
+}
+
+/// any pair of layouts, one task per image row
+template <typename T>
+static void ConvertElements(const Tensor& input, Tensor& out, const LayoutDims& d) {
+    const uint32_t block = out.GetChannelBlock();
+    const uint32_t c_pad = (d.c + block - 1) / block * block;
+    ParallelFor(d.n * d.h, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t t = begin; t < end; ++t) {
+            const uint32_t n = t / d.h, y = t % d.h;
+            for (uint32_t c = 0; c < c_pad; ++c) {
+                for (uint32_t x = 0; x < d.w; ++x) {
+                    *ElementPtr<T>(out, d, n, c, y, x) =
+                        c < d.c ? *ElementPtr<T>(input, d, n, c, y, x) : T(0);
+                }
+            }
+        }
+    });
+}
+
+/// NHWC <-> blocked, every pixel copies the channels of one block
+static void ConvertPixelBlocks(const Tensor& input, Tensor& out, const LayoutDims& d) {
+    const bool to_blocked = out.GetChannelBlock() != 1U;
+    const Tensor& blocked = to_blocked ? out : input;
+    const Tensor& pixels  = to_blocked ? input : out;
+    const uint32_t block  = blocked.GetChannelBlock();
+    const uint32_t ts     = input.GetTypeSize();
+    const uint32_t rows   = blocked.GetRows();
+    ParallelFor(d.n * rows, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t t = begin; t < end; ++t) {
+            const uint32_t n = t / rows, r = t % rows, cb = r / d.h, y = r % d.h;
+            const uint32_t valid = std::min(block, d.c - cb * block);
+            uint8_t* packed      = blocked.GetRow<uint8_t>(n, r);
+            uint8_t* pixel       = pixels.GetRow<uint8_t>(n, y) + cb * block * ts;
+            for (uint32_t x = 0; x < d.w; ++x) {
+                uint8_t* p = packed + x * block * ts;
+                uint8_t* q = pixel + x * d.c * ts;
+                if (to_blocked) {
+                    memcpy(p, q, valid * ts);
+                    memset(p + valid * ts, 0, (block - valid) * ts);
+                } else {
+                    memcpy(q, p, valid * ts);
+                }
+            }
+        }
+    });
+}
+
+/// vectorized part of ConvertPlaneBlocks, returns count of pixels done
+template <typename T>
+static uint32_t
+TransposeBlocks(T*, T* const*, const uint32_t, const uint32_t, const uint32_t, const bool) {
+    return 0;
+}
+
+#ifdef USE_AVX
+static void Transpose8x8(__m256* r) {
+    const __m256 t0 = _mm256_unpacklo_ps(r[0], r[1]);
+    const __m256 t1 = _mm256_unpackhi_ps(r[0], r[1]);
+    const __m256 t2 = _mm256_unpacklo_ps(r[2], r[3]);
+    const __m256 t3 = _mm256_unpackhi_ps(r[2], r[3]);
+    const __m256 t4 = _mm256_unpacklo_ps(r[4], r[5]);
+    const __m256 t5 = _mm256_unpackhi_ps(r[4], r[5]);
+    const __m256 t6 = _mm256_unpacklo_ps(r[6], r[7]);
+    const __m256 t7 = _mm256_unpackhi_ps(r[6], r[7]);
+    const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    r[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    r[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    r[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    r[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    r[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    r[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    r[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    r[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+/// 32bits elements, 8 channels * 8 pixels per transpose, bits are moved as float
+static uint32_t TransposeBlocks(uint32_t* packed,
+                                uint32_t* const* planes,
+                                const uint32_t block,
+                                const uint32_t valid,
+                                const uint32_t width,
+                                const bool to_blocked) {
+    if (valid != block) {
+        return 0;
+    }
+    float* p   = reinterpret_cast<float*>(packed);
+    uint32_t x = 0;
+    __m256 r[8];
+    for (; x + 8 <= width; x += 8) {
+        for (uint32_t g = 0; g < block; g += 8) {
+            if (to_blocked) {
+                for (uint32_t i = 0; i < 8; ++i) {
+                    r[i] = _mm256_loadu_ps(reinterpret_cast<const float*>(planes[g + i] + x));
+                }
+                Transpose8x8(r);
+                for (uint32_t j = 0; j < 8; ++j) {
+                    _mm256_storeu_ps(p + (x + j) * block + g, r[j]);
+                }
+            } else {
+                for (uint32_t j = 0; j < 8; ++j) {
+                    r[j] = _mm256_loadu_ps(p + (x + j) * block + g);
+                }
+                Transpose8x8(r);
+                for (uint32_t i = 0; i < 8; ++i) {
+                    _mm256_storeu_ps(reinterpret_cast<float*>(planes[g + i] + x), r[i]);
+                }
+            }
+        }
+    }
+    return x;
+}
+#endif // USE_AVX
+
+/// NCHW <-> blocked, one task per row of blocked tensor
+template <typename T>
+static void ConvertPlaneBlocks(const Tensor& input, Tensor& out, const LayoutDims& d) {
+    const bool to_blocked = out.GetChannelBlock() != 1U;
+    const Tensor& blocked = to_blocked ? out : input;
+    const Tensor& planar  = to_blocked ? input : out;
+    const uint32_t block  = blocked.GetChannelBlock();
+    const uint32_t rows   = blocked.GetRows();
+    ParallelFor(d.n * rows, 1, [&](uint32_t begin, uint32_t end) {
+        T* planes[16];
+        for (uint32_t t = begin; t < end; ++t) {
+            const uint32_t n = t / rows, r = t % rows, cb = r / d.h, y = r % d.h;
+            const uint32_t valid = std::min(block, d.c - cb * block);
+            T* packed            = blocked.GetRow<T>(n, r);
+            for (uint32_t i = 0; i < valid; ++i) {
+                planes[i] = planar.GetRow<T>(n, (cb * block + i) * d.h + y);
+            }
+            uint32_t x = TransposeBlocks(packed, planes, block, valid, d.w, to_blocked);
+            for (; x < d.w; ++x) {
+                for (uint32_t i = 0; i < block; ++i) {
+                    if (to_blocked) {
+                        packed[x * block + i] = i < valid ? planes[i][x] : T(0);
+                    } else if (i < valid) {
+                        planes[i][x] = packed[x * block + i];
+                    }
+                }
+            }
+        }
+    });
+}
+
+template <typename T>
+static void Convert(const Tensor& input, Tensor& out, const LayoutDims& d) {
+    const TensorLayout in_layout = input.GetShapeMode(), out_layout = out.GetShapeMode();
+    if ((in_layout == M_LAYOUT_NCHW && out.GetChannelBlock() != 1U) ||
+        (out_layout == M_LAYOUT_NCHW && input.GetChannelBlock() != 1U)) {
+        ConvertPlaneBlocks<T>(input, out, d);
+    } else if ((in_layout == M_LAYOUT_NHWC && out.GetChannelBlock() != 1U) ||
+               (out_layout == M_LAYOUT_NHWC && input.GetChannelBlock() != 1U)) {
+        ConvertPixelBlocks(input, out, d);
+    } else {
+        ConvertElements<T>(input, out, d);
+    }
+}
+
+MStatus convert_layout(const Tensor& input, const TensorLayout layout, Tensor& out) {
+    if (nullptr == input.GetData<void>() || input.GetShape().size() != 4 ||
+        layout >= M_LAYOUT_MAX || &input == &out) {
+        SIMPLE_LOG_ERROR("convert_layout failed, input tensor is empty or layout %i illegal",
+                         static_cast<int>(layout));
+        return MStatus::M_INVALID_ARG;
+    }
+    if (input.GetShapeMode() == layout) {
+        return input.CloneInto(out);
+    }
+
+    const LayoutDims d          = GetDims(input);
+    std::vector<uint32_t> shape = layout == M_LAYOUT_NHWC
+                                      ? std::vector<uint32_t>{d.n, d.h, d.w, d.c}
+                                      : std::vector<uint32_t>{d.n, d.c, d.h, d.w};
+    if (nullptr == out.GetData<void>() || out.GetShape() != shape ||
+        out.GetShapeMode() != layout || out.GetElemType() != input.GetElemType()) {
+        out = Tensor(shape, layout, M_MEM_ON_CPU, input.GetElemType(), input.GetPadding());
+        if (nullptr == out.GetData<void>()) {
+            SIMPLE_LOG_ERROR("convert_layout failed, malloc [%u, %u, %u, %u] failed",
+                             shape[0],
+                             shape[1],
+                             shape[2],
+                             shape[3]);
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+    }
+    out.SetName(input.GetName());
+    input.GetDataManager()->SyncCache(false);
+
+    switch (input.GetTypeSize()) {
+        case 1U:
+            Convert<uint8_t>(input, out, d);
+            break;
+        case 2U:
+            Convert<uint16_t>(input, out, d);
+            break;
+        case 4U:
+            Convert<uint32_t>(input, out, d);
+            break;
+        default:
+            SIMPLE_LOG_ERROR("convert_layout can't support %s",
+                             DataTypeStr[input.GetElemType()].c_str());
+            return MStatus::M_NOT_SUPPORT;
+    }
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor> convert_layout(const std::shared_ptr<Tensor>& input,
+                                       const TensorLayout layout) {
+    auto out = std::make_shared<Tensor>();
+    if (nullptr == input || nullptr == out ||
+        convert_layout(*input, layout, *out) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return out;
+}
+
+} // namespace base
@@ -0,0 +1,497 @@
+#include "tensor/reduce.h"
+
+#include "intrinsic.h"
+#include "manager/pipe_manager.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string.h>
+
+namespace base {
+
+// columns of one strided task, keeps the accumulators of a task in L1
+static constexpr uint32_t kColumnChunk = 1024;
+// elements of one parallel task
+static constexpr uint32_t kTaskGrain = 16384;
+
+/// @brief view shape as [outer, len, inner] around axis
+static bool SplitAxis(const Tensor& tensor,
+                      const uint32_t axis,
+                      uint32_t& outer,
+                      uint32_t& len,
+                      uint32_t& inner) {
+    if (tensor.GetData<float>(0) == nullptr) {
+        SIMPLE_LOG_ERROR("reduce failed, input tensor is empty");
+        return false;
+    }
+    if (tensor.GetElemType() != M_DATA_TYPE_FLOAT32) {
+        SIMPLE_LOG_ERROR("reduce only support fp32, but %s",
+                         DataTypeStr[tensor.GetElemType()].c_str());
+        return false;
+    }
+    if (tensor.GetChannelBlock() != 1U) {
+        SIMPLE_LOG_ERROR("reduce can't support layout %s", tensor.GetShapeModeStr().c_str());
+        return false;
+    }
+    const std::vector<uint32_t>& shape = tensor.GetShape();
+    if (shape.size() != 4 || axis >= shape.size()) {
+        SIMPLE_LOG_ERROR("reduce axis %u out of range", axis);
+        return false;
+    }
+    outer = 1;
+    inner = 1;
+    len   = shape[axis];
+    for (uint32_t i = 0; i < axis; ++i) {
+        outer *= shape[i];
+    }
+    for (uint32_t i = axis + 1; i < shape.size(); ++i) {
+        inner *= shape[i];
+    }
+    return len > 0;
+}
+
+static float RowSum(const float* x, const uint32_t n) {
+    uint32_t i = 0;
+    float sum  = 0.f;
+#ifdef USE_AVX
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_loadu_ps(x + i));
+        acc1 = _mm256_add_ps(acc1, _mm256_loadu_ps(x + i + 8));
+    }
+    sum = vhsum_f32x8_avx(_mm256_add_ps(acc0, acc1));
+#endif
+    for (; i < n; ++i) {
+        sum += x[i];
+    }
+    return sum;
+}
+
+static float RowSumSquare(const float* x, const uint32_t n) {
+    uint32_t i = 0;
+    float sum  = 0.f;
+#ifdef USE_AVX
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        const __m256 v0 = _mm256_loadu_ps(x + i), v1 = _mm256_loadu_ps(x + i + 8);
+        acc0            = _mm256_add_ps(acc0, _mm256_mul_ps(v0, v0));
+        acc1            = _mm256_add_ps(acc1, _mm256_mul_ps(v1, v1));
+    }
+    sum = vhsum_f32x8_avx(_mm256_add_ps(acc0, acc1));
+#endif
+    for (; i < n; ++i) {
+        sum += x[i] * x[i];
+    }
+    return sum;
+}
+
+static float RowMax(const float* x, const uint32_t n) {
+    uint32_t i = 0;
+    float m    = x[0];
+#ifdef USE_AVX
+    if (n >= 8) {
+        __m256 acc = _mm256_loadu_ps(x);
+        for (i = 8; i + 8 <= n; i += 8) {
+            acc = _mm256_max_ps(acc, _mm256_loadu_ps(x + i));
+        }
+        m = vhmax_f32x8_avx(acc);
+    }
+#endif
+    for (; i < n; ++i) {
+        m = std::max(m, x[i]);
+    }
+    return m;
+}
+
+static float RowMin(const float* x, const uint32_t n) {
+    uint32_t i = 0;
+    float m    = x[0];
+#ifdef USE_AVX
+    if (n >= 8) {
+        __m256 acc = _mm256_loadu_ps(x);
+        for (i = 8; i + 8 <= n; i += 8) {
+            acc = _mm256_min_ps(acc, _mm256_loadu_ps(x + i));
+        }
+        m = vhmin_f32x8_avx(acc);
+    }
+#endif
+    for (; i < n; ++i) {
+        m = std::min(m, x[i]);
+    }
+    return m;
+}
+
+/// y = exp(x - m), return sum of y, y can be nullptr
+static float RowExpSum(const float* x, const float m, float* y, const uint32_t n) {
+    uint32_t i = 0;
+    float sum  = 0.f;
+#ifdef USE_AVX
+    const __m256 vm = _mm256_set1_ps(m);
+    __m256 acc      = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        const __m256 e = vexp_f32x8_avx(_mm256_sub_ps(_mm256_loadu_ps(x + i), vm));
+        acc            = _mm256_add_ps(acc, e);
+        if (y) {
+            _mm256_storeu_ps(y + i, e);
+        }
+    }
+    sum = vhsum_f32x8_avx(acc);
+#endif
+    for (; i < n; ++i) {
+        const float e = expf(x[i] - m);
+        sum += e;
+        if (y) {
+            y[i] = e;
+        }
+    }
+    return sum;
+}
+
+/// y[j] = exp(x[j] - m[j]), s[j] += y[j]
+static void ColExpSum(const float* x, const float* m, float* y, float* s, const uint32_t n) {
+    uint32_t j = 0;
+#ifdef USE_AVX
+    for (; j + 8 <= n; j += 8) {
+        const __m256 e =
+            vexp_f32x8_avx(_mm256_sub_ps(_mm256_loadu_ps(x + j), _mm256_loadu_ps(m + j)));
+        _mm256_storeu_ps(s + j, _mm256_add_ps(_mm256_loadu_ps(s + j), e));
+        if (y) {
+            _mm256_storeu_ps(y + j, e);
+        }
+    }
+#endif
+    for (; j < n; ++j) {
+        const float e = expf(x[j] - m[j]);
+        s[j] += e;
+        if (y) {
+            y[j] = e;
+        }
+    }
+}
+
+static void ScaleRow(float* y, const float scale, const uint32_t n) {
+    for (uint32_t i = 0; i < n; ++i) {
+        y[i] *= scale;
+    }
+}
+
+/// reduce one contiguous slice of len elements
+static void ReduceRow(const float* x, const uint32_t len, const ReduceType type, void* dst) {
+    float* out_f   = static_cast<float*>(dst);
+    int32_t* out_i = static_cast<int32_t*>(dst);
+    switch (type) {
+        case M_REDUCE_SUM:
+            *out_f = RowSum(x, len);
+            break;
+        case M_REDUCE_MEAN:
+            *out_f = RowSum(x, len) / static_cast<float>(len);
+            break;
+        case M_REDUCE_MIN:
+            *out_f = RowMin(x, len);
+            break;
+        case M_REDUCE_MAX:
+            *out_f = RowMax(x, len);
+            break;
+        case M_REDUCE_ARGMIN:
+        case M_REDUCE_ARGMAX: {
+            // vectorized extreme first, then locate its first position
+            const float m = (type == M_REDUCE_ARGMAX) ? RowMax(x, len) : RowMin(x, len);
+            uint32_t idx  = 0;
+            while (idx + 1 < len && x[idx] != m) {
+                ++idx;
+            }
+            *out_i = static_cast<int32_t>(idx);
+            break;
+        }
+        case M_REDUCE_L2:
+            *out_f = sqrtf(RowSumSquare(x, len));
+            break;
+        case M_REDUCE_LOG_SUM_EXP: {
+            const float m = RowMax(x, len);
+            *out_f        = m + logf(RowExpSum(x, m, nullptr, len));
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/// reduce columns [0, width) of rows x + a * step, a in [0, len)
+static void ReduceColumns(const float* x,
+                          const uint32_t len,
+                          const size_t step,
+                          const uint32_t width,
+                          const ReduceType type,
+                          void* dst) {
+    float* out_f   = static_cast<float*>(dst);
+    int32_t* out_i = static_cast<int32_t*>(dst);
+    switch (type) {
+        case M_REDUCE_SUM:
+        case M_REDUCE_MEAN:
+        case M_REDUCE_L2: {
+            const bool square = (type == M_REDUCE_L2);
+            for (uint32_t j = 0; j < width; ++j) {
+                out_f[j] = square ? x[j] * x[j] : x[j];
+            }
+            for (uint32_t a = 1; a < len; ++a) {
+                const float* row = x + a * step;
+                if (square) {
+                    for (uint32_t j = 0; j < width; ++j) {
+                        out_f[j] += row[j] * row[j];
+                    }
+                } else {
+                    for (uint32_t j = 0; j < width; ++j) {
+                        out_f[j] += row[j];
+                    }
+                }
+            }
+            if (type == M_REDUCE_MEAN) {
+                ScaleRow(out_f, 1.f / static_cast<float>(len), width);
+            } else if (square) {
+                for (uint32_t j = 0; j < width; ++j) {
+                    out_f[j] = sqrtf(out_f[j]);
+                }
+            }
+            break;
+        }
+        case M_REDUCE_MIN:
+        case M_REDUCE_MAX: {
+            memcpy(out_f, x, width * sizeof(float));
+            for (uint32_t a = 1; a < len; ++a) {
+                const float* row = x + a * step;
+                if (type == M_REDUCE_MAX) {
+                    for (uint32_t j = 0; j < width; ++j) {
+                        out_f[j] = std::max(out_f[j], row[j]);
+                    }
+                } else {
+                    for (uint32_t j = 0; j < width; ++j) {
+                        out_f[j] = std::min(out_f[j], row[j]);
+                    }
+                }
+            }
+            break;
+        }
+        case M_REDUCE_ARGMIN:
+        case M_REDUCE_ARGMAX: {
+            const bool is_max = (type == M_REDUCE_ARGMAX);
+            float best[kColumnChunk];
+            memcpy(best, x, width * sizeof(float));
+            memset(out_i, 0, width * sizeof(int32_t));
+            for (uint32_t a = 1; a < len; ++a) {
+                const float* row = x + a * step;
+                for (uint32_t j = 0; j < width; ++j) {
+                    const bool better = is_max ? (row[j] > best[j]) : (row[j] < best[j]);
+                    best[j]           = better ? row[j] : best[j];
+                    out_i[j]          = better ? static_cast<int32_t>(a) : out_i[j];
+                }
+            }
+            break;
+        }
+        case M_REDUCE_LOG_SUM_EXP: {
+            float m[kColumnChunk];
+            memcpy(m, x, width * sizeof(float));
+            for (uint32_t a = 1; a < len; ++a) {
+                const float* row = x + a * step;
+                for (uint32_t j = 0; j < width; ++j) {
+                    m[j] = std::max(m[j], row[j]);
+                }
+            }
+            memset(out_f, 0, width * sizeof(float));
+            for (uint32_t a = 0; a < len; ++a) {
+                ColExpSum(x + a * step, m, nullptr, out_f, width);
+            }
+            for (uint32_t j = 0; j < width; ++j) {
+                out_f[j] = m[j] + logf(out_f[j]);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/// elements of tensor as rows of row elements, stride elements apart
+typedef struct RowView {
+    size_t row;    ///< elements of a row, all elements of a dense tensor
+    size_t stride; ///< elements between rows
+} RowView;
+
+static RowView ViewRows(const Tensor& tensor) {
+    RowView view;
+    view.row    = std::max<size_t>(
+        1U, tensor.IsDense() ? tensor.GetCount() : tensor.GetRowSize() / sizeof(float));
+    view.stride = tensor.IsDense() ? view.row : tensor.GetStride() / sizeof(float);
+    return view;
+}
+
+/// offset of element i of the dense order in padded rows
+static inline size_t RowOffset(const RowView& view, const size_t i) {
+    return i / view.row * view.stride + i % view.row;
+}
+
+/// @brief tasks of columns of [outer, len, inner], columns of a task lie in one row
+/// @note
+/// a row is W of NCHW or W * C of NHWC, so inner below a row divides the row and inner
+/// above a row is whole rows. a slice of inner 1 longer than a row has rows of 1 element. columns of segment seg are contiguous in memory and element a
+/// of the axis is step elements after element a - 1
+typedef struct ColumnTasks {
+    uint32_t seg;    ///< contiguous columns of a segment
+    uint32_t segs;   ///< segments of inner
+    uint32_t chunks; ///< tasks of a segment
+    size_t step;     ///< elements between neighbours along axis
+} ColumnTasks;
+
+static ColumnTasks SplitColumns(const RowView& view, const uint32_t inner) {
+    ColumnTasks tasks;
+    tasks.seg    = static_cast<uint32_t>(std::max<size_t>(1U, std::min<size_t>(inner, view.row)));
+    tasks.segs   = inner / tasks.seg;
+    tasks.chunks = (tasks.seg + kColumnChunk - 1) / kColumnChunk;
+    tasks.step   = RowOffset(view, inner);
+    return tasks;
+}
+
+/// column j and width of task t of outer slice o
+static inline void ColumnTask(const ColumnTasks& tasks,
+                              const uint32_t t,
+                              uint32_t& o,
+                              uint32_t& j,
+                              uint32_t& width) {
+    const uint32_t per_outer = tasks.segs * tasks.chunks;
+    const uint32_t q = (t % per_outer) / tasks.chunks, c = (t % per_outer) % tasks.chunks;
+    o     = t / per_outer;
+    j     = q * tasks.seg + c * kColumnChunk;
+    width = std::min(kColumnChunk, tasks.seg - c * kColumnChunk);
+}
+
+MStatus reduce(const Tensor& input, const uint32_t axis, const ReduceType type, Tensor& out) {
+    uint32_t outer = 0, len = 0, inner = 0;
+    if (&input == &out || !SplitAxis(input, axis, outer, len, inner)) {
+        return MStatus::M_INVALID_ARG;
+    }
+    if (type >= M_REDUCE_MAX_TYPE) {
+        SIMPLE_LOG_ERROR("reduce type %i illegal", static_cast<int>(type));
+        return MStatus::M_INVALID_ARG;
+    }
+
+    std::vector<uint32_t> shape = input.GetShape();
+    shape[axis]                 = 1;
+    const bool is_arg           = (type == M_REDUCE_ARGMIN || type == M_REDUCE_ARGMAX);
+    MStatus status              = out.Reset(
+        shape, input.GetShapeMode(), is_arg ? M_DATA_TYPE_INT32 : M_DATA_TYPE_FLOAT32);
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+
+    // padded rows are read in place through their stride
+    const RowView view = ViewRows(input);
+    const float* src   = input.GetData<float>(0);
+    uint8_t* dst       = out.GetData<uint8_t>(0);
+    // trailing dims of 1 put every element of axis in a padded row of its own, then the
+    // slice runs down the strided column path
+    if (inner == 1 && len <= view.row) {
+        const uint32_t grain = std::max(1U, kTaskGrain / len);
+        ParallelFor(outer, grain, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t o = begin; o < end; ++o) {
+                ReduceRow(src + RowOffset(view, static_cast<size_t>(o) * len),
+                          len,
+                          type,
+                          dst + o * sizeof(float));
+            }
+        });
+        return MStatus::M_OK;
+    }
+
+    const ColumnTasks tasks = SplitColumns(view, inner);
+    const uint32_t grain    = std::max(1U, kTaskGrain / (len * std::min(tasks.seg, kColumnChunk)));
+    ParallelFor(outer * tasks.segs * tasks.chunks, grain, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t t = begin; t < end; ++t) {
+            uint32_t o = 0, j = 0, width = 0;
+            ColumnTask(tasks, t, o, j, width);
+            ReduceColumns(src + RowOffset(view, static_cast<size_t>(o) * len * inner + j),
+                          len,
+                          tasks.step,
+                          width,
+                          type,
+                          dst + (static_cast<size_t>(o) * inner + j) * sizeof(float));
+        }
+    });
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor>
+reduce(const std::shared_ptr<Tensor>& tensor, const uint32_t axis, const ReduceType type) {
+    auto out = std::make_shared<Tensor>();
+    if (nullptr == tensor || reduce(*tensor, axis, type, *out) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return out;
+}
+
+MStatus softmax(const Tensor& input, const uint32_t axis, Tensor& out) {
+    uint32_t outer = 0, len = 0, inner = 0;
+    if (&input == &out || !SplitAxis(input, axis, outer, len, inner)) {
+        return MStatus::M_INVALID_ARG;
+    }
+    MStatus status = out.Reset(
+        input.GetShape(), input.GetShapeMode(), M_DATA_TYPE_FLOAT32, input.GetPadding());
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+
+    // out has the rows of input, padded rows of both are indexed through their stride
+    const RowView view = ViewRows(input), out_view = ViewRows(out);
+    const float* src   = input.GetData<float>(0);
+    float* dst         = out.GetData<float>(0);
+    if (inner == 1 && len <= view.row) {
+        const uint32_t grain = std::max(1U, kTaskGrain / len);
+        ParallelFor(outer, grain, [&](uint32_t begin, uint32_t end) {
+            for (uint32_t o = begin; o < end; ++o) {
+                const float* x = src + RowOffset(view, static_cast<size_t>(o) * len);
+                float* y       = dst + RowOffset(out_view, static_cast<size_t>(o) * len);
+                const float s  = RowExpSum(x, RowMax(x, len), y, len);
+                ScaleRow(y, 1.f / s, len);
+            }
+        });
+        return MStatus::M_OK;
+    }
+
+    const ColumnTasks tasks = SplitColumns(view, inner);
+    const size_t out_step   = RowOffset(out_view, inner);
+    const uint32_t grain    = std::max(1U, kTaskGrain / (len * std::min(tasks.seg, kColumnChunk)));
+    ParallelFor(outer * tasks.segs * tasks.chunks, grain, [&](uint32_t begin, uint32_t end) {
+        float m[kColumnChunk], s[kColumnChunk];
+        for (uint32_t t = begin; t < end; ++t) {
+            uint32_t o = 0, j = 0, width = 0;
+            ColumnTask(tasks, t, o, j, width);
+            const size_t first = static_cast<size_t>(o) * len * inner + j;
+            const float* x     = src + RowOffset(view, first);
+            float* y           = dst + RowOffset(out_view, first);
+            ReduceColumns(x, len, tasks.step, width, M_REDUCE_MAX, m);
+            memset(s, 0, width * sizeof(float));
+            for (uint32_t a = 0; a < len; ++a) {
+                ColExpSum(x + a * tasks.step, m, y + a * out_step, s, width);
+            }
+            for (uint32_t jj = 0; jj < width; ++jj) {
+                s[jj] = 1.f / s[jj];
+            }
+            for (uint32_t a = 0; a < len; ++a) {
+                float* row = y + a * out_step;
+                for (uint32_t jj = 0; jj < width; ++jj) {
+                    row[jj] *= s[jj];
+                }
+            }
+        }
+    });
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor> softmax(const std::shared_ptr<Tensor>& tensor, const uint32_t axis) {
+    auto out = std::make_shared<Tensor>();
+    if (nullptr == tensor || softmax(*tensor, axis, *out) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return out;
+}
+
+} // namespace base
@@ -0,0 +1,241 @@
+#include "tensor/sparse.h"
+
+#include "intrinsic.h"
+#include "manager/data_manager.h"
+#include "manager/pipe_manager.h"
+
+#include <cmath>
+#include <string.h>
+
+namespace base {
+
+static bool IsMatrix(const std::shared_ptr<Tensor>& tensor) {
+    return tensor != nullptr && tensor->GetShape().size() == 4 && tensor->GetShape(0) == 1 &&
+           tensor->GetShape(1) == 1 && tensor->GetData<void>() != nullptr &&
+           tensor->GetElemType() == M_DATA_TYPE_FLOAT32 && tensor->GetChannelBlock() == 1U;
+}
+
+/// elements between rows of 2D matrix
+static uint32_t RowPitch(const std::shared_ptr<Tensor>& tensor) {
+    if (tensor->GetShapeMode() == M_LAYOUT_NHWC) {
+        return tensor->GetShape(3);
+    }
+    return tensor->GetStride() / tensor->GetTypeSize();
+}
+
+/// dense copy of bias in scratch buffer, data is nullptr without bias
+static bool DenseBias(const std::shared_ptr<Tensor>& bias, const uint32_t n, const float*& data) {
+    data = nullptr;
+    if (nullptr == bias) {
+        return true;
+    }
+    if (bias->GetElemType() != M_DATA_TYPE_FLOAT32 || bias->GetCount() != n) {
+        SIMPLE_LOG_ERROR("sparse bias must be fp32 with %u elements", n);
+        return false;
+    }
+    float* dense = static_cast<float*>(GetScratch(0, n * sizeof(float)));
+    data         = dense;
+    return dense != nullptr && bias->CopyToDense(dense) == MStatus::M_OK;
+}
+
+/// y[i] += alpha * x[i]
+static void Axpy(float* y, const float* x, const float alpha, const uint32_t size) {
+    uint32_t i = 0;
+#ifdef USE_AVX
+    const __m256 va = _mm256_set1_ps(alpha);
+    for (; i + 8 <= size; i += 8) {
+        const __m256 vy = _mm256_loadu_ps(y + i);
+        _mm256_storeu_ps(y + i, _mm256_add_ps(vy, _mm256_mul_ps(va, _mm256_loadu_ps(x + i))));
+    }
+#endif
+    for (; i < size; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+std::shared_ptr<SparseMatrix> SparseMatrix::FromDense(const std::shared_ptr<Tensor>& dense,
+                                                      const float threshold,
+                                                      const uint32_t block) {
+    if (!IsMatrix(dense) || block == 0) {
+        SIMPLE_LOG_ERROR("SparseMatrix::FromDense only support fp32 2D matrix, block %u", block);
+        return nullptr;
+    }
+    std::shared_ptr<SparseMatrix> result(new SparseMatrix());
+    result->rows_  = dense->GetShape(2);
+    result->cols_  = dense->GetShape(3);
+    result->block_ = block;
+    result->row_ptr_.reserve(result->rows_ + 1);
+    result->row_ptr_.push_back(0);
+
+    const uint32_t cols = result->cols_;
+    for (uint32_t r = 0; r < result->rows_; ++r) {
+        const float* row = dense->GetData<float>(0) + r * RowPitch(dense);
+        for (uint32_t c0 = 0; c0 < cols; c0 += block) {
+            const uint32_t width = std::min(block, cols - c0);
+            bool keep            = false;
+            for (uint32_t t = 0; t < width && !keep; ++t) {
+                keep = std::fabs(row[c0 + t]) > threshold;
+            }
+            if (!keep) {
+                continue;
+            }
+            result->columns_.push_back(c0);
+            for (uint32_t t = 0; t < block; ++t) {
+                result->values_.push_back(t < width ? row[c0 + t] : 0.f);
+            }
+        }
+        result->row_ptr_.push_back(static_cast<uint32_t>(result->columns_.size()));
+    }
+    return result;
+}
+
+std::shared_ptr<Tensor> SparseMatrix::ToDense() const {
+    auto dense = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, rows_, cols_},
+                                          M_LAYOUT_NCHW,
+                                          M_MEM_ON_CPU,
+                                          M_DATA_TYPE_FLOAT32);
+    if (nullptr == dense->GetData<void>()) {
+        SIMPLE_LOG_ERROR("SparseMatrix::ToDense malloc [1, 1, %u, %u] failed", rows_, cols_);
+        return nullptr;
+    }
+    memset(dense->GetData<void>(), 0, dense->GetSize());
+    for (uint32_t r = 0; r < rows_; ++r) {
+        float* row = dense->GetRow<float>(0, r);
+        for (uint32_t b = row_ptr_[r]; b < row_ptr_[r + 1]; ++b) {
+            const uint32_t width = std::min(block_, cols_ - columns_[b]);
+            memcpy(row + columns_[b], &values_[b * block_], width * sizeof(float));
+        }
+    }
+    return dense;
+}
+
+MStatus spmm(const SparseMatrix& left,
+             const std::shared_ptr<Tensor>& right,
+             const std::shared_ptr<Tensor>& bias,
+             Tensor& out) {
+    if (!IsMatrix(right) || right->GetShape(2) != left.GetCols() || right.get() == &out) {
+        SIMPLE_LOG_ERROR("spmm right must be fp32 2D matrix of %u rows", left.GetCols());
+        return MStatus::M_INVALID_ARG;
+    }
+    const uint32_t R = left.GetRows(), K = left.GetCols(), N = right->GetShape(3);
+    const float* bias_data = nullptr;
+    if (!DenseBias(bias, R, bias_data)) {
+        return MStatus::M_INVALID_ARG;
+    }
+    MStatus status = out.Reset(
+        std::vector<uint32_t>{1, 1, R, N}, M_LAYOUT_NCHW, M_DATA_TYPE_FLOAT32, right->GetPadding());
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+
+    const uint32_t block = left.GetBlock();
+    const uint32_t ldb   = RowPitch(right);
+    const float* b       = right->GetData<float>(0);
+    const float* values  = left.GetValues().data();
+    const auto& row_ptr  = left.GetRowPtr();
+    const auto& columns  = left.GetColumns();
+    const uint32_t grain = std::max(1U, 4096U / std::max(1U, N));
+    ParallelFor(R, grain, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t r = begin; r < end; ++r) {
+            float* c = out.GetRow<float>(0, r);
+            std::fill(c, c + N, bias_data ? bias_data[r] : 0.f);
+            for (uint32_t blk = row_ptr[r]; blk < row_ptr[r + 1]; ++blk) {
+                const uint32_t k0 = columns[blk], width = std::min(block, K - k0);
+                for (uint32_t t = 0; t < width; ++t) {
+                    const float v = values[blk * block + t];
+                    if (v != 0.f) {
+                        Axpy(c, b + (k0 + t) * ldb, v, N);
+                    }
+                }
+            }
+        }
+    });
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor> spmm(const SparseMatrix& left,
+                             const std::shared_ptr<Tensor>& right,
+                             const std::shared_ptr<Tensor>& bias) {
+    auto out = std::make_shared<Tensor>();
+    if (spmm(left, right, bias, *out) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return out;
+}
+
+/// y[0, width) += alpha * v, blocks of 8 and 16 are whole SIMD ops
+static inline void AddBlock(float* y, const float alpha, const float* v, const uint32_t width) {
+    uint32_t t = 0;
+#ifdef USE_AVX
+    const __m256 va = _mm256_set1_ps(alpha);
+    for (; t + 8 <= width; t += 8) {
+        const __m256 vy = _mm256_loadu_ps(y + t);
+        _mm256_storeu_ps(y + t, _mm256_add_ps(vy, _mm256_mul_ps(va, _mm256_loadu_ps(v + t))));
+    }
+#endif
+    for (; t < width; ++t) {
+        y[t] += alpha * v[t];
+    }
+}
+
+MStatus innerproduct_sparse(const std::shared_ptr<Tensor>& left,
+                            const SparseMatrix& right,
+                            const std::shared_ptr<Tensor>& bias,
+                            Tensor& out) {
+    if (!IsMatrix(left) || left->GetShape(3) != right.GetRows() || left.get() == &out) {
+        SIMPLE_LOG_ERROR("innerproduct_sparse left must be fp32 2D matrix of %u cols",
+                         right.GetRows());
+        return MStatus::M_INVALID_ARG;
+    }
+    const uint32_t M = left->GetShape(2), K = right.GetRows(), N = right.GetCols();
+    const float* bias_data = nullptr;
+    if (!DenseBias(bias, N, bias_data)) {
+        return MStatus::M_INVALID_ARG;
+    }
+    MStatus status = out.Reset(
+        std::vector<uint32_t>{1, 1, M, N}, M_LAYOUT_NCHW, M_DATA_TYPE_FLOAT32, left->GetPadding());
+    if (status != MStatus::M_OK) {
+        return status;
+    }
+
+    const uint32_t block = right.GetBlock();
+    const uint32_t lda   = RowPitch(left);
+    const float* a       = left->GetData<float>(0);
+    const float* values  = right.GetValues().data();
+    const auto& row_ptr  = right.GetRowPtr();
+    const auto& columns  = right.GetColumns();
+    ParallelFor(M, 1, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; ++i) {
+            float* c = out.GetRow<float>(0, i);
+            if (nullptr == bias_data) {
+                memset(c, 0, N * sizeof(float));
+            } else {
+                memcpy(c, bias_data, N * sizeof(float));
+            }
+            const float* a_row = a + i * lda;
+            for (uint32_t k = 0; k < K; ++k) {
+                const float x = a_row[k];
+                if (x == 0.f) {
+                    continue;
+                }
+                for (uint32_t blk = row_ptr[k]; blk < row_ptr[k + 1]; ++blk) {
+                    const uint32_t n0 = columns[blk];
+                    AddBlock(c + n0, x, values + blk * block, std::min(block, N - n0));
+                }
+            }
+        }
+    });
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor> innerproduct_sparse(const std::shared_ptr<Tensor>& left,
+                                            const SparseMatrix& right,
+                                            const std::shared_ptr<Tensor>& bias) {
+    auto out = std::make_shared<Tensor>();
+    if (innerproduct_sparse(left, right, bias, *out) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return out;
+}
+
+} // namespace base
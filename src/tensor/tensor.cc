@@ -1,4 +1,6 @@
 #include "tensor/tensor.h"
+#include "image/image.h"
+#include "manager/memory_copy.h"
 
 #include <string.h>
 
@@ -30,6 +32,17 @@ static uint32_t TypeSize(DataType elem_type) {
     return size;
 }
 
+static uint32_t RowPitch(const uint32_t row_size, const TensorPadding padding) {
+    if (padding == M_TENSOR_PADDING_NONE) {
+        return row_size;
+    }
+    uint32_t pitch = static_cast<uint32_t>(align_size(row_size, TENSOR_PITCH_ALIGN));
+    if (padding == M_TENSOR_PADDING_DEALIAS && pitch % TENSOR_DEALIAS_PITCH == 0) {
+        pitch += TENSOR_PITCH_ALIGN;
+    }
+    return pitch;
+}
+
 Tensor::Tensor()
     : shape_{},
       stride_{0},
@@ -46,7 +59,8 @@ Tensor::Tensor()
 Tensor::Tensor(const std::vector<uint32_t>& shape,
                const TensorLayout& layout,
                const MemoryType& mem_type,
-               const DataType& element_type)
+               const DataType& element_type,
+               const TensorPadding padding)
     : shape_{shape},
       stride_{0},
       nscalar_{0},
@@ -55,8 +69,10 @@ Tensor::Tensor(const std::vector<uint32_t>& shape,
       shape_mode_{layout},
       elem_type_{element_type},
       name_{""},
+      mem_type_{mem_type},
       data_manager_{nullptr},
       init_done_{false} {
+    padding_ = padding;
     if (this->InitImageParamters() != MStatus::M_OK) {
         SIMPLE_LOG_ERROR("construct tensor failed, init tensor paramters failed");
         return;
@@ -81,6 +97,7 @@ Tensor::Tensor(const void* data_ptr,
       shape_mode_{layout},
       elem_type_{element_type},
       name_{""},
+      mem_type_{mem_type},
       data_manager_{nullptr},
       init_done_{false} {
     if (this->InitImageParamters() != MStatus::M_OK) {
@@ -98,7 +115,8 @@ Tensor::Tensor(const std::shared_ptr<DataManager>& data_mgr,
                const std::vector<uint32_t>& shape,
                const TensorLayout& layout,
                const MemoryType& mem_type,
-               const DataType& element_type)
+               const DataType& element_type,
+               const TensorPadding padding)
     : shape_(shape),
       stride_{0},
       nscalar_{0},
@@ -110,6 +128,7 @@ Tensor::Tensor(const std::shared_ptr<DataManager>& data_mgr,
       mem_type_(mem_type),
       data_manager_(data_mgr),
       init_done_(false) {
+    padding_ = padding;
     if (nullptr == data_manager_) {
         SIMPLE_LOG_DEBUG("construct tensor failed, input data manager nullptr");
         return;
@@ -121,33 +140,39 @@ Tensor::Tensor(const std::shared_ptr<DataManager>& data_mgr,
 }
 
 MStatus Tensor::InitImageParamters() {
-    int LAYOUT_W = -1;
-    int LAYOUT_H = -1;
-    int LAYOUT_C = -1;
+    if (shape_.size() != 4U) {
+        SIMPLE_LOG_ERROR("can't support shape of %zu dims", shape_.size());
+        return MStatus::M_NOT_SUPPORT;
+    }
+    // a row is the contiguous run of elements after H
     switch (shape_mode_) {
         case TensorLayout::M_LAYOUT_NCHW:
-            LAYOUT_W = 3;
-            LAYOUT_H = 2;
-            LAYOUT_C = 1;
+            rows_     = shape_[1] * shape_[2];
+            row_size_ = shape_[3] * this->GetTypeSize();
             break;
         case TensorLayout::M_LAYOUT_NHWC:
-            LAYOUT_W = 2;
-            LAYOUT_H = 1;
-            LAYOUT_C = 3;
+            rows_     = shape_[1];
+            row_size_ = shape_[2] * shape_[3] * this->GetTypeSize();
+            break;
+        case TensorLayout::M_LAYOUT_NC8HW8:
+        case TensorLayout::M_LAYOUT_NC16HW16: {
+            const uint32_t block = LayoutChannelBlock(shape_mode_);
+            rows_                = (shape_[1] + block - 1) / block * shape_[2];
+            row_size_            = shape_[3] * block * this->GetTypeSize();
             break;
+        }
         default:
             SIMPLE_LOG_ERROR("can't support layout");
             return MStatus::M_NOT_SUPPORT;
     }
     int LAYOUT_N = 0;
-    stride_      = shape_[LAYOUT_W] * this->GetTypeSize();
-    nscalar_     = shape_[LAYOUT_C] * shape_[LAYOUT_H] * stride_;
+    stride_      = RowPitch(row_size_, padding_);
+    nscalar_     = rows_ * stride_;
     size_        = nscalar_ * shape_[LAYOUT_N];
     init_done_   = true;
     return MStatus::M_OK;
 }
 
-
 MStatus Tensor::CreatDataManager(const MemoryType& mem_type) {
     std::string mem_type_str = DataManager::MemTypeToMemTypeStr(mem_type);
     SIMPLE_LOG_DEBUG("Tensor::CreatDataManager %s Start", mem_type_str.c_str());
@@ -169,16 +194,189 @@ MStatus Tensor::CreatDataManager(const MemoryType& mem_type) {
 }
 
 std::shared_ptr<Tensor> Tensor::Clone() const {
-    auto replica = std::make_shared<Tensor>(
-        this->shape_, this->shape_mode_, this->mem_type_, this->elem_type_);
-    if (nullptr == replica) {
+    auto replica = std::make_shared<Tensor>();
+    if (nullptr == replica || this->CloneInto(*replica) != MStatus::M_OK) {
         SIMPLE_LOG_ERROR("clone tensot failed");
         return nullptr;
     }
-    memcpy(this->GetData<void>(), replica->GetData<void>(), replica->GetSize());
     return replica;
 }
 
+MStatus Tensor::CloneInto(Tensor& target) const {
+    if (&target == this) {
+        return MStatus::M_OK;
+    }
+    if (nullptr == this->GetData<void>()) {
+        SIMPLE_LOG_ERROR("clone tensor failed, input tensor is empty");
+        return MStatus::M_INVALID_ARG;
+    }
+
+    const bool reuse = target.GetData<void>() != nullptr && target.size_ == this->size_ &&
+                       target.data_manager_->GetSize() >= this->size_;
+    if (!reuse) {
+        target = Tensor(
+            this->shape_, this->shape_mode_, this->mem_type_, this->elem_type_, this->padding_);
+        if (nullptr == target.GetData<void>()) {
+            SIMPLE_LOG_ERROR("clone tensor failed, malloc %u bytes failed", this->size_);
+            return MStatus::M_OUT_OF_MEMORY;
+        }
+    }
+    target.shape_      = this->shape_;
+    target.stride_     = this->stride_;
+    target.nscalar_    = this->nscalar_;
+    target.type_size_  = this->type_size_;
+    target.row_size_   = this->row_size_;
+    target.rows_       = this->rows_;
+    target.padding_    = this->padding_;
+    target.shape_mode_ = this->shape_mode_;
+    target.elem_type_  = this->elem_type_;
+    target.name_       = this->name_;
+    target.init_done_  = this->init_done_;
+
+    this->data_manager_->SyncCache(false);
+    FastCopy(target.GetData<void>(), this->GetData<void>(), this->size_);
+    return MStatus::M_OK;
+}
+
+MStatus Tensor::CopyFrom(const Tensor& other) {
+    return other.CloneInto(*this);
+}
+
+MStatus Tensor::Reset(const std::vector<uint32_t>& shape,
+                      const TensorLayout layout,
+                      const DataType element_type,
+                      const TensorPadding padding) {
+    if (this->GetData<void>() != nullptr && this->shape_ == shape && this->shape_mode_ == layout &&
+        this->elem_type_ == element_type && this->padding_ == padding) {
+        return MStatus::M_OK;
+    }
+    *this = Tensor(shape, layout, M_MEM_ON_CPU, element_type, padding);
+    if (nullptr == this->GetData<void>()) {
+        SIMPLE_LOG_ERROR("reset tensor failed, malloc %s failed",
+                         LogTensor("output", *this).c_str());
+        return MStatus::M_OUT_OF_MEMORY;
+    }
+    return MStatus::M_OK;
+}
+
+MStatus Tensor::FromImage(const Image& image, Tensor& out) {
+    if (nullptr == image.GetData<void>() || image.GetMemType() != M_MEM_ON_CPU) {
+        SIMPLE_LOG_ERROR("tensor from image failed, image is empty or not on cpu");
+        return MStatus::M_INVALID_ARG;
+    }
+    // planar rgb has a plane per channel, packed formats one plane of all channels
+    ImagePlane planes[IMAGE_MAX_PLANES], next[IMAGE_MAX_PLANES];
+    const uint32_t count = image.GetPlanes(0, planes);
+    const uint32_t c = image.GetChannel(), h = image.GetHeight(), w = image.GetWidth();
+    const bool planar    = count > 1U && count == c;
+    const DataType type  = ImageDataType(image.GetTypeSize());
+    if ((!planar && (count != 1U || planes[0].channel != c)) || type == M_DATA_TYPE_MAX) {
+        SIMPLE_LOG_ERROR("tensor from image can't support %s", image.GetPixelFormatStr().c_str());
+        return MStatus::M_NOT_SUPPORT;
+    }
+
+    const uint32_t row_size = (planar ? w : w * c) * image.GetTypeSize();
+    const uint32_t rows = planar ? c * h : h, stride = planes[0].pitch;
+    const TensorPadding paddings[] = {
+        M_TENSOR_PADDING_NONE, M_TENSOR_PADDING_CACHE_LINE, M_TENSOR_PADDING_DEALIAS};
+    TensorPadding padding = M_TENSOR_PADDING_NONE;
+    bool view             = false;
+    for (const TensorPadding candidate : paddings) {
+        if (!view && RowPitch(row_size, candidate) == stride) {
+            padding = candidate;
+            view    = true;
+        }
+    }
+    // rows of tensor are stride apart through planes and images
+    const size_t scalar = static_cast<size_t>(rows) * stride;
+    const bool batch    = image.GetNumber() > 1U && image.GetPlanes(1, next) == count;
+    for (uint32_t p = 0; p < count; ++p) {
+        view = view && planes[p].pitch == stride &&
+               planes[p].data == planes[0].data + static_cast<size_t>(p) * h * stride &&
+               (image.GetNumber() == 1U || (batch && next[p].data == planes[p].data + scalar));
+    }
+    const std::shared_ptr<DataManager>& data_mgr = image.GetDataManager();
+    const size_t start = planes[0].data - static_cast<uint8_t*>(data_mgr->GetDataPtr());
+    if (!view || start + scalar * image.GetNumber() > data_mgr->GetSize()) {
+        SIMPLE_LOG_ERROR("tensor from image failed, pitch %u and planes of %s aren't rows of "
+                         "tensor",
+                         stride,
+                         image.GetPixelFormatStr().c_str());
+        return MStatus::M_NOT_SUPPORT;
+    }
+
+    const std::vector<uint32_t> shape = planar ? std::vector<uint32_t>{image.GetNumber(), c, h, w}
+                                               : std::vector<uint32_t>{image.GetNumber(), h, w, c};
+    std::shared_ptr<DataManager> shared = data_mgr;
+    if (start > 0) {
+        shared = std::make_shared<SubDataManager>(
+            data_mgr, static_cast<uint32_t>(start), data_mgr->GetSize() - start);
+    }
+    Tensor tensor(shared,
+                  shape,
+                  planar ? M_LAYOUT_NCHW : M_LAYOUT_NHWC,
+                  M_MEM_ON_CPU,
+                  type,
+                  padding);
+    if (nullptr == tensor.GetData<void>()) {
+        SIMPLE_LOG_ERROR("tensor from image failed, init tensor failed");
+        return MStatus::M_FAILED;
+    }
+    out = std::move(tensor);
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor> Tensor::Clone(const TensorPadding padding) const {
+    if (nullptr == this->GetData<void>()) {
+        SIMPLE_LOG_ERROR("clone tensor failed, input tensor is empty");
+        return nullptr;
+    }
+    auto replica = std::make_shared<Tensor>(
+        this->shape_, this->shape_mode_, this->mem_type_, this->elem_type_, padding);
+    if (nullptr == replica || nullptr == replica->GetData<void>()) {
+        SIMPLE_LOG_ERROR("clone tensor failed, malloc failed");
+        return nullptr;
+    }
+    replica->name_ = this->name_;
+    this->data_manager_->SyncCache(false);
+    FastCopy2D(replica->GetData<void>(),
+               replica->stride_,
+               this->GetData<void>(),
+               this->stride_,
+               this->row_size_,
+               static_cast<size_t>(this->rows_) * this->shape_[0]);
+    return replica;
+}
+
+MStatus Tensor::CopyToDense(void* dst) const {
+    if (nullptr == dst || nullptr == this->GetData<void>()) {
+        SIMPLE_LOG_ERROR("CopyToDense failed, buffer is empty");
+        return MStatus::M_INVALID_ARG;
+    }
+    this->data_manager_->SyncCache(false);
+    FastCopy2D(dst,
+               this->row_size_,
+               this->GetData<void>(),
+               this->stride_,
+               this->row_size_,
+               static_cast<size_t>(this->rows_) * this->shape_[0]);
+    return MStatus::M_OK;
+}
+
+MStatus Tensor::CopyFromDense(const void* src) {
+    if (nullptr == src || nullptr == this->GetData<void>()) {
+        SIMPLE_LOG_ERROR("CopyFromDense failed, buffer is empty");
+        return MStatus::M_INVALID_ARG;
+    }
+    FastCopy2D(this->GetData<void>(),
+               this->stride_,
+               src,
+               this->row_size_,
+               this->row_size_,
+               static_cast<size_t>(this->rows_) * this->shape_[0]);
+    return MStatus::M_OK;
+}
+
 bool Tensor::operator==(const Tensor& other) {
     if (this->shape_ != other.shape_ || this->shape_mode_ != other.shape_mode_ ||
         this->mem_type_ != other.mem_type_ || this->name_ != other.name_ ||
@@ -194,30 +392,80 @@ bool Tensor::operator!=(const Tensor& other) {
     return (*this == other) ? false : true;
 }
 
-std::shared_ptr<Tensor> transpose(const std::shared_ptr<Tensor>& tensor) {
-    if (tensor->GetShape().size() != 4 || tensor->GetShape(0) != 1 || tensor->GetShape(1) != 1) {
-        SIMPLE_LOG_ERROR("tensor transpose only support 2D matrix");
-        return nullptr;
+MStatus reshape(const Tensor& tensor, const std::vector<uint32_t>& shape, Tensor& out) {
+    if (nullptr == tensor.GetData<void>() || tensor.GetShape().size() != 4 || shape.size() != 4 ||
+        &tensor == &out) {
+        SIMPLE_LOG_ERROR("reshape failed, input tensor is empty or shape is not 4Dims");
+        return MStatus::M_INVALID_ARG;
     }
-    std::vector<uint32_t> shape{1, 1, tensor->GetShape(3), tensor->GetShape(2)};
-    auto result = std::make_shared<Tensor>(
-        shape, tensor->GetShapeMode(), tensor->GetMemType(), tensor->GetElemType());
-    if (!result) {
-        SIMPLE_LOG_ERROR("transpose failed, malloc [%i, %i, %i, %i] data failed",
+    const uint64_t count = static_cast<uint64_t>(shape[0]) * shape[1] * shape[2] * shape[3];
+    const std::vector<uint32_t>& from = tensor.GetShape();
+    if (count != static_cast<uint64_t>(from[0]) * from[1] * from[2] * from[3]) {
+        SIMPLE_LOG_ERROR("reshape failed, count mismatch [%u, %u, %u, %u] vs %s",
                          shape[0],
                          shape[1],
                          shape[2],
-                         shape[3]);
+                         shape[3],
+                         LogTensor("input", tensor).c_str());
+        return MStatus::M_INVALID_ARG;
+    }
+    // a padded view must keep the row size, rows of blocked layout depend on C
+    const bool keep_rows = tensor.GetShapeMode() == M_LAYOUT_NCHW && shape[3] == from[3];
+    if (tensor.GetChannelBlock() != 1U || (!tensor.IsDense() && !keep_rows)) {
+        SIMPLE_LOG_ERROR("reshape can't view %s, clone it without padding first",
+                         LogTensor("input", tensor).c_str());
+        return MStatus::M_NOT_SUPPORT;
+    }
+
+    out = Tensor(tensor.GetDataManager(),
+                 shape,
+                 tensor.GetShapeMode(),
+                 tensor.GetMemType(),
+                 tensor.GetElemType(),
+                 tensor.IsDense() ? M_TENSOR_PADDING_NONE : tensor.GetPadding());
+    out.SetName(tensor.GetName());
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor> reshape(const std::shared_ptr<Tensor>& tensor,
+                                const std::vector<uint32_t>& shape) {
+    auto out = std::make_shared<Tensor>();
+    if (nullptr == tensor || reshape(*tensor, shape, *out) != MStatus::M_OK) {
         return nullptr;
     }
+    return out;
+}
+
+MStatus transpose(const Tensor& tensor, Tensor& out) {
+    if (tensor.GetShape().size() != 4 || tensor.GetShape(0) != 1 || tensor.GetShape(1) != 1 ||
+        tensor.GetShapeMode() != M_LAYOUT_NCHW || tensor.GetTypeSize() != sizeof(float) ||
+        nullptr == tensor.GetData<void>() || &tensor == &out) {
+        SIMPLE_LOG_ERROR("tensor transpose only support 2D matrix of 32bits elements");
+        return MStatus::M_INVALID_ARG;
+    }
+    std::vector<uint32_t> shape{1, 1, tensor.GetShape(3), tensor.GetShape(2)};
+    MStatus status =
+        out.Reset(shape, tensor.GetShapeMode(), tensor.GetElemType(), tensor.GetPadding());
+    if (status != MStatus::M_OK) {
+        return status;
+    }
 
-    const int rows = tensor->GetShape(2), cols = tensor->GetShape(3);
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            result->GetData<float>(0)[j * cols + i] = tensor->GetData<float>(0)[i * rows + j];
+    const uint32_t rows = tensor.GetShape(2), cols = tensor.GetShape(3);
+    for (uint32_t i = 0; i < rows; ++i) {
+        const float* src = tensor.GetRow<float>(0, i);
+        for (uint32_t j = 0; j < cols; ++j) {
+            out.GetRow<float>(0, j)[i] = src[j];
         }
     }
-    return result;
+    return MStatus::M_OK;
+}
+
+std::shared_ptr<Tensor> transpose(const std::shared_ptr<Tensor>& tensor) {
+    auto out = std::make_shared<Tensor>();
+    if (nullptr == tensor || transpose(*tensor, *out) != MStatus::M_OK) {
+        return nullptr;
+    }
+    return out;
 }
 
 } // namespace base
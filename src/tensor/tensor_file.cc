@@ -0,0 +1,282 @@
+#include "tensor/tensor_file.h"
+
+#include "manager/data_manager.h"
+
+#include <string.h>
+#ifdef __SSE4_2__
+#include <nmmintrin.h>
+#endif
+
+namespace base {
+
+#define TENSOR_FILE_FLAG_CHECKSUM (0x1U)
+#define TENSOR_FILE_MAX_DIMS (8U)
+
+typedef struct TensorFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t count;
+    uint32_t flags;
+    uint32_t reserved[11];
+} TensorFileHeader;
+
+typedef struct TensorEntryHeader {
+    uint32_t name_size;
+    uint32_t layout;
+    uint32_t elem_type;
+    uint32_t dims;
+    uint32_t shape[TENSOR_FILE_MAX_DIMS];
+    uint64_t data_size;
+    uint32_t checksum;
+    uint32_t reserved;
+} TensorEntryHeader;
+
+static_assert(sizeof(TensorFileHeader) == TENSOR_FILE_ALIGN, "file header must be 64 bytes");
+static_assert(sizeof(TensorEntryHeader) == TENSOR_FILE_ALIGN, "entry header must be 64 bytes");
+
+static uint32_t Crc32cTable(const uint32_t idx) {
+    static uint32_t table[256] = {0};
+    static bool init           = [] {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; ++k) {
+                c = (c & 1) ? (c >> 1) ^ 0x82F63B78U : (c >> 1);
+            }
+            table[i] = c;
+        }
+        return true;
+    }();
+    UNUSED_WARN(init);
+    return table[idx];
+}
+
+uint32_t Crc32c(const void* data, const size_t size, const uint32_t crc) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t c       = ~crc;
+    size_t i         = 0;
+#ifdef __SSE4_2__
+    uint64_t c64 = c;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t v;
+        memcpy(&v, p + i, sizeof(v));
+        c64 = _mm_crc32_u64(c64, v);
+    }
+    c = static_cast<uint32_t>(c64);
+#endif
+    for (; i < size; ++i) {
+        c = Crc32cTable((c ^ p[i]) & 0xFF) ^ (c >> 8);
+    }
+    return ~c;
+}
+
+MStatus TensorFileWriter::Open(const std::string& path, const bool checksum) {
+    Close();
+    file_ = fopen(path.c_str(), "wb");
+    if (nullptr == file_) {
+        SIMPLE_LOG_ERROR("TensorFileWriter can't open %s", path.c_str());
+        return MStatus::M_FILE_NOT_FOUND;
+    }
+    checksum_ = checksum;
+    count_    = 0;
+
+    // count is patched on close
+    TensorFileHeader header;
+    memset(&header, 0, sizeof(header));
+    if (fwrite(&header, sizeof(header), 1, file_) != 1) {
+        SIMPLE_LOG_ERROR("TensorFileWriter write header failed");
+        return MStatus::M_FAILED;
+    }
+    offset_ = sizeof(header);
+    return MStatus::M_OK;
+}
+
+MStatus TensorFileWriter::WritePadding(const uint64_t align) {
+    static const uint8_t zeros[TENSOR_FILE_ALIGN] = {0};
+    const uint64_t pad = align_size(offset_, align) - offset_;
+    if (pad > 0 && fwrite(zeros, 1, pad, file_) != pad) {
+        return MStatus::M_FAILED;
+    }
+    offset_ += pad;
+    return MStatus::M_OK;
+}
+
+MStatus TensorFileWriter::Write(const Tensor& tensor) {
+    return Write(tensor.GetName(), tensor);
+}
+
+MStatus TensorFileWriter::Write(const std::string& name, const Tensor& tensor) {
+    if (nullptr == file_) {
+        SIMPLE_LOG_ERROR("TensorFileWriter is not opened");
+        return MStatus::M_FAILED;
+    }
+    const uint8_t* data = tensor.GetData<uint8_t>(0);
+    if (nullptr == data || tensor.GetMemType() != M_MEM_ON_CPU) {
+        SIMPLE_LOG_ERROR("TensorFileWriter only support cpu tensor with data");
+        return MStatus::M_INVALID_ARG;
+    }
+    const std::vector<uint32_t> shape = tensor.GetShape();
+    if (shape.size() > TENSOR_FILE_MAX_DIMS) {
+        SIMPLE_LOG_ERROR("TensorFileWriter can't support %zu dims", shape.size());
+        return MStatus::M_NOT_SUPPORT;
+    }
+
+    TensorEntryHeader entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.name_size = static_cast<uint32_t>(name.size());
+    entry.layout    = static_cast<uint32_t>(tensor.GetShapeMode());
+    entry.elem_type = static_cast<uint32_t>(tensor.GetElemType());
+    entry.dims      = static_cast<uint32_t>(shape.size());
+    for (size_t i = 0; i < shape.size(); ++i) {
+        entry.shape[i] = shape[i];
+    }
+    // payload is always dense, padded rows are written one by one
+    const uint8_t* bytes  = static_cast<const uint8_t*>(data);
+    const size_t rows     = tensor.IsDense() ? 1U : static_cast<size_t>(tensor.GetRows()) * shape[0];
+    const size_t row_size = tensor.IsDense() ? tensor.GetSize() : tensor.GetRowSize();
+    entry.data_size       = rows * row_size;
+    entry.checksum        = 0U;
+    for (size_t r = 0; checksum_ && r < rows; ++r) {
+        entry.checksum = Crc32c(bytes + r * tensor.GetStride(), row_size, entry.checksum);
+    }
+
+    if (fwrite(&entry, sizeof(entry), 1, file_) != 1 ||
+        fwrite(name.data(), 1, name.size(), file_) != name.size()) {
+        SIMPLE_LOG_ERROR("TensorFileWriter write %s header failed", name.c_str());
+        return MStatus::M_FAILED;
+    }
+    offset_ += sizeof(entry) + name.size();
+    if (WritePadding(TENSOR_FILE_ALIGN) != MStatus::M_OK) {
+        return MStatus::M_FAILED;
+    }
+    for (size_t r = 0; r < rows; ++r) {
+        if (fwrite(bytes + r * tensor.GetStride(), 1, row_size, file_) != row_size) {
+            SIMPLE_LOG_ERROR("TensorFileWriter write %s payload failed", name.c_str());
+            return MStatus::M_FAILED;
+        }
+    }
+    offset_ += entry.data_size;
+    if (WritePadding(TENSOR_FILE_ALIGN) != MStatus::M_OK) {
+        return MStatus::M_FAILED;
+    }
+    count_++;
+    return MStatus::M_OK;
+}
+
+MStatus TensorFileWriter::Close() {
+    if (nullptr == file_) {
+        return MStatus::M_OK;
+    }
+    TensorFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TENSOR_FILE_MAGIC, sizeof(header.magic));
+    header.version = TENSOR_FILE_VERSION;
+    header.count   = count_;
+    header.flags   = checksum_ ? TENSOR_FILE_FLAG_CHECKSUM : 0U;
+
+    MStatus status = MStatus::M_OK;
+    if (fseek(file_, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(header), 1, file_) != 1) {
+        SIMPLE_LOG_ERROR("TensorFileWriter write header failed");
+        status = MStatus::M_FAILED;
+    }
+    if (fclose(file_) != 0) {
+        status = MStatus::M_FAILED;
+    }
+    file_ = nullptr;
+    return status;
+}
+
+MStatus TensorFileReader::Open(const std::string& path, const bool verify) {
+    Close();
+    std::shared_ptr<MappedFile> file;
+    const MStatus status = MappedFile::Map(path, file);
+    if (status != MStatus::M_OK) {
+        SIMPLE_LOG_ERROR("TensorFileReader can't map %s", path.c_str());
+        return status;
+    }
+    const size_t file_size = file->GetSize();
+    if (file_size < sizeof(TensorFileHeader)) {
+        SIMPLE_LOG_ERROR("TensorFileReader %s is too small", path.c_str());
+        return MStatus::M_INVALID_FILE_FORMAT;
+    }
+
+    TensorFileHeader header;
+    memcpy(&header, file->GetData(), sizeof(header));
+    if (memcmp(header.magic, TENSOR_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TENSOR_FILE_VERSION) {
+        SIMPLE_LOG_ERROR("TensorFileReader %s is not a tensor file", path.c_str());
+        return MStatus::M_INVALID_FILE_FORMAT;
+    }
+
+    uint64_t offset = sizeof(header);
+    for (uint32_t i = 0; i < header.count; ++i) {
+        TensorEntryHeader entry;
+        if (offset + sizeof(entry) > file_size) {
+            Close();
+            SIMPLE_LOG_ERROR("TensorFileReader entry %u out of file", i);
+            return MStatus::M_INVALID_FILE_FORMAT;
+        }
+        memcpy(&entry, file->GetData() + offset, sizeof(entry));
+        const uint64_t name_offset = offset + sizeof(entry);
+        const uint64_t data_offset = align_size(name_offset + entry.name_size, TENSOR_FILE_ALIGN);
+        if (entry.dims > TENSOR_FILE_MAX_DIMS || entry.layout >= M_LAYOUT_MAX ||
+            entry.elem_type >= M_DATA_TYPE_MAX || data_offset + entry.data_size > file_size) {
+            Close();
+            SIMPLE_LOG_ERROR("TensorFileReader entry %u is broken", i);
+            return MStatus::M_INVALID_FILE_FORMAT;
+        }
+
+        uint8_t* data = file->GetData() + data_offset;
+        if (verify && (header.flags & TENSOR_FILE_FLAG_CHECKSUM) &&
+            Crc32c(data, entry.data_size) != entry.checksum) {
+            Close();
+            SIMPLE_LOG_ERROR("TensorFileReader entry %u checksum mismatch", i);
+            return MStatus::M_INVALID_FILE_FORMAT;
+        }
+
+        std::string name(reinterpret_cast<const char*>(file->GetData() + name_offset),
+                         entry.name_size);
+        std::vector<uint32_t> shape(entry.shape, entry.shape + entry.dims);
+        auto data_mgr = std::make_shared<MappedDataManager>(
+            file, data, static_cast<uint32_t>(entry.data_size));
+        auto tensor = std::make_shared<Tensor>(data_mgr,
+                                               shape,
+                                               static_cast<TensorLayout>(entry.layout),
+                                               M_MEM_ON_CPU,
+                                               static_cast<DataType>(entry.elem_type));
+        if (tensor->GetSize() != entry.data_size) {
+            Close();
+            SIMPLE_LOG_ERROR("TensorFileReader entry %u size mismatch", i);
+            return MStatus::M_INVALID_FILE_FORMAT;
+        }
+        tensor->SetName(name);
+        names_.push_back(name);
+        tensors_.push_back(tensor);
+        offset = align_size(data_offset + entry.data_size, TENSOR_FILE_ALIGN);
+    }
+    return MStatus::M_OK;
+}
+
+void TensorFileReader::Close() {
+    names_.clear();
+    tensors_.clear();
+}
+
+std::shared_ptr<Tensor> TensorFileReader::Get(const uint32_t idx) const {
+    if (idx >= tensors_.size()) {
+        SIMPLE_LOG_ERROR("TensorFileReader index %u out of range %zu", idx, tensors_.size());
+        return nullptr;
+    }
+    return tensors_[idx];
+}
+
+std::shared_ptr<Tensor> TensorFileReader::Get(const std::string& name) const {
+    for (size_t i = 0; i < names_.size(); ++i) {
+        if (names_[i] == name) {
+            return tensors_[i];
+        }
+    }
+    SIMPLE_LOG_ERROR("TensorFileReader can't find %s", name.c_str());
+    return nullptr;
+}
+
+} // namespace base
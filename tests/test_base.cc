@@ -1,9 +1,20 @@
 #include "common.h"
+#include "image/color.h"
+#include "image/image.h"
+#include "image/image_file.h"
+#include "image/image_operator.h"
+#include "image/preprocess.h"
+#include "image/resize.h"
+#include "image/stats.h"
+#include "image/warp.h"
+#include "intrinsic.h"
 #include "log.h"
 #include "manager/data_manager.h"
+#include "tensor/batch.h"
 #include "tensor/tensor.h"
 #include "utils/test_util.h"
 
+#include <cmath>
 #include <fstream>
 #include <gtest/gtest.h>
 #include <thread>
@@ -36,6 +47,1242 @@ protected:
 
 TEST_F(ImageTest, InvalidInput) {}
 
+TEST_F(ImageTest, Clone) {
+    // 1080p frame is over the stream threshold and runs the parallel non-temporal copy
+    base::Image frame(1920, 1080, 1, M_PIX_FMT_BGR888, TimeStamp(), M_MEM_ON_CPU);
+    ASSERT_NE(frame.GetData<uint8_t>(), nullptr);
+    EXPECT_EQ(frame.GetPixelFormatStr(), "BGR888");
+    for (uint32_t i = 0; i < frame.GetSize(); ++i) {
+        frame.GetData<uint8_t>()[i] = static_cast<uint8_t>(i * 13 + (i >> 12));
+    }
+    base::Image replica = frame.Clone();
+    ASSERT_NE(replica.GetData<uint8_t>(), nullptr);
+    EXPECT_NE(replica.GetData<uint8_t>(), frame.GetData<uint8_t>());
+    EXPECT_EQ(memcmp(replica.GetData<uint8_t>(), frame.GetData<uint8_t>(), frame.GetSize()), 0);
+
+    // all planes of yuv, and same byte size reuses buffer of target
+    base::Image nv12(64, 48, 2, M_PIX_FMT_NV12, TimeStamp(), M_MEM_ON_CPU);
+    for (uint32_t i = 0; i < nv12.GetSize(); ++i) {
+        nv12.GetData<uint8_t>()[i] = static_cast<uint8_t>(i * 7);
+    }
+    base::Image target(96, 32, 2, M_PIX_FMT_NV21, TimeStamp(), M_MEM_ON_CPU);
+    uint8_t* buffer = target.GetData<uint8_t>();
+    ASSERT_EQ(nv12.CloneInto(target), M_OK);
+    EXPECT_EQ(target.GetData<uint8_t>(), buffer);
+    EXPECT_EQ(target.GetWidth(), 64U);
+    EXPECT_EQ(target.GetPixelFormat(), M_PIX_FMT_NV12);
+    EXPECT_EQ(memcmp(target.GetData<uint8_t>(), nv12.GetData<uint8_t>(), nv12.GetSize()), 0);
+
+    ASSERT_EQ(frame.CloneInto(target), M_OK);
+    EXPECT_EQ(target.GetSize(), frame.GetSize());
+    EXPECT_EQ(memcmp(target.GetData<uint8_t>(), frame.GetData<uint8_t>(), frame.GetSize()), 0);
+    EXPECT_EQ(base::Image().CloneInto(target), M_INVALID_ARG);
+}
+
+TEST_F(ImageTest, ConvertColor) {
+    // width 70 runs two 32 pixels SIMD steps and a scalar tail
+    const uint32_t w = 70, h = 6, number = 2;
+    const float coeff[][5] = {{1.164383f, 1.596027f, 0.391762f, 0.812968f, 2.017232f},
+                              {1.f, 1.402f, 0.344136f, 0.714136f, 1.772f},
+                              {1.164383f, 1.792741f, 0.213249f, 0.532909f, 2.112402f},
+                              {1.f, 1.5748f, 0.187324f, 0.468124f, 1.8556f}};
+    const PixelFormat inputs[]  = {M_PIX_FMT_NV12,
+                                   M_PIX_FMT_NV21,
+                                   M_PIX_FMT_YUV420P,
+                                   M_PIX_FMT_YV12,
+                                   M_PIX_FMT_YUYV,
+                                   M_PIX_FMT_UYVY};
+    const PixelFormat outputs[] = {M_PIX_FMT_BGR888,
+                                   M_PIX_FMT_RGB888,
+                                   M_PIX_FMT_BGRA8888,
+                                   M_PIX_FMT_RGBA8888,
+                                   M_PIX_FMT_BGR888_PLANAR,
+                                   M_PIX_FMT_RGB888_PLANAR};
+    auto Y = [](uint32_t n, uint32_t i, uint32_t x) { return (n * 91 + i * 37 + x * 29) % 256; };
+    auto U = [](uint32_t n, uint32_t i, uint32_t x) { return (n * 53 + i * 71 + x * 13) % 256; };
+    auto V = [](uint32_t n, uint32_t i, uint32_t x) { return (n * 17 + i * 11 + x * 101) % 256; };
+
+    for (const PixelFormat in_format : inputs) {
+        base::Image yuv(w, h, number, in_format, TimeStamp(), M_MEM_ON_CPU);
+        ASSERT_NE(yuv.GetData<uint8_t>(), nullptr);
+        const bool packed = in_format == M_PIX_FMT_YUYV || in_format == M_PIX_FMT_UYVY;
+        // chroma of row i is chroma row i / 2 of 4:2:0, fill sample (i, x) at row i of 4:2:2
+        for (uint32_t n = 0; n < number; ++n) {
+            uint8_t* base = yuv.GetData<uint8_t>(n);
+            for (uint32_t i = 0; i < h; ++i) {
+                for (uint32_t x = 0; x < w; ++x) {
+                    const uint32_t ci = packed ? i : i / 2, cx = x / 2;
+                    if (packed) {
+                        const bool yuyv                 = in_format == M_PIX_FMT_YUYV;
+                        uint8_t* p                      = base + i * w * 2 + cx * 4;
+                        p[(x % 2) * 2 + (yuyv ? 0 : 1)] = Y(n, i, x);
+                        p[yuyv ? 1 : 0]                 = U(n, ci, cx);
+                        p[yuyv ? 3 : 2]                 = V(n, ci, cx);
+                        continue;
+                    }
+                    uint8_t* chroma = base + w * h;
+                    base[i * w + x] = Y(n, i, x);
+                    if (in_format == M_PIX_FMT_NV12 || in_format == M_PIX_FMT_NV21) {
+                        const bool nv12             = in_format == M_PIX_FMT_NV12;
+                        chroma[ci * w + cx * 2]     = nv12 ? U(n, ci, cx) : V(n, ci, cx);
+                        chroma[ci * w + cx * 2 + 1] = nv12 ? V(n, ci, cx) : U(n, ci, cx);
+                    } else {
+                        const bool yv12                     = in_format == M_PIX_FMT_YV12;
+                        chroma[ci * w / 2 + cx]             = yv12 ? V(n, ci, cx) : U(n, ci, cx);
+                        chroma[w * h / 4 + ci * w / 2 + cx] = yv12 ? U(n, ci, cx) : V(n, ci, cx);
+                    }
+                }
+            }
+        }
+
+        for (const PixelFormat out_format : outputs) {
+            for (int space = 0; space < base::M_COLOR_MAX; ++space) {
+                base::Image rgb;
+                ASSERT_EQ(base::convert_color(yuv, out_format, rgb, base::ColorSpace(space)), M_OK);
+                ASSERT_EQ(rgb.GetPixelFormat(), out_format);
+                const float* k     = coeff[space];
+                const float offset = space % 2 == 0 ? 16.f : 0.f;
+                const bool planar  = rgb.GetChannel() == 3 && rgb.GetStride() == w;
+                const bool bgr     = out_format == M_PIX_FMT_BGR888 ||
+                                 out_format == M_PIX_FMT_BGRA8888 ||
+                                 out_format == M_PIX_FMT_BGR888_PLANAR;
+                int max_diff = 0;
+                for (uint32_t n = 0; n < number; ++n) {
+                    for (uint32_t i = 0; i < h; ++i) {
+                        for (uint32_t x = 0; x < w; ++x) {
+                            const uint32_t ci = packed ? i : i / 2;
+                            const float y     = (Y(n, i, x) - offset) * k[0];
+                            const float u     = U(n, ci, x / 2) - 128.f;
+                            const float v     = V(n, ci, x / 2) - 128.f;
+                            const float ref[3] = {
+                                y + k[4] * u, y - k[2] * u - k[3] * v, y + k[1] * v};
+                            for (uint32_t c = 0; c < 3; ++c) {
+                                const uint32_t ch = bgr ? c : 2 - c;
+                                const uint8_t* p  = rgb.GetData<uint8_t>(n);
+                                const uint8_t got =
+                                    planar ? p[ch * w * h + i * w + x]
+                                           : p[i * rgb.GetStride() + x * rgb.GetChannel() + ch];
+                                const int expect = static_cast<int>(
+                                    std::round(std::min(255.f, std::max(0.f, ref[c]))));
+                                max_diff = std::max(max_diff, std::abs(expect - got));
+                            }
+                            if (rgb.GetChannel() == 4) {
+                                ASSERT_EQ(rgb.GetData<uint8_t>(n)[i * w * 4 + x * 4 + 3], 255);
+                            }
+                        }
+                    }
+                }
+                EXPECT_LE(max_diff, 1) << FormatStr[in_format] << " to " << FormatStr[out_format]
+                                       << " space " << space;
+            }
+        }
+    }
+
+    // reuse of buffer, odd width and illegal formats
+    base::Image yuv(w, h, 1, M_PIX_FMT_NV12, TimeStamp(), M_MEM_ON_CPU);
+    base::Image rgb(w, h, 1, M_PIX_FMT_BGR888, TimeStamp(), M_MEM_ON_CPU);
+    uint8_t* buffer = rgb.GetData<uint8_t>();
+    ASSERT_EQ(base::convert_color(yuv, M_PIX_FMT_BGR888, rgb), M_OK);
+    EXPECT_EQ(rgb.GetData<uint8_t>(), buffer);
+    EXPECT_EQ(base::convert_color(yuv, M_PIX_FMT_BGR888, yuv), M_INVALID_ARG);
+    EXPECT_EQ(base::convert_color(yuv, M_PIX_FMT_GRAY8, rgb), M_NOT_SUPPORT);
+    EXPECT_EQ(base::convert_color(rgb, M_PIX_FMT_NV12, yuv), M_NOT_SUPPORT);
+    base::Image odd(w + 1, h, 1, M_PIX_FMT_NV12, TimeStamp(), M_MEM_ON_CPU);
+    EXPECT_EQ(base::convert_color(odd, M_PIX_FMT_BGR888, rgb), M_NOT_SUPPORT);
+}
+
+TEST_F(ImageTest, ConvertChannels) {
+    const uint32_t w = 70, h = 4, number = 2;
+    const std::vector<std::vector<PixelFormat>> groups = {{M_PIX_FMT_BGR888,
+                                                           M_PIX_FMT_RGB888,
+                                                           M_PIX_FMT_BGRA8888,
+                                                           M_PIX_FMT_RGBA8888,
+                                                           M_PIX_FMT_BGR888_PLANAR,
+                                                           M_PIX_FMT_RGB888_PLANAR},
+                                                          {M_PIX_FMT_BGR161616,
+                                                           M_PIX_FMT_RGB161616_PLANAR,
+                                                           M_PIX_FMT_BGR161616_PLANAR},
+                                                          {M_PIX_FMT_RGB323232,
+                                                           M_PIX_FMT_BGR323232,
+                                                           M_PIX_FMT_RGB323232_PLANAR}};
+    // element c of b, g, r, a as uint32_t of any type size
+    auto At = [&](const base::Image& image, uint32_t n, uint32_t i, uint32_t x, uint32_t c) {
+        const uint32_t ts = image.GetTypeSize(), ch = image.GetChannel();
+        const bool bgr    = image.GetPixelFormatStr().compare(0, 3, "BGR") == 0;
+        const uint32_t k  = c == 3 || bgr ? c : 2 - c;
+        const bool planar = image.GetStride() == w * ts;
+        uint8_t* p        = image.GetData<uint8_t>(n) +
+                     (planar ? (k * h * w + i * w + x) * ts : ((i * w + x) * ch + k) * ts);
+        uint32_t value = 0;
+        memcpy(&value, p, ts);
+        return std::make_pair(p, value);
+    };
+    auto Value = [](uint32_t n, uint32_t i, uint32_t x, uint32_t c, uint32_t ts) {
+        const uint32_t v    = n * 31 + i * 7 + x * 3 + c * 50;
+        const uint32_t mask = ts == 4 ? 0xFFFFFFFFU : (1U << (8 * ts)) - 1;
+        return (ts == 1 ? v : v * 1000 + c) & mask;
+    };
+
+    for (const auto& group : groups) {
+        for (const PixelFormat in_format : group) {
+            base::Image input(w, h, number, in_format, TimeStamp(), M_MEM_ON_CPU);
+            const uint32_t ts = input.GetTypeSize();
+            for (uint32_t n = 0; n < number; ++n) {
+                for (uint32_t i = 0; i < h; ++i) {
+                    for (uint32_t x = 0; x < w; ++x) {
+                        for (uint32_t c = 0; c < input.GetChannel(); ++c) {
+                            const uint32_t v = Value(n, i, x, c, ts);
+                            memcpy(At(input, n, i, x, c).first, &v, ts);
+                        }
+                    }
+                }
+            }
+            for (const PixelFormat out_format : group) {
+                base::Image out;
+                ASSERT_EQ(base::convert_color(input, out_format, out), M_OK);
+                ASSERT_EQ(out.GetPixelFormat(), out_format);
+                for (uint32_t n = 0; n < number; ++n) {
+                    for (uint32_t i = 0; i < h; ++i) {
+                        for (uint32_t x = 0; x < w; ++x) {
+                            for (uint32_t c = 0; c < out.GetChannel(); ++c) {
+                                const uint32_t expect =
+                                    c < input.GetChannel() ? Value(n, i, x, c, ts) : 255U;
+                                ASSERT_EQ(At(out, n, i, x, c).second, expect)
+                                    << FormatStr[in_format] << " to " << FormatStr[out_format]
+                                    << " at " << x << ", " << i << ", channel " << c;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // in place, the same layout and a layout change of the same byte size
+    const PixelFormat chain[] = {
+        M_PIX_FMT_RGB888, M_PIX_FMT_BGR888_PLANAR, M_PIX_FMT_RGB888_PLANAR};
+    base::Image image(w, h, 1, M_PIX_FMT_BGR888, TimeStamp(), M_MEM_ON_CPU);
+    for (uint32_t i = 0; i < image.GetSize(); ++i) {
+        image.GetData<uint8_t>()[i] = static_cast<uint8_t>(i * 7);
+    }
+    const base::Image origin = image.Clone();
+    uint8_t* buffer          = image.GetData<uint8_t>();
+    for (const PixelFormat format : chain) {
+        ASSERT_EQ(base::convert_color(image, format, image), M_OK);
+        EXPECT_EQ(image.GetData<uint8_t>(), buffer);
+        EXPECT_EQ(image.GetPixelFormat(), format);
+        for (uint32_t x = 0; x < w; ++x) {
+            for (uint32_t c = 0; c < 3; ++c) {
+                ASSERT_EQ(At(image, 0, h - 1, x, c).second, At(origin, 0, h - 1, x, c).second);
+            }
+        }
+    }
+    EXPECT_EQ(base::convert_color(image, M_PIX_FMT_BGRA8888, image), M_INVALID_ARG);
+    EXPECT_EQ(base::convert_color(image, M_PIX_FMT_BGR161616, image), M_NOT_SUPPORT);
+}
+
+TEST_F(ImageTest, Normalize) {
+    const uint32_t w = 70, h = 4, number = 2;
+    const float scale[3]  = {1.f / 58.395f, 1.f / 57.12f, 1.f / 57.375f};
+    const float offset[3] = {-123.675f / 58.395f, -116.28f / 57.12f, -103.53f / 57.375f};
+    const PixelFormat inputs[] = {
+        M_PIX_FMT_BGR888, M_PIX_FMT_RGBA8888, M_PIX_FMT_RGB888_PLANAR, M_PIX_FMT_GRAY8};
+    const PixelFormat outputs[] = {M_PIX_FMT_RGB323232_PLANAR,
+                                   M_PIX_FMT_BGR323232_PLANAR,
+                                   M_PIX_FMT_RGB323232,
+                                   M_PIX_FMT_BGR323232,
+                                   M_PIX_FMT_RGB161616_PLANAR,
+                                   M_PIX_FMT_BGR161616,
+                                   M_PIX_FMT_GRAY32,
+                                   M_PIX_FMT_GRAY16};
+    for (const PixelFormat in_format : inputs) {
+        base::Image input(w, h, number, in_format, TimeStamp(), M_MEM_ON_CPU);
+        for (uint32_t i = 0; i < input.GetSize(); ++i) {
+            input.GetData<uint8_t>()[i] = static_cast<uint8_t>(i * 29 + (i >> 7));
+        }
+        const bool gray = in_format == M_PIX_FMT_GRAY8;
+        // packed pixels in channel order of out
+        base::Image rgb, bgr;
+        if (!gray) {
+            ASSERT_EQ(base::convert_color(input, M_PIX_FMT_RGB888, rgb), M_OK);
+            ASSERT_EQ(base::convert_color(input, M_PIX_FMT_BGR888, bgr), M_OK);
+        }
+        for (const PixelFormat out_format : outputs) {
+            base::Image out;
+            const bool gray_out = out_format == M_PIX_FMT_GRAY32 || out_format == M_PIX_FMT_GRAY16;
+            if (gray != gray_out) {
+                EXPECT_EQ(base::normalize(input, out_format, scale, offset, out), M_NOT_SUPPORT);
+                continue;
+            }
+            ASSERT_EQ(base::normalize(input, out_format, scale, offset, out), M_OK);
+            ASSERT_EQ(out.GetPixelFormat(), out_format);
+            const uint32_t ts = out.GetTypeSize(), cn = gray ? 1 : 3;
+            const bool planar = gray || out.GetStride() == w * ts;
+            const base::Image& order = FormatStr[out_format].compare(0, 3, "BGR") == 0 ? bgr : rgb;
+            for (uint32_t n = 0; n < number; ++n) {
+                for (uint32_t i = 0; i < h; ++i) {
+                    for (uint32_t x = 0; x < w; ++x) {
+                        for (uint32_t c = 0; c < cn; ++c) {
+                            const uint8_t pixel =
+                                gray ? input.GetData<uint8_t>(n)[i * w + x]
+                                     : order.GetData<uint8_t>(n)[(i * w + x) * 3 + c];
+                            const size_t k = planar ? c * h * w + i * w + x : (i * w + x) * 3 + c;
+                            const float v  = ts == 4 ? out.GetData<float>(n)[k]
+                                                     : fp16_to_fp32(out.GetData<uint16_t>(n)[k]);
+                            ASSERT_NEAR(v, pixel * scale[c] + offset[c], ts == 4 ? 1e-5 : 4e-3)
+                                << FormatStr[in_format] << " to " << FormatStr[out_format] << " at "
+                                << x << ", " << i << ", channel " << c;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    base::Image input(w, h, 1, M_PIX_FMT_BGR888, TimeStamp(), M_MEM_ON_CPU);
+    base::Image out;
+    EXPECT_EQ(base::normalize(input, M_PIX_FMT_RGB888, scale, offset, out), M_NOT_SUPPORT);
+    EXPECT_EQ(base::normalize(input, M_PIX_FMT_RGB323232, scale, offset, input), M_INVALID_ARG);
+    EXPECT_EQ(base::normalize(input, M_PIX_FMT_RGB323232, nullptr, offset, out), M_INVALID_ARG);
+}
+
+TEST_F(ImageTest, Resize) {
+    // bilinear of one plane in double, edges replicated
+    auto Reference = [](const base::ImagePlane& in, uint32_t w, uint32_t h, uint32_t x,
+                        uint32_t y, uint32_t c) {
+        auto Axis = [](uint32_t i, uint32_t size, uint32_t out, uint32_t& i0, double& f) {
+            const double s = (i + 0.5) * size / out - 0.5;
+            const double v = std::min(std::max(s, 0.0), size - 1.0);
+            i0             = std::min(static_cast<uint32_t>(v), size - 1);
+            f              = i0 + 1 < size ? v - i0 : 0.0;
+        };
+        auto At = [&](uint32_t sx, uint32_t sy) {
+            const uint8_t* p = in.data + sy * in.pitch + (sx * in.channel + c) * in.type_size;
+            return in.type_size == 1 ? static_cast<double>(*p) : *reinterpret_cast<const float*>(p);
+        };
+        uint32_t x0 = 0, y0 = 0;
+        double fx = 0, fy = 0;
+        Axis(x, in.width, w, x0, fx);
+        Axis(y, in.height, h, y0, fy);
+        const uint32_t x1 = std::min(x0 + 1, in.width - 1), y1 = std::min(y0 + 1, in.height - 1);
+        return (At(x0, y0) * (1 - fx) + At(x1, y0) * fx) * (1 - fy) +
+               (At(x0, y1) * (1 - fx) + At(x1, y1) * fx) * fy;
+    };
+    auto Fill = [](base::Image& image) {
+        for (uint32_t i = 0; i < image.GetSize() / image.GetTypeSize(); ++i) {
+            if (image.GetTypeSize() == 1) {
+                image.GetData<uint8_t>()[i] = static_cast<uint8_t>((i * 37) ^ (i >> 5));
+            } else {
+                image.GetData<float>()[i] = static_cast<float>((i * 37) % 1001) / 7.f;
+            }
+        }
+    };
+
+    const PixelFormat formats[] = {M_PIX_FMT_GRAY8,
+                                   M_PIX_FMT_BGR888,
+                                   M_PIX_FMT_RGBA8888,
+                                   M_PIX_FMT_RGB888_PLANAR,
+                                   M_PIX_FMT_BGR323232,
+                                   M_PIX_FMT_FLOAT32C4,
+                                   M_PIX_FMT_NV12,
+                                   M_PIX_FMT_YV12};
+    const uint32_t sizes[][2] = {{40, 22}, {158, 90}, {100, 60}};
+    for (const PixelFormat format : formats) {
+        base::Image input(100, 60, 2, format, TimeStamp(), M_MEM_ON_CPU);
+        Fill(input);
+        for (const auto& size : sizes) {
+            base::Image out;
+            ASSERT_EQ(base::resize(input, size[0], size[1], out), M_OK);
+            ASSERT_EQ(out.GetPixelFormat(), format);
+            ASSERT_EQ(out.GetNumber(), 2U);
+            const double tolerance = input.GetTypeSize() == 1 ? 1.0 : 1e-3;
+            for (uint32_t n = 0; n < 2; ++n) {
+                base::ImagePlane in_planes[IMAGE_MAX_PLANES], out_planes[IMAGE_MAX_PLANES];
+                const uint32_t count = input.GetPlanes(n, in_planes);
+                ASSERT_EQ(out.GetPlanes(n, out_planes), count);
+                for (uint32_t p = 0; p < count; ++p) {
+                    const base::ImagePlane& op = out_planes[p];
+                    for (uint32_t y = 0; y < op.height; ++y) {
+                        for (uint32_t x = 0; x < op.width * op.channel; ++x) {
+                            const uint8_t* q = op.data + y * op.pitch + x * op.type_size;
+                            const double v   = op.type_size == 1
+                                                   ? static_cast<double>(*q)
+                                                   : *reinterpret_cast<const float*>(q);
+                            const double expect = Reference(in_planes[p],
+                                                            op.width,
+                                                            op.height,
+                                                            x / op.channel,
+                                                            y,
+                                                            x % op.channel);
+                            ASSERT_NEAR(v, expect, tolerance)
+                                << FormatStr[format] << " to " << size[0] << "x" << size[1]
+                                << " plane " << p << " at " << x << ", " << y;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    base::Image gray(64, 32, 1, M_PIX_FMT_GRAY8, TimeStamp(), M_MEM_ON_CPU);
+    Fill(gray);
+    // area of 2x shrinking is the rounded mean of 2x2 pixels
+    base::Image area(gray, 32, 16);
+    uint8_t* buffer = area.GetData<uint8_t>();
+    auto op         = base::ImageOperator::Create("resize_area");
+    ASSERT_NE(op, nullptr);
+    ASSERT_EQ(op->Run(gray, area), M_OK);
+    EXPECT_EQ(area.GetData<uint8_t>(), buffer);
+    const uint8_t* g = gray.GetData<uint8_t>();
+    for (uint32_t y = 0; y < 16; ++y) {
+        for (uint32_t x = 0; x < 32; ++x) {
+            const uint32_t sum = g[2 * y * 64 + 2 * x] + g[2 * y * 64 + 2 * x + 1] +
+                                 g[(2 * y + 1) * 64 + 2 * x] + g[(2 * y + 1) * 64 + 2 * x + 1];
+            ASSERT_NEAR(area.GetData<uint8_t>()[y * 32 + x], (sum + 2) / 4, 1);
+        }
+    }
+    // sums of 4 are exact in fp32, halves round to even in the SIMD body and the tail
+    for (const PixelFormat format : {M_PIX_FMT_GRAY8, M_PIX_FMT_BGR888}) {
+        base::Image wide(70, 32, 1, format, TimeStamp(), M_MEM_ON_CPU);
+        Fill(wide);
+        base::Image half;
+        ASSERT_EQ(base::resize(wide, 35, 16, half, base::M_INTER_AREA), M_OK);
+        const uint32_t cn = wide.GetChannel(), pitch = 70 * cn;
+        const uint8_t* w  = wide.GetData<uint8_t>();
+        for (uint32_t y = 0; y < 16; ++y) {
+            for (uint32_t j = 0; j < 35 * cn; ++j) {
+                const uint32_t i   = 2 * y * pitch + (j / cn) * 2 * cn + j % cn;
+                const uint32_t sum = w[i] + w[i + cn] + w[i + pitch] + w[i + pitch + cn];
+                ASSERT_EQ(half.GetData<uint8_t>()[y * 35 * cn + j], std::nearbyint(sum / 4.0))
+                    << FormatStr[format] << " at " << j << ", " << y;
+            }
+        }
+    }
+    // area of fp32 shrinking by 100 / 37 against boxes in double
+    base::Image bgr(100, 60, 1, M_PIX_FMT_BGR323232, TimeStamp(), M_MEM_ON_CPU);
+    Fill(bgr);
+    base::Image box;
+    ASSERT_EQ(base::resize(bgr, 37, 23, box, base::M_INTER_AREA), M_OK);
+    const double sx = 100.0 / 37, sy = 60.0 / 23;
+    auto Cover = [](double i0, double i1, uint32_t k) {
+        return std::max(0.0, std::min(i1, k + 1.0) - std::max(i0, static_cast<double>(k)));
+    };
+    for (uint32_t y = 0; y < 23; ++y) {
+        for (uint32_t j = 0; j < 37 * 3; ++j) {
+            const uint32_t x = j / 3, c = j % 3;
+            double sum       = 0.0;
+            for (uint32_t v = 0; v < 60; ++v) {
+                for (uint32_t u = 0; u < 100; ++u) {
+                    sum += Cover(x * sx, (x + 1) * sx, u) * Cover(y * sy, (y + 1) * sy, v) *
+                           bgr.GetData<float>()[(v * 100 + u) * 3 + c];
+                }
+            }
+            ASSERT_NEAR(box.GetData<float>()[y * 37 * 3 + j], sum / (sx * sy), 1e-3)
+                << "at " << j << ", " << y;
+        }
+    }
+
+    // nearest takes the pixel under the center of out pixel
+    base::Image nearest(gray, 21, 10);
+    op = base::ImageOperator::Create("resize_nearest");
+    ASSERT_NE(op, nullptr);
+    ASSERT_EQ(op->Run(gray, nearest), M_OK);
+    for (uint32_t y = 0; y < 10; ++y) {
+        for (uint32_t x = 0; x < 21; ++x) {
+            const uint32_t sx = static_cast<uint32_t>((x + 0.5) * 64 / 21);
+            const uint32_t sy = static_cast<uint32_t>((y + 0.5) * 32 / 10);
+            ASSERT_EQ(nearest.GetData<uint8_t>()[y * 21 + x], g[sy * 64 + sx]);
+        }
+    }
+
+    EXPECT_NE(base::ImageOperator::Create("resize"), nullptr);
+    EXPECT_EQ(base::ImageOperator::Create("no_such_operator"), nullptr);
+    EXPECT_EQ(base::resize(gray, 32, 16, gray), M_INVALID_ARG);
+    EXPECT_EQ(base::resize(gray, 0, 16, area), M_NOT_SUPPORT);
+    EXPECT_EQ(base::resize(gray, 32, 16, area, base::M_INTER_MAX), M_NOT_SUPPORT);
+    base::Image nv12(64, 32, 1, M_PIX_FMT_NV12, TimeStamp(), M_MEM_ON_CPU);
+    EXPECT_EQ(base::resize(nv12, 31, 16, area), M_NOT_SUPPORT);
+}
+
+TEST_F(ImageTest, Pitch) {
+    const uint32_t w = 100, h = 60, number = 2, pitch = 128, aligned = 64;
+    // decoder frame of NV12 with padded rows and planes of aligned height
+    base::Image dense(w, h, number, M_PIX_FMT_NV12, TimeStamp(), M_MEM_ON_CPU);
+    for (uint32_t i = 0; i < dense.GetSize(); ++i) {
+        dense.GetData<uint8_t>()[i] = static_cast<uint8_t>(i * 31 + (i >> 8));
+    }
+    const uint32_t scalar = pitch * aligned * 3 / 2;
+    std::vector<uint8_t> frame(scalar * number, 0xEE);
+    for (uint32_t n = 0; n < number; ++n) {
+        for (uint32_t y = 0; y < h * 3 / 2; ++y) {
+            const uint32_t row = y < h ? y : aligned + (y - h);
+            memcpy(&frame[n * scalar + row * pitch], dense.GetData<uint8_t>(n) + y * w, w);
+        }
+    }
+    base::Image nv12(
+        w, h, number, M_PIX_FMT_NV12, TimeStamp(), frame.data(), {pitch, pitch}, aligned);
+    ASSERT_EQ(nv12.GetData<uint8_t>(), frame.data());
+    EXPECT_FALSE(nv12.IsDense());
+    EXPECT_TRUE(dense.IsDense());
+    EXPECT_EQ(nv12.GetStride(), pitch);
+    EXPECT_EQ(nv12.GetAlignedHeight(), aligned);
+    EXPECT_EQ(nv12.GetScalar(), scalar);
+    base::ImagePlane planes[IMAGE_MAX_PLANES];
+    ASSERT_EQ(nv12.GetPlanes(1, planes), 2U);
+    EXPECT_EQ(planes[1].data, frame.data() + scalar + pitch * aligned);
+    EXPECT_EQ(planes[1].pitch, pitch);
+
+    // kernels read padded rows, results equal those of the dense frame
+    auto Same = [](const base::Image& a, const base::Image& b) {
+        return a.GetSize() == b.GetSize() &&
+               memcmp(a.GetData<void>(), b.GetData<void>(), a.GetSize()) == 0;
+    };
+    const base::Image clone = nv12.Clone();
+    EXPECT_TRUE(clone.IsDense());
+    EXPECT_TRUE(Same(clone, dense));
+    base::Image a, b;
+    ASSERT_EQ(base::convert_color(nv12, M_PIX_FMT_BGR888, a), M_OK);
+    ASSERT_EQ(base::convert_color(dense, M_PIX_FMT_BGR888, b), M_OK);
+    EXPECT_TRUE(Same(a, b));
+    ASSERT_EQ(base::resize(nv12, 64, 32, a), M_OK);
+    ASSERT_EQ(base::resize(dense, 64, 32, b), M_OK);
+    EXPECT_TRUE(Same(a, b));
+
+    // chroma pitch of YV12 is half of Y pitch
+    base::Image yv12(w, h, 1, M_PIX_FMT_YV12, TimeStamp(), frame.data(), {pitch}, aligned);
+    ASSERT_EQ(yv12.GetPlanes(0, planes), 3U);
+    EXPECT_EQ(planes[1].pitch, pitch / 2);
+    EXPECT_EQ(planes[2].data, frame.data() + pitch * aligned + pitch / 2 * aligned / 2);
+
+    // allocated planar image with 64 bytes aligned rows
+    base::Image planar(w, h, 1, M_PIX_FMT_RGB888_PLANAR, TimeStamp(), {pitch, pitch, pitch}, h);
+    ASSERT_NE(planar.GetData<void>(), nullptr);
+    base::Image packed(w, h, 1, M_PIX_FMT_RGB888, TimeStamp(), M_MEM_ON_CPU);
+    for (uint32_t i = 0; i < packed.GetSize(); ++i) {
+        packed.GetData<uint8_t>()[i] = static_cast<uint8_t>(i * 7);
+    }
+    ASSERT_EQ(base::convert_color(packed, M_PIX_FMT_RGB888_PLANAR, planar), M_OK);
+    EXPECT_EQ(planar.GetStride(), pitch);
+    base::Image green;
+    ASSERT_EQ(planar.ImageSplitChannel(0, 1, green), M_OK);
+    EXPECT_EQ(green.GetStride(), pitch);
+    const uint8_t* rgb = packed.GetData<uint8_t>();
+    EXPECT_EQ(green.GetData<uint8_t>()[5 * pitch + 9], rgb[(5 * w + 9) * 3 + 1]);
+    base::Tensor stacked;
+    ASSERT_EQ(base::stack({std::make_shared<base::Image>(planar)}, stacked), M_OK);
+    EXPECT_EQ(stacked.GetRow<uint8_t>(0, 2 * h + 5)[9], rgb[(5 * w + 9) * 3 + 2]);
+    EXPECT_EQ(planar.ImageReshape(w, h, 1, M_PIX_FMT_BGR888_PLANAR), M_NOT_SUPPORT);
+
+    base::Image narrow(w, h, 1, M_PIX_FMT_BGR888, TimeStamp(), frame.data(), {w}, h);
+    EXPECT_EQ(narrow.GetData<void>(), nullptr);
+    base::Image short_rows(w, h, 1, M_PIX_FMT_GRAY8, TimeStamp(), frame.data(), {pitch}, h - 1);
+    EXPECT_EQ(short_rows.GetData<void>(), nullptr);
+}
+
+TEST_F(ImageTest, MultiPlane) {
+    const uint32_t w = 100, h = 60, number = 2, pitch = 128;
+    base::Image dense(w, h, number, M_PIX_FMT_NV12, TimeStamp(), M_MEM_ON_CPU);
+    for (uint32_t i = 0; i < dense.GetSize(); ++i) {
+        dense.GetData<uint8_t>()[i] = static_cast<uint8_t>(i * 29 + (i >> 7));
+    }
+    // Y and UV of decoder in buffers of their own, UV rows padded
+    std::vector<uint8_t> y(w * h * number), uv(pitch * h / 2 * number, 0xEE);
+    for (uint32_t n = 0; n < number; ++n) {
+        memcpy(&y[n * w * h], dense.GetData<uint8_t>(n), w * h);
+        for (uint32_t i = 0; i < h / 2; ++i) {
+            memcpy(&uv[(n * h / 2 + i) * pitch], dense.GetData<uint8_t>(n) + (h + i) * w, w);
+        }
+    }
+    base::Image detach(w,
+                       h,
+                       number,
+                       M_PIX_FMT_NV12_DETACH,
+                       TimeStamp(),
+                       std::vector<const void*>{y.data(), uv.data()},
+                       {w, pitch},
+                       0);
+    ASSERT_EQ(detach.GetData<uint8_t>(), y.data());
+    EXPECT_TRUE(detach.IsDetached());
+    EXPECT_FALSE(detach.IsDense());
+    EXPECT_EQ(detach.GetScalar(), w * h);
+    EXPECT_NE(detach.GetPlaneDataManager(1), detach.GetDataManager());
+    base::ImagePlane planes[IMAGE_MAX_PLANES];
+    ASSERT_EQ(detach.GetPlanes(1, planes), 2U);
+    EXPECT_EQ(planes[0].data, y.data() + w * h);
+    EXPECT_EQ(planes[1].data, uv.data() + pitch * h / 2);
+
+    // kernels read the planes in place, results equal those of the contiguous frame
+    auto Same = [](const base::Image& a, const base::Image& b) {
+        return a.GetSize() == b.GetSize() &&
+               memcmp(a.GetData<void>(), b.GetData<void>(), a.GetSize()) == 0;
+    };
+    base::Image a, b;
+    ASSERT_EQ(base::convert_color(detach, M_PIX_FMT_BGR888, a), M_OK);
+    ASSERT_EQ(base::convert_color(dense, M_PIX_FMT_BGR888, b), M_OK);
+    EXPECT_TRUE(Same(a, b));
+    ASSERT_EQ(base::resize(detach, 64, 32, a), M_OK);
+    ASSERT_EQ(base::resize(dense, 64, 32, b), M_OK);
+    EXPECT_TRUE(a.IsDetached());
+    ASSERT_EQ(a.GetPlanes(1, planes), 2U);
+    EXPECT_EQ(memcmp(planes[0].data, b.GetData<uint8_t>(1), 64 * 32), 0);
+    EXPECT_EQ(memcmp(planes[1].data, b.GetData<uint8_t>(1) + 64 * 32, 64 * 16), 0);
+    base::PreprocessParam param;
+    param.width  = 48;
+    param.height = 30;
+    base::Tensor ta, tb;
+    ASSERT_EQ(base::preprocess(detach, param, ta), M_OK);
+    ASSERT_EQ(base::preprocess(dense, param, tb), M_OK);
+    EXPECT_EQ(memcmp(ta.GetData<void>(), tb.GetData<void>(), ta.GetSize()), 0);
+
+    // clone keeps the planes apart, NV12_DETACH is allocated apart too
+    base::Image clone = detach.Clone();
+    EXPECT_TRUE(clone.IsDetached());
+    ASSERT_EQ(clone.GetPlanes(1, planes), 2U);
+    EXPECT_EQ(memcmp(planes[1].data, dense.GetData<uint8_t>(1) + w * h, w * h / 2), 0);
+    ASSERT_EQ(detach.CloneInto(b), M_OK);
+    EXPECT_TRUE(b.IsDetached());
+
+    // YUV420P of 3 buffers is copied into one buffer by clone
+    std::vector<uint8_t> u(w * h / 4, 64), v(w * h / 4, 192);
+    base::Image i420(w,
+                     h,
+                     1,
+                     M_PIX_FMT_YUV420P,
+                     TimeStamp(),
+                     std::vector<const void*>{y.data(), u.data(), v.data()},
+                     {},
+                     0);
+    ASSERT_EQ(i420.GetPlanes(0, planes), 3U);
+    EXPECT_EQ(planes[2].data, v.data());
+    const base::Image packed = i420.Clone();
+    EXPECT_FALSE(packed.IsDetached());
+    EXPECT_TRUE(packed.IsDense());
+    EXPECT_EQ(packed.GetData<uint8_t>()[w * h + w * h / 4], 192);
+    ASSERT_EQ(base::convert_color(i420, M_PIX_FMT_RGB888, a), M_OK);
+    ASSERT_EQ(base::convert_color(packed, M_PIX_FMT_RGB888, b), M_OK);
+    EXPECT_TRUE(Same(a, b));
+
+    base::Image missing(w,
+                        h,
+                        1,
+                        M_PIX_FMT_YUV420P,
+                        TimeStamp(),
+                        std::vector<const void*>{y.data(), u.data()},
+                        {},
+                        0);
+    EXPECT_EQ(missing.GetData<void>(), nullptr);
+}
+
+TEST_F(ImageTest, View) {
+    const uint32_t w = 100, h = 60, number = 2;
+    base::Image nv12(w, h, number, M_PIX_FMT_NV12, TimeStamp(), M_MEM_ON_CPU);
+    for (uint32_t i = 0; i < nv12.GetSize(); ++i) {
+        nv12.GetData<uint8_t>()[i] = static_cast<uint8_t>(i * 37 + (i >> 6));
+    }
+    auto Same = [](const base::Image& a, const base::Image& b) {
+        return a.GetSize() == b.GetSize() &&
+               memcmp(a.GetData<void>(), b.GetData<void>(), a.GetSize()) == 0;
+    };
+
+    // view of image 1 shares the buffer, and outlives the batch
+    base::Image item, bgr;
+    {
+        base::Image batch = nv12.Clone();
+        ASSERT_EQ(batch.ImageSplit(1, item), M_OK);
+        EXPECT_EQ(item.GetData<uint8_t>(), batch.GetData<uint8_t>(1));
+        EXPECT_EQ(item.GetNumber(), 1U);
+        EXPECT_EQ(batch.ImageSplit(number, bgr), M_INVALID_ARG);
+    }
+    base::Image a, b;
+    ASSERT_EQ(base::convert_color(item, M_PIX_FMT_BGR888, a), M_OK);
+    ASSERT_EQ(base::convert_color(nv12, M_PIX_FMT_BGR888, bgr), M_OK);
+    EXPECT_EQ(memcmp(a.GetData<void>(), bgr.GetData<void>(1), a.GetSize()), 0);
+
+    // crop reads rows of parent pitch, results equal those of a dense copy
+    base::Image crop;
+    ASSERT_EQ(nv12.Crop(10, 6, 40, 20, crop), M_OK);
+    EXPECT_FALSE(crop.IsDense());
+    EXPECT_EQ(crop.GetStride(), w);
+    EXPECT_EQ(crop.GetData<uint8_t>(1), nv12.GetData<uint8_t>(1) + 6 * w + 10);
+    base::ImagePlane planes[IMAGE_MAX_PLANES];
+    ASSERT_EQ(crop.GetPlanes(1, planes), 2U);
+    EXPECT_EQ(planes[1].data, nv12.GetData<uint8_t>(1) + w * h + 3 * w + 10);
+    const base::Image dense = crop.Clone();
+    EXPECT_TRUE(dense.IsDense());
+    ASSERT_EQ(base::convert_color(crop, M_PIX_FMT_RGB888, a), M_OK);
+    ASSERT_EQ(base::convert_color(dense, M_PIX_FMT_RGB888, b), M_OK);
+    EXPECT_TRUE(Same(a, b));
+    ASSERT_EQ(base::resize(crop, 24, 12, a), M_OK);
+    ASSERT_EQ(base::resize(dense, 24, 12, b), M_OK);
+    EXPECT_TRUE(Same(a, b));
+    base::PreprocessParam param;
+    param.width  = 32;
+    param.height = 16;
+    base::Tensor ta, tb;
+    ASSERT_EQ(base::preprocess(crop, param, ta), M_OK);
+    ASSERT_EQ(base::preprocess(dense, param, tb), M_OK);
+    EXPECT_EQ(memcmp(ta.GetData<void>(), tb.GetData<void>(), ta.GetSize()), 0);
+    EXPECT_EQ(nv12.Crop(11, 6, 40, 20, crop), M_INVALID_ARG);
+    EXPECT_EQ(nv12.Crop(80, 6, 40, 20, crop), M_INVALID_ARG);
+
+    // kernels write into a view of the same size and format in place
+    base::Image box;
+    ASSERT_EQ(bgr.Crop(50, 30, 40, 20, box), M_OK);
+    ASSERT_EQ(base::convert_color(dense, M_PIX_FMT_BGR888, box), M_OK);
+    EXPECT_EQ(box.GetData<uint8_t>(), bgr.GetData<uint8_t>() + (30 * w + 50) * 3);
+    ASSERT_EQ(base::convert_color(dense, M_PIX_FMT_BGR888, a), M_OK);
+    for (uint32_t i = 0; i < 20; ++i) {
+        EXPECT_EQ(memcmp(bgr.GetData<uint8_t>(1) + ((30 + i) * w + 50) * 3,
+                         a.GetData<uint8_t>(1) + i * 40 * 3,
+                         40 * 3),
+                  0);
+    }
+
+    // a crop has the byte size of its parent, clone into it takes a new buffer
+    const base::Image saved = bgr.Clone();
+    base::Image other       = bgr.Clone();
+    for (uint32_t i = 0; i < other.GetSize(); ++i) {
+        other.GetData<uint8_t>()[i] = static_cast<uint8_t>(i * 7);
+    }
+    ASSERT_EQ(bgr.Crop(0, 0, 40, 20, box), M_OK);
+    ASSERT_EQ(box.GetSize(), other.GetSize());
+    ASSERT_EQ(other.CloneInto(box), M_OK);
+    EXPECT_NE(box.GetData<uint8_t>(), bgr.GetData<uint8_t>());
+    EXPECT_TRUE(Same(box, other));
+    EXPECT_EQ(memcmp(bgr.GetData<void>(), saved.GetData<void>(), bgr.GetSize()), 0);
+}
+
+TEST_F(ImageTest, Preprocess) {
+    const uint32_t w = 100, h = 60, number = 2;
+    base::PreprocessParam param;
+    param.width  = 48;
+    param.height = 30;
+    for (uint32_t c = 0; c < 3; ++c) {
+        param.mean[c] = 100.f + 10.f * c;
+        param.norm[c] = 1.f / (50.f + c);
+    }
+    // resized value of convert_color output in double, normalized
+    auto Reference = [&](const base::Image& rgb, uint32_t n, uint32_t x, uint32_t y, uint32_t c) {
+        const uint32_t cn = rgb.GetChannel();
+        auto Axis         = [&](uint32_t i, uint32_t in, uint32_t out, uint32_t& i0, double& f) {
+            if (param.interpolation == base::M_INTER_NEAREST) {
+                i0 = std::min(static_cast<uint32_t>((i + 0.5) * in / out), in - 1);
+                f  = 0.0;
+                return;
+            }
+            const double s = std::min(std::max((i + 0.5) * in / out - 0.5, 0.0), in - 1.0);
+            i0             = static_cast<uint32_t>(s);
+            f              = i0 + 1 < in ? s - i0 : 0.0;
+        };
+        auto At = [&](uint32_t sx, uint32_t sy) {
+            return static_cast<double>(rgb.GetData<uint8_t>(n)[(sy * w + sx) * cn + c]);
+        };
+        uint32_t x0 = 0, y0 = 0;
+        double fx = 0, fy = 0;
+        Axis(x, w, param.width, x0, fx);
+        Axis(y, h, param.height, y0, fy);
+        const uint32_t x1 = std::min(x0 + 1, w - 1), y1 = std::min(y0 + 1, h - 1);
+        const double v = (At(x0, y0) * (1 - fx) + At(x1, y0) * fx) * (1 - fy) +
+                         (At(x0, y1) * (1 - fx) + At(x1, y1) * fx) * fy;
+        return (v - param.mean[c]) * param.norm[c];
+    };
+    auto Check = [&](const base::Image& input, const base::Tensor& out) {
+        base::Image rgb;
+        if (param.format == M_PIX_FMT_GRAY8) {
+            rgb = base::Image(w, h, number, M_PIX_FMT_GRAY8, TimeStamp(), M_MEM_ON_CPU);
+            for (uint32_t n = 0; n < number; ++n) {
+                memcpy(rgb.GetData<uint8_t>(n), input.GetData<uint8_t>(n), w * h);
+            }
+        } else {
+            ASSERT_EQ(base::convert_color(input, param.format, rgb), M_OK);
+        }
+        const bool nchw = param.layout == M_LAYOUT_NCHW;
+        const uint32_t cn = rgb.GetChannel();
+        const double tolerance = param.elem_type == M_DATA_TYPE_FLOAT32 ? 0.01 : 0.02;
+        for (uint32_t n = 0; n < number; ++n) {
+            for (uint32_t y = 0; y < param.height; ++y) {
+                for (uint32_t x = 0; x < param.width; ++x) {
+                    for (uint32_t c = 0; c < cn; ++c) {
+                        const size_t row = nchw ? c * param.height + y : y;
+                        const size_t col = nchw ? x : x * cn + c;
+                        const double v =
+                            param.elem_type == M_DATA_TYPE_FLOAT32
+                                ? out.GetRow<float>(n, row)[col]
+                                : fp16_to_fp32(out.GetRow<uint16_t>(n, row)[col]);
+                        ASSERT_NEAR(v, Reference(rgb, n, x, y, c), tolerance)
+                            << input.GetPixelFormatStr() << " at " << x << ", " << y
+                            << " channel " << c;
+                    }
+                }
+            }
+        }
+    };
+
+    const PixelFormat formats[] = {M_PIX_FMT_NV12,
+                                   M_PIX_FMT_YV12,
+                                   M_PIX_FMT_UYVY,
+                                   M_PIX_FMT_BGR888,
+                                   M_PIX_FMT_RGBA8888,
+                                   M_PIX_FMT_RGB888_PLANAR};
+    for (const PixelFormat format : formats) {
+        base::Image input(w, h, number, format, TimeStamp(), M_MEM_ON_CPU);
+        for (uint32_t i = 0; i < input.GetSize(); ++i) {
+            input.GetData<uint8_t>()[i] = static_cast<uint8_t>((i * 37) ^ (i >> 6));
+        }
+        base::Tensor out;
+        param.format        = M_PIX_FMT_RGB888;
+        param.layout        = M_LAYOUT_NCHW;
+        param.elem_type     = M_DATA_TYPE_FLOAT32;
+        param.interpolation = base::M_INTER_LINEAR;
+        ASSERT_EQ(base::preprocess(input, param, out), M_OK);
+        ASSERT_EQ(out.GetShape(), (std::vector<uint32_t>{number, 3, 30, 48}));
+        Check(input, out);
+
+        // same tensor of another layout, type and order
+        param.format        = M_PIX_FMT_BGR888;
+        param.layout        = M_LAYOUT_NHWC;
+        param.elem_type     = M_DATA_TYPE_FLOAT16;
+        param.interpolation = base::M_INTER_NEAREST;
+        ASSERT_EQ(base::preprocess(input, param, out), M_OK);
+        ASSERT_EQ(out.GetShape(), (std::vector<uint32_t>{number, 30, 48, 3}));
+        Check(input, out);
+    }
+
+    // gray of Y plane, buffer reused
+    base::Image nv12(w, h, number, M_PIX_FMT_NV12, TimeStamp(), M_MEM_ON_CPU);
+    for (uint32_t i = 0; i < nv12.GetSize(); ++i) {
+        nv12.GetData<uint8_t>()[i] = static_cast<uint8_t>(i * 13);
+    }
+    base::Tensor out;
+    param.format        = M_PIX_FMT_GRAY8;
+    param.layout        = M_LAYOUT_NCHW;
+    param.elem_type     = M_DATA_TYPE_FLOAT32;
+    param.interpolation = base::M_INTER_LINEAR;
+    ASSERT_EQ(base::preprocess(nv12, param, out), M_OK);
+    Check(nv12, out);
+    const float* buffer = out.GetData<float>();
+    ASSERT_EQ(base::preprocess(nv12, param, out), M_OK);
+    EXPECT_EQ(out.GetData<float>(), buffer);
+
+    base::Image gray(w, h, 1, M_PIX_FMT_GRAY8, TimeStamp(), M_MEM_ON_CPU);
+    param.format = M_PIX_FMT_RGB888;
+    EXPECT_EQ(base::preprocess(gray, param, out), M_NOT_SUPPORT);
+    param.interpolation = base::M_INTER_AREA;
+    EXPECT_EQ(base::preprocess(nv12, param, out), M_NOT_SUPPORT);
+    param.interpolation = base::M_INTER_LINEAR;
+    param.elem_type     = M_DATA_TYPE_UINT8;
+    EXPECT_EQ(base::preprocess(nv12, param, out), M_NOT_SUPPORT);
+}
+
+TEST_F(ImageTest, CropResize) {
+    const uint32_t w = 100, h = 60, number = 2;
+    base::Image nv12(w, h, number, M_PIX_FMT_NV12, TimeStamp(), M_MEM_ON_CPU);
+    for (uint32_t i = 0; i < nv12.GetSize(); ++i) {
+        nv12.GetData<uint8_t>()[i] = static_cast<uint8_t>(i * 41 + (i >> 5));
+    }
+    base::Image rgb;
+    ASSERT_EQ(base::convert_color(nv12, M_PIX_FMT_RGB888, rgb), M_OK);
+    base::PreprocessParam param;
+    param.width  = 16;
+    param.height = 8;
+    for (uint32_t c = 0; c < 3; ++c) {
+        param.mean[c] = 120.f + c;
+        param.norm[c] = 1.f / (60.f + c);
+    }
+
+    // shrinking boxes sample inside the box, as preprocess of a crop of the box
+    std::vector<base::CropBox> boxes;
+    for (uint32_t i = 0; i < 40; ++i) {
+        const float x = static_cast<float>(i * 6 % 60), y = static_cast<float>(i * 4 % 30);
+        boxes.push_back({x, y, x + 32.f + (i % 5) * 2, y + 16.f + (i % 3) * 4, i % number});
+    }
+    for (const base::Image* input : {&nv12, &rgb}) {
+        for (const TensorLayout layout : {M_LAYOUT_NCHW, M_LAYOUT_NHWC}) {
+            param.layout = layout;
+            base::Tensor out, ref;
+            ASSERT_EQ(base::crop_resize(*input, boxes, param, out), M_OK);
+            ASSERT_EQ(out.GetShape(0), boxes.size());
+            for (uint32_t i = 0; i < boxes.size(); ++i) {
+                const base::CropBox& box = boxes[i];
+                base::Image item, crop;
+                ASSERT_EQ(input->ImageSplit(box.index, item), M_OK);
+                ASSERT_EQ(item.Crop(box.x0, box.y0, box.x1 - box.x0, box.y1 - box.y0, crop), M_OK);
+                ASSERT_EQ(base::preprocess(crop, param, ref), M_OK);
+                EXPECT_EQ(memcmp(out.GetData<float>(i), ref.GetData<void>(), ref.GetSize()), 0);
+            }
+        }
+    }
+
+    // letterbox keeps aspect ratio, rows around the content are padding
+    param.layout    = M_LAYOUT_NCHW;
+    param.letterbox = true;
+    param.pad       = 114.f;
+    param.width     = 16;
+    param.height    = 16;
+    base::Tensor box_out, ref;
+    ASSERT_EQ(base::crop_resize(rgb, {{10.f, 6.f, 50.f, 26.f, 1}}, param, box_out), M_OK);
+    const float pad = (114.f - param.mean[1]) * param.norm[1];
+    EXPECT_FLOAT_EQ(box_out.GetRow<float>(0, 16 + 3)[5], pad);
+    EXPECT_FLOAT_EQ(box_out.GetRow<float>(0, 16 + 12)[5], pad);
+    base::Image item, crop;
+    ASSERT_EQ(rgb.ImageSplit(1, item), M_OK);
+    ASSERT_EQ(item.Crop(10, 6, 40, 20, crop), M_OK);
+    param.letterbox = false;
+    param.height    = 8;
+    ASSERT_EQ(base::preprocess(crop, param, ref), M_OK);
+    for (uint32_t c = 0; c < 3; ++c) {
+        for (uint32_t y = 0; y < 8; ++y) {
+            EXPECT_EQ(memcmp(box_out.GetRow<float>(0, c * 16 + 4 + y),
+                             ref.GetRow<float>(0, c * 8 + y),
+                             16 * sizeof(float)),
+                      0);
+        }
+    }
+    param.letterbox = true;
+    param.width     = 50;
+    param.height    = 50;
+    ASSERT_EQ(base::preprocess(rgb, param, box_out), M_OK);
+    EXPECT_FLOAT_EQ(box_out.GetRow<float>(1, 9)[20], (114.f - param.mean[0]) * param.norm[0]);
+    EXPECT_NE(box_out.GetRow<float>(1, 10)[20], (114.f - param.mean[0]) * param.norm[0]);
+
+    // boxes over the edge take edge pixels, boxes out of image are refused
+    param.letterbox = false;
+    ASSERT_EQ(base::crop_resize(nv12, {{-20.f, -10.f, 30.5f, 20.5f, 0}}, param, box_out), M_OK);
+    EXPECT_TRUE(std::isfinite(box_out.GetRow<float>(0, 0)[0]));
+    EXPECT_EQ(base::crop_resize(nv12, {{100.f, 0.f, 120.f, 20.f, 0}}, param, box_out),
+              M_INVALID_ARG);
+    EXPECT_EQ(base::crop_resize(nv12, {{0.f, 0.f, 20.f, 20.f, 2}}, param, box_out),
+              M_INVALID_ARG);
+    EXPECT_EQ(base::crop_resize(nv12, {}, param, box_out), M_INVALID_ARG);
+}
+
+TEST_F(ImageTest, Warp) {
+    const uint32_t w = 150, h = 90, number = 2;
+    base::Image bgr(w, h, number, M_PIX_FMT_BGR888, TimeStamp(), M_MEM_ON_CPU);
+    for (uint32_t n = 0; n < number; ++n) {
+        for (uint32_t y = 0; y < h; ++y) {
+            uint8_t* row = bgr.GetData<uint8_t>(n) + y * w * 3;
+            for (uint32_t x = 0; x < w * 3; ++x) {
+                row[x] = static_cast<uint8_t>((x / 3 + y) / 2 + (x % 3) * 20 + n * 5);
+            }
+        }
+    }
+
+    // identity and integer translation copy pixels, out of input is the border
+    const float identity[6] = {1.f, 0.f, 0.f, 0.f, 1.f, 0.f};
+    const float shift[6]    = {1.f, 0.f, 7.f, 0.f, 1.f, -3.f};
+    base::Image out;
+    ASSERT_EQ(base::warp_affine(bgr, identity, w, h, out), M_OK);
+    EXPECT_EQ(memcmp(out.GetData<void>(), bgr.GetData<void>(), bgr.GetSize()), 0);
+    for (const base::InterpolationType type : {base::M_INTER_NEAREST, base::M_INTER_LINEAR}) {
+        const base::BorderType border = base::M_BORDER_CONSTANT;
+        ASSERT_EQ(base::warp_affine(bgr, shift, w, h, out, type, border, 9.f), M_OK);
+        const uint8_t* src = bgr.GetData<uint8_t>(1);
+        const uint8_t* dst = out.GetData<uint8_t>(1);
+        EXPECT_EQ(memcmp(dst + 10 * w * 3 + 7 * 3, src + 13 * w * 3, (w - 7) * 3), 0);
+        EXPECT_EQ(dst[10 * w * 3 + 6 * 3], 9);
+        EXPECT_EQ(dst[(h - 2) * w * 3 + 20 * 3], 9);
+        ASSERT_EQ(base::warp_affine(bgr, shift, w, h, out, type, base::M_BORDER_REPLICATE), M_OK);
+        EXPECT_EQ(out.GetData<uint8_t>(1)[10 * w * 3 + 2 * 3 + 1], src[13 * w * 3 + 1]);
+        EXPECT_EQ(out.GetData<uint8_t>(1)[(h - 1) * w * 3 + 30 * 3],
+                  src[(h - 1) * w * 3 + 23 * 3]);
+    }
+
+    // rotation and scale against double bilinear, out of the edge pixels are skipped
+    const double angle = 0.3, scale = 0.8, c = std::cos(angle) * scale, s = std::sin(angle) * scale;
+    const float rotate[6] = {static_cast<float>(c),
+                             static_cast<float>(s),
+                             10.f,
+                             static_cast<float>(-s),
+                             static_cast<float>(c),
+                             40.f};
+    const float projective[9] = {
+        rotate[0], rotate[1], rotate[2], rotate[3], rotate[4], rotate[5], 0.f, 0.f, 1.f};
+    base::Image persp;
+    const uint32_t ow = 130, oh = 70;
+    ASSERT_EQ(base::warp_affine(bgr, rotate, ow, oh, out), M_OK);
+    ASSERT_EQ(base::warp_perspective(bgr, projective, ow, oh, persp), M_OK);
+    const double det = 1.0 * rotate[0] * rotate[4] - 1.0 * rotate[1] * rotate[3];
+    uint32_t checked = 0;
+    for (uint32_t n = 0; n < number; ++n) {
+        const uint8_t* src = bgr.GetData<uint8_t>(n);
+        for (uint32_t y = 0; y < oh; ++y) {
+            for (uint32_t x = 0; x < ow; ++x) {
+                const double dx = x - rotate[2], dy = y - rotate[5];
+                const double sx = (rotate[4] * dx - rotate[1] * dy) / det;
+                const double sy = (-rotate[3] * dx + rotate[0] * dy) / det;
+                if (sx < 0.5 || sy < 0.5 || sx > w - 2.5 || sy > h - 2.5) {
+                    continue;
+                }
+                const uint32_t x0 = static_cast<uint32_t>(sx), y0 = static_cast<uint32_t>(sy);
+                const double fx = sx - x0, fy = sy - y0;
+                for (uint32_t ch = 0; ch < 3; ++ch) {
+                    const uint8_t* p = src + y0 * w * 3 + x0 * 3 + ch;
+                    const double ref = (p[0] * (1 - fx) + p[3] * fx) * (1 - fy) +
+                                       (p[w * 3] * (1 - fx) + p[w * 3 + 3] * fx) * fy;
+                    const uint32_t i = (y * ow + x) * 3 + ch;
+                    EXPECT_NEAR(out.GetData<uint8_t>(n)[i], ref, 1.0);
+                    EXPECT_NEAR(persp.GetData<uint8_t>(n)[i], ref, 1.0);
+                }
+                ++checked;
+            }
+        }
+    }
+    EXPECT_GT(checked, ow * oh);
+
+    // planes of planar formats warp as the channels of packed formats, fp32 too
+    base::Image planar, planar_out, back, fp32, fp32_out;
+    ASSERT_EQ(base::convert_color(bgr, M_PIX_FMT_BGR888_PLANAR, planar), M_OK);
+    ASSERT_EQ(base::warp_affine(planar, rotate, ow, oh, planar_out), M_OK);
+    ASSERT_EQ(base::convert_color(planar_out, M_PIX_FMT_BGR888, back), M_OK);
+    EXPECT_EQ(memcmp(back.GetData<void>(), out.GetData<void>(), out.GetSize()), 0);
+    const float one[3] = {1.f, 1.f, 1.f}, zero[3] = {0.f, 0.f, 0.f};
+    ASSERT_EQ(base::normalize(bgr, M_PIX_FMT_BGR323232, one, zero, fp32), M_OK);
+    ASSERT_EQ(base::warp_affine(fp32, rotate, ow, oh, fp32_out), M_OK);
+    for (uint32_t i = 0; i < out.GetSize(); ++i) {
+        EXPECT_NEAR(fp32_out.GetData<float>()[i], out.GetData<uint8_t>()[i], 1.0);
+    }
+
+    // bad matrix, yuv and in place are refused
+    const float singular[6] = {1.f, 2.f, 0.f, 2.f, 4.f, 0.f};
+    EXPECT_EQ(base::warp_affine(bgr, singular, w, h, out), M_INVALID_ARG);
+    EXPECT_EQ(base::warp_affine(bgr, identity, w, h, bgr), M_INVALID_ARG);
+    base::Image nv12(w, h, 1, M_PIX_FMT_NV12, TimeStamp(), M_MEM_ON_CPU);
+    EXPECT_EQ(base::warp_affine(nv12, identity, w, h, out), M_NOT_SUPPORT);
+}
+
+TEST_F(ImageTest, TensorView) {
+    const uint32_t w = 50, h = 20, number = 2;
+    // packed image is NHWC, images of batch and crops of whole rows are views too
+    base::Image bgr(w, h, number, M_PIX_FMT_BGR888, TimeStamp(), M_MEM_ON_CPU);
+    base::Tensor tensor;
+    ASSERT_EQ(base::Tensor::FromImage(bgr, tensor), M_OK);
+    EXPECT_EQ(tensor.GetShape(), std::vector<uint32_t>({number, h, w, 3}));
+    EXPECT_EQ(tensor.GetShapeMode(), M_LAYOUT_NHWC);
+    EXPECT_EQ(tensor.GetElemType(), M_DATA_TYPE_UINT8);
+    EXPECT_EQ(tensor.GetDataManager(), bgr.GetDataManager());
+    EXPECT_EQ(tensor.GetData<uint8_t>(1), bgr.GetData<uint8_t>(1));
+    base::Image item, rows, crop;
+    ASSERT_EQ(bgr.ImageSplit(1, item), M_OK);
+    ASSERT_EQ(base::Tensor::FromImage(item, tensor), M_OK);
+    EXPECT_EQ(tensor.GetData<uint8_t>(), bgr.GetData<uint8_t>(1));
+    ASSERT_EQ(item.Crop(0, 5, w, 10, rows), M_OK);
+    ASSERT_EQ(base::Tensor::FromImage(rows, tensor), M_OK);
+    EXPECT_EQ(tensor.GetRow<uint8_t>(0, 0), bgr.GetData<uint8_t>(1) + 5 * w * 3);
+    ASSERT_EQ(bgr.Crop(2, 0, 20, h, crop), M_OK);
+    EXPECT_EQ(base::Tensor::FromImage(crop, tensor), M_NOT_SUPPORT);
+
+    // cache line pitch is a padded tensor, other pitches and yuv are refused
+    base::Image padded(w, h, 1, M_PIX_FMT_BGR888, TimeStamp(), {192}, 0, M_MEM_ON_CPU);
+    ASSERT_EQ(base::Tensor::FromImage(padded, tensor), M_OK);
+    EXPECT_EQ(tensor.GetPadding(), base::M_TENSOR_PADDING_CACHE_LINE);
+    EXPECT_EQ(tensor.GetStride(), 192U);
+    base::Image odd(w, h, 1, M_PIX_FMT_BGR888, TimeStamp(), {160}, 0, M_MEM_ON_CPU);
+    EXPECT_EQ(base::Tensor::FromImage(odd, tensor), M_NOT_SUPPORT);
+    base::Image nv12(w, h, 1, M_PIX_FMT_NV12, TimeStamp(), M_MEM_ON_CPU);
+    EXPECT_EQ(base::Tensor::FromImage(nv12, tensor), M_NOT_SUPPORT);
+
+    // planar image is NCHW, writes through one are seen by the other
+    base::Image planar(w, h, number, M_PIX_FMT_RGB323232_PLANAR, TimeStamp(), M_MEM_ON_CPU);
+    ASSERT_EQ(base::Tensor::FromImage(planar, tensor), M_OK);
+    EXPECT_EQ(tensor.GetShape(), std::vector<uint32_t>({number, 3, h, w}));
+    EXPECT_EQ(tensor.GetElemType(), M_DATA_TYPE_FLOAT32);
+    tensor.GetRow<float>(1, 2 * h + 3)[4] = 7.f;
+    base::ImagePlane planes[IMAGE_MAX_PLANES];
+    ASSERT_EQ(planar.GetPlanes(1, planes), 3U);
+    EXPECT_EQ(reinterpret_cast<float*>(planes[2].data + 3 * planes[2].pitch)[4], 7.f);
+
+    // tensor as image keeps stride as pitch
+    base::Tensor nchw({1, 3, h, w}, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32,
+                      base::M_TENSOR_PADDING_CACHE_LINE);
+    base::Image image;
+    ASSERT_EQ(base::Image::FromTensor(nchw, M_PIX_FMT_BGR323232_PLANAR, image), M_OK);
+    EXPECT_EQ(image.GetDataManager(), nchw.GetDataManager());
+    EXPECT_EQ(image.GetWidth(), w);
+    EXPECT_EQ(image.GetPitch(1), nchw.GetStride());
+    ASSERT_EQ(image.GetPlanes(0, planes), 3U);
+    EXPECT_EQ(planes[1].data, nchw.GetRow<uint8_t>(0, h));
+    base::Tensor nhwc({number, h, w, 4}, M_LAYOUT_NHWC, M_MEM_ON_CPU, M_DATA_TYPE_UINT8);
+    ASSERT_EQ(base::Image::FromTensor(nhwc, M_PIX_FMT_BGRA8888, image), M_OK);
+    EXPECT_EQ(image.GetData<uint8_t>(1), nhwc.GetData<uint8_t>(1));
+    base::Tensor back;
+    ASSERT_EQ(base::Tensor::FromImage(image, back), M_OK);
+    EXPECT_EQ(back.GetShape(), nhwc.GetShape());
+    EXPECT_EQ(base::Image::FromTensor(nhwc, M_PIX_FMT_BGR888, image), M_NOT_SUPPORT);
+    EXPECT_EQ(base::Image::FromTensor(nhwc, M_PIX_FMT_GRAY32, image), M_NOT_SUPPORT);
+    EXPECT_EQ(base::Image::FromTensor(nchw, M_PIX_FMT_BGR323232, image), M_NOT_SUPPORT);
+    EXPECT_EQ(base::Image::FromTensor(nchw, M_PIX_FMT_BGR888_PLANAR, image), M_NOT_SUPPORT);
+    EXPECT_EQ(base::Image::FromTensor(nchw, M_PIX_FMT_NV12, image), M_NOT_SUPPORT);
+}
+
+TEST_F(ImageTest, ImageFile) {
+    const uint32_t w = 37, h = 11;
+    base::Image bgr(w, h, 2, M_PIX_FMT_BGR888, TimeStamp(), M_MEM_ON_CPU);
+    for (uint32_t i = 0; i < bgr.GetSize(); ++i) {
+        bgr.GetData<uint8_t>()[i] = static_cast<uint8_t>(i * 7 + (i >> 4));
+    }
+
+    // ppm keeps rgb order, bgr is swapped on write
+    const std::string ppm = "image_file_test.ppm", pgm = "image_file_test.pgm";
+    ASSERT_EQ(base::write_pnm(ppm, bgr, 1), M_OK);
+    base::Image rgb, back;
+    ASSERT_EQ(base::read_pnm(ppm, rgb), M_OK);
+    EXPECT_EQ(rgb.GetPixelFormat(), M_PIX_FMT_RGB888);
+    EXPECT_EQ(rgb.GetWidth(), w);
+    EXPECT_EQ(rgb.GetHeight(), h);
+    ASSERT_EQ(base::convert_color(rgb, M_PIX_FMT_BGR888, back), M_OK);
+    EXPECT_EQ(memcmp(back.GetData<void>(), bgr.GetData<void>(1), bgr.GetScalar()), 0);
+
+    // comments in header and padded rows
+    base::Image gray(w, h, 1, M_PIX_FMT_GRAY8, TimeStamp(), {64}, 0, M_MEM_ON_CPU);
+    for (uint32_t y = 0; y < h; ++y) {
+        for (uint32_t x = 0; x < w; ++x) {
+            gray.GetData<uint8_t>()[y * 64 + x] = static_cast<uint8_t>(x * y);
+        }
+    }
+    ASSERT_EQ(base::write_pnm(pgm, gray), M_OK);
+    base::Image pgm_image;
+    ASSERT_EQ(base::read_pnm(pgm, pgm_image), M_OK);
+    EXPECT_EQ(pgm_image.GetPixelFormat(), M_PIX_FMT_GRAY8);
+    EXPECT_EQ(pgm_image.GetData<uint8_t>()[5 * w + 7], 35);
+    FILE* file = fopen(pgm.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fprintf(file, "P5\n# dump\n2 2 # size\n255\n");
+    fwrite("\x01\x02\x03\x04", 1, 4, file);
+    fclose(file);
+    ASSERT_EQ(base::read_pnm(pgm, pgm_image), M_OK);
+    EXPECT_EQ(pgm_image.GetData<uint8_t>()[3], 4);
+    file = fopen(pgm.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fprintf(file, "P5 4 4 65535\n");
+    fclose(file);
+    EXPECT_EQ(base::read_pnm(pgm, pgm_image), M_NOT_SUPPORT);
+    file = fopen(pgm.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fprintf(file, "P5 4 4 255\n123");
+    fclose(file);
+    EXPECT_EQ(base::read_pnm(pgm, pgm_image), M_INVALID_FILE_FORMAT);
+    EXPECT_EQ(base::write_pnm(pgm, bgr, 2), M_INVALID_ARG);
+
+    // raw frames of padded and detached images read back dense, mapping outlives the file
+    const std::string raw = "image_file_test.nv12";
+    base::Image nv12(w + 1, h + 1, 2, M_PIX_FMT_NV12_DETACH, TimeStamp(), {64, 64}, 0);
+    for (uint32_t n = 0; n < 2; ++n) {
+        base::ImagePlane planes[IMAGE_MAX_PLANES];
+        ASSERT_EQ(nv12.GetPlanes(n, planes), 2U);
+        for (uint32_t p = 0; p < 2; ++p) {
+            for (uint32_t y = 0; y < planes[p].height * planes[p].pitch; ++y) {
+                planes[p].data[y] = static_cast<uint8_t>(y * 3 + p * 50 + n);
+            }
+        }
+    }
+    ASSERT_EQ(base::write_raw(raw, nv12), M_OK);
+    base::Image frames, dense;
+    ASSERT_EQ(base::read_raw(raw, w + 1, h + 1, 2, M_PIX_FMT_NV12, frames), M_OK);
+    remove(raw.c_str());
+    ASSERT_EQ(base::convert_color(nv12, M_PIX_FMT_BGR888, back), M_OK);
+    ASSERT_EQ(base::convert_color(frames, M_PIX_FMT_BGR888, dense), M_OK);
+    EXPECT_EQ(memcmp(back.GetData<void>(), dense.GetData<void>(), back.GetSize()), 0);
+    EXPECT_EQ(base::read_raw(ppm, w, h, 3, M_PIX_FMT_BGR888, frames), M_INVALID_FILE_FORMAT);
+    EXPECT_EQ(base::read_raw(ppm, w, h, 1, M_PIX_FMT_BGR888, frames, {w}), M_INVALID_ARG);
+    EXPECT_EQ(base::read_raw(ppm, w, h, 1, M_PIX_FMT_NV12, frames, {}, h - 1), M_INVALID_ARG);
+
+    // batch dump on the compute pipe
+    std::vector<std::string> paths;
+    std::vector<base::Image> images;
+    for (uint32_t i = 0; i < 6; ++i) {
+        paths.push_back("image_file_test_" + std::to_string(i) + ".raw");
+        base::Image item;
+        ASSERT_EQ(bgr.ImageSplit(i % 2, item), M_OK);
+        images.push_back(item);
+    }
+    ASSERT_EQ(base::write_images(paths, images, false), M_OK);
+    for (uint32_t i = 0; i < 6; ++i) {
+        ASSERT_EQ(base::read_raw(paths[i], w, h, 1, M_PIX_FMT_BGR888, frames), M_OK);
+        EXPECT_EQ(memcmp(frames.GetData<void>(), bgr.GetData<void>(i % 2), bgr.GetScalar()), 0);
+        remove(paths[i].c_str());
+    }
+    EXPECT_EQ(base::write_images(paths, {bgr}), M_INVALID_ARG);
+    remove(ppm.c_str());
+    remove(pgm.c_str());
+}
+
+TEST_F(ImageTest, Stats) {
+    const uint32_t w = 101, h = 37, number = 2;
+    base::Image bgr(w, h, number, M_PIX_FMT_BGR888, TimeStamp(), M_MEM_ON_CPU);
+    for (uint32_t i = 0; i < bgr.GetSize(); ++i) {
+        bgr.GetData<uint8_t>()[i] = static_cast<uint8_t>((i * 2654435761U) >> 13) % 200 + i % 3;
+    }
+    double sum[3] = {0}, sq[3] = {0}, lo[3] = {255, 255, 255}, hi[3] = {0, 0, 0};
+    std::vector<uint32_t> ref(3 * IMAGE_HIST_BINS, 0U);
+    for (uint32_t i = 0; i < bgr.GetSize(); ++i) {
+        const uint8_t v = bgr.GetData<uint8_t>()[i];
+        sum[i % 3] += v;
+        sq[i % 3] += 1.0 * v * v;
+        lo[i % 3] = std::min(lo[i % 3], 1.0 * v);
+        hi[i % 3] = std::max(hi[i % 3], 1.0 * v);
+        ref[i % 3 * IMAGE_HIST_BINS + v]++;
+    }
+    const double count = 1.0 * w * h * number;
+
+    // packed, planar, fp32 and fp16 of the same pixels give the same statistics
+    base::Image planar, fp32, fp16;
+    const float one[3] = {1.f, 1.f, 1.f}, zero[3] = {0.f, 0.f, 0.f};
+    ASSERT_EQ(base::convert_color(bgr, M_PIX_FMT_BGR888_PLANAR, planar), M_OK);
+    ASSERT_EQ(base::normalize(bgr, M_PIX_FMT_BGR323232, one, zero, fp32), M_OK);
+    ASSERT_EQ(base::normalize(bgr, M_PIX_FMT_BGR161616_PLANAR, one, zero, fp16), M_OK);
+    for (const base::Image* image : {&bgr, &planar, &fp32, &fp16}) {
+        base::ImageStats stats;
+        ASSERT_EQ(base::image_stats(*image, stats), M_OK);
+        EXPECT_EQ(stats.channel, 3U);
+        EXPECT_EQ(stats.count, static_cast<uint64_t>(count));
+        for (uint32_t c = 0; c < 3; ++c) {
+            const double mean = sum[c] / count;
+            EXPECT_NEAR(stats.mean[c], mean, 1e-3);
+            EXPECT_NEAR(stats.stddev[c], std::sqrt(sq[c] / count - mean * mean), 1e-3);
+            EXPECT_EQ(stats.min[c], lo[c]);
+            EXPECT_EQ(stats.max[c], hi[c]);
+        }
+    }
+    // small deviations of a large mean, squares of values would take all bits of fp32
+    const float step[3] = {1.f / 64, 1.f / 64, 1.f / 64}, large[3] = {1e5f, -1e5f, 7e4f};
+    base::Image shifted;
+    ASSERT_EQ(base::normalize(bgr, M_PIX_FMT_BGR323232, step, large, shifted), M_OK);
+    base::ImageStats shifted_stats;
+    ASSERT_EQ(base::image_stats(shifted, shifted_stats), M_OK);
+    for (uint32_t c = 0; c < 3; ++c) {
+        const double mean = sum[c] / count;
+        EXPECT_NEAR(shifted_stats.mean[c], mean / 64 + large[c], 1e-6);
+        EXPECT_NEAR(shifted_stats.stddev[c], std::sqrt(sq[c] / count - mean * mean) / 64, 1e-6);
+    }
+    std::vector<uint32_t> hist;
+    ASSERT_EQ(base::image_histogram(bgr, hist), M_OK);
+    EXPECT_EQ(hist, ref);
+    ASSERT_EQ(base::image_histogram(planar, hist), M_OK);
+    EXPECT_EQ(hist, ref);
+
+    // crop view reads rows in place
+    base::Image crop, dense;
+    ASSERT_EQ(bgr.Crop(3, 2, 60, 30, crop), M_OK);
+    ASSERT_EQ(crop.CloneInto(dense), M_OK);
+    base::ImageStats view_stats, dense_stats;
+    std::vector<uint32_t> view_hist;
+    ASSERT_EQ(base::image_stats(crop, view_stats), M_OK);
+    ASSERT_EQ(base::image_stats(dense, dense_stats), M_OK);
+    ASSERT_EQ(base::image_histogram(crop, view_hist), M_OK);
+    ASSERT_EQ(base::image_histogram(dense, hist), M_OK);
+    EXPECT_EQ(view_hist, hist);
+    for (uint32_t c = 0; c < 3; ++c) {
+        EXPECT_DOUBLE_EQ(view_stats.mean[c], dense_stats.mean[c]);
+        EXPECT_DOUBLE_EQ(view_stats.max[c], dense_stats.max[c]);
+    }
+
+    base::Image nv12(w + 1, h + 1, 1, M_PIX_FMT_NV12, TimeStamp(), M_MEM_ON_CPU);
+    base::ImageStats stats;
+    EXPECT_EQ(base::image_stats(nv12, stats), M_NOT_SUPPORT);
+    EXPECT_EQ(base::image_histogram(fp32, hist), M_NOT_SUPPORT);
+}
+
 TEST_F(TensorTest, Matrix_GetShape_API) {
     const int rows = 100, cols = 50;
     std::vector<uint32_t> shape{1, 1, rows, cols};
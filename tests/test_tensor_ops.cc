@@ -0,0 +1,950 @@
+#include "common.h"
+#include "image/image.h"
+#include "log.h"
+#include "tensor/batch.h"
+#include "tensor/conv2d.h"
+#include "tensor/innerproduct.h"
+#include "tensor/innerproduct_kernel.h"
+#include "tensor/layout.h"
+#include "tensor/reduce.h"
+#include "tensor/sparse.h"
+#include "tensor/tensor.h"
+#include "tensor/tensor_file.h"
+#include "utils/test_util.h"
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+class TensorOpsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+#ifdef CONFIG_SIMPLE_BASE_ENABLE_SPDLOG
+        close_level();
+#endif
+    }
+};
+
+using namespace base;
+
+TEST_F(TensorOpsTest, innerproduct_fp32) {
+    // the second shape has several K and N panels and row tiles of gemm
+    const uint32_t shapes[][3] = {{7, 13, 21}, {70, 300, 150}};
+    for (const auto& shape : shapes) {
+        const uint32_t M = shape[0], K = shape[1], N = shape[2];
+        auto left  = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, M, K},
+                                             M_LAYOUT_NCHW,
+                                             M_MEM_ON_CPU,
+                                             M_DATA_TYPE_FLOAT32);
+        auto right = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, K, N},
+                                              M_LAYOUT_NCHW,
+                                              M_MEM_ON_CPU,
+                                              M_DATA_TYPE_FLOAT32);
+        auto bias  = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, 1, N},
+                                             M_LAYOUT_NCHW,
+                                             M_MEM_ON_CPU,
+                                             M_DATA_TYPE_FLOAT32);
+        init_random<float>(left->GetData<float>(0), M * K, -1, 1);
+        init_random<float>(right->GetData<float>(0), K * N, -1, 1);
+        init_random<float>(bias->GetData<float>(0), N, -1, 1);
+
+        auto out = innerproduct(left, right, bias);
+        ASSERT_NE(out, nullptr);
+        EXPECT_EQ(out->GetShape(2), M);
+        EXPECT_EQ(out->GetShape(3), N);
+        for (uint32_t i = 0; i < M; ++i) {
+            for (uint32_t j = 0; j < N; ++j) {
+                float ref = bias->GetData<float>(0)[j];
+                for (uint32_t k = 0; k < K; ++k) {
+                    ref += left->GetData<float>(0)[i * K + k] * right->GetData<float>(0)[k * N + j];
+                }
+                ASSERT_NEAR(out->GetData<float>(0)[i * N + j], ref, 1e-3);
+            }
+        }
+    }
+}
+
+TEST_F(TensorOpsTest, innerproduct_int8) {
+    const uint32_t M = 5, K = 37, N = 19;
+    auto left  = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, M, K},
+                                         M_LAYOUT_NCHW,
+                                         M_MEM_ON_CPU,
+                                         M_DATA_TYPE_UINT8);
+    auto right = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, K, N},
+                                          M_LAYOUT_NCHW,
+                                          M_MEM_ON_CPU,
+                                          M_DATA_TYPE_INT8);
+    uint8_t* a = left->GetData<uint8_t>(0);
+    int8_t* b  = right->GetData<int8_t>(0);
+    for (uint32_t i = 0; i < M * K; ++i) {
+        a[i] = static_cast<uint8_t>((i * 37 + 11) % 256);
+    }
+
+    // full int8 range and reduced 7bits range select different AVX2 kernels
+    for (int range : {128, 64}) {
+        for (uint32_t i = 0; i < K * N; ++i) {
+            b[i] = static_cast<int8_t>(static_cast<int>((i * 53 + 7) % (2 * range)) - range);
+        }
+        auto out = innerproduct(left, right, nullptr);
+        ASSERT_NE(out, nullptr);
+        EXPECT_EQ(out->GetElemType(), M_DATA_TYPE_FLOAT32);
+        for (uint32_t i = 0; i < M; ++i) {
+            for (uint32_t j = 0; j < N; ++j) {
+                int32_t ref = 0;
+                for (uint32_t k = 0; k < K; ++k) {
+                    ref += a[i * K + k] * b[k * N + j];
+                }
+                EXPECT_EQ(out->GetData<float>(0)[i * N + j], static_cast<float>(ref));
+            }
+        }
+    }
+
+    // zero point compensation, per channel scale and requantize
+    auto packed = Int8Weight::Pack(right, std::vector<float>(N, 0.01f));
+    ASSERT_NE(packed, nullptr);
+    QuantParam in_param{0.02f, 128};
+    QuantParam out_param{0.5f, 10};
+    auto out_f = innerproduct_int8(left, in_param, *packed, nullptr);
+    auto out_q = innerproduct_int8(left, in_param, *packed, nullptr, M_DATA_TYPE_UINT8, out_param);
+    ASSERT_NE(out_f, nullptr);
+    ASSERT_NE(out_q, nullptr);
+    for (uint32_t i = 0; i < M; ++i) {
+        for (uint32_t j = 0; j < N; ++j) {
+            float ref = 0.f;
+            for (uint32_t k = 0; k < K; ++k) {
+                ref += 0.02f * (a[i * K + k] - 128) * 0.01f * b[k * N + j];
+            }
+            EXPECT_NEAR(out_f->GetData<float>(0)[i * N + j], ref, 1e-3);
+            const long q = std::min(std::max(lrintf(ref / 0.5f) + 10L, 0L), 255L);
+            EXPECT_NEAR(out_q->GetData<uint8_t>(0)[i * N + j], q, 1);
+        }
+    }
+
+    // pre-packed weight of several tiles, out buffer is reused across calls
+    const uint32_t M2 = 9, K2 = 70, N2 = 300;
+    auto left2  = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, M2, K2},
+                                          M_LAYOUT_NCHW,
+                                          M_MEM_ON_CPU,
+                                          M_DATA_TYPE_UINT8);
+    auto right2 = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, K2, N2},
+                                           M_LAYOUT_NCHW,
+                                           M_MEM_ON_CPU,
+                                           M_DATA_TYPE_INT8);
+    for (uint32_t i = 0; i < M2 * K2; ++i) {
+        left2->GetData<uint8_t>(0)[i] = static_cast<uint8_t>(i * 29 + 3);
+    }
+    for (uint32_t i = 0; i < K2 * N2; ++i) {
+        right2->GetData<int8_t>(0)[i] = static_cast<int8_t>(static_cast<int>(i * 41 % 256) - 128);
+    }
+    auto packed2 = Int8Weight::Pack(right2, std::vector<float>(N2, 0.5f));
+    ASSERT_NE(packed2, nullptr);
+    Tensor out2;
+    ASSERT_EQ(innerproduct(left2, packed2, nullptr, out2), M_OK);
+    const float* buffer = out2.GetData<float>(0);
+    ASSERT_EQ(innerproduct(left2, packed2, nullptr, out2), M_OK);
+    EXPECT_EQ(out2.GetData<float>(0), buffer);
+    auto raw2 = innerproduct(left2, right2, nullptr);
+    ASSERT_NE(raw2, nullptr);
+    const uint8_t* a2 = left2->GetData<uint8_t>(0);
+    const int8_t* b2  = right2->GetData<int8_t>(0);
+    for (uint32_t i = 0; i < M2; ++i) {
+        for (uint32_t j = 0; j < N2; ++j) {
+            int32_t ref = 0;
+            for (uint32_t k = 0; k < K2; ++k) {
+                ref += a2[i * K2 + k] * b2[k * N2 + j];
+            }
+            ASSERT_EQ(out2.GetData<float>(0)[i * N2 + j], 0.5f * ref);
+            ASSERT_EQ(raw2->GetData<float>(0)[i * N2 + j], static_cast<float>(ref));
+        }
+    }
+}
+
+/// kernel of a library loaded after the first innerproduct, writes shape M * N to c
+class LateKernel final : public InnerProductKernel {
+public:
+    void Run(const float*,
+             const uint32_t,
+             const float*,
+             const uint32_t,
+             const float*,
+             float* c,
+             const uint32_t ldc) const override {
+        for (uint32_t i = 0; i < 2; ++i) {
+            std::fill(c + i * ldc, c + i * ldc + 5, 10.f);
+        }
+    }
+};
+
+TEST_F(TensorOpsTest, innerproduct_fixed) {
+    auto& kernels = RegisterBase<InnerProductKernel>::GetInstance();
+    EXPECT_FALSE(kernels.IsRegistered(InnerProductKernel::Key(7, 21, 13)));
+
+    // N of 10 has a masked tail, N of 128 has two column chunks
+    const uint32_t shapes[][3] = {{1, 10, 256}, {4, 64, 128}, {1, 128, 256}};
+    for (const auto& shape : shapes) {
+        const uint32_t M = shape[0], N = shape[1], K = shape[2];
+        EXPECT_TRUE(kernels.IsRegistered(InnerProductKernel::Key(M, N, K)));
+
+        auto left  = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, M, K},
+                                             M_LAYOUT_NCHW,
+                                             M_MEM_ON_CPU,
+                                             M_DATA_TYPE_FLOAT32,
+                                             M_TENSOR_PADDING_DEALIAS);
+        auto right = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, K, N},
+                                              M_LAYOUT_NCHW,
+                                              M_MEM_ON_CPU,
+                                              M_DATA_TYPE_FLOAT32);
+        auto bias  = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, 1, N},
+                                             M_LAYOUT_NCHW,
+                                             M_MEM_ON_CPU,
+                                             M_DATA_TYPE_FLOAT32);
+        for (uint32_t i = 0; i < M; ++i) {
+            init_random<float>(left->GetRow<float>(0, i), K, -1, 1);
+        }
+        init_random<float>(right->GetData<float>(0), K * N, -1, 1);
+        init_random<float>(bias->GetData<float>(0), N, -1, 1);
+
+        auto out = innerproduct(left, right, bias);
+        ASSERT_NE(out, nullptr);
+        for (uint32_t i = 0; i < M; ++i) {
+            for (uint32_t j = 0; j < N; ++j) {
+                float ref = bias->GetData<float>(0)[j];
+                for (uint32_t k = 0; k < K; ++k) {
+                    ref += left->GetRow<float>(0, i)[k] * right->GetData<float>(0)[k * N + j];
+                }
+                EXPECT_NEAR(out->GetRow<float>(0, i)[j], ref, 1e-3);
+            }
+        }
+    }
+
+    // a miss is looked up again after the registry grows
+    auto small = std::make_shared<Tensor>(
+        std::vector<uint32_t>{1, 1, 2, 3}, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32);
+    auto wide  = std::make_shared<Tensor>(
+        std::vector<uint32_t>{1, 1, 3, 5}, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32);
+    init_random<float>(small->GetData<float>(0), 6, -1, 1);
+    init_random<float>(wide->GetData<float>(0), 15, -1, 1);
+    const std::string late = InnerProductKernel::Key(2, 5, 3);
+    if (!kernels.IsRegistered(late)) {
+        auto generic = innerproduct(small, wide, nullptr);
+        ASSERT_NE(generic, nullptr);
+        EXPECT_LT(fabsf(generic->GetData<float>(0)[0]), 3.f);
+        kernels.Register(late, [] { return std::make_shared<LateKernel>(); });
+    }
+    auto fixed = innerproduct(small, wide, nullptr);
+    ASSERT_NE(fixed, nullptr);
+    for (uint32_t i = 0; i < 2; ++i) {
+        for (uint32_t j = 0; j < 5; ++j) {
+            EXPECT_EQ(fixed->GetRow<float>(0, i)[j], 10.f);
+        }
+    }
+
+    // K of 30 leaves a tail of the unrolled K loop, N of 70 a second chunk with masked tail
+    const uint32_t M = 3, N = 70, K = 30;
+    std::vector<float> a(M * K), b(K * N), c(M * N);
+    init_random<float>(a.data(), M * K, -1, 1);
+    init_random<float>(b.data(), K * N, -1, 1);
+    FixedInnerProduct<M, N, K>().Run(a.data(), K, b.data(), N, nullptr, c.data(), N);
+    for (uint32_t i = 0; i < M; ++i) {
+        for (uint32_t j = 0; j < N; ++j) {
+            float ref = 0.f;
+            for (uint32_t k = 0; k < K; ++k) {
+                ref += a[i * K + k] * b[k * N + j];
+            }
+            EXPECT_NEAR(c[i * N + j], ref, 1e-3);
+        }
+    }
+}
+
+TEST_F(TensorOpsTest, sparse_innerproduct) {
+    // N of 20 leaves a tail block of 4 with block 8
+    const uint32_t M = 3, K = 37, N = 20;
+    auto left   = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, M, K},
+                                         M_LAYOUT_NCHW,
+                                         M_MEM_ON_CPU,
+                                         M_DATA_TYPE_FLOAT32,
+                                         M_TENSOR_PADDING_CACHE_LINE);
+    auto weight = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, K, N},
+                                           M_LAYOUT_NCHW,
+                                           M_MEM_ON_CPU,
+                                           M_DATA_TYPE_FLOAT32);
+    auto bias   = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, 1, N},
+                                         M_LAYOUT_NCHW,
+                                         M_MEM_ON_CPU,
+                                         M_DATA_TYPE_FLOAT32);
+    for (uint32_t i = 0; i < M; ++i) {
+        init_random<float>(left->GetRow<float>(0, i), K, -1, 1);
+        left->GetRow<float>(0, i)[i] = 0.f;
+    }
+    float* w = weight->GetData<float>(0);
+    init_random<float>(w, K * N, -1, 1);
+    init_random<float>(bias->GetData<float>(0), N, -1, 1);
+    for (uint32_t i = 0; i < K * N; ++i) {
+        w[i] = fabs(w[i]) < 0.7f ? 0.f : w[i];
+    }
+
+    auto dense = innerproduct(left, weight, bias);
+    ASSERT_NE(dense, nullptr);
+    for (uint32_t block : {1U, 8U}) {
+        auto sparse = SparseMatrix::FromDense(weight, 0.f, block);
+        ASSERT_NE(sparse, nullptr);
+        EXPECT_EQ(sparse->GetRowPtr().size(), K + 1);
+        if (block == 1U) {
+            EXPECT_LT(sparse->GetDensity(), 0.5f);
+        }
+        auto restored = sparse->ToDense();
+        ASSERT_NE(restored, nullptr);
+        EXPECT_EQ(memcmp(restored->GetData<float>(0), w, K * N * sizeof(float)), 0);
+
+        auto out = innerproduct_sparse(left, *sparse, bias);
+        ASSERT_NE(out, nullptr);
+        for (uint32_t i = 0; i < M; ++i) {
+            for (uint32_t j = 0; j < N; ++j) {
+                EXPECT_NEAR(out->GetRow<float>(0, i)[j], dense->GetRow<float>(0, i)[j], 1e-4);
+            }
+        }
+    }
+
+    // weight^T * left^T as sparse * dense
+    auto sparse = SparseMatrix::FromDense(left, 0.5f, 8);
+    ASSERT_NE(sparse, nullptr);
+    auto out = spmm(*sparse, weight, nullptr);
+    ASSERT_NE(out, nullptr);
+    auto kept = sparse->ToDense();
+    for (uint32_t i = 0; i < M; ++i) {
+        for (uint32_t j = 0; j < N; ++j) {
+            float ref = 0.f;
+            for (uint32_t k = 0; k < K; ++k) {
+                ref += kept->GetRow<float>(0, i)[k] * w[k * N + j];
+            }
+            EXPECT_NEAR(out->GetRow<float>(0, i)[j], ref, 1e-4);
+        }
+    }
+    EXPECT_EQ(spmm(*sparse, left, nullptr), nullptr);
+}
+
+TEST_F(TensorOpsTest, conv2d) {
+    struct Case {
+        TensorLayout layout;
+        uint32_t c, oc, k, stride, pad, dilation, group;
+        ActivationType activation;
+    };
+    // pointwise, im2col, grouped dilated and depthwise of both layouts
+    const Case cases[] = {{M_LAYOUT_NCHW, 8, 16, 1, 1, 0, 1, 1, M_ACTIVATION_NONE},
+                          {M_LAYOUT_NCHW, 3, 8, 3, 1, 1, 1, 1, M_ACTIVATION_RELU},
+                          {M_LAYOUT_NCHW, 4, 6, 3, 2, 2, 2, 2, M_ACTIVATION_RELU6},
+                          {M_LAYOUT_NCHW, 12, 12, 3, 1, 1, 1, 12, M_ACTIVATION_RELU},
+                          {M_LAYOUT_NCHW, 12, 12, 3, 2, 1, 1, 12, M_ACTIVATION_NONE},
+                          {M_LAYOUT_NHWC, 8, 16, 1, 1, 0, 1, 1, M_ACTIVATION_NONE},
+                          {M_LAYOUT_NHWC, 3, 8, 3, 1, 1, 1, 1, M_ACTIVATION_RELU},
+                          {M_LAYOUT_NHWC, 4, 6, 3, 2, 2, 2, 2, M_ACTIVATION_RELU6},
+                          {M_LAYOUT_NHWC, 12, 12, 3, 2, 1, 1, 12, M_ACTIVATION_RELU}};
+    const uint32_t N = 2, H = 11, W = 19;
+    for (const auto& t : cases) {
+        const bool nchw = t.layout == M_LAYOUT_NCHW;
+        std::vector<uint32_t> shape =
+            nchw ? std::vector<uint32_t>{N, t.c, H, W} : std::vector<uint32_t>{N, H, W, t.c};
+        auto input  = std::make_shared<Tensor>(
+            shape, t.layout, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32, M_TENSOR_PADDING_CACHE_LINE);
+        auto weight = std::make_shared<Tensor>(std::vector<uint32_t>{t.oc, t.c / t.group, t.k, t.k},
+                                               M_LAYOUT_NCHW,
+                                               M_MEM_ON_CPU,
+                                               M_DATA_TYPE_FLOAT32);
+        auto bias   = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, 1, t.oc},
+                                             M_LAYOUT_NCHW,
+                                             M_MEM_ON_CPU,
+                                             M_DATA_TYPE_FLOAT32);
+        for (uint32_t n = 0; n < N; ++n) {
+            for (uint32_t r = 0; r < input->GetRows(); ++r) {
+                init_random<float>(input->GetRow<float>(n, r), input->GetRowSize() / 4, -1, 1);
+            }
+        }
+        init_random<float>(weight->GetData<float>(0), weight->GetCount(), -1, 1);
+        init_random<float>(bias->GetData<float>(0), t.oc, -1, 1);
+
+        auto at = [&](uint32_t n, uint32_t ch, uint32_t y, uint32_t x) {
+            return nchw ? input->GetRow<float>(n, ch * H + y)[x]
+                        : input->GetRow<float>(n, y)[x * t.c + ch];
+        };
+
+        Conv2dParam param(t.stride, t.pad, t.group);
+        param.dilation_h = param.dilation_w = t.dilation;
+        param.activation = t.activation;
+        auto out         = conv2d(input, weight, bias, param);
+        ASSERT_NE(out, nullptr);
+        const uint32_t span = t.dilation * (t.k - 1) + 1;
+        const uint32_t OH   = (H + 2 * t.pad - span) / t.stride + 1;
+        const uint32_t OW   = (W + 2 * t.pad - span) / t.stride + 1;
+        EXPECT_EQ(out->GetShape(nchw ? 2 : 1), OH);
+        EXPECT_EQ(out->GetShape(nchw ? 3 : 2), OW);
+
+        const uint32_t ic_g = t.c / t.group, oc_g = t.oc / t.group;
+        for (uint32_t n = 0; n < N; ++n) {
+            for (uint32_t oc = 0; oc < t.oc; ++oc) {
+                for (uint32_t oy = 0; oy < OH; ++oy) {
+                    for (uint32_t ox = 0; ox < OW; ++ox) {
+                        float ref = bias->GetData<float>(0)[oc];
+                        for (uint32_t ic = 0; ic < ic_g; ++ic) {
+                            for (uint32_t ky = 0; ky < t.k; ++ky) {
+                                for (uint32_t kx = 0; kx < t.k; ++kx) {
+                                    const int y = oy * t.stride + ky * t.dilation - t.pad;
+                                    const int x = ox * t.stride + kx * t.dilation - t.pad;
+                                    if (y < 0 || y >= (int)H || x < 0 || x >= (int)W) {
+                                        continue;
+                                    }
+                                    ref += weight->GetRow<float>(oc, ic * t.k + ky)[kx] *
+                                           at(n, oc / oc_g * ic_g + ic, y, x);
+                                }
+                            }
+                        }
+                        if (t.activation != M_ACTIVATION_NONE) {
+                            ref = std::max(ref, 0.f);
+                        }
+                        if (t.activation == M_ACTIVATION_RELU6) {
+                            ref = std::min(ref, 6.f);
+                        }
+                        const float val = nchw ? out->GetRow<float>(n, oc * OH + oy)[ox]
+                                               : out->GetRow<float>(n, oy)[ox * t.oc + oc];
+                        ASSERT_NEAR(val, ref, 1e-4);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_F(TensorOpsTest, out_param) {
+    const uint32_t M = 5, K = 33, N = 20;
+    auto left   = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, M, K},
+                                         M_LAYOUT_NCHW,
+                                         M_MEM_ON_CPU,
+                                         M_DATA_TYPE_FLOAT32,
+                                         M_TENSOR_PADDING_CACHE_LINE);
+    auto weight = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, K, N},
+                                           M_LAYOUT_NCHW,
+                                           M_MEM_ON_CPU,
+                                           M_DATA_TYPE_FLOAT32);
+    for (uint32_t i = 0; i < M; ++i) {
+        init_random<float>(left->GetRow<float>(0, i), K, -1, 1);
+    }
+    init_random<float>(weight->GetData<float>(0), K * N, -1, 1);
+
+    // the second call writes into the buffer of the first
+    Tensor out;
+    ASSERT_EQ(innerproduct(left, weight, nullptr, out), M_OK);
+    float* buffer = out.GetData<float>(0);
+    init_random<float>(weight->GetData<float>(0), K * N, -1, 1);
+    ASSERT_EQ(innerproduct(left, weight, nullptr, out), M_OK);
+    EXPECT_EQ(out.GetData<float>(0), buffer);
+    auto ref = innerproduct(left, weight, nullptr);
+    ASSERT_NE(ref, nullptr);
+    for (uint32_t i = 0; i < M; ++i) {
+        EXPECT_EQ(memcmp(out.GetRow<float>(0, i), ref->GetRow<float>(0, i), N * sizeof(float)), 0);
+    }
+    EXPECT_EQ(innerproduct(left, weight, nullptr, *left), M_INVALID_ARG);
+
+    // another shape gets a new buffer
+    Tensor sum;
+    ASSERT_EQ(reduce(*left, 3, M_REDUCE_SUM, sum), M_OK);
+    buffer = sum.GetData<float>(0);
+    ASSERT_EQ(reduce(*left, 3, M_REDUCE_MAX, sum), M_OK);
+    EXPECT_EQ(sum.GetData<float>(0), buffer);
+    ASSERT_EQ(reduce(*left, 2, M_REDUCE_MAX, sum), M_OK);
+    EXPECT_EQ(sum.GetShape(), (std::vector<uint32_t>{1, 1, 1, K}));
+
+    Tensor trans;
+    ASSERT_EQ(transpose(*left, trans), M_OK);
+    EXPECT_EQ(trans.GetShape(), (std::vector<uint32_t>{1, 1, K, M}));
+    EXPECT_EQ(trans.GetRow<float>(0, 7)[3], left->GetRow<float>(0, 3)[7]);
+    ASSERT_EQ(softmax(trans, 3, out), M_OK);
+    EXPECT_EQ(out.GetShape(), trans.GetShape());
+
+    // reshape is a view, padded rows only keep W
+    Tensor view;
+    ASSERT_EQ(reshape(*weight, {1, K, 1, N}, view), M_OK);
+    EXPECT_EQ(view.GetData<float>(0), weight->GetData<float>(0));
+    EXPECT_EQ(reshape(*weight, {1, 1, N, K + 1}, view), M_INVALID_ARG);
+    EXPECT_EQ(reshape(*left, {1, 1, 1, M * K}, view), M_NOT_SUPPORT);
+    ASSERT_EQ(reshape(*left, {1, M, 1, K}, view), M_OK);
+    EXPECT_EQ(view.GetRow<float>(0, 4), left->GetRow<float>(0, 4));
+
+    // move leaves source without buffer
+    Tensor moved(std::move(out));
+    EXPECT_EQ(out.GetData<void>(), nullptr);
+    EXPECT_NE(moved.GetData<void>(), nullptr);
+    out = std::move(moved);
+    EXPECT_EQ(moved.GetData<void>(), nullptr);
+    EXPECT_EQ(out.GetShape(), trans.GetShape());
+}
+
+TEST_F(TensorOpsTest, reduce_axis) {
+    const std::vector<uint32_t> shape{2, 3, 5, 19};
+    auto tensor =
+        std::make_shared<Tensor>(shape, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32);
+    init_random<float>(tensor->GetData<float>(0), tensor->GetCount(), -2, 2);
+    const float* x = tensor->GetData<float>(0);
+
+    for (uint32_t axis = 0; axis < 4; ++axis) {
+        uint32_t outer = 1, inner = 1, len = shape[axis];
+        for (uint32_t i = 0; i < axis; ++i) {
+            outer *= shape[i];
+        }
+        for (uint32_t i = axis + 1; i < 4; ++i) {
+            inner *= shape[i];
+        }
+        auto sum    = reduce(tensor, axis, M_REDUCE_SUM);
+        auto max    = reduce(tensor, axis, M_REDUCE_MAX);
+        auto argmin = reduce(tensor, axis, M_REDUCE_ARGMIN);
+        auto lse    = reduce(tensor, axis, M_REDUCE_LOG_SUM_EXP);
+        auto prob   = softmax(tensor, axis);
+        ASSERT_NE(sum, nullptr);
+        ASSERT_NE(prob, nullptr);
+        EXPECT_EQ(sum->GetShape(axis), 1U);
+        EXPECT_EQ(argmin->GetElemType(), M_DATA_TYPE_INT32);
+        for (uint32_t o = 0; o < outer; ++o) {
+            for (uint32_t j = 0; j < inner; ++j) {
+                float ref_sum = 0.f, ref_max = -1e9f, ref_min = 1e9f, ref_exp = 0.f, prob_sum = 0.f;
+                int32_t ref_argmin = 0;
+                for (uint32_t a = 0; a < len; ++a) {
+                    const float v = x[(o * len + a) * inner + j];
+                    ref_sum += v;
+                    ref_max = std::max(ref_max, v);
+                    ref_exp += expf(v);
+                    prob_sum += prob->GetData<float>(0)[(o * len + a) * inner + j];
+                    if (v < ref_min) {
+                        ref_min    = v;
+                        ref_argmin = a;
+                    }
+                }
+                EXPECT_NEAR(sum->GetData<float>(0)[o * inner + j], ref_sum, 1e-4);
+                EXPECT_EQ(max->GetData<float>(0)[o * inner + j], ref_max);
+                EXPECT_EQ(argmin->GetData<int32_t>(0)[o * inner + j], ref_argmin);
+                EXPECT_NEAR(lse->GetData<float>(0)[o * inner + j], logf(ref_exp), 1e-4);
+                EXPECT_NEAR(prob_sum, 1.f, 1e-5);
+            }
+        }
+    }
+}
+
+TEST_F(TensorOpsTest, softmax_stable) {
+    std::vector<float> logits{1000.f, 1001.f, 1002.f, -1000.f, 0.f, 1.f, 2.f, 3.f, 4.f, 5.f};
+    auto tensor = std::make_shared<Tensor>(logits.data(),
+                                           std::vector<uint32_t>{1, 1, 1, 10},
+                                           M_LAYOUT_NCHW,
+                                           M_MEM_ON_CPU,
+                                           M_DATA_TYPE_FLOAT32);
+    auto prob   = softmax(tensor, 3);
+    ASSERT_NE(prob, nullptr);
+    float sum = 0.f;
+    for (uint32_t i = 0; i < 10; ++i) {
+        EXPECT_FALSE(std::isnan(prob->GetData<float>(0)[i]));
+        sum += prob->GetData<float>(0)[i];
+    }
+    EXPECT_NEAR(sum, 1.f, 1e-5);
+    EXPECT_GT(prob->GetData<float>(0)[2], prob->GetData<float>(0)[1]);
+}
+
+TEST_F(TensorOpsTest, tensor_file) {
+    const std::string path = "tensor_file_test.bin";
+    auto weight = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, 17, 9},
+                                           M_LAYOUT_NCHW,
+                                           M_MEM_ON_CPU,
+                                           M_DATA_TYPE_FLOAT32);
+    auto labels = std::make_shared<Tensor>(std::vector<uint32_t>{2, 5, 3, 1},
+                                           M_LAYOUT_NHWC,
+                                           M_MEM_ON_CPU,
+                                           M_DATA_TYPE_UINT8);
+    init_random<float>(weight->GetData<float>(0), weight->GetCount(), -1, 1);
+    for (uint32_t i = 0; i < labels->GetCount(); ++i) {
+        labels->GetData<uint8_t>(0)[i] = static_cast<uint8_t>(i);
+    }
+    weight->SetName("fc.weight");
+
+    TensorFileWriter writer;
+    ASSERT_EQ(writer.Open(path), M_OK);
+    EXPECT_EQ(writer.Write(*weight), M_OK);
+    EXPECT_EQ(writer.Write("labels", *labels), M_OK);
+    EXPECT_EQ(writer.Close(), M_OK);
+
+    std::shared_ptr<Tensor> mapped;
+    {
+        TensorFileReader reader;
+        ASSERT_EQ(reader.Open(path, true), M_OK);
+        ASSERT_EQ(reader.GetCount(), 2U);
+        EXPECT_EQ(reader.GetNames()[0], "fc.weight");
+        mapped = reader.Get("labels");
+        auto w = reader.Get(0);
+        ASSERT_NE(w, nullptr);
+        EXPECT_EQ(w->GetShape(), weight->GetShape());
+        EXPECT_EQ(reinterpret_cast<size_t>(w->GetData<void>()) % TENSOR_FILE_ALIGN, 0U);
+        EXPECT_EQ(memcmp(w->GetData<void>(), weight->GetData<void>(), weight->GetSize()), 0);
+    }
+    // tensor keeps the mapping after reader released
+    ASSERT_NE(mapped, nullptr);
+    EXPECT_EQ(mapped->GetShapeMode(), M_LAYOUT_NHWC);
+    EXPECT_EQ(mapped->GetElemType(), M_DATA_TYPE_UINT8);
+    EXPECT_EQ(memcmp(mapped->GetData<void>(), labels->GetData<void>(), labels->GetSize()), 0);
+
+    // corrupt one byte of first payload, after file header, entry header and name
+    FILE* file = fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    fseek(file, 3 * TENSOR_FILE_ALIGN + 1, SEEK_SET);
+    fputc(0x5a, file);
+    fclose(file);
+    TensorFileReader reader;
+    EXPECT_EQ(reader.Open(path, true), M_INVALID_FILE_FORMAT);
+    EXPECT_EQ(reader.Open(path, false), M_OK);
+    remove(path.c_str());
+}
+
+TEST_F(TensorOpsTest, clone_into) {
+    // larger than parallel grain and stream threshold
+    auto src = std::make_shared<Tensor>(std::vector<uint32_t>{2, 3, 301, 517},
+                                        M_LAYOUT_NCHW,
+                                        M_MEM_ON_CPU,
+                                        M_DATA_TYPE_FLOAT32);
+    init_random<float>(src->GetData<float>(0), src->GetCount(), -1, 1);
+    src->SetName("src");
+
+    auto replica = src->Clone();
+    ASSERT_NE(replica, nullptr);
+    EXPECT_NE(replica->GetData<float>(0), src->GetData<float>(0));
+    EXPECT_EQ(replica->GetShape(), src->GetShape());
+    EXPECT_EQ(memcmp(replica->GetData<void>(), src->GetData<void>(), src->GetSize()), 0);
+
+    // same byte size reuses buffer of target
+    Tensor target(std::vector<uint32_t>{1, 6, 517, 301},
+                  M_LAYOUT_NCHW,
+                  M_MEM_ON_CPU,
+                  M_DATA_TYPE_FLOAT32);
+    float* buffer = target.GetData<float>(0);
+    ASSERT_EQ(src->CloneInto(target), M_OK);
+    EXPECT_EQ(target.GetData<float>(0), buffer);
+    EXPECT_EQ(target.GetShape(), src->GetShape());
+    EXPECT_EQ(target.GetName(), "src");
+    EXPECT_EQ(memcmp(target.GetData<void>(), src->GetData<void>(), src->GetSize()), 0);
+
+    // different size gets a new buffer, odd size covers unaligned tail
+    Tensor small(std::vector<uint32_t>{1, 1, 3, 1001}, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_UINT8);
+    for (uint32_t i = 0; i < small.GetCount(); ++i) {
+        small.GetData<uint8_t>(0)[i] = static_cast<uint8_t>(i * 7);
+    }
+    ASSERT_EQ(target.CopyFrom(small), M_OK);
+    EXPECT_EQ(target.GetElemType(), M_DATA_TYPE_UINT8);
+    EXPECT_EQ(target.GetSize(), small.GetSize());
+    EXPECT_EQ(memcmp(target.GetData<void>(), small.GetData<void>(), small.GetSize()), 0);
+
+    Tensor empty;
+    EXPECT_EQ(target.CopyFrom(empty), M_INVALID_ARG);
+}
+
+TEST_F(TensorOpsTest, batch_stack) {
+    std::vector<std::shared_ptr<Tensor>> items;
+    for (uint32_t n = 0; n < 4; ++n) {
+        auto item = std::make_shared<Tensor>(std::vector<uint32_t>{1, 3, 5, 7},
+                                             M_LAYOUT_NCHW,
+                                             M_MEM_ON_CPU,
+                                             M_DATA_TYPE_FLOAT32);
+        init_random<float>(item->GetData<float>(0), item->GetCount(), -1, 1);
+        items.push_back(item);
+    }
+
+    Tensor batch;
+    ASSERT_EQ(stack(items, batch), M_OK);
+    EXPECT_EQ(batch.GetShape(), (std::vector<uint32_t>{4, 3, 5, 7}));
+    float* buffer = batch.GetData<float>(0);
+    // second call writes into the same batch buffer
+    ASSERT_EQ(stack(items, batch), M_OK);
+    EXPECT_EQ(batch.GetData<float>(0), buffer);
+
+    auto views = unstack(std::make_shared<Tensor>(batch));
+    ASSERT_EQ(views.size(), 4U);
+    for (uint32_t n = 0; n < 4; ++n) {
+        EXPECT_EQ(views[n]->GetShape(), items[n]->GetShape());
+        EXPECT_EQ(views[n]->GetData<float>(0), batch.GetData<float>(n));
+        EXPECT_EQ(memcmp(views[n]->GetData<void>(), items[n]->GetData<void>(), items[n]->GetSize()),
+                  0);
+    }
+
+    // concat along C of NCHW interleaves rows of every input
+    auto channel = concat({items[0], items[1]}, 1);
+    ASSERT_NE(channel, nullptr);
+    EXPECT_EQ(channel->GetShape(1), 6U);
+    EXPECT_EQ(memcmp(channel->GetData<float>(0) + 3 * 5 * 7, items[1]->GetData<void>(), items[1]->GetSize()),
+              0);
+
+    // concat along C of NHWC
+    auto a = std::make_shared<Tensor>(
+        std::vector<uint32_t>{2, 4, 4, 3}, M_LAYOUT_NHWC, M_MEM_ON_CPU, M_DATA_TYPE_UINT8);
+    auto b = std::make_shared<Tensor>(
+        std::vector<uint32_t>{2, 4, 4, 1}, M_LAYOUT_NHWC, M_MEM_ON_CPU, M_DATA_TYPE_UINT8);
+    memset(a->GetData<void>(), 1, a->GetSize());
+    memset(b->GetData<void>(), 2, b->GetSize());
+    auto rgba = concat({a, b}, 3);
+    ASSERT_NE(rgba, nullptr);
+    for (uint32_t i = 0; i < 2 * 4 * 4; ++i) {
+        EXPECT_EQ(rgba->GetData<uint8_t>(0)[i * 4 + 2], 1);
+        EXPECT_EQ(rgba->GetData<uint8_t>(0)[i * 4 + 3], 2);
+    }
+    EXPECT_EQ(concat({a, items[0]}, 3), nullptr);
+
+    // images of same format stack into NHWC tensor
+    std::vector<std::shared_ptr<Image>> images;
+    for (uint32_t n = 0; n < 3; ++n) {
+        auto image = std::make_shared<Image>(8, 6, 1, M_PIX_FMT_BGR888, TimeStamp(), M_MEM_ON_CPU);
+        memset(image->GetData<void>(), static_cast<int>(n), image->GetSize());
+        images.push_back(image);
+    }
+    auto image_batch = stack(images);
+    ASSERT_NE(image_batch, nullptr);
+    EXPECT_EQ(image_batch->GetShape(), (std::vector<uint32_t>{3, 6, 8, 3}));
+    EXPECT_EQ(image_batch->GetShapeMode(), M_LAYOUT_NHWC);
+    EXPECT_EQ(image_batch->GetData<uint8_t>(2)[0], 2);
+}
+
+TEST_F(TensorOpsTest, padded_pitch) {
+    const std::vector<uint32_t> shape{2, 3, 5, 225};
+    auto padded = std::make_shared<Tensor>(
+        shape, M_LAYOUT_NCHW, M_MEM_ON_CPU, M_DATA_TYPE_FLOAT32, M_TENSOR_PADDING_CACHE_LINE);
+    EXPECT_EQ(padded->GetStride(), 960U);
+    EXPECT_EQ(padded->GetRowSize(), 900U);
+    EXPECT_EQ(padded->GetCount(), 2U * 3 * 5 * 225);
+    EXPECT_FALSE(padded->IsDense());
+    for (uint32_t r = 0; r < padded->GetRows(); ++r) {
+        EXPECT_EQ(reinterpret_cast<size_t>(padded->GetRow<float>(1, r)) % TENSOR_PITCH_ALIGN, 0U);
+    }
+    Tensor dealias(std::vector<uint32_t>{1, 1, 4, 256},
+                   M_LAYOUT_NCHW,
+                   M_MEM_ON_CPU,
+                   M_DATA_TYPE_FLOAT32,
+                   M_TENSOR_PADDING_DEALIAS);
+    EXPECT_EQ(dealias.GetStride(), 1088U);
+
+    // explicit copies to and from dense buffer
+    std::vector<float> dense(padded->GetCount());
+    init_random<float>(dense.data(), dense.size(), -1, 1);
+    ASSERT_EQ(padded->CopyFromDense(dense.data()), M_OK);
+    EXPECT_EQ(padded->GetRow<float>(1, 4)[7], dense[(3 * 5 + 4) * 225 + 7]);
+    EXPECT_EQ(padded->GetDataAt<float>(3 * 5 * 225 + 4 * 225 + 7), dense[(3 * 5 + 4) * 225 + 7]);
+    std::vector<float> back(dense.size());
+    ASSERT_EQ(padded->CopyToDense(back.data()), M_OK);
+    EXPECT_EQ(back, dense);
+    auto plain = padded->Clone(M_TENSOR_PADDING_NONE);
+    ASSERT_NE(plain, nullptr);
+    EXPECT_TRUE(plain->IsDense());
+    EXPECT_EQ(memcmp(plain->GetData<void>(), dense.data(), plain->GetSize()), 0);
+
+    // kernels give the same result on padded and dense rows of NCHW and NHWC along every axis
+    auto pixels = std::make_shared<Tensor>(std::vector<uint32_t>{2, 5, 75, 3},
+                                           M_LAYOUT_NHWC,
+                                           M_MEM_ON_CPU,
+                                           M_DATA_TYPE_FLOAT32,
+                                           M_TENSOR_PADDING_CACHE_LINE);
+    ASSERT_EQ(pixels->CopyFromDense(dense.data()), M_OK);
+    EXPECT_FALSE(pixels->IsDense());
+    // W = 1 and H = W = 1 put every element in a padded row of its own
+    auto column = std::make_shared<Tensor>(std::vector<uint32_t>{2, 3, 5, 1},
+                                           M_LAYOUT_NCHW,
+                                           M_MEM_ON_CPU,
+                                           M_DATA_TYPE_FLOAT32,
+                                           M_TENSOR_PADDING_CACHE_LINE);
+    auto point  = std::make_shared<Tensor>(std::vector<uint32_t>{2, 7, 1, 1},
+                                           M_LAYOUT_NCHW,
+                                           M_MEM_ON_CPU,
+                                           M_DATA_TYPE_FLOAT32,
+                                           M_TENSOR_PADDING_CACHE_LINE);
+    ASSERT_EQ(column->CopyFromDense(dense.data()), M_OK);
+    ASSERT_EQ(point->CopyFromDense(dense.data()), M_OK);
+    EXPECT_FALSE(column->IsDense());
+    EXPECT_FALSE(point->IsDense());
+    for (const auto& input : {padded, pixels, column, point}) {
+        auto copy = input->Clone(M_TENSOR_PADDING_NONE);
+        for (uint32_t axis = 0; axis < 4; ++axis) {
+            for (ReduceType type : {M_REDUCE_SUM, M_REDUCE_ARGMAX, M_REDUCE_LOG_SUM_EXP}) {
+                auto a = reduce(input, axis, type);
+                auto b = reduce(copy, axis, type);
+                ASSERT_NE(a, nullptr);
+                for (uint32_t i = 0; i < b->GetCount(); ++i) {
+                    if (type == M_REDUCE_ARGMAX) {
+                        ASSERT_EQ(a->GetData<int32_t>(0)[i], b->GetData<int32_t>(0)[i]);
+                    } else {
+                        ASSERT_NEAR(a->GetData<float>(0)[i], b->GetData<float>(0)[i], 1e-4);
+                    }
+                }
+            }
+            auto prob = softmax(input, axis);
+            auto ref  = softmax(copy, axis);
+            ASSERT_NE(prob, nullptr);
+            EXPECT_EQ(prob->GetStride(), input->GetStride());
+            for (uint32_t i = 0; i < ref->GetCount(); i += 7) {
+                ASSERT_NEAR(prob->GetDataAt<float>(i), ref->GetDataAt<float>(i), 1e-6);
+            }
+        }
+    }
+    Tensor ones(std::vector<uint32_t>{1, 1, 5, 1},
+                M_LAYOUT_NCHW,
+                M_MEM_ON_CPU,
+                M_DATA_TYPE_FLOAT32,
+                M_TENSOR_PADDING_CACHE_LINE);
+    const float values[5] = {1.f, 2.f, 3.f, 4.f, 5.f};
+    ASSERT_EQ(ones.CopyFromDense(values), M_OK);
+    Tensor total, peak, prob;
+    ASSERT_EQ(reduce(ones, 2, M_REDUCE_SUM, total), M_OK);
+    ASSERT_EQ(reduce(ones, 2, M_REDUCE_MAX, peak), M_OK);
+    ASSERT_EQ(softmax(ones, 2, prob), M_OK);
+    EXPECT_EQ(total.GetData<float>(0)[0], 15.f);
+    EXPECT_EQ(peak.GetData<float>(0)[0], 5.f);
+    float sum = 0.f;
+    for (uint32_t i = 0; i < 5; ++i) {
+        sum += prob.GetDataAt<float>(i);
+    }
+    EXPECT_NEAR(sum, 1.f, 1e-6);
+
+    const uint32_t M = 9, K = 33, N = 17;
+    auto left  = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, M, K},
+                                         M_LAYOUT_NCHW,
+                                         M_MEM_ON_CPU,
+                                         M_DATA_TYPE_FLOAT32,
+                                         M_TENSOR_PADDING_CACHE_LINE);
+    auto right = std::make_shared<Tensor>(std::vector<uint32_t>{1, 1, K, N},
+                                          M_LAYOUT_NCHW,
+                                          M_MEM_ON_CPU,
+                                          M_DATA_TYPE_FLOAT32,
+                                          M_TENSOR_PADDING_CACHE_LINE);
+    std::vector<float> a(M * K), b(K * N);
+    init_random<float>(a.data(), a.size(), -1, 1);
+    init_random<float>(b.data(), b.size(), -1, 1);
+    left->CopyFromDense(a.data());
+    right->CopyFromDense(b.data());
+    auto out = innerproduct(left, right, nullptr);
+    ASSERT_NE(out, nullptr);
+    EXPECT_EQ(out->GetPadding(), M_TENSOR_PADDING_CACHE_LINE);
+    for (uint32_t i = 0; i < M; ++i) {
+        for (uint32_t j = 0; j < N; ++j) {
+            float ref = 0.f;
+            for (uint32_t k = 0; k < K; ++k) {
+                ref += a[i * K + k] * b[k * N + j];
+            }
+            EXPECT_NEAR(out->GetRow<float>(0, i)[j], ref, 1e-4);
+        }
+    }
+    auto trans = transpose(left);
+    ASSERT_NE(trans, nullptr);
+    EXPECT_EQ(trans->GetRow<float>(0, 5)[2], a[2 * K + 5]);
+
+    // batch with padded items, file payload is stored dense
+    auto batch = stack({padded, plain});
+    ASSERT_NE(batch, nullptr);
+    EXPECT_EQ(batch->GetStride(), 960U);
+    auto items = unstack(batch);
+    ASSERT_EQ(items.size(), 4U);
+    EXPECT_EQ(items[3]->GetRow<float>(0, 14)[224], plain->GetRow<float>(1, 14)[224]);
+    auto channel = concat({padded, plain}, 1);
+    ASSERT_NE(channel, nullptr);
+    EXPECT_EQ(channel->GetRow<float>(1, 3 * 5 + 2)[9], plain->GetRow<float>(1, 2)[9]);
+    auto width = concat({padded, plain}, 3);
+    ASSERT_NE(width, nullptr);
+    EXPECT_EQ(width->GetRow<float>(1, 7)[225 + 9], plain->GetRow<float>(1, 7)[9]);
+
+    const std::string path = "tensor_file_pitch.bin";
+    TensorFileWriter writer;
+    ASSERT_EQ(writer.Open(path), M_OK);
+    EXPECT_EQ(writer.Write("padded", *padded), M_OK);
+    writer.Close();
+    TensorFileReader reader;
+    ASSERT_EQ(reader.Open(path, true), M_OK);
+    EXPECT_EQ(memcmp(reader.Get(0)->GetData<void>(), dense.data(), plain->GetSize()), 0);
+    reader.Close();
+    remove(path.c_str());
+}
+
+TEST_F(TensorOpsTest, blocked_layout) {
+    const uint32_t N = 2, C = 13, H = 5, W = 19;
+    auto planar = std::make_shared<Tensor>(std::vector<uint32_t>{N, C, H, W},
+                                           M_LAYOUT_NCHW,
+                                           M_MEM_ON_CPU,
+                                           M_DATA_TYPE_FLOAT32,
+                                           M_TENSOR_PADDING_CACHE_LINE);
+    std::vector<float> dense(planar->GetCount());
+    init_random<float>(dense.data(), dense.size(), -1, 1);
+    planar->CopyFromDense(dense.data());
+
+    for (TensorLayout layout : {M_LAYOUT_NC8HW8, M_LAYOUT_NC16HW16}) {
+        const uint32_t block = LayoutChannelBlock(layout);
+        auto blocked         = convert_layout(planar, layout);
+        ASSERT_NE(blocked, nullptr);
+        EXPECT_EQ(blocked->GetShape(), planar->GetShape());
+        EXPECT_EQ(blocked->GetRows(), (C + block - 1) / block * H);
+        EXPECT_EQ(blocked->GetRowSize(), W * block * sizeof(float));
+        for (uint32_t n = 0; n < N; ++n) {
+            for (uint32_t c = 0; c < (C + block - 1) / block * block; ++c) {
+                for (uint32_t y = 0; y < H; ++y) {
+                    for (uint32_t x = 0; x < W; ++x) {
+                        const float* row = blocked->GetRow<float>(n, c / block * H + y);
+                        const float v    = row[x * block + c % block];
+                        EXPECT_EQ(v, c < C ? dense[((n * C + c) * H + y) * W + x] : 0.f);
+                    }
+                }
+            }
+        }
+
+        // blocked -> NCHW and blocked -> NHWC -> blocked keep every element
+        auto back = convert_layout(blocked, M_LAYOUT_NCHW);
+        ASSERT_NE(back, nullptr);
+        std::vector<float> result(back->GetCount());
+        back->CopyToDense(result.data());
+        EXPECT_EQ(result, dense);
+
+        auto pixels = convert_layout(blocked, M_LAYOUT_NHWC);
+        ASSERT_NE(pixels, nullptr);
+        EXPECT_EQ(pixels->GetShape(), (std::vector<uint32_t>{N, H, W, C}));
+        EXPECT_EQ(pixels->GetRow<float>(1, 3)[7 * C + 11],
+                  dense[((1 * C + 11) * H + 3) * W + 7]);
+        auto again = convert_layout(pixels, layout);
+        ASSERT_NE(again, nullptr);
+        std::vector<float> packed(blocked->GetCount()), repacked(again->GetCount());
+        blocked->CopyToDense(packed.data());
+        again->CopyToDense(repacked.data());
+        EXPECT_EQ(packed, repacked);
+    }
+
+    // depthwise 3x3 runs on blocked layout, general kernel goes through NCHW
+    for (uint32_t group : {C, 1U}) {
+        auto weight = std::make_shared<Tensor>(std::vector<uint32_t>{C, C / group, 3, 3},
+                                               M_LAYOUT_NCHW,
+                                               M_MEM_ON_CPU,
+                                               M_DATA_TYPE_FLOAT32);
+        init_random<float>(weight->GetData<float>(0), weight->GetCount(), -1, 1);
+        Conv2dParam param(1, 1, group);
+        param.activation = M_ACTIVATION_RELU;
+        auto ref         = conv2d(planar, weight, nullptr, param);
+        auto out         = conv2d(convert_layout(planar, M_LAYOUT_NC8HW8), weight, nullptr, param);
+        ASSERT_NE(ref, nullptr);
+        ASSERT_NE(out, nullptr);
+        EXPECT_EQ(out->GetShapeMode(), M_LAYOUT_NC8HW8);
+        auto out_planar = convert_layout(out, M_LAYOUT_NCHW);
+        std::vector<float> a(ref->GetCount()), b(out_planar->GetCount());
+        ref->CopyToDense(a.data());
+        out_planar->CopyToDense(b.data());
+        for (size_t i = 0; i < a.size(); ++i) {
+            ASSERT_NEAR(a[i], b[i], 1e-5);
+        }
+        EXPECT_EQ(out->GetRow<float>(0, 1 * H + 2)[3 * 8 + 7], 0.f);
+
+        // out of blocked input keeps its buffer across calls
+        auto input = convert_layout(planar, M_LAYOUT_NC16HW16);
+        Tensor reused;
+        ASSERT_EQ(conv2d(input, weight, nullptr, param, reused), M_OK);
+        const float* buffer = reused.GetData<float>(0);
+        ASSERT_EQ(conv2d(input, weight, nullptr, param, reused), M_OK);
+        EXPECT_EQ(reused.GetData<float>(0), buffer);
+        EXPECT_EQ(reused.GetShapeMode(), M_LAYOUT_NC16HW16);
+        ASSERT_EQ(convert_layout(reused, M_LAYOUT_NCHW, *out_planar), M_OK);
+        out_planar->CopyToDense(b.data());
+        for (size_t i = 0; i < a.size(); ++i) {
+            ASSERT_NEAR(a[i], b[i], 1e-5);
+        }
+    }
+}